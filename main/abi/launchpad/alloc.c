@@ -0,0 +1,427 @@
+/* -------------------------------------------------------------
+ * launchpad_alloc_api.c
+ *
+ * Slab / heap / PSRAM tiered allocator for loaded ELF modules.
+ * See include/alloc.h.
+ * ------------------------------------------------------------- */
+
+#include "include/alloc.h"
+#include "include/arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "elf/esp_elf.h"
+
+static const char *TAG = "LaunchpadAlloc";
+
+#if CONFIG_CACHE_L2_CACHE_LINE_SIZE
+#define CACHE_LINE      CONFIG_CACHE_L2_CACHE_LINE_SIZE
+#elif CONFIG_CACHE_L1_CACHE_LINE_SIZE
+#define CACHE_LINE      CONFIG_CACHE_L1_CACHE_LINE_SIZE
+#else
+#define CACHE_LINE      64
+#endif
+
+#if CONFIG_SPIRAM
+#define PSRAM_MIN       CONFIG_LAUNCHPAD_ALLOC_PSRAM_MIN
+#else
+#define PSRAM_MIN       SIZE_MAX
+#endif
+
+#define SLAB_PAGE       4096        /* carved into objects of one class */
+#define SLAB_POOL_ALIGN 512         /* power-of-two classes are size-aligned */
+#define MAG_SIZE        16          /* objects cached per core and class */
+
+_Static_assert(LAUNCHPAD_ALLOC_SLAB_MAX == SLAB_POOL_ALIGN, "largest class must be pool-aligned");
+
+/* Size classes; the powers of two double as aligned classes */
+static const uint16_t s_class_size[] = { 16, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+
+#define CLASS_COUNT     (sizeof(s_class_size) / sizeof(s_class_size[0]))
+
+/* Class of a request, indexed by (size + 15) / 16 */
+static uint8_t s_class_of[LAUNCHPAD_ALLOC_SLAB_MAX / 16 + 1];
+
+/* Per-core cache; only touched with interrupts masked on its core */
+typedef struct {
+    uint32_t count;
+    void    *slot[MAG_SIZE];
+} magazine_t;
+
+/* Shared free list of a class, fed from pool pages */
+typedef struct {
+    void        *head;      /* objects linked through their first word */
+    portMUX_TYPE lock;
+} depot_t;
+
+static magazine_t s_mag[portNUM_PROCESSORS][CLASS_COUNT];
+static depot_t    s_depot[CLASS_COUNT];
+
+static uint8_t   *s_pool;           /* SLAB_PAGE * s_pages bytes of internal RAM */
+static uint8_t   *s_page_class;     /* class of each page; pages keep it for good */
+static uint32_t   s_pages;          /* 0 until the pool is reserved */
+static uint32_t   s_pages_used;
+
+/* The pool is reserved on first use: with arenas, apps may never get here */
+enum { POOL_NONE, POOL_BUSY, POOL_READY, POOL_FAILED };
+static uint32_t   s_pool_state;
+
+/* ------------------------------------------------------------------
+ * Slabs
+ * ------------------------------------------------------------------ */
+
+static inline bool slab_owns(const void *p)
+{
+    return (uintptr_t)p - (uintptr_t)s_pool < (uintptr_t)s_pages * SLAB_PAGE;
+}
+
+static inline int slab_class(const void *p)
+{
+    return s_page_class[((const uint8_t *)p - s_pool) / SLAB_PAGE];
+}
+
+/* Reserve the pool; false while another task does it or if there is no memory */
+static bool slab_pool_reserve(void)
+{
+    const size_t pool = CONFIG_LAUNCHPAD_ALLOC_SLAB_POOL_SIZE;
+    uint32_t state = POOL_NONE;
+
+    if (!__atomic_compare_exchange_n(&s_pool_state, &state, POOL_BUSY, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        return state == POOL_READY;
+    }
+
+    s_page_class = calloc(pool / SLAB_PAGE, 1);
+    s_pool = heap_caps_aligned_alloc(SLAB_POOL_ALIGN, pool, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!s_pool || !s_page_class) {
+        ESP_LOGW(TAG, "no memory for a %d byte slab pool, small blocks use the heap", (int)pool);
+        heap_caps_free(s_pool);
+        free(s_page_class);
+        s_pool = NULL;
+        s_page_class = NULL;
+        __atomic_store_n(&s_pool_state, POOL_FAILED, __ATOMIC_RELEASE);
+        return false;
+    }
+
+    __atomic_store_n(&s_pages, pool / SLAB_PAGE, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_pool_state, POOL_READY, __ATOMIC_RELEASE);
+    ESP_LOGI(TAG, "slab pool: %d x %d bytes", (int)(pool / SLAB_PAGE), SLAB_PAGE);
+    return true;
+}
+
+/* Carve a fresh page into a list of objects, or NULL when the pool is used up */
+static void *slab_carve(int cls, void **tail)
+{
+    const size_t sz = s_class_size[cls];
+
+    if (!s_pages && !slab_pool_reserve()) {
+        return NULL;
+    }
+
+    if (__atomic_load_n(&s_pages_used, __ATOMIC_RELAXED) >= s_pages) {
+        return NULL;
+    }
+
+    uint32_t page = __atomic_fetch_add(&s_pages_used, 1, __ATOMIC_RELAXED);
+    if (page >= s_pages) {
+        return NULL;
+    }
+
+    uint8_t *base = s_pool + (size_t)page * SLAB_PAGE;
+    size_t n = SLAB_PAGE / sz;
+
+    s_page_class[page] = cls;
+    for (size_t i = 0; i + 1 < n; i++) {
+        *(void **)(base + i * sz) = base + (i + 1) * sz;
+    }
+    *tail = base + (n - 1) * sz;
+    return base;
+}
+
+/* Slow path: move half a magazine from the depot and return one object */
+static void *slab_refill(int cls)
+{
+    depot_t *d = &s_depot[cls];
+    void *p = NULL;
+
+    for (;;) {
+        portENTER_CRITICAL(&d->lock);
+        if (d->head) {
+            magazine_t *m = &s_mag[xPortGetCoreID()][cls];
+
+            p = d->head;
+            d->head = *(void **)p;
+            while (d->head && m->count < MAG_SIZE / 2) {
+                m->slot[m->count++] = d->head;
+                d->head = *(void **)d->head;
+            }
+        }
+        portEXIT_CRITICAL(&d->lock);
+
+        if (p) {
+            return p;
+        }
+
+        void *tail;
+        void *head = slab_carve(cls, &tail);
+        if (!head) {
+            return NULL;
+        }
+
+        portENTER_CRITICAL(&d->lock);
+        *(void **)tail = d->head;
+        d->head = head;
+        portEXIT_CRITICAL(&d->lock);
+    }
+}
+
+/* Slow path: the magazine is full, hand half of it and @p to the depot */
+static void slab_flush(int cls, void *p)
+{
+    depot_t *d = &s_depot[cls];
+
+    portENTER_CRITICAL(&d->lock);
+    magazine_t *m = &s_mag[xPortGetCoreID()][cls];
+
+    *(void **)p = d->head;
+    d->head = p;
+    while (m->count > MAG_SIZE / 2) {
+        void *q = m->slot[--m->count];
+
+        *(void **)q = d->head;
+        d->head = q;
+    }
+    portEXIT_CRITICAL(&d->lock);
+}
+
+static void *slab_alloc(int cls)
+{
+    UBaseType_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+    magazine_t *m = &s_mag[xPortGetCoreID()][cls];
+    void *p = m->count ? m->slot[--m->count] : NULL;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+
+    return p ? p : slab_refill(cls);
+}
+
+static void slab_free(void *p)
+{
+    int cls = slab_class(p);
+
+    UBaseType_t irq = portSET_INTERRUPT_MASK_FROM_ISR();
+    magazine_t *m = &s_mag[xPortGetCoreID()][cls];
+    bool cached = m->count < MAG_SIZE;
+    if (cached) {
+        m->slot[m->count++] = p;
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq);
+
+    if (!cached) {
+        slab_flush(cls, p);
+    }
+}
+
+/* Smallest power-of-two class that is a whole number of lines */
+static int slab_aligned_class(size_t size)
+{
+    for (int cls = 0; cls < (int)CLASS_COUNT; cls++) {
+        size_t sz = s_class_size[cls];
+
+        if (sz >= size && sz >= CACHE_LINE && (sz & (sz - 1)) == 0) {
+            return cls;
+        }
+    }
+    return -1;
+}
+
+/* ------------------------------------------------------------------
+ * Heap tiers
+ * ------------------------------------------------------------------ */
+
+static void *heap_alloc(size_t size, uint32_t caps, size_t align)
+{
+    return align ? heap_caps_aligned_alloc(align, size, caps) : heap_caps_malloc(size, caps);
+}
+
+static void *tier_alloc(size_t size, size_t align)
+{
+    void *p = NULL;
+
+    if (size >= PSRAM_MIN) {
+        p = heap_alloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, align);
+    }
+    return p ? p : heap_alloc(size, MALLOC_CAP_DEFAULT, align);
+}
+
+/* ------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------ */
+
+void launchpad_alloc_init(void)
+{
+    int cls = 0;
+
+    for (size_t i = 0; i < sizeof(s_class_of); i++) {
+        while (s_class_size[cls] < (i ? i * 16 : 1)) {
+            cls++;
+        }
+        s_class_of[i] = cls;
+    }
+
+    for (int i = 0; i < (int)CLASS_COUNT; i++) {
+        portMUX_INITIALIZE(&s_depot[i].lock);
+    }
+
+    _register_symbol("launchpad_malloc", (void *)launchpad_malloc);
+    _register_symbol("launchpad_calloc", (void *)launchpad_calloc);
+    _register_symbol("launchpad_realloc", (void *)launchpad_realloc);
+    _register_symbol("launchpad_free", (void *)launchpad_free);
+    _register_symbol("launchpad_malloc_caps", (void *)launchpad_malloc_caps);
+    _register_symbol("launchpad_malloc_aligned", (void *)launchpad_malloc_aligned);
+    _register_symbol("launchpad_calloc_aligned", (void *)launchpad_calloc_aligned);
+    _register_symbol("launchpad_cache_line_size", (void *)launchpad_cache_line_size);
+
+    ESP_LOGI(TAG, "slab pool %d bytes on first use, PSRAM from %d bytes, line %d",
+             CONFIG_LAUNCHPAD_ALLOC_SLAB_POOL_SIZE, PSRAM_MIN == SIZE_MAX ? -1 : (int)PSRAM_MIN,
+             CACHE_LINE);
+}
+
+void *launchpad_malloc(size_t size)
+{
+    if (size <= LAUNCHPAD_ALLOC_SLAB_MAX) {
+        void *p = slab_alloc(s_class_of[(size + 15) / 16]);
+        if (p) {
+            return p;
+        }
+    }
+    return tier_alloc(size, 0);
+}
+
+void *launchpad_calloc(size_t nmemb, size_t size)
+{
+    size_t n;
+
+    if (__builtin_mul_overflow(nmemb, size, &n)) {
+        return NULL;
+    }
+
+    void *p = launchpad_malloc(n);
+    if (p) {
+        memset(p, 0, n);
+    }
+    return p;
+}
+
+void *launchpad_realloc(void *ptr, size_t size)
+{
+    if (!ptr) {
+        return launchpad_malloc(size);
+    }
+    if (!size) {
+        launchpad_free(ptr);
+        return NULL;
+    }
+
+    if (slab_owns(ptr)) {
+        size_t have = s_class_size[slab_class(ptr)];
+
+        if (size <= have) {
+            return ptr;
+        }
+
+        void *p = launchpad_malloc(size);
+        if (p) {
+            memcpy(p, ptr, have);
+            slab_free(ptr);
+        }
+        return p;
+    }
+
+    /* The app's own malloc() hands out arena blocks */
+    if (launchpad_arena_owns(ptr)) {
+        return launchpad_arena_realloc(ptr, size);
+    }
+
+    /* Grown past the PSRAM threshold: let the block move out */
+    if (size >= PSRAM_MIN) {
+        void *p = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (p) {
+            return p;
+        }
+    }
+    return heap_caps_realloc(ptr, size, MALLOC_CAP_DEFAULT);
+}
+
+void launchpad_free(void *ptr)
+{
+    if (slab_owns(ptr)) {
+        slab_free(ptr);
+    } else if (launchpad_arena_owns(ptr)) {
+        launchpad_arena_free(ptr);
+    } else {
+        heap_caps_free(ptr);
+    }
+}
+
+void *launchpad_malloc_caps(size_t size, uint32_t flags)
+{
+    const size_t align = (flags & LAUNCHPAD_ALLOC_ALIGNED) ? CACHE_LINE : 0;
+    void *p = NULL;
+
+    if (align) {
+        size = (size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    }
+
+    if (flags & LAUNCHPAD_ALLOC_DMA) {
+        p = heap_alloc(size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, align);
+    } else if (flags & LAUNCHPAD_ALLOC_PSRAM) {
+        p = heap_alloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, align);
+    } else if (flags & LAUNCHPAD_ALLOC_INTERNAL) {
+        int cls = align ? slab_aligned_class(size) :
+                  size <= LAUNCHPAD_ALLOC_SLAB_MAX ? s_class_of[(size + 15) / 16] : -1;
+
+        p = cls >= 0 ? slab_alloc(cls) : NULL;
+        if (!p) {
+            p = heap_alloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, align);
+        }
+    } else if (align) {
+        int cls = slab_aligned_class(size);
+
+        p = cls >= 0 ? slab_alloc(cls) : NULL;
+        if (!p) {
+            p = tier_alloc(size, align);
+        }
+    } else {
+        p = launchpad_malloc(size);
+    }
+
+    if (p && (flags & LAUNCHPAD_ALLOC_ZERO)) {
+        memset(p, 0, size);
+    }
+    return p;
+}
+
+void *launchpad_malloc_aligned(size_t size)
+{
+    return launchpad_malloc_caps(size, LAUNCHPAD_ALLOC_ALIGNED);
+}
+
+void *launchpad_calloc_aligned(size_t nmemb, size_t size)
+{
+    size_t n;
+
+    if (__builtin_mul_overflow(nmemb, size, &n)) {
+        return NULL;
+    }
+    return launchpad_malloc_caps(n, LAUNCHPAD_ALLOC_ALIGNED | LAUNCHPAD_ALLOC_ZERO);
+}
+
+size_t launchpad_cache_line_size(void)
+{
+    return CACHE_LINE;
+}
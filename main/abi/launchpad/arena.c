@@ -0,0 +1,568 @@
+/* -------------------------------------------------------------
+ * launchpad_arena_api.c
+ *
+ * Per-app TLSF heaps for loaded ELF modules. See include/arena.h.
+ * ------------------------------------------------------------- */
+
+#include "include/arena.h"
+#include "include/alloc.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "multi_heap.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#include "elf/esp_elf.h"
+
+static const char *TAG = "LaunchpadArena";
+
+#if CONFIG_LAUNCHPAD_APP_ARENA
+
+#if CONFIG_LAUNCHPAD_APP_ARENA_PSRAM
+#define ARENA_CAPS  (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define ARENA_CAPS  (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+
+/* Tasks an app may have running besides the one it was started in */
+#define ARENA_TASKS_MAX     8
+
+/* Slot of a task that was created but has not reported its handle yet */
+#define TASK_STARTING       ((TaskHandle_t)1)
+
+typedef struct {
+    uintptr_t           code_lo;    /* image owning the arena */
+    uintptr_t           code_hi;
+    uintptr_t           lo;         /* arena memory */
+    uintptr_t           hi;
+    multi_heap_handle_t heap;
+    portMUX_TYPE        lock;       /* taken by multi_heap */
+    TaskHandle_t        owner;      /* task the app was started in */
+    TaskHandle_t        tasks[ARENA_TASKS_MAX];     /* created by the app, still alive */
+} arena_t;
+
+/* Passed to a task created by an app */
+typedef struct {
+    TaskFunction_t      fn;
+    void               *arg;
+    TaskHandle_t       *slot;
+} arena_task_start_t;
+
+/* Passed to a pthread created by an app */
+typedef struct {
+    void             *(*fn)(void *);
+    void               *arg;
+    TaskHandle_t       *slot;
+} arena_pthread_start_t;
+
+static arena_t      s_arenas[LAUNCHPAD_ARENA_MAX];
+static portMUX_TYPE s_slots_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* ------------------------------------------------------------------
+ * Lookup
+ *
+ * Slots only change while their app is not running, so the hot
+ * paths read them without the slot lock.
+ * ------------------------------------------------------------------ */
+
+static bool arena_runs_in(const arena_t *a, TaskHandle_t task)
+{
+    if (task == a->owner) {
+        return true;
+    }
+    for (int i = 0; i < ARENA_TASKS_MAX; i++) {
+        if (a->tasks[i] == task) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * By the caller's address first. A caller outside every image (the
+ * app tail-called malloc, or handed it to firmware as a callback) is
+ * matched by the task it runs in.
+ */
+static arena_t *arena_by_caller(uintptr_t pc)
+{
+    for (int i = 0; i < LAUNCHPAD_ARENA_MAX; i++) {
+        arena_t *a = &s_arenas[i];
+
+        if (a->heap && pc >= a->code_lo && pc < a->code_hi) {
+            return a;
+        }
+    }
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    for (int i = 0; i < LAUNCHPAD_ARENA_MAX; i++) {
+        arena_t *a = &s_arenas[i];
+
+        if (a->heap && arena_runs_in(a, self)) {
+            return a;
+        }
+    }
+    return NULL;
+}
+
+static arena_t *arena_by_ptr(const void *p)
+{
+    uintptr_t addr = (uintptr_t)p;
+
+    for (int i = 0; i < LAUNCHPAD_ARENA_MAX; i++) {
+        arena_t *a = &s_arenas[i];
+
+        if (a->heap && addr >= a->lo && addr < a->hi) {
+            return a;
+        }
+    }
+    return NULL;
+}
+
+/* ------------------------------------------------------------------
+ * libc entry points seen by the app
+ *
+ * An app with an arena never spills into the global heap: running
+ * out of arena returns NULL like any exhausted heap.
+ * ------------------------------------------------------------------ */
+
+static void *arena_malloc_from(uintptr_t pc, size_t n)
+{
+    arena_t *a = arena_by_caller(pc);
+
+    return a ? multi_heap_malloc(a->heap, n) : malloc(n);
+}
+
+static void *arena_malloc(size_t n)
+{
+    return arena_malloc_from((uintptr_t)__builtin_return_address(0), n);
+}
+
+static void *arena_calloc(size_t nmemb, size_t size)
+{
+    size_t n;
+
+    if (__builtin_mul_overflow(nmemb, size, &n)) {
+        return NULL;
+    }
+
+    void *p = arena_malloc_from((uintptr_t)__builtin_return_address(0), n);
+    if (p) {
+        memset(p, 0, n);
+    }
+    return p;
+}
+
+static void *arena_realloc(void *ptr, size_t n)
+{
+    if (!ptr) {
+        return arena_malloc_from((uintptr_t)__builtin_return_address(0), n);
+    }
+
+    arena_t *a = arena_by_ptr(ptr);
+
+    /* Not ours: may still be a launchpad_malloc() slab block */
+    return a ? multi_heap_realloc(a->heap, ptr, n) : launchpad_realloc(ptr, n);
+}
+
+static void arena_free(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    arena_t *a = arena_by_ptr(ptr);
+
+    if (a) {
+        multi_heap_free(a->heap, ptr);
+    } else {
+        launchpad_free(ptr);
+    }
+}
+
+/* ------------------------------------------------------------------
+ * Tasks created by apps
+ *
+ * Tracked so that the arena (and the image) is not released under a
+ * task that still runs app code. A pthread runs in a task that the
+ * firmware's pthread library creates, so it is tracked from inside,
+ * once it starts.
+ * ------------------------------------------------------------------ */
+
+/* Forget @task in whichever arena lists it */
+static void arena_task_forget(TaskHandle_t task)
+{
+    taskENTER_CRITICAL(&s_slots_lock);
+    for (int i = 0; i < LAUNCHPAD_ARENA_MAX; i++) {
+        for (int j = 0; j < ARENA_TASKS_MAX; j++) {
+            if (s_arenas[i].tasks[j] == task) {
+                s_arenas[i].tasks[j] = NULL;
+            }
+        }
+    }
+    taskEXIT_CRITICAL(&s_slots_lock);
+}
+
+/* Reserve a task slot in @a, marked as starting; NULL if all are taken */
+static TaskHandle_t *arena_task_reserve(arena_t *a)
+{
+    TaskHandle_t *slot = NULL;
+
+    taskENTER_CRITICAL(&s_slots_lock);
+    for (int j = 0; j < ARENA_TASKS_MAX; j++) {
+        if (!a->tasks[j]) {
+            slot = &a->tasks[j];
+            *slot = TASK_STARTING;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_slots_lock);
+
+    if (!slot) {
+        ESP_LOGE(TAG, "app already runs %d tasks", ARENA_TASKS_MAX);
+    }
+    return slot;
+}
+
+/* Put the running task into @slot unless its creator already did */
+static void arena_task_started(TaskHandle_t *slot)
+{
+    TaskHandle_t starting = TASK_STARTING;
+
+    __atomic_compare_exchange_n(slot, &starting, xTaskGetCurrentTaskHandle(), false,
+                                __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+static void arena_task_entry(void *arg)
+{
+    arena_task_start_t start = *(arena_task_start_t *)arg;
+
+    heap_caps_free(arg);
+    arena_task_started(start.slot);
+
+    start.fn(start.arg);
+
+    /* Returning from a FreeRTOS task is not allowed; make it an exit */
+    arena_task_forget(xTaskGetCurrentTaskHandle());
+    vTaskDelete(NULL);
+}
+
+static BaseType_t arena_task_create(TaskFunction_t fn, const char *name, uint32_t stack,
+                                    void *arg, UBaseType_t prio, TaskHandle_t *out,
+                                    BaseType_t core)
+{
+    arena_t *a = arena_by_caller((uintptr_t)__builtin_return_address(0));
+    TaskHandle_t *slot;
+    TaskHandle_t task = NULL;
+
+    if (!a) {
+        return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, core);
+    }
+
+    arena_task_start_t *start = heap_caps_malloc(sizeof(*start), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!start) {
+        return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+    }
+
+    slot = arena_task_reserve(a);
+    if (!slot) {
+        heap_caps_free(start);
+        return errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+    }
+
+    start->fn   = fn;
+    start->arg  = arg;
+    start->slot = slot;
+
+    BaseType_t ret = xTaskCreatePinnedToCore(arena_task_entry, name, stack, start, prio, &task, core);
+    if (ret != pdPASS) {
+        heap_caps_free(start);
+        __atomic_store_n(slot, NULL, __ATOMIC_RELEASE);
+        return ret;
+    }
+
+    /* The task may already have filled in its slot, or even be gone */
+    TaskHandle_t starting = TASK_STARTING;
+    __atomic_compare_exchange_n(slot, &starting, task, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+
+    if (out) {
+        *out = task;
+    }
+    return ret;
+}
+
+static BaseType_t arena_task_create_any(TaskFunction_t fn, const char *name, uint32_t stack,
+                                        void *arg, UBaseType_t prio, TaskHandle_t *out)
+{
+    return arena_task_create(fn, name, stack, arg, prio, out, tskNO_AFFINITY);
+}
+
+static void arena_task_delete(TaskHandle_t task)
+{
+    arena_task_forget(task ? task : xTaskGetCurrentTaskHandle());
+    vTaskDelete(task);
+}
+
+static void *arena_pthread_entry(void *arg)
+{
+    arena_pthread_start_t start = *(arena_pthread_start_t *)arg;
+
+    heap_caps_free(arg);
+    arena_task_started(start.slot);
+
+    void *ret = start.fn(start.arg);
+
+    /* What runs after this is the pthread library's, not app code */
+    arena_task_forget(xTaskGetCurrentTaskHandle());
+    return ret;
+}
+
+/* The slot stays "starting" until the thread runs: there is no handle
+ * to fill in from here, and an unstarted thread counts as alive */
+static int arena_pthread_create(pthread_t *thread, const pthread_attr_t *attr,
+                                void *(*fn)(void *), void *arg)
+{
+    arena_t *a = arena_by_caller((uintptr_t)__builtin_return_address(0));
+
+    if (!a) {
+        return pthread_create(thread, attr, fn, arg);
+    }
+
+    arena_pthread_start_t *start = heap_caps_malloc(sizeof(*start), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!start) {
+        return ENOMEM;
+    }
+
+    TaskHandle_t *slot = arena_task_reserve(a);
+    if (!slot) {
+        heap_caps_free(start);
+        return EAGAIN;
+    }
+
+    start->fn   = fn;
+    start->arg  = arg;
+    start->slot = slot;
+
+    int ret = pthread_create(thread, attr, arena_pthread_entry, start);
+    if (ret != 0) {
+        heap_caps_free(start);
+        __atomic_store_n(slot, NULL, __ATOMIC_RELEASE);
+    }
+    return ret;
+}
+
+static void arena_pthread_exit(void *ret)
+{
+    arena_task_forget(xTaskGetCurrentTaskHandle());
+    pthread_exit(ret);
+}
+
+/* ------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------ */
+
+void launchpad_arena_init(void)
+{
+    _register_symbol("malloc", (void *)arena_malloc);
+    _register_symbol("calloc", (void *)arena_calloc);
+    _register_symbol("realloc", (void *)arena_realloc);
+    _register_symbol("free", (void *)arena_free);
+    _register_symbol("xTaskCreate", (void *)arena_task_create_any);
+    _register_symbol("xTaskCreatePinnedToCore", (void *)arena_task_create);
+    _register_symbol("vTaskDelete", (void *)arena_task_delete);
+    _register_symbol("pthread_create", (void *)arena_pthread_create);
+    _register_symbol("pthread_exit", (void *)arena_pthread_exit);
+
+    ESP_LOGI(TAG, "%d arenas of %d bytes", LAUNCHPAD_ARENA_MAX,
+             CONFIG_LAUNCHPAD_APP_ARENA_SIZE);
+}
+
+esp_err_t launchpad_arena_attach(const void *image, size_t size)
+{
+    const size_t len = CONFIG_LAUNCHPAD_APP_ARENA_SIZE;
+    arena_t *a = NULL;
+
+    void *mem = heap_caps_malloc(len, ARENA_CAPS);
+    if (!mem) {
+        ESP_LOGW(TAG, "no memory for a %d byte arena, app uses the global heap", (int)len);
+        return ESP_ERR_NO_MEM;
+    }
+
+    taskENTER_CRITICAL(&s_slots_lock);
+    for (int i = 0; i < LAUNCHPAD_ARENA_MAX; i++) {
+        if (!s_arenas[i].lo) {
+            a = &s_arenas[i];
+            a->lo = (uintptr_t)mem;     /* claim the slot */
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&s_slots_lock);
+
+    if (!a) {
+        heap_caps_free(mem);
+        ESP_LOGW(TAG, "all %d arenas in use, app uses the global heap", LAUNCHPAD_ARENA_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+
+    multi_heap_handle_t heap = multi_heap_register(mem, len);
+    if (!heap) {
+        heap_caps_free(mem);
+        a->lo = 0;
+        return ESP_ERR_NO_MEM;
+    }
+
+    portMUX_INITIALIZE(&a->lock);
+    multi_heap_set_lock(heap, &a->lock);
+
+    a->code_lo = (uintptr_t)image;
+    a->code_hi = (uintptr_t)image + size;
+    a->hi      = (uintptr_t)mem + len;
+    a->owner   = xTaskGetCurrentTaskHandle();
+    __atomic_store_n(&a->heap, heap, __ATOMIC_RELEASE);
+
+    ESP_LOGD(TAG, "arena %p..%p for image %p", mem, (void *)a->hi, image);
+    return ESP_OK;
+}
+
+esp_err_t launchpad_arena_detach(const void *image)
+{
+    for (int i = 0; i < LAUNCHPAD_ARENA_MAX; i++) {
+        arena_t *a = &s_arenas[i];
+
+        if (!a->heap || a->code_lo != (uintptr_t)image) {
+            continue;
+        }
+
+        int alive = 0;
+        taskENTER_CRITICAL(&s_slots_lock);
+        for (int j = 0; j < ARENA_TASKS_MAX; j++) {
+            alive += a->tasks[j] != NULL;
+        }
+        taskEXIT_CRITICAL(&s_slots_lock);
+
+        if (alive) {
+            ESP_LOGE(TAG, "app exited with %d task(s) still running, arena kept", alive);
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        multi_heap_info_t info;
+        multi_heap_get_info(a->heap, &info);
+        if (info.allocated_blocks) {
+            ESP_LOGW(TAG, "app exited with %d bytes in %d blocks, released",
+                     (int)info.total_allocated_bytes, (int)info.allocated_blocks);
+        }
+
+        /* The arena goes away as a whole: no per-block frees */
+        void *mem = (void *)a->lo;
+
+        taskENTER_CRITICAL(&s_slots_lock);
+        memset(a, 0, sizeof(*a));
+        taskEXIT_CRITICAL(&s_slots_lock);
+
+        heap_caps_free(mem);
+        return ESP_OK;
+    }
+    return ESP_OK;
+}
+
+bool launchpad_arena_owns(const void *ptr)
+{
+    return arena_by_ptr(ptr) != NULL;
+}
+
+void *launchpad_arena_realloc(void *ptr, size_t size)
+{
+    arena_t *a = arena_by_ptr(ptr);
+
+    return a ? multi_heap_realloc(a->heap, ptr, size) : NULL;
+}
+
+void launchpad_arena_free(void *ptr)
+{
+    arena_t *a = arena_by_ptr(ptr);
+
+    if (a) {
+        multi_heap_free(a->heap, ptr);
+    }
+}
+
+esp_err_t launchpad_arena_stats(launchpad_arena_stats_t *out)
+{
+    arena_t *a = arena_by_caller((uintptr_t)__builtin_return_address(0));
+    multi_heap_info_t info;
+
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!a) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    multi_heap_get_info(a->heap, &info);
+
+    out->total_bytes        = a->hi - a->lo;
+    out->free_bytes         = info.total_free_bytes;
+    out->largest_free_block = info.largest_free_block;
+    out->minimum_free_bytes = info.minimum_free_bytes;
+    out->allocated_blocks   = info.allocated_blocks;
+    out->free_blocks        = info.free_blocks;
+    out->fragmentation      = info.total_free_bytes ?
+                              100 - (uint32_t)((uint64_t)info.largest_free_block * 100 /
+                                               info.total_free_bytes) : 0;
+    return ESP_OK;
+}
+
+#else /* !CONFIG_LAUNCHPAD_APP_ARENA */
+
+void launchpad_arena_init(void)
+{
+    /* Without arenas apps get the tiered allocator */
+    _register_symbol("malloc", (void *)launchpad_malloc);
+    _register_symbol("calloc", (void *)launchpad_calloc);
+    _register_symbol("realloc", (void *)launchpad_realloc);
+    _register_symbol("free", (void *)launchpad_free);
+    _register_symbol("xTaskCreate", (void *)xTaskCreate);
+    _register_symbol("xTaskCreatePinnedToCore", (void *)xTaskCreatePinnedToCore);
+    _register_symbol("vTaskDelete", (void *)vTaskDelete);
+    _register_symbol("pthread_create", (void *)pthread_create);
+    _register_symbol("pthread_exit", (void *)pthread_exit);
+
+    ESP_LOGI(TAG, "disabled, apps use the tiered allocator");
+}
+
+esp_err_t launchpad_arena_attach(const void *image, size_t size)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t launchpad_arena_detach(const void *image)
+{
+    return ESP_OK;
+}
+
+bool launchpad_arena_owns(const void *ptr)
+{
+    return false;
+}
+
+void *launchpad_arena_realloc(void *ptr, size_t size)
+{
+    return NULL;
+}
+
+void launchpad_arena_free(void *ptr)
+{
+}
+
+esp_err_t launchpad_arena_stats(launchpad_arena_stats_t *out)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* CONFIG_LAUNCHPAD_APP_ARENA */
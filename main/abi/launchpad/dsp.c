@@ -0,0 +1,902 @@
+/* -------------------------------------------------------------
+ * launchpad_dsp_api.c
+ *
+ * Scalar reference and FPU-accelerated DSP kernels for loaded
+ * ELF modules. See include/dsp.h.
+ * ------------------------------------------------------------- */
+
+#include "include/dsp.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "platform.h"
+#include "elf/esp_elf.h"
+
+static const char *TAG = "LaunchpadDSP";
+
+/* Kernel table; one instance per implementation */
+struct dsp_ops {
+    float   (*dot_f32)(const float *, const float *, int);
+    int32_t (*dot_s16)(const int16_t *, const int16_t *, int, int);
+    int     (*fir_f32)(launchpad_dsp_fir_f32_t *, const float *, float *, int);
+    int     (*fir_s16)(launchpad_dsp_fir_s16_t *, const int16_t *, int16_t *, int);
+    int     (*biquad_f32)(const float *, float *, int, const float *, float *);
+    int     (*fft2r_f32)(float *, int);
+    int     (*fft4r_f32)(float *, int);
+    int     (*mat_mul_f32)(const float *, const float *, float *, int, int, int);
+};
+
+/* Twiddle table: W_N^k = w[2k] - i * w[2k + 1], k < 3N/4 */
+struct fft_tw {
+    struct fft_tw *prev;        /* outgrown table, freed by fft_deinit() */
+    int            n;
+    float          w[];
+};
+
+/* Grow-only: fft_init() publishes a larger table and keeps the old one,
+ * so a transform never loses the table it started with. fft_deinit()
+ * waits for the transforms in flight before it frees them. */
+static struct fft_tw *s_tw;
+static int            s_tw_users;
+static portMUX_TYPE   s_tw_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* ------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------ */
+
+static inline int16_t sat16(int64_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
+}
+
+static inline int32_t sat32(int64_t v)
+{
+    return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (int32_t)v);
+}
+
+static inline int is_pow2(int n)
+{
+    return n > 0 && !(n & (n - 1));
+}
+
+static inline int ilog2(int n)
+{
+    int l = 0;
+    while ((1 << l) < n) {
+        l++;
+    }
+    return l;
+}
+
+static void bit_reverse(float *x, int n)
+{
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+
+        if (i < j) {
+            float re = x[2 * i], im = x[2 * i + 1];
+            x[2 * i]     = x[2 * j];
+            x[2 * i + 1] = x[2 * j + 1];
+            x[2 * j]     = re;
+            x[2 * j + 1] = im;
+        }
+    }
+}
+
+static void digit_reverse4(float *x, int n)
+{
+    int digits = ilog2(n) / 2;
+
+    for (int i = 1; i < n; i++) {
+        int j = 0;
+        for (int d = 0, v = i; d < digits; d++, v >>= 2) {
+            j = (j << 2) | (v & 3);
+        }
+
+        if (i < j) {
+            float re = x[2 * i], im = x[2 * i + 1];
+            x[2 * i]     = x[2 * j];
+            x[2 * i + 1] = x[2 * j + 1];
+            x[2 * j]     = re;
+            x[2 * j + 1] = im;
+        }
+    }
+}
+
+static void fft_release(void)
+{
+    __atomic_sub_fetch(&s_tw_users, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Validate a transform and pin the twiddle table; fft_release() after */
+static int fft_check(float *data, int n, int radix4, const struct fft_tw **tw)
+{
+    if (!data || !is_pow2(n) || n < 2) {
+        return -1;
+    }
+    if (radix4 && (ilog2(n) & 1)) {
+        return -1;
+    }
+
+    __atomic_add_fetch(&s_tw_users, 1, __ATOMIC_SEQ_CST);
+    *tw = __atomic_load_n(&s_tw, __ATOMIC_SEQ_CST);
+    if (!*tw || n > (*tw)->n) {
+        fft_release();
+        return -2;
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------
+ * Scalar reference implementations
+ * ------------------------------------------------------------------ */
+
+static float ref_dot_f32(const float *a, const float *b, int len)
+{
+    float acc = 0.0f;
+    for (int i = 0; i < len; i++) {
+        acc += a[i] * b[i];
+    }
+    return acc;
+}
+
+static int32_t ref_dot_s16(const int16_t *a, const int16_t *b, int len, int shift)
+{
+    int64_t acc = 0;
+    for (int i = 0; i < len; i++) {
+        acc += (int32_t)a[i] * b[i];
+    }
+    return sat32(acc >> shift);
+}
+
+static int ref_fir_f32(launchpad_dsp_fir_f32_t *fir, const float *in, float *out, int len)
+{
+    for (int n = 0; n < len; n++) {
+        fir->delay[fir->pos] = in[n];
+
+        float acc = 0.0f;
+        for (int i = 0; i < fir->ntaps; i++) {
+            int idx = fir->pos - i;
+            if (idx < 0) {
+                idx += fir->ntaps;
+            }
+            acc += fir->coeffs[i] * fir->delay[idx];
+        }
+        out[n] = acc;
+
+        if (++fir->pos == fir->ntaps) {
+            fir->pos = 0;
+        }
+    }
+    return 0;
+}
+
+static int ref_fir_s16(launchpad_dsp_fir_s16_t *fir, const int16_t *in, int16_t *out, int len)
+{
+    for (int n = 0; n < len; n++) {
+        fir->delay[fir->pos] = in[n];
+
+        int64_t acc = 0;
+        for (int i = 0; i < fir->ntaps; i++) {
+            int idx = fir->pos - i;
+            if (idx < 0) {
+                idx += fir->ntaps;
+            }
+            acc += (int32_t)fir->coeffs[i] * fir->delay[idx];
+        }
+        out[n] = sat16(acc >> fir->shift);
+
+        if (++fir->pos == fir->ntaps) {
+            fir->pos = 0;
+        }
+    }
+    return 0;
+}
+
+static int ref_biquad_f32(const float *in, float *out, int len, const float *coef, float *w)
+{
+    for (int n = 0; n < len; n++) {
+        float x = in[n];
+        float y = coef[0] * x + w[0];
+        w[0] = coef[1] * x - coef[3] * y + w[1];
+        w[1] = coef[2] * x - coef[4] * y;
+        out[n] = y;
+    }
+    return 0;
+}
+
+static int ref_fft2r_f32(float *x, int n)
+{
+    const struct fft_tw *tw;
+    int ret = fft_check(x, n, 0, &tw);
+    if (ret) {
+        return ret;
+    }
+
+    bit_reverse(x, n);
+
+    for (int L = 2; L <= n; L <<= 1) {
+        int m = L >> 1;
+        int step = tw->n / L;
+
+        for (int k0 = 0; k0 < n; k0 += L) {
+            for (int j = 0; j < m; j++) {
+                float c = tw->w[2 * j * step], s = tw->w[2 * j * step + 1];
+                float *a = &x[2 * (k0 + j)];
+                float *b = &x[2 * (k0 + j + m)];
+
+                float tr = b[0] * c + b[1] * s;
+                float ti = b[1] * c - b[0] * s;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+    fft_release();
+    return 0;
+}
+
+static int ref_fft4r_f32(float *x, int n)
+{
+    const struct fft_tw *tw;
+    int ret = fft_check(x, n, 1, &tw);
+    if (ret) {
+        return ret;
+    }
+
+    digit_reverse4(x, n);
+
+    for (int L = 4; L <= n; L <<= 2) {
+        int m = L >> 2;
+        int step = tw->n / L;
+
+        for (int k0 = 0; k0 < n; k0 += L) {
+            for (int j = 0; j < m; j++) {
+                float *p0 = &x[2 * (k0 + j)];
+                float *p1 = p0 + 2 * m;
+                float *p2 = p1 + 2 * m;
+                float *p3 = p2 + 2 * m;
+                const float *w1 = &tw->w[2 * j * step];
+                const float *w2 = &tw->w[4 * j * step];
+                const float *w3 = &tw->w[6 * j * step];
+
+                float a1r = p1[0] * w1[0] + p1[1] * w1[1], a1i = p1[1] * w1[0] - p1[0] * w1[1];
+                float a2r = p2[0] * w2[0] + p2[1] * w2[1], a2i = p2[1] * w2[0] - p2[0] * w2[1];
+                float a3r = p3[0] * w3[0] + p3[1] * w3[1], a3i = p3[1] * w3[0] - p3[0] * w3[1];
+
+                float t0r = p0[0] + a2r, t0i = p0[1] + a2i;
+                float t1r = p0[0] - a2r, t1i = p0[1] - a2i;
+                float t2r = a1r + a3r,   t2i = a1i + a3i;
+                float t3r = a1r - a3r,   t3i = a1i - a3i;
+
+                p0[0] = t0r + t2r;  p0[1] = t0i + t2i;
+                p2[0] = t0r - t2r;  p2[1] = t0i - t2i;
+                p1[0] = t1r + t3i;  p1[1] = t1i - t3r;     /* t1 - i*t3 */
+                p3[0] = t1r - t3i;  p3[1] = t1i + t3r;     /* t1 + i*t3 */
+            }
+        }
+    }
+    fft_release();
+    return 0;
+}
+
+static int ref_mat_mul_f32(const float *A, const float *B, float *C, int m, int n, int k)
+{
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < k; j++) {
+            float acc = 0.0f;
+            for (int p = 0; p < n; p++) {
+                acc += A[i * n + p] * B[p * k + j];
+            }
+            C[i * k + j] = acc;
+        }
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------
+ * FPU-accelerated implementations
+ *
+ * Independent accumulators hide the FPU latency, fmaf() maps to a
+ * single fused multiply-add (fmadd.s / madd.s), and the trivial
+ * first FFT stage runs without twiddle multiplications.
+ * ------------------------------------------------------------------ */
+
+static float fast_dot_f32(const float *a, const float *b, int len)
+{
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+    int i = 0;
+
+    for (; i + 4 <= len; i += 4) {
+        acc0 = fmaf(a[i],     b[i],     acc0);
+        acc1 = fmaf(a[i + 1], b[i + 1], acc1);
+        acc2 = fmaf(a[i + 2], b[i + 2], acc2);
+        acc3 = fmaf(a[i + 3], b[i + 3], acc3);
+    }
+    for (; i < len; i++) {
+        acc0 = fmaf(a[i], b[i], acc0);
+    }
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+static int32_t fast_dot_s16(const int16_t *a, const int16_t *b, int len, int shift)
+{
+    int64_t acc0 = 0, acc1 = 0;
+    int i = 0;
+
+    for (; i + 4 <= len; i += 4) {
+        /* Widen each product: two INT16_MIN^2 terms overflow int32_t */
+        acc0 += (int64_t)a[i]     * b[i]     + (int64_t)a[i + 2] * b[i + 2];
+        acc1 += (int64_t)a[i + 1] * b[i + 1] + (int64_t)a[i + 3] * b[i + 3];
+    }
+    for (; i < len; i++) {
+        acc0 += (int32_t)a[i] * b[i];
+    }
+    return sat32((acc0 + acc1) >> shift);
+}
+
+/* sum_i c[i] * d[i0 - i] for i in [0, cnt) -- walks @d backwards */
+static inline float fast_dot_rev_f32(const float *c, const float *d, int cnt)
+{
+    float acc0 = 0.0f, acc1 = 0.0f;
+    int i = 0;
+
+    for (; i + 2 <= cnt; i += 2) {
+        acc0 = fmaf(c[i],     d[-i],     acc0);
+        acc1 = fmaf(c[i + 1], d[-i - 1], acc1);
+    }
+    if (i < cnt) {
+        acc0 = fmaf(c[i], d[-i], acc0);
+    }
+    return acc0 + acc1;
+}
+
+static int fast_fir_f32(launchpad_dsp_fir_f32_t *fir, const float *in, float *out, int len)
+{
+    const int ntaps = fir->ntaps;
+
+    for (int n = 0; n < len; n++) {
+        int pos = fir->pos;
+        fir->delay[pos] = in[n];
+
+        /* Two contiguous runs instead of a modulo per tap */
+        float acc = fast_dot_rev_f32(fir->coeffs, &fir->delay[pos], pos + 1);
+        acc += fast_dot_rev_f32(&fir->coeffs[pos + 1], &fir->delay[ntaps - 1], ntaps - pos - 1);
+        out[n] = acc;
+
+        fir->pos = (pos + 1 == ntaps) ? 0 : pos + 1;
+    }
+    return 0;
+}
+
+static inline int64_t fast_dot_rev_s16(const int16_t *c, const int16_t *d, int cnt)
+{
+    int64_t acc0 = 0, acc1 = 0;
+    int i = 0;
+
+    for (; i + 2 <= cnt; i += 2) {
+        acc0 += (int32_t)c[i]     * d[-i];
+        acc1 += (int32_t)c[i + 1] * d[-i - 1];
+    }
+    if (i < cnt) {
+        acc0 += (int32_t)c[i] * d[-i];
+    }
+    return acc0 + acc1;
+}
+
+static int fast_fir_s16(launchpad_dsp_fir_s16_t *fir, const int16_t *in, int16_t *out, int len)
+{
+    const int ntaps = fir->ntaps;
+
+    for (int n = 0; n < len; n++) {
+        int pos = fir->pos;
+        fir->delay[pos] = in[n];
+
+        int64_t acc = fast_dot_rev_s16(fir->coeffs, &fir->delay[pos], pos + 1);
+        acc += fast_dot_rev_s16(&fir->coeffs[pos + 1], &fir->delay[ntaps - 1], ntaps - pos - 1);
+        out[n] = sat16(acc >> fir->shift);
+
+        fir->pos = (pos + 1 == ntaps) ? 0 : pos + 1;
+    }
+    return 0;
+}
+
+static int fast_biquad_f32(const float *in, float *out, int len, const float *coef, float *w)
+{
+    const float b0 = coef[0], b1 = coef[1], b2 = coef[2];
+    const float a1 = coef[3], a2 = coef[4];
+    float w0 = w[0], w1 = w[1];
+
+    for (int n = 0; n < len; n++) {
+        float x = in[n];
+        float y = fmaf(b0, x, w0);
+        w0 = fmaf(b1, x, fmaf(-a1, y, w1));
+        w1 = fmaf(b2, x, -a2 * y);
+        out[n] = y;
+    }
+
+    w[0] = w0;
+    w[1] = w1;
+    return 0;
+}
+
+static int fast_fft2r_f32(float *x, int n)
+{
+    const struct fft_tw *tw;
+    int ret = fft_check(x, n, 0, &tw);
+    if (ret) {
+        return ret;
+    }
+
+    bit_reverse(x, n);
+
+    /* L = 2: twiddle is 1 */
+    for (int k = 0; k < n; k += 2) {
+        float *a = &x[2 * k];
+        float br = a[2], bi = a[3];
+        a[2] = a[0] - br;
+        a[3] = a[1] - bi;
+        a[0] += br;
+        a[1] += bi;
+    }
+
+    for (int L = 4; L <= n; L <<= 1) {
+        int m = L >> 1;
+        int step = 2 * (tw->n / L);
+
+        for (int k0 = 0; k0 < n; k0 += L) {
+            const float *w = tw->w;
+            float *a = &x[2 * k0];
+            float *b = a + 2 * m;
+
+            for (int j = 0; j < m; j++, a += 2, b += 2, w += step) {
+                float tr = fmaf(b[0], w[0], b[1] * w[1]);
+                float ti = fmaf(b[1], w[0], -b[0] * w[1]);
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+    fft_release();
+    return 0;
+}
+
+static int fast_fft4r_f32(float *x, int n)
+{
+    const struct fft_tw *tw;
+    int ret = fft_check(x, n, 1, &tw);
+    if (ret) {
+        return ret;
+    }
+
+    digit_reverse4(x, n);
+
+    /* L = 4: all twiddles are 1 */
+    for (int k = 0; k < n; k += 4) {
+        float *p = &x[2 * k];
+        float t0r = p[0] + p[4], t0i = p[1] + p[5];
+        float t1r = p[0] - p[4], t1i = p[1] - p[5];
+        float t2r = p[2] + p[6], t2i = p[3] + p[7];
+        float t3r = p[2] - p[6], t3i = p[3] - p[7];
+
+        p[0] = t0r + t2r;  p[1] = t0i + t2i;
+        p[4] = t0r - t2r;  p[5] = t0i - t2i;
+        p[2] = t1r + t3i;  p[3] = t1i - t3r;
+        p[6] = t1r - t3i;  p[7] = t1i + t3r;
+    }
+
+    for (int L = 16; L <= n; L <<= 2) {
+        int m = L >> 2;
+        int step = 2 * (tw->n / L);
+
+        for (int k0 = 0; k0 < n; k0 += L) {
+            float *p0 = &x[2 * k0];
+
+            for (int j = 0; j < m; j++, p0 += 2) {
+                float *p1 = p0 + 2 * m;
+                float *p2 = p1 + 2 * m;
+                float *p3 = p2 + 2 * m;
+                const float *w1 = &tw->w[j * step];
+                const float *w2 = &tw->w[2 * j * step];
+                const float *w3 = &tw->w[3 * j * step];
+
+                float a1r = fmaf(p1[0], w1[0], p1[1] * w1[1]);
+                float a1i = fmaf(p1[1], w1[0], -p1[0] * w1[1]);
+                float a2r = fmaf(p2[0], w2[0], p2[1] * w2[1]);
+                float a2i = fmaf(p2[1], w2[0], -p2[0] * w2[1]);
+                float a3r = fmaf(p3[0], w3[0], p3[1] * w3[1]);
+                float a3i = fmaf(p3[1], w3[0], -p3[0] * w3[1]);
+
+                float t0r = p0[0] + a2r, t0i = p0[1] + a2i;
+                float t1r = p0[0] - a2r, t1i = p0[1] - a2i;
+                float t2r = a1r + a3r,   t2i = a1i + a3i;
+                float t3r = a1r - a3r,   t3i = a1i - a3i;
+
+                p0[0] = t0r + t2r;  p0[1] = t0i + t2i;
+                p2[0] = t0r - t2r;  p2[1] = t0i - t2i;
+                p1[0] = t1r + t3i;  p1[1] = t1i - t3r;
+                p3[0] = t1r - t3i;  p3[1] = t1i + t3r;
+            }
+        }
+    }
+    fft_release();
+    return 0;
+}
+
+static int fast_mat_mul_f32(const float *A, const float *B, float *C, int m, int n, int k)
+{
+    for (int i = 0; i < m; i++) {
+        const float *a = &A[i * n];
+        float *c = &C[i * k];
+        int j = 0;
+
+        /* 4 output columns per pass, one broadcast of a[p] each */
+        for (; j + 4 <= k; j += 4) {
+            float c0 = 0.0f, c1 = 0.0f, c2 = 0.0f, c3 = 0.0f;
+            const float *b = &B[j];
+
+            for (int p = 0; p < n; p++, b += k) {
+                float ap = a[p];
+                c0 = fmaf(ap, b[0], c0);
+                c1 = fmaf(ap, b[1], c1);
+                c2 = fmaf(ap, b[2], c2);
+                c3 = fmaf(ap, b[3], c3);
+            }
+            c[j] = c0;
+            c[j + 1] = c1;
+            c[j + 2] = c2;
+            c[j + 3] = c3;
+        }
+
+        for (; j < k; j++) {
+            float acc = 0.0f;
+            for (int p = 0; p < n; p++) {
+                acc = fmaf(a[p], B[p * k + j], acc);
+            }
+            c[j] = acc;
+        }
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------
+ * Dispatch
+ * ------------------------------------------------------------------ */
+
+static const struct dsp_ops s_ref_ops = {
+    .dot_f32     = ref_dot_f32,
+    .dot_s16     = ref_dot_s16,
+    .fir_f32     = ref_fir_f32,
+    .fir_s16     = ref_fir_s16,
+    .biquad_f32  = ref_biquad_f32,
+    .fft2r_f32   = ref_fft2r_f32,
+    .fft4r_f32   = ref_fft4r_f32,
+    .mat_mul_f32 = ref_mat_mul_f32,
+};
+
+static const struct dsp_ops s_fast_ops = {
+    .dot_f32     = fast_dot_f32,
+    .dot_s16     = fast_dot_s16,
+    .fir_f32     = fast_fir_f32,
+    .fir_s16     = fast_fir_s16,
+    .biquad_f32  = fast_biquad_f32,
+    .fft2r_f32   = fast_fft2r_f32,
+    .fft4r_f32   = fast_fft4r_f32,
+    .mat_mul_f32 = fast_mat_mul_f32,
+};
+
+static const struct dsp_ops *s_ops = &s_ref_ops;
+
+void launchpad_dsp_init(void)
+{
+    launchpad_platform_info_t info = launchpad_platform();
+
+    if (info.hardware & (LAUNCHPAD_HW_RISCV_F | LAUNCHPAD_HW_XTENSA_FPU | LAUNCHPAD_HW_ARM_VFP)) {
+        s_ops = &s_fast_ops;
+    }
+
+    /* Export the selected kernels directly so ELF calls skip the dispatch;
+     * mat_mul keeps its wrapper, the kernels do not check their arguments */
+    _register_symbol("launchpad_dsp_dot_f32",     (void *)s_ops->dot_f32);
+    _register_symbol("launchpad_dsp_dot_s16",     (void *)s_ops->dot_s16);
+    _register_symbol("launchpad_dsp_fir_f32",     (void *)s_ops->fir_f32);
+    _register_symbol("launchpad_dsp_fir_s16",     (void *)s_ops->fir_s16);
+    _register_symbol("launchpad_dsp_biquad_f32",  (void *)s_ops->biquad_f32);
+    _register_symbol("launchpad_dsp_fft2r_f32",   (void *)s_ops->fft2r_f32);
+    _register_symbol("launchpad_dsp_fft4r_f32",   (void *)s_ops->fft4r_f32);
+    _register_symbol("launchpad_dsp_mat_mul_f32", (void *)launchpad_dsp_mat_mul_f32);
+
+    ESP_LOGI(TAG, "DSP kernels: %s", launchpad_dsp_impl());
+}
+
+const char *launchpad_dsp_impl(void)
+{
+    return (s_ops == &s_fast_ops) ? "fpu" : "scalar";
+}
+
+float launchpad_dsp_dot_f32(const float *a, const float *b, int len)
+{
+    return s_ops->dot_f32(a, b, len);
+}
+
+int32_t launchpad_dsp_dot_s16(const int16_t *a, const int16_t *b, int len, int shift)
+{
+    return s_ops->dot_s16(a, b, len, shift);
+}
+
+int launchpad_dsp_fir_init_f32(launchpad_dsp_fir_f32_t *fir, const float *coeffs,
+                               float *delay, int ntaps)
+{
+    if (!fir || !coeffs || !delay || ntaps <= 0) {
+        return -1;
+    }
+
+    fir->coeffs = coeffs;
+    fir->delay  = delay;
+    fir->ntaps  = ntaps;
+    fir->pos    = 0;
+    memset(delay, 0, ntaps * sizeof(float));
+    return 0;
+}
+
+int launchpad_dsp_fir_f32(launchpad_dsp_fir_f32_t *fir, const float *in, float *out, int len)
+{
+    return s_ops->fir_f32(fir, in, out, len);
+}
+
+int launchpad_dsp_fir_init_s16(launchpad_dsp_fir_s16_t *fir, const int16_t *coeffs,
+                               int16_t *delay, int ntaps, int shift)
+{
+    if (!fir || !coeffs || !delay || ntaps <= 0 || shift < 0 || shift > 47) {
+        return -1;
+    }
+
+    fir->coeffs = coeffs;
+    fir->delay  = delay;
+    fir->ntaps  = ntaps;
+    fir->pos    = 0;
+    fir->shift  = shift;
+    memset(delay, 0, ntaps * sizeof(int16_t));
+    return 0;
+}
+
+int launchpad_dsp_fir_s16(launchpad_dsp_fir_s16_t *fir, const int16_t *in, int16_t *out, int len)
+{
+    return s_ops->fir_s16(fir, in, out, len);
+}
+
+int launchpad_dsp_biquad_f32(const float *in, float *out, int len,
+                             const float coef[5], float w[2])
+{
+    return s_ops->biquad_f32(in, out, len, coef, w);
+}
+
+int launchpad_dsp_fft_init(int max_n)
+{
+    if (!is_pow2(max_n) || max_n < 4 || max_n > LAUNCHPAD_DSP_FFT_MAX) {
+        return -1;
+    }
+
+    struct fft_tw *cur = __atomic_load_n(&s_tw, __ATOMIC_SEQ_CST);
+    if (cur && cur->n >= max_n) {
+        return 0;
+    }
+
+    /* Radix-4 needs W^k up to k = 3N/4 */
+    int cnt = 3 * max_n / 4;
+    struct fft_tw *tw = heap_caps_malloc(sizeof(*tw) + 2 * cnt * sizeof(float),
+                                         MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!tw) {
+        return -2;
+    }
+
+    tw->n = max_n;
+    for (int k = 0; k < cnt; k++) {
+        double phi = 2.0 * M_PI * k / max_n;
+        tw->w[2 * k]     = (float)cos(phi);
+        tw->w[2 * k + 1] = (float)sin(phi);
+    }
+
+    /* Another caller may have grown it meanwhile */
+    taskENTER_CRITICAL(&s_tw_lock);
+    cur = s_tw;
+    if (!cur || cur->n < max_n) {
+        tw->prev = cur;
+        __atomic_store_n(&s_tw, tw, __ATOMIC_SEQ_CST);
+        tw = NULL;
+    }
+    taskEXIT_CRITICAL(&s_tw_lock);
+
+    free(tw);
+    return 0;
+}
+
+void launchpad_dsp_fft_deinit(void)
+{
+    taskENTER_CRITICAL(&s_tw_lock);
+    struct fft_tw *tw = s_tw;
+    __atomic_store_n(&s_tw, NULL, __ATOMIC_SEQ_CST);
+    taskEXIT_CRITICAL(&s_tw_lock);
+
+    /* New transforms now fail with -2; let the running ones finish */
+    while (__atomic_load_n(&s_tw_users, __ATOMIC_SEQ_CST)) {
+        vTaskDelay(1);
+    }
+
+    while (tw) {
+        struct fft_tw *prev = tw->prev;
+        free(tw);
+        tw = prev;
+    }
+}
+
+int launchpad_dsp_fft2r_f32(float *data, int n)
+{
+    return s_ops->fft2r_f32(data, n);
+}
+
+int launchpad_dsp_fft4r_f32(float *data, int n)
+{
+    return s_ops->fft4r_f32(data, n);
+}
+
+int launchpad_dsp_mat_mul_f32(const float *A, const float *B, float *C,
+                              int m, int n, int k)
+{
+    if (!A || !B || !C || m <= 0 || n <= 0 || k <= 0) {
+        return -1;
+    }
+    return s_ops->mat_mul_f32(A, B, C, m, n, k);
+}
+
+/* ------------------------------------------------------------------
+ * Benchmark
+ * ------------------------------------------------------------------ */
+
+#define BENCH_N     1024
+#define BENCH_TAPS  32
+#define BENCH_MAT   16
+
+static float max_err(const float *a, const float *b, int n)
+{
+    float e = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float d = fabsf(a[i] - b[i]);
+        if (d > e) {
+            e = d;
+        }
+    }
+    return e;
+}
+
+/* Cycles per sample of @expr, evaluated once */
+#define BENCH(_cps, _samples, _expr) do {                      \
+        uint32_t _t0 = esp_cpu_get_cycle_count();               \
+        _expr;                                                  \
+        uint32_t _t1 = esp_cpu_get_cycle_count();               \
+        (_cps) = (float)(_t1 - _t0) / (float)(_samples);        \
+    } while (0)
+
+void launchpad_dsp_benchmark(void)
+{
+    const struct dsp_ops *ops[2] = { &s_ref_ops, &s_fast_ops };
+    float cps[8][2];
+    float err[8] = { 0 };
+
+    float   *fa  = malloc(2 * BENCH_N * sizeof(float));
+    float   *fb  = malloc(2 * BENCH_N * sizeof(float));
+    float   *fo[2] = { malloc(2 * BENCH_N * sizeof(float)), malloc(2 * BENCH_N * sizeof(float)) };
+    int16_t *sa  = malloc(BENCH_N * sizeof(int16_t));
+    int16_t *so[2] = { malloc(BENCH_N * sizeof(int16_t)), malloc(BENCH_N * sizeof(int16_t)) };
+    float   *fdl = malloc(BENCH_TAPS * sizeof(float));
+    int16_t *sdl = malloc(BENCH_TAPS * sizeof(int16_t));
+    float    fc[BENCH_TAPS];
+    int16_t  sc[BENCH_TAPS];
+
+    if (!fa || !fb || !fo[0] || !fo[1] || !sa || !so[0] || !so[1] || !fdl || !sdl ||
+            launchpad_dsp_fft_init(BENCH_N)) {
+        ESP_LOGE(TAG, "benchmark: out of memory");
+        goto out;
+    }
+
+    for (int i = 0; i < 2 * BENCH_N; i++) {
+        fa[i] = sinf(0.01f * i);
+        fb[i] = cosf(0.013f * i);
+    }
+    for (int i = 0; i < BENCH_N; i++) {
+        sa[i] = (int16_t)(fa[i] * 16000.0f);
+    }
+    for (int i = 0; i < BENCH_TAPS; i++) {
+        fc[i] = 1.0f / BENCH_TAPS;
+        sc[i] = (int16_t)(32767 / BENCH_TAPS);
+    }
+
+    const float bq[5] = { 0.2929f, 0.5858f, 0.2929f, 0.0f, 0.1716f };
+    int32_t dots[2];
+    float dotf[2];
+
+    launchpad_dsp_fir_f32_t ff;
+    launchpad_dsp_fir_s16_t fs;
+    float w[2];
+
+    /* Each kernel runs through both paths before the next one reuses fo[] */
+    for (int v = 0; v < 2; v++) {
+        BENCH(cps[0][v], BENCH_N, dotf[v] = ops[v]->dot_f32(fa, fb, BENCH_N));
+        BENCH(cps[1][v], BENCH_N, dots[v] = ops[v]->dot_s16(sa, sa, BENCH_N, 15));
+    }
+
+    for (int v = 0; v < 2; v++) {
+        launchpad_dsp_fir_init_f32(&ff, fc, fdl, BENCH_TAPS);
+        BENCH(cps[2][v], BENCH_N, ops[v]->fir_f32(&ff, fa, fo[v], BENCH_N));
+    }
+    err[2] = max_err(fo[0], fo[1], BENCH_N);
+
+    for (int v = 0; v < 2; v++) {
+        launchpad_dsp_fir_init_s16(&fs, sc, sdl, BENCH_TAPS, 15);
+        BENCH(cps[3][v], BENCH_N, ops[v]->fir_s16(&fs, sa, so[v], BENCH_N));
+    }
+    err[3] = memcmp(so[0], so[1], BENCH_N * sizeof(int16_t)) ? 1.0f : 0.0f;
+
+    for (int v = 0; v < 2; v++) {
+        w[0] = w[1] = 0.0f;
+        BENCH(cps[4][v], BENCH_N, ops[v]->biquad_f32(fa, fo[v], BENCH_N, bq, w));
+    }
+    err[4] = max_err(fo[0], fo[1], BENCH_N);
+
+    for (int v = 0; v < 2; v++) {
+        memcpy(fo[v], fa, 2 * BENCH_N * sizeof(float));
+        BENCH(cps[5][v], BENCH_N, ops[v]->fft2r_f32(fo[v], BENCH_N));
+    }
+    err[5] = max_err(fo[0], fo[1], 2 * BENCH_N);
+
+    for (int v = 0; v < 2; v++) {
+        memcpy(fo[v], fa, 2 * BENCH_N * sizeof(float));
+        BENCH(cps[6][v], BENCH_N, ops[v]->fft4r_f32(fo[v], BENCH_N));
+    }
+    err[6] = max_err(fo[0], fo[1], 2 * BENCH_N);
+
+    for (int v = 0; v < 2; v++) {
+        BENCH(cps[7][v], BENCH_MAT * BENCH_MAT,
+              ops[v]->mat_mul_f32(fa, fb, fo[v], BENCH_MAT, BENCH_MAT, BENCH_MAT));
+    }
+    err[7] = max_err(fo[0], fo[1], BENCH_MAT * BENCH_MAT);
+
+    err[0] = fabsf(dotf[0] - dotf[1]);
+    err[1] = (dots[0] != dots[1]) ? 1.0f : 0.0f;
+
+    static const char *const names[8] = {
+        "dot_f32", "dot_s16", "fir_f32", "fir_s16",
+        "biquad_f32", "fft2r_f32", "fft4r_f32", "mat_mul_f32",
+    };
+
+    ESP_LOGI(TAG, "%-12s %12s %12s %10s", "kernel", "scalar c/s", "fpu c/s", "max err");
+    for (int i = 0; i < 8; i++) {
+        ESP_LOGI(TAG, "%-12s %12.2f %12.2f %10.2e", names[i], cps[i][0], cps[i][1], err[i]);
+    }
+
+out:
+    free(fa);
+    free(fb);
+    free(fo[0]);
+    free(fo[1]);
+    free(sa);
+    free(so[0]);
+    free(so[1]);
+    free(fdl);
+    free(sdl);
+}
@@ -0,0 +1,387 @@
+/* -------------------------------------------------------------
+ * launchpad_fmath_api.c
+ *
+ * Float-only libm kernels for loaded ELF modules.
+ * See include/fmath.h.
+ *
+ * Polynomials follow the Cephes single-precision library; every
+ * step stays in float so that cores with a single-precision FPU
+ * (ESP32-P4, ESP32) never fall into soft-float double helpers.
+ * ------------------------------------------------------------- */
+
+#include "include/fmath.h"
+
+#include <math.h>
+#include <stdint.h>
+#include "esp_log.h"
+
+#include "platform.h"
+#include "elf/esp_elf.h"
+
+static const char *TAG = "LaunchpadFMath";
+
+typedef union {
+    float    f;
+    uint32_t u;
+} fbits_t;
+
+/* Round to nearest integer for |x| < 2^22 without calling libm */
+#define ROUND_MAGIC 12582912.0f     /* 1.5 * 2^23 */
+
+static inline float round_near(float x)
+{
+    return (x + ROUND_MAGIC) - ROUND_MAGIC;
+}
+
+/* 2^k for k in [-126, 127] */
+static inline float pow2i(int k)
+{
+    fbits_t b = { .u = (uint32_t)(k + 127) << 23 };
+    return b.f;
+}
+
+/* ------------------------------------------------------------------
+ * sinf / cosf
+ * ------------------------------------------------------------------ */
+
+/* pi/2 split so that k * PIO2_1 and k * PIO2_2 are exact for the fast range */
+#define PIO2_1  1.5703125f
+#define PIO2_2  4.837512969970703125e-4f
+#define PIO2_3  7.549790126404332e-08f
+#define PIO2_4  -1.7151245100058819e-15f
+#define TWO_OPI 0.636619772367581343f
+
+/* sin(r), |r| <= pi/4 */
+static inline float sin_kern(float r)
+{
+    float z = r * r;
+    return fmaf(((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z, r, r);
+}
+
+/* cos(r), |r| <= pi/4 */
+static inline float cos_kern(float r)
+{
+    float z = r * r;
+    float p = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z;
+    return (1.0f - 0.5f * z) + p;
+}
+
+/* r = x - k * pi/2, returns k */
+static inline int trig_reduce(float x, float *r)
+{
+    float k = round_near(x * TWO_OPI);
+
+    float t = fmaf(-k, PIO2_1, x);
+    t = fmaf(-k, PIO2_2, t);
+    t = fmaf(-k, PIO2_3, t);
+    *r = fmaf(-k, PIO2_4, t);
+    return (int)k;
+}
+
+float launchpad_fast_sinf(float x)
+{
+    if (!(fabsf(x) <= LAUNCHPAD_FMATH_TRIG_MAX)) {
+        return sinf(x);                     /* huge, inf or NaN */
+    }
+    if (fabsf(x) < 0x1p-12f) {
+        return x;                           /* exact to float, keeps -0 */
+    }
+
+    float r;
+    int q = trig_reduce(x, &r);
+
+    switch (q & 3) {
+    case 0:  return  sin_kern(r);
+    case 1:  return  cos_kern(r);
+    case 2:  return -sin_kern(r);
+    default: return -cos_kern(r);
+    }
+}
+
+float launchpad_fast_cosf(float x)
+{
+    if (!(fabsf(x) <= LAUNCHPAD_FMATH_TRIG_MAX)) {
+        return cosf(x);
+    }
+
+    float r;
+    int q = trig_reduce(x, &r);
+
+    switch (q & 3) {
+    case 0:  return  cos_kern(r);
+    case 1:  return -sin_kern(r);
+    case 2:  return -cos_kern(r);
+    default: return  sin_kern(r);
+    }
+}
+
+/* ------------------------------------------------------------------
+ * expf / exp2f
+ * ------------------------------------------------------------------ */
+
+#define LOG2E   1.44269504088896341f
+#define LN2_HI  0.693359375f
+#define LN2_LO  -2.12194440e-4f
+
+/* e^r, |r| <= ln2/2 */
+static inline float exp_kern(float r)
+{
+    float z = r * r;
+    float p = ((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r
+                + 4.1665795894e-2f) * r + 1.6666665459e-1f) * r + 5.0000001201e-1f;
+    return fmaf(p, z, r) + 1.0f;
+}
+
+/* y * 2^k for k in [-150, 128] */
+static inline float scale2(float y, int k)
+{
+    if (k > 127) {
+        return y * 2.0f * pow2i(k - 1);
+    }
+    if (k < -126) {
+        return y * pow2i(k + 100) * 7.88860905e-31f;      /* 2^-100 */
+    }
+    return y * pow2i(k);
+}
+
+float launchpad_fast_expf(float x)
+{
+    if (!(x <= 88.7228394f)) {
+        return x + INFINITY;                /* +inf on overflow, NaN stays NaN */
+    }
+    if (x < -103.972084f) {
+        return 0.0f;
+    }
+
+    float k = round_near(x * LOG2E);
+    float r = fmaf(-k, LN2_HI, x);
+    r = fmaf(-k, LN2_LO, r);
+
+    return scale2(exp_kern(r), (int)k);
+}
+
+float launchpad_fast_exp2f(float x)
+{
+    if (!(x < 128.0f)) {
+        return x + INFINITY;
+    }
+    if (x < -150.0f) {
+        return 0.0f;
+    }
+
+    float k = round_near(x);
+    float r = (x - k) * 0.693147180559945309f;   /* x - k is exact */
+
+    return scale2(exp_kern(r), (int)k);
+}
+
+/* ------------------------------------------------------------------
+ * logf / log2f / log10f
+ * ------------------------------------------------------------------ */
+
+#define SQRTHF  0.707106781186547524f
+
+/*
+ * Split finite x > 0 into x = 2^e * (1 + f), f in [sqrt(.5) - 1, sqrt(2) - 1)
+ * and return log(1 + f) - f as *tail so callers can rescale precisely.
+ */
+static inline float log_kern(float x, int *e, float *tail)
+{
+    fbits_t b = { .f = x };
+    int ex = 0;
+
+    if (b.u < 0x00800000u) {                /* subnormal */
+        b.f *= 8388608.0f;                  /* 2^23 */
+        ex = -23;
+    }
+
+    ex += (int)(b.u >> 23) - 126;
+    b.u = (b.u & 0x007fffffu) | 0x3f000000u;     /* mantissa in [0.5, 1) */
+
+    float m = b.f;
+    if (m < SQRTHF) {
+        ex--;
+        m = m + m - 1.0f;
+    } else {
+        m = m - 1.0f;
+    }
+
+    float z = m * m;
+    float p = ((((((((7.0376836292e-2f * m - 1.1514610310e-1f) * m + 1.1676998740e-1f) * m
+                    - 1.2420140846e-1f) * m + 1.4249322787e-1f) * m - 1.6668057665e-1f) * m
+                 + 2.0000714765e-1f) * m - 2.4999993993e-1f) * m + 3.3333331174e-1f);
+
+    *e = ex;
+    *tail = fmaf(p * m, z, -0.5f * z);
+    return m;
+}
+
+/* NaN, +inf, 0 and negative inputs */
+static inline int log_special(float x, float *res)
+{
+    if (x > 0.0f && x < INFINITY) {
+        return 0;
+    }
+    if (x == 0.0f) {
+        *res = -INFINITY;
+    } else if (x < 0.0f) {
+        *res = NAN;
+    } else {
+        *res = x;                           /* +inf or NaN */
+    }
+    return 1;
+}
+
+float launchpad_fast_logf(float x)
+{
+    float res, tail;
+    int e;
+
+    if (log_special(x, &res)) {
+        return res;
+    }
+
+    float f = log_kern(x, &e, &tail);
+    float fe = (float)e;
+
+    return fmaf(fe, LN2_HI, f + fmaf(fe, LN2_LO, tail));
+}
+
+float launchpad_fast_log2f(float x)
+{
+    float res, tail;
+    int e;
+
+    if (log_special(x, &res)) {
+        return res;
+    }
+
+    float f = log_kern(x, &e, &tail);
+    return fmaf(f + tail, LOG2E, (float)e);
+}
+
+float launchpad_fast_log10f(float x)
+{
+    float res, tail;
+    int e;
+
+    if (log_special(x, &res)) {
+        return res;
+    }
+
+    float f = log_kern(x, &e, &tail);
+    float fe = (float)e;
+
+    /* log10(2) = 0.30078125 + 2.48745663981195213739e-4 */
+    float y = fmaf(f + tail, 0.434294481903251827651f, fe * 2.48745663981195213739e-4f);
+    return fmaf(fe, 0.30078125f, y);
+}
+
+/* ------------------------------------------------------------------
+ * atanf / atan2f
+ * ------------------------------------------------------------------ */
+
+#define PI_F      3.14159265358979323846f
+#define PIO2_F    1.57079632679489661923f
+#define PIO4_F    0.78539816339744830962f
+
+/* Rounding error of PIO2_F / PIO4_F, added back after the polynomial */
+#define PIO2_LO   (-4.37113900018624283e-8f)
+#define PIO4_LO   (-2.18556950009312141e-8f)
+
+float launchpad_fast_atanf(float x)
+{
+    float a = fabsf(x);
+    float y0 = 0.0f, y0_lo = 0.0f;
+
+    if (a != a) {
+        return x;
+    }
+
+    if (a > 2.414213562373095f) {           /* tan(3pi/8) */
+        y0 = PIO2_F;
+        y0_lo = PIO2_LO;
+        a = -1.0f / a;
+    } else if (a > 0.4142135623730950f) {   /* tan(pi/8) */
+        y0 = PIO4_F;
+        y0_lo = PIO4_LO;
+        a = (a - 1.0f) / (a + 1.0f);
+    }
+
+    float z = a * a;
+    float p = ((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z
+              - 3.33329491539e-1f;
+    float y = y0 + (fmaf(p * z, a, a) + y0_lo);
+
+    return copysignf(y, x);
+}
+
+float launchpad_fast_atan2f(float y, float x)
+{
+    if (x != x || y != y) {
+        return x + y;
+    }
+
+    if (isinf(y)) {
+        if (isinf(x)) {
+            return copysignf(x > 0.0f ? PIO4_F : 3.0f * PIO4_F, y);
+        }
+        return copysignf(PIO2_F, y);
+    }
+    if (isinf(x)) {
+        return copysignf(x > 0.0f ? 0.0f : PI_F, y);
+    }
+    if (x == 0.0f) {
+        if (y == 0.0f) {
+            return signbit(x) ? copysignf(PI_F, y) : y;
+        }
+        return copysignf(PIO2_F, y);
+    }
+
+    float a = launchpad_fast_atanf(fabsf(y / x));
+    if (x < 0.0f) {
+        a = (PI_F - a) + -8.742278e-8f;     /* pi - PI_F */
+    }
+    return copysignf(a, y);
+}
+
+/* ------------------------------------------------------------------
+ * Dispatch
+ * ------------------------------------------------------------------ */
+
+static const char *s_impl = "newlib";
+
+void launchpad_fmath_init(void)
+{
+    launchpad_platform_info_t info = launchpad_platform();
+
+    if (info.hardware & (LAUNCHPAD_HW_RISCV_F | LAUNCHPAD_HW_XTENSA_FPU | LAUNCHPAD_HW_ARM_VFP)) {
+        _register_symbol("sinf",   (void *)launchpad_fast_sinf);
+        _register_symbol("cosf",   (void *)launchpad_fast_cosf);
+        _register_symbol("expf",   (void *)launchpad_fast_expf);
+        _register_symbol("exp2f",  (void *)launchpad_fast_exp2f);
+        _register_symbol("logf",   (void *)launchpad_fast_logf);
+        _register_symbol("log2f",  (void *)launchpad_fast_log2f);
+        _register_symbol("log10f", (void *)launchpad_fast_log10f);
+        _register_symbol("atanf",  (void *)launchpad_fast_atanf);
+        _register_symbol("atan2f", (void *)launchpad_fast_atan2f);
+        s_impl = "fpu";
+    } else {
+        _register_symbol("sinf",   (void *)sinf);
+        _register_symbol("cosf",   (void *)cosf);
+        _register_symbol("expf",   (void *)expf);
+        _register_symbol("exp2f",  (void *)exp2f);
+        _register_symbol("logf",   (void *)logf);
+        _register_symbol("log2f",  (void *)log2f);
+        _register_symbol("log10f", (void *)log10f);
+        _register_symbol("atanf",  (void *)atanf);
+        _register_symbol("atan2f", (void *)atan2f);
+    }
+
+    ESP_LOGI(TAG, "float math: %s", s_impl);
+}
+
+const char *launchpad_fmath_impl(void)
+{
+    return s_impl;
+}
@@ -2,12 +2,116 @@
  * launchpad_log.c
  *
  * Wrapper API для логирования, чтобы ELF мог вызывать launchpad_log.
+ *
+ * В отложенном режиме вызов не форматирует: в кольцо своего ядра
+ * пишутся время, указатели на тег и формат (они лежат в .rodata
+ * приложения) и сырые аргументы. Печатает фоновая задача. Строки
+ * вне образа ELF и flash печатаются сразу.
  * ------------------------------------------------------------- */
 
 #include "include/log.h"
 #include <esp_log.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_memory_utils.h"
+
+/* Кольцо одного ядра, в словах; степень двойки */
+#ifndef LAUNCHPAD_LOG_RING_WORDS
+#define LAUNCHPAD_LOG_RING_WORDS 1024
+#endif
+
+/* Форматы, для которых запомнены типы аргументов (2^N записей) */
+#ifndef LAUNCHPAD_LOG_FMT_CACHE_BITS
+#define LAUNCHPAD_LOG_FMT_CACHE_BITS 7
+#endif
+
+/* Как часто фоновая задача разбирает кольца */
+#ifndef LAUNCHPAD_LOG_DRAIN_MS
+#define LAUNCHPAD_LOG_DRAIN_MS 10
+#endif
+
+#ifndef LAUNCHPAD_LOG_TASK_STACK
+#define LAUNCHPAD_LOG_TASK_STACK 4096
+#endif
+
+#ifndef LAUNCHPAD_LOG_TASK_PRIO
+#define LAUNCHPAD_LOG_TASK_PRIO (tskIDLE_PRIORITY + 1)
+#endif
+
+_Static_assert((LAUNCHPAD_LOG_RING_WORDS & (LAUNCHPAD_LOG_RING_WORDS - 1)) == 0,
+               "LAUNCHPAD_LOG_RING_WORDS must be a power of two");
+
+#define ARGS_MAX        8       /* больше – печатаем сразу */
+#define STR_MAX         32      /* %s копируется, длиннее – обрезается */
+#define SPEC_MAX        16      /* длина одной спецификации, с '%' */
+#define LOG_LINE_MAX    256
+
+#define RING_MASK       (LAUNCHPAD_LOG_RING_WORDS - 1)
+#define FMT_CACHE       (1u << LAUNCHPAD_LOG_FMT_CACHE_BITS)
+#define FMT_PROBES      4
+
+/*
+ * Запись в кольце, по словам:
+ *   [0]  заголовок: бит 31 – готова, бит 30 – пропуск до конца кольца,
+ *        биты 24-26 – уровень, биты 0-15 – длина записи в словах
+ *   [1]  время, мкс (64 бита)
+ *        указатель на тег, указатель на формат
+ *        аргументы: целые и double как есть, %s – длина и байты
+ */
+#define REC_COMMITTED   0x80000000u
+#define REC_PAD         0x40000000u
+#define REC_LEVEL_SHIFT 24
+#define REC_WORDS_MASK  0xFFFFu
+#define PTR_WORDS       (sizeof(void *) / 4)
+#define REC_TAG         3
+#define REC_FMT         (REC_TAG + PTR_WORDS)
+#define REC_ARGS        (REC_FMT + PTR_WORDS)
+#define REC_MAX_WORDS   (REC_ARGS + ARGS_MAX * (1 + STR_MAX / 4))
+
+/* Типы аргументов, по 2 бита на аргумент в описании формата */
+enum { ARG_I32, ARG_I64, ARG_F64, ARG_STR };
+
+#define DESC_VALID      0x80000000u
+#define DESC_SYNC       0x40000000u     /* формат не разобрать – печатаем сразу */
+#define DESC_COUNT_SHIFT 16
+#define DESC_TYPE(d, i) (((d) >> ((i) * 2)) & 3)
+
+typedef struct {
+    uint32_t head;          /* занято писателями */
+    uint32_t tail;          /* разобрано фоновой задачей */
+    uint32_t words[LAUNCHPAD_LOG_RING_WORDS];
+} log_ring_t;
+
+typedef struct {
+    const char *fmt;
+    uint32_t    desc;
+} log_fmt_t;
+
+/* Одна спецификация преобразования */
+typedef struct {
+    char conv;              /* 0 – не поддерживается */
+    char len;               /* 0, 'H' (hh), 'h', 'l', 'q' (ll), 'j', 'z', 't' */
+    int  stars;             /* '*' в ширине и точности, по int на каждую */
+} log_spec_t;
+
+static int          s_mode = LAUNCHPAD_LOG_MODE_SYNC;
+static log_ring_t  *s_rings;                /* по кольцу на ядро */
+static log_fmt_t    s_fmts[FMT_CACHE];
+static TaskHandle_t s_task;
+static SemaphoreHandle_t s_drain_lock;
+static struct launchpad_log_stats s_stats;
+static uintptr_t    s_image_lo;             /* образ работающего ELF */
+static uintptr_t    s_image_hi;
+static uint32_t     s_dropped_reported;
 
 /* ------------------------------------------------------------------
  * Internal helper: map our level enum → esp_log_level_t
@@ -24,6 +128,467 @@ static inline esp_log_level_t _to_esp_level(int level)
     }
 }
 
+/* ------------------------------------------------------------------
+ * Format strings
+ * ------------------------------------------------------------------ */
+
+/* Разбор спецификации; p указывает за '%', возвращает конец */
+static const char *spec_parse(const char *p, log_spec_t *s)
+{
+    s->conv = 0;
+    s->len = 0;
+    s->stars = 0;
+
+    while (*p && strchr("-+ #0", *p)) {
+        p++;
+    }
+    if (*p == '*') {
+        s->stars++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            s->stars++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+
+    switch (*p) {
+    case 'h':
+        s->len = (p[1] == 'h') ? 'H' : 'h';
+        p += (s->len == 'H') ? 2 : 1;
+        break;
+    case 'l':
+        s->len = (p[1] == 'l') ? 'q' : 'l';
+        p += (s->len == 'q') ? 2 : 1;
+        break;
+    case 'j':
+    case 'z':
+    case 't':
+        s->len = *p++;
+        break;
+    default:
+        break;
+    }
+
+    if (*p && strchr("diouxXcsp%fFeEgGaA", *p)) {
+        s->conv = *p++;
+    }
+    return p;
+}
+
+/* Тип аргумента спецификации или -1 */
+static int spec_type(const log_spec_t *s)
+{
+    size_t size;
+
+    switch (s->conv) {
+    case 0:
+        return -1;
+    case 's':
+        return s->len ? -1 : ARG_STR;
+    case 'p':
+        return sizeof(void *) > 4 ? ARG_I64 : ARG_I32;
+    case 'f': case 'F': case 'e': case 'E':
+    case 'g': case 'G': case 'a': case 'A':
+        return s->len ? -1 : ARG_F64;
+    default:
+        break;
+    }
+
+    switch (s->len) {
+    case 'q': size = sizeof(long long); break;
+    case 'j': size = sizeof(intmax_t); break;
+    case 'l': size = sizeof(long); break;
+    case 'z': size = sizeof(size_t); break;
+    case 't': size = sizeof(ptrdiff_t); break;
+    default:  size = sizeof(int); break;
+    }
+    return size > 4 ? ARG_I64 : ARG_I32;
+}
+
+/* Описание формата: число аргументов и их типы */
+static uint32_t fmt_describe(const char *fmt)
+{
+    uint32_t desc = 0;
+    int n = 0;
+
+    for (const char *p = fmt; *p; ) {
+        if (*p++ != '%') {
+            continue;
+        }
+
+        const char *start = p - 1;
+        log_spec_t s;
+        p = spec_parse(p, &s);
+        if (s.conv == '%') {
+            continue;
+        }
+
+        int type = spec_type(&s);
+        if (type < 0 || p - start >= SPEC_MAX || n + s.stars + 1 > ARGS_MAX) {
+            return DESC_VALID | DESC_SYNC;
+        }
+        n += s.stars;       /* '*' – это int, тип 0 */
+        desc |= (uint32_t)type << (n * 2);
+        n++;
+    }
+    return DESC_VALID | ((uint32_t)n << DESC_COUNT_SHIFT) | desc;
+}
+
+/* Описание из кэша: формат разбирается один раз на адрес */
+static uint32_t fmt_lookup(const char *fmt)
+{
+    uint32_t h = ((uint32_t)(uintptr_t)fmt * 2654435761u) >> (32 - LAUNCHPAD_LOG_FMT_CACHE_BITS);
+
+    for (uint32_t i = 0; i < FMT_PROBES; i++) {
+        log_fmt_t *e = &s_fmts[(h + i) & (FMT_CACHE - 1)];
+        const char *cur = __atomic_load_n(&e->fmt, __ATOMIC_ACQUIRE);
+
+        if (cur == NULL) {
+            if (__atomic_compare_exchange_n(&e->fmt, &cur, fmt, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                uint32_t desc = fmt_describe(fmt);
+                __atomic_store_n(&e->desc, desc, __ATOMIC_RELEASE);
+                return desc;
+            }
+        }
+        if (cur == fmt) {
+            /* Запись могли сбросить и занять заново, пока читали */
+            uint32_t desc = __atomic_load_n(&e->desc, __ATOMIC_ACQUIRE);
+            if ((desc & DESC_VALID) && __atomic_load_n(&e->fmt, __ATOMIC_ACQUIRE) == fmt) {
+                return desc;
+            }
+            break;
+        }
+    }
+    return fmt_describe(fmt);
+}
+
+static void fmt_cache_reset(void)
+{
+    for (uint32_t i = 0; i < FMT_CACHE; i++) {
+        __atomic_store_n(&s_fmts[i].desc, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&s_fmts[i].fmt, NULL, __ATOMIC_RELEASE);
+    }
+}
+
+/* ------------------------------------------------------------------
+ * Per-core rings
+ * ------------------------------------------------------------------ */
+
+/* Место под запись из @words слов или NULL, если кольцо полно */
+static uint32_t *ring_reserve(log_ring_t *r, uint32_t words, bool *half)
+{
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+
+    for (;;) {
+        uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+        uint32_t off = head & RING_MASK;
+        uint32_t pad = (off + words > LAUNCHPAD_LOG_RING_WORDS) ? LAUNCHPAD_LOG_RING_WORDS - off : 0;
+        uint32_t used = head + pad + words - tail;
+
+        if (used > LAUNCHPAD_LOG_RING_WORDS) {
+            return NULL;
+        }
+        if (__atomic_compare_exchange_n(&r->head, &head, head + pad + words, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            if (pad) {
+                __atomic_store_n(&r->words[off], REC_COMMITTED | REC_PAD | pad, __ATOMIC_RELEASE);
+            }
+            *half = head - tail < LAUNCHPAD_LOG_RING_WORDS / 2 &&
+                    used >= LAUNCHPAD_LOG_RING_WORDS / 2;
+            return &r->words[(head + pad) & RING_MASK];
+        }
+    }
+}
+
+/* Первая готовая запись кольца, пропуски отбрасываются */
+static uint32_t *ring_peek(log_ring_t *r)
+{
+    for (;;) {
+        uint32_t *rec = &r->words[r->tail & RING_MASK];
+        uint32_t hdr = __atomic_load_n(rec, __ATOMIC_ACQUIRE);
+
+        if (!(hdr & REC_COMMITTED)) {
+            return NULL;
+        }
+        if (!(hdr & REC_PAD)) {
+            return rec;
+        }
+        memset(rec, 0, (hdr & REC_WORDS_MASK) * 4);
+        __atomic_store_n(&r->tail, r->tail + (hdr & REC_WORDS_MASK), __ATOMIC_RELEASE);
+    }
+}
+
+/* Освободить запись; нули нужны, чтобы старый заголовок не сошёл за новый */
+static void ring_release(log_ring_t *r, uint32_t *rec)
+{
+    uint32_t words = *rec & REC_WORDS_MASK;
+
+    memset(rec, 0, words * 4);
+    __atomic_store_n(&r->tail, r->tail + words, __ATOMIC_RELEASE);
+}
+
+/*
+ * Тег и формат хранятся указателями, а формат ещё и ключ кэша описаний.
+ * Годятся только строки, которые не исчезнут и не сменятся по тому же
+ * адресу: в образе ELF или во flash-.rodata прошивки.
+ */
+static bool log_ptr_stable(const void *p)
+{
+    uintptr_t a = (uintptr_t)p;
+
+    return (a >= __atomic_load_n(&s_image_lo, __ATOMIC_ACQUIRE) &&
+            a < __atomic_load_n(&s_image_hi, __ATOMIC_ACQUIRE)) || esp_ptr_in_drom(p);
+}
+
+/* Запись в кольцо; -1 – формат не поддерживается, печатать сразу */
+static int log_defer(int level, const char *tag, const char *fmt, va_list ap)
+{
+    if (!log_ptr_stable(fmt) || (tag && !log_ptr_stable(tag))) {
+        __atomic_add_fetch(&s_stats.sync, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    uint32_t desc = fmt_lookup(fmt);
+    if (desc & DESC_SYNC) {
+        __atomic_add_fetch(&s_stats.sync, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    uint32_t rec[REC_MAX_WORDS];
+    uint32_t n = REC_ARGS;
+    int64_t now = esp_timer_get_time();
+    int count = (desc >> DESC_COUNT_SHIFT) & 0xF;
+
+    memcpy(&rec[1], &now, sizeof(now));
+    memcpy(&rec[REC_TAG], &tag, sizeof(tag));
+    memcpy(&rec[REC_FMT], &fmt, sizeof(fmt));
+
+    for (int i = 0; i < count; i++) {
+        switch (DESC_TYPE(desc, i)) {
+        case ARG_I32:
+            rec[n++] = va_arg(ap, unsigned int);
+            break;
+        case ARG_I64: {
+            unsigned long long v = va_arg(ap, unsigned long long);
+            memcpy(&rec[n], &v, sizeof(v));
+            n += 2;
+            break;
+        }
+        case ARG_F64: {
+            double v = va_arg(ap, double);
+            memcpy(&rec[n], &v, sizeof(v));
+            n += 2;
+            break;
+        }
+        default: {
+            /* Строка может жить на стеке вызывающего – копируем */
+            const char *s = va_arg(ap, const char *);
+            uint32_t len = s ? strnlen(s, STR_MAX) : 0;
+            rec[n] = s ? len : UINT32_MAX;
+            if (len) {
+                memcpy(&rec[n + 1], s, len);
+            }
+            n += 1 + (len + 3) / 4;
+            break;
+        }
+        }
+    }
+
+    log_ring_t *r = &s_rings[xPortGetCoreID()];
+    bool half;
+    uint32_t *dst = ring_reserve(r, n, &half);
+    if (!dst) {
+        __atomic_add_fetch(&s_stats.dropped, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    memcpy(dst + 1, rec + 1, (n - 1) * 4);
+    __atomic_store_n(dst, REC_COMMITTED | (((uint32_t)level & 7) << REC_LEVEL_SHIFT) | n,
+                     __ATOMIC_RELEASE);
+
+    /* Будим задачу один раз, когда кольцо заполнилось наполовину */
+    if (half) {
+        xTaskNotifyGive(s_task);
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------
+ * Decoder
+ * ------------------------------------------------------------------ */
+
+#define SPEC_PRINT(v)                                                           \
+    (s->stars == 2 ? snprintf(out, room, spec, star[0], star[1], v) :           \
+     s->stars == 1 ? snprintf(out, room, spec, star[0], v) :                    \
+                     snprintf(out, room, spec, v))
+
+/* Одна спецификация со своим аргументом; возвращает записанную длину */
+static size_t spec_print(char *out, size_t room, const char *spec, const log_spec_t *s,
+                         const int *star, const uint32_t **arg)
+{
+    const uint32_t *a = *arg;
+    int n;
+
+    switch (spec_type(s)) {
+    case ARG_STR: {
+        char str[STR_MAX + 1];
+        uint32_t len = (a[0] == UINT32_MAX) ? 0 : a[0];
+
+        memcpy(str, a + 1, len);
+        str[len] = '\0';
+        *arg = a + 1 + (len + 3) / 4;
+        n = SPEC_PRINT(a[0] == UINT32_MAX ? "(null)" : str);
+        break;
+    }
+    case ARG_F64: {
+        double v;
+        memcpy(&v, a, sizeof(v));
+        *arg = a + 2;
+        n = SPEC_PRINT(v);
+        break;
+    }
+    case ARG_I64: {
+        unsigned long long v;
+        memcpy(&v, a, sizeof(v));
+        *arg = a + 2;
+        n = (s->conv == 'p') ? SPEC_PRINT((void *)(uintptr_t)v) : SPEC_PRINT(v);
+        break;
+    }
+    default:
+        *arg = a + 1;
+        n = (s->conv == 'p') ? SPEC_PRINT((void *)(uintptr_t)a[0]) : SPEC_PRINT(a[0]);
+        break;
+    }
+
+    if (n < 0) {
+        return 0;
+    }
+    return ((size_t)n < room) ? (size_t)n : room - 1;
+}
+
+/* Напечатать запись так же, как её напечатал бы синхронный режим */
+static void log_emit(const uint32_t *rec)
+{
+    static char line[LOG_LINE_MAX];
+    const char *tag;
+    const char *fmt;
+    const uint32_t *arg = rec + REC_ARGS;
+    size_t len = 0;
+
+    memcpy(&tag, &rec[REC_TAG], sizeof(tag));
+    memcpy(&fmt, &rec[REC_FMT], sizeof(fmt));
+
+    for (const char *p = fmt; *p && len < sizeof(line) - 1; ) {
+        if (*p != '%') {
+            line[len++] = *p++;
+            continue;
+        }
+
+        const char *start = p;
+        log_spec_t s;
+        int star[2] = { 0, 0 };
+        char spec[SPEC_MAX];
+
+        p = spec_parse(p + 1, &s);
+        if (s.conv == '%') {
+            line[len++] = '%';
+            continue;
+        }
+        memcpy(spec, start, p - start);
+        spec[p - start] = '\0';
+        for (int i = 0; i < s.stars; i++) {
+            star[i] = (int)*arg++;
+        }
+        len += spec_print(line + len, sizeof(line) - len, spec, &s, star, &arg);
+    }
+    line[len] = '\0';
+
+    esp_log_write(_to_esp_level((rec[0] >> REC_LEVEL_SHIFT) & 7), tag ? tag : "ELF", "%s", line);
+}
+
+/* Разобрать все кольца, сливая их по времени */
+static void log_drain(void)
+{
+    xSemaphoreTake(s_drain_lock, portMAX_DELAY);
+
+    for (;;) {
+        log_ring_t *best = NULL;
+        uint32_t *best_rec = NULL;
+        int64_t best_time = 0;
+
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            uint32_t *rec = ring_peek(&s_rings[core]);
+            int64_t t;
+
+            if (!rec) {
+                continue;
+            }
+            memcpy(&t, &rec[1], sizeof(t));
+            if (!best_rec || t < best_time) {
+                best = &s_rings[core];
+                best_rec = rec;
+                best_time = t;
+            }
+        }
+        if (!best_rec) {
+            break;
+        }
+        log_emit(best_rec);
+        ring_release(best, best_rec);
+        __atomic_store_n(&s_stats.records, s_stats.records + 1, __ATOMIC_RELAXED);
+    }
+
+    uint32_t dropped = __atomic_load_n(&s_stats.dropped, __ATOMIC_RELAXED);
+    if (dropped != s_dropped_reported) {
+        esp_log_write(ESP_LOG_WARN, "launchpad_log", "%u messages dropped\n",
+                      (unsigned)(dropped - s_dropped_reported));
+        s_dropped_reported = dropped;
+    }
+
+    xSemaphoreGive(s_drain_lock);
+}
+
+static void log_task(void *arg)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LAUNCHPAD_LOG_DRAIN_MS));
+        log_drain();
+    }
+}
+
+static int log_deferred_init(void)
+{
+    if (s_rings) {
+        return 0;
+    }
+
+    s_rings = heap_caps_calloc(portNUM_PROCESSORS, sizeof(log_ring_t),
+                               MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s_drain_lock = xSemaphoreCreateMutex();
+    if (!s_rings || !s_drain_lock ||
+        xTaskCreate(log_task, "launchpad_log", LAUNCHPAD_LOG_TASK_STACK, NULL,
+                    LAUNCHPAD_LOG_TASK_PRIO, &s_task) != pdPASS) {
+        if (s_drain_lock) {
+            vSemaphoreDelete(s_drain_lock);
+        }
+        heap_caps_free(s_rings);
+        s_rings = NULL;
+        s_drain_lock = NULL;
+        return 1;
+    }
+    return 0;
+}
+
 /* ------------------------------------------------------------------
  * Public API
  * ------------------------------------------------------------------ */
@@ -37,6 +602,17 @@ int launchpad_log(int level, const char *tag, const char *fmt, ...)
     va_list args;
     va_start(args, fmt);
 
+    if (s_mode == LAUNCHPAD_LOG_MODE_DEFERRED) {
+        va_list copy;
+        va_copy(copy, args);
+        int rc = log_defer(level, tag, fmt, copy);
+        va_end(copy);
+        if (rc == 0) {
+            va_end(args);
+            return 0;
+        }
+    }
+
     esp_log_level_t esp_level = _to_esp_level(level);
 
     /* Передаём управление стандартному esp_log_writev */
@@ -45,3 +621,54 @@ int launchpad_log(int level, const char *tag, const char *fmt, ...)
     va_end(args);
     return 0;
 }
+
+int launchpad_log_set_mode(int mode)
+{
+    switch (mode) {
+    case LAUNCHPAD_LOG_MODE_SYNC:
+        s_mode = mode;
+        launchpad_log_flush();  /* отложенное выйдет раньше нового */
+        return 0;
+    case LAUNCHPAD_LOG_MODE_DEFERRED:
+        if (log_deferred_init()) {
+            return 1;
+        }
+        s_mode = mode;
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+void launchpad_log_flush(void)
+{
+    if (s_rings) {
+        log_drain();
+    }
+}
+
+void launchpad_log_app_enter(const void *image, size_t size)
+{
+    __atomic_store_n(&s_image_hi, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_image_lo, (uintptr_t)image, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_image_hi, (uintptr_t)image + size, __ATOMIC_RELEASE);
+}
+
+void launchpad_log_app_exit(void)
+{
+    /* Новые записи уже не ссылаются на образ; старые указывают в него */
+    __atomic_store_n(&s_image_hi, 0, __ATOMIC_RELEASE);
+    launchpad_log_flush();
+    fmt_cache_reset();
+}
+
+int launchpad_log_get_stats(struct launchpad_log_stats *st)
+{
+    if (!st) {
+        return 1;
+    }
+    st->records = __atomic_load_n(&s_stats.records, __ATOMIC_RELAXED);
+    st->dropped = __atomic_load_n(&s_stats.dropped, __ATOMIC_RELAXED);
+    st->sync    = __atomic_load_n(&s_stats.sync, __ATOMIC_RELAXED);
+    return 0;
+}
@@ -0,0 +1,294 @@
+/* -------------------------------------------------------------
+ * launchpad_mem_api.c
+ *
+ * SIMD (ESP32-P4 PIE) and scalar memory/string primitives for
+ * loaded ELF modules. See include/mem.h.
+ * ------------------------------------------------------------- */
+
+#include "include/mem.h"
+
+#include <stdint.h>
+#include <string.h>
+#include "soc/soc_caps.h"
+#include "esp_log.h"
+
+#include "platform.h"
+#include "elf/esp_elf.h"
+
+static const char *TAG = "LaunchpadMem";
+
+/* ------------------------------------------------------------------
+ * Word-at-a-time helpers (any 32-bit core)
+ * ------------------------------------------------------------------ */
+
+#define ONES    0x01010101U
+#define HIGHS   0x80808080U
+
+/* Non-zero if any byte of @x is 0x00 */
+#define HAS_ZERO(x) (((x) - ONES) & ~(x) & HIGHS)
+
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+static size_t word_strlen(const char *s)
+{
+    const char *p = s;
+
+    while ((uintptr_t)p & 3) {
+        if (!*p) {
+            return p - s;
+        }
+        p++;
+    }
+
+    /* Aligned word reads never cross a page/region boundary */
+    const word_t *w = (const word_t *)p;
+    while (!HAS_ZERO(*w)) {
+        w++;
+    }
+
+    p = (const char *)w;
+    while (*p) {
+        p++;
+    }
+    return p - s;
+}
+
+static int word_strcmp(const char *a, const char *b)
+{
+    if (((uintptr_t)a ^ (uintptr_t)b) & 3) {
+        return strcmp(a, b);
+    }
+
+    while ((uintptr_t)a & 3) {
+        if (*a != *b || !*a) {
+            return (unsigned char)*a - (unsigned char)*b;
+        }
+        a++;
+        b++;
+    }
+
+    const word_t *wa = (const word_t *)a;
+    const word_t *wb = (const word_t *)b;
+    while (*wa == *wb && !HAS_ZERO(*wa)) {
+        wa++;
+        wb++;
+    }
+
+    a = (const char *)wa;
+    b = (const char *)wb;
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return (unsigned char)*a - (unsigned char)*b;
+}
+
+/* ------------------------------------------------------------------
+ * ESP32-P4 PIE (128-bit) block primitives
+ *
+ * esp.vld.128 / esp.vst.128 ignore the low 4 address bits, so the
+ * vector loops only run on 16-byte aligned pointers; heads, tails
+ * and mutually misaligned buffers go through newlib.
+ * ------------------------------------------------------------------ */
+
+#if SOC_CPU_HAS_PIE
+
+static void *pie_memcpy(void *dst, const void *src, size_t n)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    if (n < LAUNCHPAD_MEM_SIMD_MIN || (((uintptr_t)d ^ (uintptr_t)s) & 15)) {
+        return memcpy(dst, src, n);
+    }
+
+    size_t head = (-(uintptr_t)d) & 15;
+    if (head) {
+        memcpy(d, s, head);
+        d += head;
+        s += head;
+        n -= head;
+    }
+
+    for (size_t blocks = n >> 6; blocks; blocks--) {
+        __asm__ __volatile__(
+            "esp.vld.128.ip q0, %0, 16\n"
+            "esp.vld.128.ip q1, %0, 16\n"
+            "esp.vld.128.ip q2, %0, 16\n"
+            "esp.vld.128.ip q3, %0, 16\n"
+            "esp.vst.128.ip q0, %1, 16\n"
+            "esp.vst.128.ip q1, %1, 16\n"
+            "esp.vst.128.ip q2, %1, 16\n"
+            "esp.vst.128.ip q3, %1, 16\n"
+            : "+r"(s), "+r"(d)
+            :
+            : "memory");
+    }
+
+    n &= 63;
+    if (n) {
+        memcpy(d, s, n);
+    }
+    return dst;
+}
+
+static void *pie_memset(void *dst, int c, size_t n)
+{
+    uint8_t *d = dst;
+
+    if (n < LAUNCHPAD_MEM_SIMD_MIN) {
+        return memset(dst, c, n);
+    }
+
+    size_t head = (-(uintptr_t)d) & 15;
+    if (head) {
+        memset(d, c, head);
+        d += head;
+        n -= head;
+    }
+
+    uint32_t w = (uint8_t)c * ONES;
+    const uint32_t pattern[4] __attribute__((aligned(16))) = { w, w, w, w };
+    const uint32_t *pp = pattern;
+
+    __asm__ __volatile__("esp.vld.128.ip q0, %0, 0\n" : "+r"(pp) : "m"(pattern));
+
+    for (size_t blocks = n >> 6; blocks; blocks--) {
+        __asm__ __volatile__(
+            "esp.vst.128.ip q0, %0, 16\n"
+            "esp.vst.128.ip q0, %0, 16\n"
+            "esp.vst.128.ip q0, %0, 16\n"
+            "esp.vst.128.ip q0, %0, 16\n"
+            : "+r"(d)
+            :
+            : "memory");
+    }
+
+    n &= 63;
+    if (n) {
+        memset(d, c, n);
+    }
+    return dst;
+}
+
+static int pie_memcmp(const void *pa, const void *pb, size_t n)
+{
+    const uint8_t *a = pa;
+    const uint8_t *b = pb;
+
+    if (n < LAUNCHPAD_MEM_SIMD_MIN || (((uintptr_t)a ^ (uintptr_t)b) & 15)) {
+        return memcmp(pa, pb, n);
+    }
+
+    size_t head = (-(uintptr_t)a) & 15;
+    if (head) {
+        int r = memcmp(a, b, head);
+        if (r) {
+            return r;
+        }
+        a += head;
+        b += head;
+        n -= head;
+    }
+
+    /* 32 bytes per step: XOR both halves, OR them and reduce to a word */
+    while (n >= 32) {
+        uint32_t l0, l1, l2, l3;
+
+        __asm__ __volatile__(
+            "esp.vld.128.ip q0, %4, 16\n"
+            "esp.vld.128.ip q1, %5, 16\n"
+            "esp.vld.128.ip q2, %4, 16\n"
+            "esp.vld.128.ip q3, %5, 16\n"
+            "esp.xorq q4, q0, q1\n"
+            "esp.xorq q5, q2, q3\n"
+            "esp.orq q4, q4, q5\n"
+            "esp.movi.32.a q4, %0, 0\n"
+            "esp.movi.32.a q4, %1, 1\n"
+            "esp.movi.32.a q4, %2, 2\n"
+            "esp.movi.32.a q4, %3, 3\n"
+            : "=r"(l0), "=r"(l1), "=r"(l2), "=r"(l3), "+r"(a), "+r"(b)
+            :
+            : "memory");
+
+        if (l0 | l1 | l2 | l3) {
+            /* Locate the first differing byte inside the block */
+            return memcmp(a - 32, b - 32, 32);
+        }
+        n -= 32;
+    }
+
+    return n ? memcmp(a, b, n) : 0;
+}
+
+#endif /* SOC_CPU_HAS_PIE */
+
+/* ------------------------------------------------------------------
+ * Dispatch
+ * ------------------------------------------------------------------ */
+
+static void  *(*s_memcpy)(void *, const void *, size_t) = memcpy;
+static void  *(*s_memset)(void *, int, size_t)          = memset;
+static int    (*s_memcmp)(const void *, const void *, size_t) = memcmp;
+static size_t (*s_strlen)(const char *)                 = strlen;
+static int    (*s_strcmp)(const char *, const char *)   = strcmp;
+static const char *s_impl = "scalar";
+
+void launchpad_mem_init(void)
+{
+    launchpad_platform_info_t info = launchpad_platform();
+
+#if SOC_CPU_HAS_PIE
+    if (info.hardware & LAUNCHPAD_HW_SIMD_SUPPORT) {
+        s_memcpy = pie_memcpy;
+        s_memset = pie_memset;
+        s_memcmp = pie_memcmp;
+        s_impl   = "pie";
+    }
+#endif
+
+    /* Word-at-a-time string scans pay off on every 32-bit core with a data cache */
+    if (info.bitness == 32 && (info.hardware & LAUNCHPAD_HW_CACHE_L1_D)) {
+        s_strlen = word_strlen;
+        s_strcmp = word_strcmp;
+    }
+
+    /* Export the selected routines directly so ELF calls skip the dispatch */
+    _register_symbol("memcpy", (void *)s_memcpy);
+    _register_symbol("memset", (void *)s_memset);
+    _register_symbol("memcmp", (void *)s_memcmp);
+    _register_symbol("strlen", (void *)s_strlen);
+    _register_symbol("strcmp", (void *)s_strcmp);
+
+    ESP_LOGI(TAG, "memory primitives: %s", s_impl);
+}
+
+void *launchpad_memcpy(void *dst, const void *src, size_t n)
+{
+    return s_memcpy(dst, src, n);
+}
+
+void *launchpad_memset(void *dst, int c, size_t n)
+{
+    return s_memset(dst, c, n);
+}
+
+int launchpad_memcmp(const void *a, const void *b, size_t n)
+{
+    return s_memcmp(a, b, n);
+}
+
+size_t launchpad_strlen(const char *s)
+{
+    return s_strlen(s);
+}
+
+int launchpad_strcmp(const char *a, const char *b)
+{
+    return s_strcmp(a, b);
+}
+
+const char *launchpad_mem_impl(void)
+{
+    return s_impl;
+}
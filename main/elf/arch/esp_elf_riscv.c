@@ -85,7 +85,7 @@ int esp_elf_arch_relocate(esp_elf_t *elf, const elf32_rela_t *rela,
 
     assert(elf && rela);
 
-    where = (uint32_t *)((uint8_t *)elf->psegment + rela->offset + elf->svaddr);
+    where = (uint32_t *)((uint8_t *)elf->psegment + rela->offset - elf->svaddr);
     ESP_LOGD(TAG, "type: %d, where=%p addr=0x%x offset=0x%x",
              ELF_R_TYPE(rela->info), where, (int)elf->psegment, (int)rela->offset);
 
@@ -103,6 +103,31 @@ int esp_elf_arch_relocate(esp_elf_t *elf, const elf32_rela_t *rela,
     case R_RISCV_JUMP_SLOT:
         *where = addr;
         break;
+    case R_RISCV_TLS_DTPMOD32:
+    case R_RISCV_TLS_DTPREL32:
+        if (!elf->tls.gen) {
+            ESP_LOGE(TAG, "TLS relocation without PT_TLS");
+            return -EINVAL;
+        }
+        if (ELF_R_SYM(rela->info) && !sym->shndx) {
+            ESP_LOGE(TAG, "TLS variables of the firmware are not exported");
+            return -ENOSYS;
+        }
+
+        if (ELF_R_TYPE(rela->info) == R_RISCV_TLS_DTPMOD32) {
+            *where = (Elf32_Addr)&elf->tls;
+        } else {
+            *where = sym->value + rela->addend - ESP_ELF_TLS_DTV_OFFSET;
+        }
+        break;
+    case R_RISCV_TLS_TPREL32:
+    case R_RISCV_TPREL_HI20:
+    case R_RISCV_TPREL_LO12_I:
+    case R_RISCV_TPREL_LO12_S:
+    case R_RISCV_TPREL_ADD:
+        /* tp belongs to the firmware's own TLS, apps go through __tls_get_addr() */
+        ESP_LOGE(TAG, "Static TLS is not supported, build with -ftls-model=global-dynamic");
+        return -ENOTSUP;
     default:
         ESP_LOGE(TAG, "info=%d is not supported\n", ELF_R_TYPE(rela->info));
         return -EINVAL;
@@ -49,6 +49,99 @@ void esp_elf_free(void *ptr);
 int esp_elf_arch_relocate(esp_elf_t *elf, const elf32_rela_t *rela,
                           const elf32_sym_t *sym, uint32_t addr);
 
+/**
+ * @brief Bias between DTPREL values and offsets into a TLS block.
+ */
+#ifdef __riscv
+#define ESP_ELF_TLS_DTV_OFFSET  0x800
+#else
+#define ESP_ELF_TLS_DTV_OFFSET  0
+#endif
+
+/**
+ * @brief Record the PT_TLS template of a loaded ELF.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_tls_init(esp_elf_t *elf, const uint8_t *pbuf);
+
+/**
+ * @brief Give the calling task its TLS block of an ELF.
+ *
+ * Called before the entry runs, so the main thread of an app never
+ * meets an allocation failure inside __tls_get_addr().
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return ESP_OK if success or -ENOMEM if failed.
+ */
+int esp_elf_tls_prepare(esp_elf_t *elf);
+
+/**
+ * @brief Free the calling task's TLS block of an ELF.
+ *
+ * Blocks of other tasks are freed when those tasks are deleted or
+ * recycled when they touch TLS of a later image.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return None
+ */
+void esp_elf_tls_deinit(esp_elf_t *elf);
+
+#if CONFIG_LAUNCHPAD_SHARED_TEXT
+/**
+ * @brief Load ELF segments with the read-only part shared between instances.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if loaded, -EAGAIN if the caller should fall back to a
+ *         private copy or other if failed.
+ */
+int esp_elf_share_load(esp_elf_t *elf, const uint8_t *pbuf);
+
+/**
+ * @brief Decide whether freshly relocated read-only pages may be shared.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return None
+ */
+void esp_elf_share_commit(esp_elf_t *elf, const uint8_t *pbuf);
+
+/**
+ * @brief First address relocation may write to.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return End of the shared pages if they are read-only, else elf->svaddr.
+ */
+Elf32_Addr esp_elf_share_reloc_start(const esp_elf_t *elf);
+
+/**
+ * @brief Unmap an instance and drop its reference to the shared pages.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return None
+ */
+void esp_elf_share_release(esp_elf_t *elf);
+
+/**
+ * @brief Tell whether an image would be loaded with shared read-only pages.
+ *
+ * @param pbuf - ELF data buffer
+ *
+ * @return true if esp_elf_share_load() may take it.
+ */
+bool esp_elf_share_candidate(const uint8_t *pbuf);
+#endif
+
 /**
  * @brief Remap symbol from ".data" to ".text" section.
  *
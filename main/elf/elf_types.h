@@ -41,6 +41,12 @@ extern "C" {
 #define PT_LOPROC       0x70000000      /*!< Start of processor-specific */
 #define PT_HIPROC       0x7fffffff      /*!< End of processor-specific */
 
+/** @brief Segment Flags */
+
+#define PF_X            1               /*!< executable */
+#define PF_W            2               /*!< writable */
+#define PF_R            4               /*!< readable */
+
 /** @brief Section Type */
 
 #define SHT_NULL        0               /*!< invalid section header */
@@ -55,6 +61,7 @@ extern "C" {
 #define SHT_REL         9               /*!< relocation table */
 #define SHT_SHKIB       10              /*!< reserved but has unspecified semantics. */
 #define SHT_SYNSYM      11              /*!< dynamic symbol */
+#define SHT_RELR        19              /*!< packed relative relocation table */
 #define SHT_LOPROC      0x70000000      /*!< reserved for processor-specific semantics */
 #define SHT_LOUSER      0x7fffffff      /*!< lower bound of the range of indexes reserved for application programs */
 #define SHT_HIUSER      0xffffffff      /*!< upper bound of the range of indexes reserved for application programs. */
@@ -81,6 +88,32 @@ extern "C" {
 #define STT_LOPROC      13              /*!< processor specific range */
 #define STT_HIPROC      15              /*!< processor specific link range */
 
+/** @brief LaunchPad Note */
+
+#define ELF_NOTE_LAUNCHPAD  "LaunchPad"     /*!< note owner name */
+#define NT_LAUNCHPAD_FIXED  0x4c500001      /*!< image linked at the fixed load window */
+
+/** @brief Dynamic Array Tags */
+
+#define DT_NULL         0               /*!< end of dynamic array */
+#define DT_NEEDED       1               /*!< name of needed library */
+#define DT_PLTRELSZ     2               /*!< size of PLT relocations */
+#define DT_PLTGOT       3               /*!< PLT/GOT address */
+#define DT_HASH         4               /*!< SysV symbol hash table */
+#define DT_STRTAB       5               /*!< dynamic string table */
+#define DT_SYMTAB       6               /*!< dynamic symbol table */
+#define DT_RELA         7               /*!< Elf32_Rela relocations */
+#define DT_RELASZ       8               /*!< total size of DT_RELA */
+#define DT_RELAENT      9               /*!< size of one Elf32_Rela */
+#define DT_STRSZ        10              /*!< size of string table */
+#define DT_SYMENT       11              /*!< size of one symbol */
+#define DT_PLTREL       20              /*!< type of PLT relocations */
+#define DT_JMPREL       23              /*!< PLT relocations */
+#define DT_RELRSZ       35              /*!< total size of DT_RELR */
+#define DT_RELR         36              /*!< packed relative relocations */
+#define DT_RELRENT      37              /*!< size of one RELR entry */
+#define DT_GNU_HASH     0x6ffffef5      /*!< GNU-style symbol hash table */
+
 /** @brief Section names */
 
 #define ELF_BSS         ".bss"          /*!< uninitialized data */
@@ -168,6 +201,22 @@ typedef struct elf32_phdr {
     Elf32_Word align;                        /* memory alignment */
 } elf32_phdr_t;
 
+/** @brief Note Header, followed by the 4-byte aligned name and descriptor */
+
+typedef struct elf32_nhdr {
+    Elf32_Word namesz;                       /* name size, including NUL */
+    Elf32_Word descsz;                       /* descriptor size */
+    Elf32_Word type;                         /* note type */
+} elf32_nhdr_t;
+
+/** @brief NT_LAUNCHPAD_FIXED descriptor */
+
+typedef struct elf32_lp_fixed {
+    Elf32_Addr base;                         /* window base the image is linked at */
+    Elf32_Word size;                         /* window size the image was linked for */
+    uint8_t    fw_sha256[8];                 /* firmware ELF SHA prefix if prelinked, else zero */
+} elf32_lp_fixed_t;
+
 /** @brief Section Header */
 
 typedef struct elf32_shdr {
@@ -209,6 +258,17 @@ typedef struct elf32_rela {
     Elf32_Sword     addend;             /*!< Added information */
 } elf32_rela_t;
 
+/** @brief Packed relative relocation entry (address or bitmap) */
+
+typedef Elf32_Word elf32_relr_t;
+
+/** @brief Dynamic section entry */
+
+typedef struct elf32_dyn {
+    Elf32_Sword     tag;                /*!< DT_* entry type */
+    Elf32_Word      val;                /*!< integer value or virtual address */
+} elf32_dyn_t;
+
 /** @brief ELF section object */
 
 typedef struct esp_elf_sec {
@@ -219,6 +279,21 @@ typedef struct esp_elf_sec {
     size_t          size;               /*!< section size */
 } esp_elf_sec_t;
 
+/** @brief ELF thread-local storage template, also the module ID of __tls_get_addr() */
+
+typedef struct esp_elf_tls {
+    const uint8_t   *init;              /*!< initialisation image inside the loaded segment */
+    uint32_t        filesz;             /*!< size of the initialisation image */
+    uint32_t        memsz;              /*!< size of one TLS block */
+    uint32_t        align;              /*!< alignment of one TLS block */
+    uint32_t        gen;                /*!< load generation, 0 if the image has no PT_TLS */
+} esp_elf_tls_t;
+
+/** @brief ELF object flags */
+
+#define ESP_ELF_F_FIXED     (1 << 0)    /*!< segments live in the fixed load window */
+#define ESP_ELF_F_SHARED    (1 << 1)    /*!< read-only segments are shared with other instances */
+
 /** @brief ELF object */
 
 typedef struct esp_elf {
@@ -226,12 +301,22 @@ typedef struct esp_elf {
 
     uint32_t         svaddr;            /*!< start virtual address of segment */
 
+    uint32_t         ssize;             /*!< size of the segment image at psegment */
+
     unsigned char   *ptext;             /*!< instruction buffer pointer */
 
     unsigned char   *pdata;             /*!< data buffer pointer */
 
+    unsigned char   *pimage;            /*!< caller's ELF buffer owned by the object, if loaded in place */
+
     esp_elf_sec_t   sec[ELF_SECS];      /*!< ".bss", "data", "rodata", ".text" */
 
+    uint32_t        flags;              /*!< ESP_ELF_F_* load flags */
+
+    esp_elf_tls_t   tls;                /*!< PT_TLS template */
+
+    void            *share;             /*!< shared read-only segment cache entry */
+
     int (*entry)(int argc, char *argv[]);               /*!< Entry pointer of ELF */
 
 #ifdef CONFIG_ELF_LOADER_SET_MMU
@@ -11,18 +11,31 @@
 #include <sys/param.h>
 
 #include "esp_log.h"
+#include "esp_memory_utils.h"
 #include "soc/soc_caps.h"
 
 #if SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
 #include "hal/cache_ll.h"
 #endif
 
+#if CONFIG_LAUNCHPAD_PARALLEL_RELOC
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#endif
+
+#if CONFIG_LAUNCHPAD_FIXED_WINDOW && !CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+#include "esp_app_desc.h"
+#include "heap_memory_layout.h"
+#endif
+
 #include "elf_symbol.h"
 #include "elf_platform.h"
 
 #define stype(_s, _t)               ((_s)->type == (_t))
 #define sflags(_s, _f)              (((_s)->flags & (_f)) == (_f))
 #define ADDR_OFFSET                 (0x400)
+#define INPLACE_ALIGN_MAX           (64)
 
 static const char *TAG = "ELF";
 
@@ -238,7 +251,7 @@ static int esp_elf_load_segment(esp_elf_t *elf, const uint8_t *pbuf)
             return -EINVAL;
         }
 
-        if (first_segment == true) {
+        if (!first_segment) {
             vaddr_s = phdr[i].vaddr;
             vaddr_e = phdr[i].vaddr + phdr[i].memsz;
             first_segment = true;
@@ -277,6 +290,7 @@ static int esp_elf_load_segment(esp_elf_t *elf, const uint8_t *pbuf)
     }
 
     elf->svaddr = vaddr_s;
+    elf->ssize = size;
     elf->psegment = esp_elf_malloc(size, true);
     if (!elf->psegment) {
         return -ENOMEM;
@@ -304,6 +318,284 @@ static int esp_elf_load_segment(esp_elf_t *elf, const uint8_t *pbuf)
 
     return 0;
 }
+
+#if CONFIG_LAUNCHPAD_FIXED_WINDOW
+
+#define FIXED_WINDOW_BASE           ((Elf32_Addr)CONFIG_LAUNCHPAD_FIXED_WINDOW_ADDR)
+#define FIXED_WINDOW_SIZE           ((uint32_t)CONFIG_LAUNCHPAD_FIXED_WINDOW_SIZE)
+#define NOTE_ALIGN(_n)              (((_n) + 3) & ~3u)
+
+/* Keep the heap allocator away from the window */
+SOC_RESERVE_MEMORY_REGION(CONFIG_LAUNCHPAD_FIXED_WINDOW_ADDR,
+                          CONFIG_LAUNCHPAD_FIXED_WINDOW_ADDR + CONFIG_LAUNCHPAD_FIXED_WINDOW_SIZE,
+                          launchpad_fixed_window);
+
+static bool s_fixed_window_busy;
+
+/**
+ * @brief Find the NT_LAUNCHPAD_FIXED note of an image.
+ *
+ * @param pbuf - ELF data buffer
+ *
+ * @return Note descriptor or NULL if the image carries none.
+ */
+static const elf32_lp_fixed_t *esp_elf_find_fixed_note(const uint8_t *pbuf)
+{
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type != PT_NOTE) {
+            continue;
+        }
+
+        uint32_t off = 0;
+
+        while (off + sizeof(elf32_nhdr_t) <= phdr[i].filesz) {
+            const elf32_nhdr_t *nhdr = (const elf32_nhdr_t *)(pbuf + phdr[i].offset + off);
+            const char *name = (const char *)(nhdr + 1);
+            const uint8_t *desc = (const uint8_t *)name + NOTE_ALIGN(nhdr->namesz);
+
+            off += sizeof(elf32_nhdr_t) + NOTE_ALIGN(nhdr->namesz) + NOTE_ALIGN(nhdr->descsz);
+            if (off > phdr[i].filesz) {
+                break;
+            }
+
+            if (nhdr->type == NT_LAUNCHPAD_FIXED &&
+                    nhdr->namesz == sizeof(ELF_NOTE_LAUNCHPAD) &&
+                    !memcmp(name, ELF_NOTE_LAUNCHPAD, sizeof(ELF_NOTE_LAUNCHPAD)) &&
+                    nhdr->descsz >= sizeof(elf32_lp_fixed_t)) {
+                return (const elf32_lp_fixed_t *)desc;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Load ELF segments into the fixed load window.
+ *
+ * The image must carry a NT_LAUNCHPAD_FIXED note naming this window and
+ * all of its PT_LOAD segments must lie inside it. Segments are copied to
+ * their link-time addresses, so the load bias is zero.
+ *
+ * @param elf       - ELF object pointer
+ * @param pbuf      - ELF data buffer
+ * @param prelinked - Set if the image was prelinked against this firmware
+ *                    and needs no relocation at all
+ *
+ * @return ESP_OK if loaded, -EAGAIN if the caller should fall back to a
+ *         normal load or other if failed.
+ */
+static int esp_elf_load_fixed(esp_elf_t *elf, const uint8_t *pbuf, bool *prelinked)
+{
+    bool busy = false;
+    Elf32_Addr vaddr_s = UINT32_MAX;
+    Elf32_Addr vaddr_e = 0;
+
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+    const elf32_lp_fixed_t *note = esp_elf_find_fixed_note(pbuf);
+
+    if (!note) {
+        return -EAGAIN;
+    }
+
+    if (note->base != FIXED_WINDOW_BASE || note->size > FIXED_WINDOW_SIZE) {
+        ESP_LOGW(TAG, "Image linked for window 0x%x+0x%x, have 0x%x+0x%x",
+                 (int)note->base, (int)note->size, (int)FIXED_WINDOW_BASE, (int)FIXED_WINDOW_SIZE);
+        return -EAGAIN;
+    }
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type != PT_LOAD) {
+            continue;
+        }
+
+        if (phdr[i].memsz < phdr[i].filesz ||
+                phdr[i].vaddr < FIXED_WINDOW_BASE ||
+                phdr[i].memsz > FIXED_WINDOW_SIZE ||
+                phdr[i].vaddr - FIXED_WINDOW_BASE > FIXED_WINDOW_SIZE - phdr[i].memsz) {
+            ESP_LOGE(TAG, "Invalid segment[%d] for fixed window, vaddr: 0x%x, memsz: %d",
+                     i, phdr[i].vaddr, phdr[i].memsz);
+            return -EINVAL;
+        }
+
+        vaddr_s = MIN(vaddr_s, phdr[i].vaddr);
+        vaddr_e = MAX(vaddr_e, phdr[i].vaddr + phdr[i].memsz);
+    }
+
+    if (vaddr_s == UINT32_MAX) {
+        return -EINVAL;
+    }
+
+    if (!__atomic_compare_exchange_n(&s_fixed_window_busy, &busy, true, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        ESP_LOGW(TAG, "Fixed window is in use, relocating instead");
+        return -EAGAIN;
+    }
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type == PT_LOAD) {
+            uint8_t *dst = (uint8_t *)(uintptr_t)phdr[i].vaddr;
+
+            memcpy(dst, pbuf + phdr[i].offset, phdr[i].filesz);
+            memset(dst + phdr[i].filesz, 0, phdr[i].memsz - phdr[i].filesz);
+        }
+    }
+
+#if SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
+    /* The window is reused at the same addresses, drop stale instructions */
+    cache_ll_writeback_all(CACHE_LL_LEVEL_INT_MEM, CACHE_TYPE_DATA, CACHE_LL_ID_ALL);
+    cache_ll_invalidate_all(CACHE_LL_LEVEL_INT_MEM, CACHE_TYPE_INSTRUCTION, CACHE_LL_ID_ALL);
+#endif
+
+    elf->svaddr   = vaddr_s;
+    elf->ssize    = vaddr_e - vaddr_s;
+    elf->psegment = (unsigned char *)(uintptr_t)vaddr_s;
+    elf->entry    = (void *)(uintptr_t)ehdr->entry;
+    elf->flags   |= ESP_ELF_F_FIXED;
+
+    *prelinked = !memcmp(note->fw_sha256, esp_app_get_description()->app_elf_sha256,
+                         sizeof(note->fw_sha256));
+
+    return 0;
+}
+#endif /* CONFIG_LAUNCHPAD_FIXED_WINDOW */
+
+/**
+ * @brief Use the ELF buffer itself as the segment memory.
+ *
+ * This works when every PT_LOAD sits at the same distance from its
+ * virtual address in the file as the first one does, which is what
+ * linkers emit for images that are not page-padded. Then the buffer
+ * already holds the memory image, apart from the zero-fill past each
+ * segment's file size. The buffer must be long enough to hold the last
+ * segment's memsz, aligned for the segments and executable.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer
+ * @param size - Buffer size in bytes, may exceed the file size
+ *
+ * @return ESP_OK if placed, -EAGAIN if the image has to be copied.
+ */
+static int esp_elf_place_inplace(esp_elf_t *elf, uint8_t *pbuf, size_t size)
+{
+    bool first_segment = false;
+    int32_t delta = 0;
+    uint32_t align = 4;
+    Elf32_Addr vaddr_s = 0;
+    Elf32_Addr vaddr_e = 0;
+
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    if (size < sizeof(elf32_hdr_t) ||
+            ehdr->phoff > size || ehdr->phnum * sizeof(elf32_phdr_t) > size - ehdr->phoff) {
+        return -EAGAIN;
+    }
+
+#if CONFIG_LAUNCHPAD_FIXED_WINDOW
+    if (esp_elf_find_fixed_note(pbuf)) {
+        return -EAGAIN;
+    }
+#endif
+
+#if CONFIG_LAUNCHPAD_SHARED_TEXT
+    /* Another instance may already hold the read-only pages */
+    if (esp_elf_share_candidate(pbuf)) {
+        return -EAGAIN;
+    }
+#endif
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type != PT_LOAD) {
+            continue;
+        }
+
+        if (phdr[i].memsz < phdr[i].filesz ||
+                phdr[i].vaddr + phdr[i].memsz < phdr[i].vaddr) {
+            return -EAGAIN;
+        }
+
+        if (!first_segment) {
+            delta = (int32_t)(phdr[i].offset - phdr[i].vaddr);
+            vaddr_s = phdr[i].vaddr;
+            first_segment = true;
+        } else if ((int32_t)(phdr[i].offset - phdr[i].vaddr) != delta ||
+                   phdr[i].vaddr < vaddr_e) {
+            ESP_LOGD(TAG, "segment[%d] is not laid out in place", i);
+            return -EAGAIN;
+        }
+
+        vaddr_e = phdr[i].vaddr + phdr[i].memsz;
+        align = MAX(align, MIN(phdr[i].align, INPLACE_ALIGN_MAX));
+    }
+
+    if (!first_segment || vaddr_e == vaddr_s) {
+        return -EAGAIN;
+    }
+
+    uint32_t start = vaddr_s + delta;
+    uint8_t *image = pbuf + start;
+
+    if (start > size || vaddr_e - vaddr_s > size - start) {
+        ESP_LOGD(TAG, "buffer too short for in-place image, need %d",
+                 (int)(start + vaddr_e - vaddr_s));
+        return -EAGAIN;
+    }
+
+    if (((uintptr_t)image - vaddr_s) & (align - 1)) {
+        ESP_LOGD(TAG, "buffer misaligned for in-place image, align %d", (int)align);
+        return -EAGAIN;
+    }
+
+    if (!esp_ptr_executable(image) || !esp_ptr_executable(image + (vaddr_e - vaddr_s) - 1)) {
+        ESP_LOGD(TAG, "buffer %p is not executable", image);
+        return -EAGAIN;
+    }
+
+    elf->svaddr   = vaddr_s;
+    elf->ssize    = vaddr_e - vaddr_s;
+    elf->psegment = image;
+    elf->pimage   = pbuf;
+    elf->entry    = (void *)(image + ehdr->entry - vaddr_s);
+
+    return 0;
+}
+
+/**
+ * @brief Zero everything between the file contents of in-place segments.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return None
+ */
+static void esp_elf_zero_inplace(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    Elf32_Addr fill_s = 0;
+
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type != PT_LOAD) {
+            continue;
+        }
+
+        Elf32_Addr fill_e = phdr[i].vaddr + phdr[i].memsz;
+
+        if (fill_s && phdr[i].vaddr > fill_s) {
+            memset(elf->psegment + fill_s - elf->svaddr, 0, phdr[i].vaddr - fill_s);
+        }
+        memset(elf->psegment + phdr[i].vaddr + phdr[i].filesz - elf->svaddr, 0,
+               phdr[i].memsz - phdr[i].filesz);
+
+        fill_s = fill_e;
+    }
+}
 #endif
 
 /**
@@ -326,6 +618,104 @@ uintptr_t esp_elf_map_sym(esp_elf_t *elf, uintptr_t sym)
     return 0;
 }
 
+/**
+ * @brief Apply packed relative relocations (SHT_RELR / DT_RELR).
+ *
+ * An even entry is the link-time address of a word to rebase; an odd
+ * entry is a bitmap whose bits 1..31 select the following 31 words.
+ * Every selected word holds a link-time address and is moved by the
+ * load bias, so no symbol lookup or per-type dispatch is needed.
+ *
+ * @param elf  - ELF object pointer
+ * @param relr - RELR entries
+ * @param num  - Number of entries
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_relocate_relr(esp_elf_t *elf, const elf32_relr_t *relr, uint32_t num)
+{
+    uint32_t *where = NULL;
+
+#if !CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    const uintptr_t bias = (uintptr_t)elf->psegment - elf->svaddr;
+#define RELR_APPLY(_p)  (*(_p) += bias)
+#elif defined(CONFIG_ELF_LOADER_CACHE_OFFSET)
+#define RELR_APPLY(_p)  (*(_p) = elf_remap_text(elf, esp_elf_map_sym(elf, *(_p))))
+#else
+#define RELR_APPLY(_p)  (*(_p) = esp_elf_map_sym(elf, *(_p)))
+#endif
+
+    for (uint32_t i = 0; i < num; i++) {
+        elf32_relr_t entry = relr[i];
+
+        if (!(entry & 1)) {
+#if !CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+            where = (uint32_t *)(entry + bias);
+#else
+            where = (uint32_t *)esp_elf_map_sym(elf, entry);
+            if (!where) {
+                ESP_LOGE(TAG, "RELR address 0x%x is out of image", (int)entry);
+                return -EINVAL;
+            }
+#endif
+            RELR_APPLY(where);
+            where++;
+        } else {
+            if (!where) {
+                ESP_LOGE(TAG, "RELR bitmap without base address");
+                return -EINVAL;
+            }
+
+            for (uint32_t *p = where; (entry >>= 1) != 0; p++) {
+                if (entry & 1) {
+                    RELR_APPLY(p);
+                }
+            }
+            where += 8 * sizeof(elf32_relr_t) - 1;
+        }
+    }
+
+#undef RELR_APPLY
+
+    return 0;
+}
+
+/**
+ * @brief Release the memory holding loaded ELF segments or sections.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return None
+ */
+static void esp_elf_unload(esp_elf_t *elf)
+{
+#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    esp_elf_free(elf->pdata);
+    esp_elf_free(elf->ptext);
+    elf->pdata = NULL;
+    elf->ptext = NULL;
+#else
+#if CONFIG_LAUNCHPAD_FIXED_WINDOW
+    if (elf->flags & ESP_ELF_F_FIXED) {
+        __atomic_store_n(&s_fixed_window_busy, false, __ATOMIC_RELEASE);
+        elf->flags &= ~ESP_ELF_F_FIXED;
+    } else
+#endif
+#if CONFIG_LAUNCHPAD_SHARED_TEXT
+    if (elf->flags & ESP_ELF_F_SHARED) {
+        esp_elf_share_release(elf);
+    } else
+#endif
+    if (elf->pimage) {
+        esp_elf_free(elf->pimage);
+        elf->pimage = NULL;
+    } else {
+        esp_elf_free(elf->psegment);
+    }
+    elf->psegment = NULL;
+#endif
+}
+
 /**
  * @brief Initialize ELF object.
  *
@@ -344,9 +734,522 @@ int esp_elf_init(esp_elf_t *elf)
     return 0;
 }
 
+/** @brief A share of one Elf32_Rela array, applied by one core */
+
+typedef struct esp_elf_rela_job {
+    esp_elf_t           *elf;           /*!< ELF object pointer */
+    const elf32_rela_t  *rela;          /*!< relocation entries */
+    uint32_t            nr_reloc;       /*!< number of relocation entries */
+    const elf32_sym_t   *symtab;        /*!< symbol table the entries refer to */
+    const char          *strtab;        /*!< string table of @symtab */
+    const uintptr_t     *addrs;         /*!< pre-resolved addresses, by symbol index */
+    Elf32_Addr          lo;             /*!< first target address of this share */
+    Elf32_Addr          hi;             /*!< last target address of this share */
+    int                 ret;            /*!< result */
+#if CONFIG_LAUNCHPAD_PARALLEL_RELOC
+    SemaphoreHandle_t   done;           /*!< given when a helper task finishes */
+#endif
+} esp_elf_rela_job_t;
+
+/**
+ * @brief Tell whether a relocation resolves its symbol by name.
+ */
+static inline bool esp_elf_rela_by_name(int type, const elf32_sym_t *sym, const char *strtab)
+{
+    if (type == STT_COMMON || type == STT_OBJECT || type == STT_SECTION) {
+        return strtab[sym->name] != 0;
+    }
+
+    return type == STT_FILE && !sym->value;
+}
+
+/**
+ * @brief Apply the relocations of a job whose targets lie in [lo, hi].
+ *
+ * @param job - Job description
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_rela_apply(esp_elf_rela_job_t *job)
+{
+    for (uint32_t i = 0; i < job->nr_reloc; i++) {
+        uintptr_t addr = 0;
+        elf32_rela_t rela_buf;
+
+        memcpy(&rela_buf, &job->rela[i], sizeof(elf32_rela_t));
+
+        if (rela_buf.offset < job->lo || rela_buf.offset > job->hi) {
+            continue;
+        }
+
+        uint32_t index = ELF_R_SYM(rela_buf.info);
+        const elf32_sym_t *sym = &job->symtab[index];
+        int type = ELF_R_TYPE(rela_buf.info);
+
+        if (type == STT_FILE && sym->value) {
+            addr = esp_elf_map_sym(job->elf, sym->value);
+        } else if (esp_elf_rela_by_name(type, sym, job->strtab)) {
+            addr = job->addrs[index];
+        }
+
+        int ret = esp_elf_arch_relocate(job->elf, &rela_buf, sym, addr);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+#if CONFIG_LAUNCHPAD_PARALLEL_RELOC
+static void esp_elf_rela_task(void *arg)
+{
+    esp_elf_rela_job_t *job = arg;
+
+    job->ret = esp_elf_rela_apply(job);
+    xSemaphoreGive(job->done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Split a job in two and apply the halves on both cores.
+ *
+ * If the first and second half of the entries write disjoint words, as
+ * in a table sorted by offset, each core takes one half. Otherwise the
+ * target range is cut in the middle and each core applies the entries
+ * on its side. Either way no word is written by both cores, so the
+ * result matches the serial order.
+ *
+ * @param job - Job covering all targets
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_rela_apply_parallel(esp_elf_rela_job_t *job)
+{
+    StaticSemaphore_t done_buf;
+    esp_elf_rela_job_t helper = *job;
+    uint32_t half = job->nr_reloc / 2;
+    Elf32_Addr lo[2] = { UINT32_MAX, UINT32_MAX };
+    Elf32_Addr hi[2] = { 0, 0 };
+
+    if (!half) {
+        return esp_elf_rela_apply(job);
+    }
+
+    for (uint32_t i = 0; i < job->nr_reloc; i++) {
+        Elf32_Addr offset = job->rela[i].offset;
+        int h = i >= half;
+
+        lo[h] = MIN(lo[h], offset);
+        hi[h] = MAX(hi[h], offset);
+    }
+
+    /* An entry writes up to 4 bytes from its offset */
+
+    if (hi[0] + 3 < lo[1] || hi[1] + 3 < lo[0]) {
+        helper.rela      = job->rela + half;
+        helper.nr_reloc -= half;
+        job->nr_reloc    = half;
+    } else {
+        Elf32_Addr min = MIN(lo[0], lo[1]);
+        Elf32_Addr max = MAX(hi[0], hi[1]);
+        Elf32_Addr pivot = (min + (max - min) / 2) & ~3u;
+
+        if (pivot <= MAX(min, job->lo)) {
+            return esp_elf_rela_apply(job);
+        }
+
+        helper.lo = pivot;
+        job->hi   = pivot - 1;
+    }
+
+    helper.done = xSemaphoreCreateBinaryStatic(&done_buf);
+
+    if (xTaskCreatePinnedToCore(esp_elf_rela_task, "elf_reloc", 3072, &helper,
+                                uxTaskPriorityGet(NULL), NULL, !xPortGetCoreID()) != pdPASS) {
+        ESP_LOGW(TAG, "No helper task, relocating on one core");
+        job->ret = esp_elf_rela_apply(job);
+        return job->ret ? job->ret : esp_elf_rela_apply(&helper);
+    }
+
+    job->ret = esp_elf_rela_apply(job);
+
+    /* Join before anyone flushes the cache or runs the image */
+
+    xSemaphoreTake(helper.done, portMAX_DELAY);
+    vSemaphoreDelete(helper.done);
+
+    return job->ret ? job->ret : helper.ret;
+}
+#endif
+
+/**
+ * @brief Apply an array of Elf32_Rela relocations.
+ *
+ * Symbols are resolved once each into a table shared by all entries;
+ * large arrays are then applied on both cores.
+ *
+ * @param elf      - ELF object pointer
+ * @param rela     - Relocation entries
+ * @param nr_reloc - Number of relocation entries
+ * @param symtab   - Symbol table the entries refer to
+ * @param nr_sym   - Number of symbols in @symtab, 0 if unknown
+ * @param strtab   - String table of @symtab
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_relocate_rela(esp_elf_t *elf, const elf32_rela_t *rela, uint32_t nr_reloc,
+                                 const elf32_sym_t *symtab, uint32_t nr_sym, const char *strtab)
+{
+    int ret = 0;
+    uint32_t nr_addr = nr_sym;
+
+    if (!nr_reloc) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < nr_reloc; i++) {
+        uint32_t index = ELF_R_SYM(rela[i].info);
+
+        if (nr_sym && index >= nr_sym) {
+            ESP_LOGE(TAG, "Relocation %d refers to symbol %d of %d",
+                     (int)i, (int)index, (int)nr_sym);
+            return -EINVAL;
+        }
+
+        nr_addr = MAX(nr_addr, index + 1);
+    }
+
+    uintptr_t *addrs = calloc(nr_addr, sizeof(uintptr_t));
+    if (!addrs) {
+        return -ENOMEM;
+    }
+
+    /* Resolve every named symbol once */
+
+    for (uint32_t i = 0; i < nr_reloc; i++) {
+        uint32_t index = ELF_R_SYM(rela[i].info);
+        const elf32_sym_t *sym = &symtab[index];
+        const char *name = strtab + sym->name;
+
+        if (addrs[index] || !esp_elf_rela_by_name(ELF_R_TYPE(rela[i].info), sym, strtab)) {
+            continue;
+        }
+
+        addrs[index] = elf_find_sym(name);
+        if (!addrs[index]) {
+            ESP_LOGE(TAG, "Can't find symbol %s", name);
+            ret = -ENOSYS;
+            goto out;
+        }
+
+        ESP_LOGD(TAG, "Find symbol %s addr=%x", name, addrs[index]);
+    }
+
+    esp_elf_rela_job_t job = {
+        .elf      = elf,
+        .rela     = rela,
+        .nr_reloc = nr_reloc,
+        .symtab   = symtab,
+        .strtab   = strtab,
+        .addrs    = addrs,
+        .lo       = 0,
+        .hi       = UINT32_MAX,
+    };
+
+#if CONFIG_LAUNCHPAD_SHARED_TEXT
+    /* Shared pages mapped read-only are already relocated */
+
+    if (elf->flags & ESP_ELF_F_SHARED) {
+        job.lo = esp_elf_share_reloc_start(elf);
+    }
+#endif
+
+#if CONFIG_LAUNCHPAD_PARALLEL_RELOC
+    if (nr_reloc >= CONFIG_LAUNCHPAD_PARALLEL_RELOC_MIN) {
+        ret = esp_elf_rela_apply_parallel(&job);
+    } else
+#endif
+    {
+        ret = esp_elf_rela_apply(&job);
+    }
+
+out:
+    free(addrs);
+    return ret;
+}
+
+/**
+ * @brief Relocate ELF using its section header table.
+ *
+ * @param elf - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_relocate_sections(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    int ret;
+
+    const elf32_hdr_t *ehdr  = (const elf32_hdr_t *)pbuf;
+    const elf32_shdr_t *shdr = (const elf32_shdr_t *)(pbuf + ehdr->shoff);
+    const char *shstrab      = (const char *)pbuf + shdr[ehdr->shstrndx].offset;
+
+    for (uint32_t i = 0; i < ehdr->shnum; i++) {
+        if (stype(&shdr[i], SHT_RELR)) {
+            ESP_LOGD(TAG, "Section %s has %d packed relative entries",
+                     shstrab + shdr[i].name, (int)(shdr[i].size / sizeof(elf32_relr_t)));
+
+            ret = esp_elf_relocate_relr(elf, (const elf32_relr_t *)(pbuf + shdr[i].offset),
+                                        shdr[i].size / sizeof(elf32_relr_t));
+            if (ret) {
+                return ret;
+            }
+        } else if (stype(&shdr[i], SHT_RELA)) {
+            const elf32_shdr_t *symsec = &shdr[shdr[i].link];
+            uint32_t nr_reloc = shdr[i].size / sizeof(elf32_rela_t);
+
+            ESP_LOGD(TAG, "Section %s has %d symbol tables", shstrab + shdr[i].name, (int)nr_reloc);
+
+            ret = esp_elf_relocate_rela(elf,
+                                        (const elf32_rela_t *)(pbuf + shdr[i].offset),
+                                        nr_reloc,
+                                        (const elf32_sym_t *)(pbuf + symsec->offset),
+                                        symsec->size / sizeof(elf32_sym_t),
+                                        (const char *)(pbuf + shdr[symsec->link].offset));
+            if (ret) {
+                return ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+#if !CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+
+/**
+ * @brief Translate a link-time address to its bytes in the ELF file.
+ *
+ * @param pbuf  - ELF data buffer
+ * @param vaddr - Virtual address
+ * @param size  - Number of bytes that must be backed by the file
+ *
+ * @return Pointer into @pbuf or NULL if no PT_LOAD covers the range.
+ */
+static const void *esp_elf_vaddr_to_file(const uint8_t *pbuf, Elf32_Addr vaddr, uint32_t size)
+{
+    const elf32_hdr_t *ehdr  = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type == PT_LOAD &&
+                vaddr >= phdr[i].vaddr &&
+                size <= phdr[i].filesz &&
+                vaddr - phdr[i].vaddr <= phdr[i].filesz - size) {
+            return pbuf + phdr[i].offset + (vaddr - phdr[i].vaddr);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Number of dynamic symbols, derived from DT_GNU_HASH.
+ *
+ * The symbol count is not stored anywhere without section headers; it is
+ * one past the last symbol reachable from the highest hash bucket.
+ *
+ * @return Symbol count or 0 if the table is malformed.
+ */
+static uint32_t esp_elf_gnu_hash_nsyms(const uint8_t *pbuf, Elf32_Addr vaddr)
+{
+    const uint32_t *hdr = esp_elf_vaddr_to_file(pbuf, vaddr, 4 * sizeof(uint32_t));
+    if (!hdr) {
+        return 0;
+    }
+
+    uint32_t nbuckets  = hdr[0];
+    uint32_t symoffset = hdr[1];
+    uint32_t nbloom    = hdr[2];
+    Elf32_Addr buckets_vaddr = vaddr + (4 + nbloom) * sizeof(uint32_t);
+    Elf32_Addr chain_vaddr   = buckets_vaddr + nbuckets * sizeof(uint32_t);
+
+    const uint32_t *buckets = esp_elf_vaddr_to_file(pbuf, buckets_vaddr, nbuckets * sizeof(uint32_t));
+    if (!buckets) {
+        return 0;
+    }
+
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < nbuckets; i++) {
+        last = MAX(last, buckets[i]);
+    }
+    if (last < symoffset) {
+        return symoffset;
+    }
+
+    /* Walk the last chain to its terminator (low bit set) */
+    for (;;) {
+        const uint32_t *chain = esp_elf_vaddr_to_file(pbuf, chain_vaddr + (last - symoffset) * sizeof(uint32_t),
+                                                      sizeof(uint32_t));
+        if (!chain) {
+            return 0;
+        }
+        if (*chain & 1) {
+            return last + 1;
+        }
+        last++;
+    }
+}
+
+/**
+ * @brief Relocate ELF using only its PT_DYNAMIC segment.
+ *
+ * Used for images stripped of their section header table. Relocations,
+ * symbols and strings are located through DT_* tags, and all link-time
+ * addresses are translated to file offsets through the PT_LOAD headers.
+ *
+ * @param elf - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+static int esp_elf_relocate_dynamic(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    int ret;
+    const elf32_dyn_t *dyn = NULL;
+    uint32_t nr_dyn = 0;
+
+    const elf32_hdr_t *ehdr  = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type == PT_DYNAMIC) {
+            dyn    = (const elf32_dyn_t *)(pbuf + phdr[i].offset);
+            nr_dyn = phdr[i].filesz / sizeof(elf32_dyn_t);
+            break;
+        }
+    }
+
+    if (!dyn) {
+        ESP_LOGE(TAG, "No section headers and no PT_DYNAMIC");
+        return -EINVAL;
+    }
+
+    Elf32_Addr rela_va = 0, jmprel_va = 0, relr_va = 0;
+    Elf32_Addr symtab_va = 0, strtab_va = 0, hash_va = 0, gnu_hash_va = 0;
+    uint32_t rela_sz = 0, jmprel_sz = 0, relr_sz = 0, strtab_sz = 0;
+    uint32_t pltrel = DT_RELA;
+
+    for (uint32_t i = 0; i < nr_dyn && dyn[i].tag != DT_NULL; i++) {
+        switch (dyn[i].tag) {
+        case DT_RELA:     rela_va     = dyn[i].val; break;
+        case DT_RELASZ:   rela_sz     = dyn[i].val; break;
+        case DT_JMPREL:   jmprel_va   = dyn[i].val; break;
+        case DT_PLTRELSZ: jmprel_sz   = dyn[i].val; break;
+        case DT_PLTREL:   pltrel      = dyn[i].val; break;
+        case DT_RELR:     relr_va     = dyn[i].val; break;
+        case DT_RELRSZ:   relr_sz     = dyn[i].val; break;
+        case DT_SYMTAB:   symtab_va   = dyn[i].val; break;
+        case DT_STRTAB:   strtab_va   = dyn[i].val; break;
+        case DT_STRSZ:    strtab_sz   = dyn[i].val; break;
+        case DT_HASH:     hash_va     = dyn[i].val; break;
+        case DT_GNU_HASH: gnu_hash_va = dyn[i].val; break;
+        case DT_RELAENT:
+            if (dyn[i].val != sizeof(elf32_rela_t)) {
+                return -EINVAL;
+            }
+            break;
+        case DT_SYMENT:
+            if (dyn[i].val != sizeof(elf32_sym_t)) {
+                return -EINVAL;
+            }
+            break;
+        case DT_RELRENT:
+            if (dyn[i].val != sizeof(elf32_relr_t)) {
+                return -EINVAL;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (jmprel_sz && pltrel != DT_RELA) {
+        ESP_LOGE(TAG, "DT_PLTREL %d is not supported", (int)pltrel);
+        return -EINVAL;
+    }
+
+    /* Symbol count bounds every relocation's symbol index */
+
+    uint32_t nr_sym = 0;
+    if (gnu_hash_va) {
+        nr_sym = esp_elf_gnu_hash_nsyms(pbuf, gnu_hash_va);
+    } else if (hash_va) {
+        const uint32_t *hash = esp_elf_vaddr_to_file(pbuf, hash_va, 2 * sizeof(uint32_t));
+        nr_sym = hash ? hash[1] : 0;
+    }
+
+    const elf32_sym_t *symtab = NULL;
+    const char *strtab = NULL;
+    if (rela_sz || jmprel_sz) {
+        /* Without a hash table the count is unknown and indexes go unchecked */
+        symtab = esp_elf_vaddr_to_file(pbuf, symtab_va, MAX(nr_sym, 1) * sizeof(elf32_sym_t));
+        strtab = esp_elf_vaddr_to_file(pbuf, strtab_va, strtab_sz);
+        if (!symtab || !strtab) {
+            ESP_LOGE(TAG, "Invalid dynamic symbol table");
+            return -EINVAL;
+        }
+    }
+
+    if (relr_sz) {
+        const elf32_relr_t *relr = esp_elf_vaddr_to_file(pbuf, relr_va, relr_sz);
+        if (!relr) {
+            return -EINVAL;
+        }
+
+        ret = esp_elf_relocate_relr(elf, relr, relr_sz / sizeof(elf32_relr_t));
+        if (ret) {
+            return ret;
+        }
+    }
+
+    if (rela_sz) {
+        const elf32_rela_t *rela = esp_elf_vaddr_to_file(pbuf, rela_va, rela_sz);
+        if (!rela) {
+            return -EINVAL;
+        }
+
+        ret = esp_elf_relocate_rela(elf, rela, rela_sz / sizeof(elf32_rela_t), symtab, nr_sym, strtab);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    if (jmprel_sz) {
+        const elf32_rela_t *rela = esp_elf_vaddr_to_file(pbuf, jmprel_va, jmprel_sz);
+        if (!rela) {
+            return -EINVAL;
+        }
+
+        ret = esp_elf_relocate_rela(elf, rela, jmprel_sz / sizeof(elf32_rela_t), symtab, nr_sym, strtab);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+#endif /* !CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR */
+
 /**
  * @brief Decode and relocate ELF data.
  *
+ * Images with a section header table are relocated section by section;
+ * images stripped of it (e_shoff/e_shnum zero) are relocated from their
+ * PT_DYNAMIC segment alone.
+ *
  * @param elf - ELF object pointer
  * @param pbuf - ELF data buffer
  *
@@ -355,25 +1258,42 @@ int esp_elf_init(esp_elf_t *elf)
 int esp_elf_relocate(esp_elf_t *elf, const uint8_t *pbuf)
 {
     int ret;
+    bool stripped;
+    bool prelinked = false;
 
     const elf32_hdr_t *ehdr;
-    const elf32_shdr_t *shdr;
-    const char *shstrab;
 
     if (!elf || !pbuf) {
         return -EINVAL;
     }
 
-    ehdr    = (const elf32_hdr_t *)pbuf;
-    shdr    = (const elf32_shdr_t *)(pbuf + ehdr->shoff);
-    shstrab = (const char *)pbuf + shdr[ehdr->shstrndx].offset;
+    ehdr     = (const elf32_hdr_t *)pbuf;
+    stripped = !ehdr->shoff || !ehdr->shnum;
+
+#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    if (stripped) {
+        ESP_LOGE(TAG, "Section loading needs section headers");
+        return -EINVAL;
+    }
+#endif
 
     /* Load section or segment to memory space */
 
 #if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
     ret = esp_elf_load_section(elf, pbuf);
 #else
-    ret = esp_elf_load_segment(elf, pbuf);
+    ret = -EAGAIN;
+#if CONFIG_LAUNCHPAD_FIXED_WINDOW
+    ret = esp_elf_load_fixed(elf, pbuf, &prelinked);
+#endif
+#if CONFIG_LAUNCHPAD_SHARED_TEXT
+    if (ret == -EAGAIN) {
+        ret = esp_elf_share_load(elf, pbuf);
+    }
+#endif
+    if (ret == -EAGAIN) {
+        ret = esp_elf_load_segment(elf, pbuf);
+    }
 #endif
 
     if (ret) {
@@ -383,84 +1303,117 @@ int esp_elf_relocate(esp_elf_t *elf, const uint8_t *pbuf)
 
     ESP_LOGI(TAG, "elf->entry=%p\n", elf->entry);
 
-    /* Relocation section data */
+    ret = esp_elf_tls_init(elf, pbuf);
+    if (ret) {
+        esp_elf_unload(elf);
+        return ret;
+    }
 
-    for (uint32_t i = 0; i < ehdr->shnum; i++) {
-        if (stype(&shdr[i], SHT_RELA)) {
-            uint32_t nr_reloc;
-            const elf32_rela_t *rela;
-            const elf32_sym_t *symtab;
-            const char *strtab;
+    /*
+     * Prelinked into the fixed window, nothing left to patch. TLS module
+     * IDs are only known now, relocating at zero bias is idempotent.
+     */
 
-            nr_reloc = shdr[i].size / sizeof(elf32_rela_t);
-            rela     = (const elf32_rela_t *)(pbuf + shdr[i].offset);
-            symtab   = (const elf32_sym_t *)(pbuf + shdr[shdr[i].link].offset);
-            strtab   = (const char *)(pbuf + shdr[shdr[shdr[i].link].link].offset);
+    if (prelinked && !elf->tls.gen) {
+        return 0;
+    }
 
-            ESP_LOGD(TAG, "Section %s has %d symbol tables", shstrab + shdr[i].name, (int)nr_reloc);
+    /* Relocation section data */
 
-            for (int i = 0; i < nr_reloc; i++) {
-                int type;
-                uintptr_t addr = 0;
-                elf32_rela_t rela_buf;
+#if !CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    if (stripped) {
+        ret = esp_elf_relocate_dynamic(elf, pbuf);
+    } else
+#endif
+    {
+        ret = esp_elf_relocate_sections(elf, pbuf);
+    }
 
-                memcpy(&rela_buf, &rela[i], sizeof(elf32_rela_t));
+    if (ret) {
+        esp_elf_unload(elf);
+        return ret;
+    }
 
-                const elf32_sym_t *sym = &symtab[ELF_R_SYM(rela_buf.info)];
+#if CONFIG_LAUNCHPAD_SHARED_TEXT
+    if (elf->flags & ESP_ELF_F_SHARED) {
+        esp_elf_share_commit(elf, pbuf);
+    }
+#endif
 
-                type = ELF_R_TYPE(rela_buf.info);
-                if (type == STT_COMMON || type == STT_OBJECT || type == STT_SECTION) {
-                    const char *comm_name = strtab + sym->name;
+#ifdef CONFIG_ELF_LOADER_LOAD_PSRAM
+    esp_elf_arch_flush();
+#endif
 
-                    if (comm_name[0]) {
-                        addr = elf_find_sym(comm_name);
+    return 0;
+}
 
-                        if (!addr) {
-                            ESP_LOGE(TAG, "Can't find common %s", strtab + sym->name);
-#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
-                            esp_elf_free(elf->pdata);
-                            esp_elf_free(elf->ptext);
-#else
-                            esp_elf_free(elf->psegment);
-#endif
-                            return -ENOSYS;
-                        }
-
-                        ESP_LOGD(TAG, "Find common %s addr=%x", comm_name, addr);
-                    }
-                } else if (type == STT_FILE) {
-                    const char *func_name = strtab + sym->name;
-
-                    if (sym->value) {
-                        addr = esp_elf_map_sym(elf, sym->value);
-                    } else {
-                        addr = elf_find_sym(func_name);
-                    }
-
-                    if (!addr) {
-                        ESP_LOGE(TAG, "Can't find symbol %s", func_name);
-#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
-                        esp_elf_free(elf->pdata);
-                        esp_elf_free(elf->ptext);
-#else
-                        esp_elf_free(elf->psegment);
+/**
+ * @brief Decode and relocate ELF data, taking ownership of the buffer.
+ *
+ * When the segment layout, alignment and memory capabilities of @pbuf
+ * allow it, the segments are relocated where they already are and the
+ * buffer becomes the image, freed by esp_elf_deinit(). Otherwise this
+ * falls back to esp_elf_relocate() and frees @pbuf before returning.
+ * Either way the caller must not touch @pbuf afterwards.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer from esp_elf_malloc() or heap_caps_malloc()
+ * @param size - Buffer size in bytes, room past the file end is used for .bss
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_relocate_inplace(esp_elf_t *elf, uint8_t *pbuf, size_t size)
+{
+    int ret = -EAGAIN;
+
+    if (!elf || !pbuf) {
+        esp_elf_free(pbuf);
+        return -EINVAL;
+    }
+
+#if !CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    ret = esp_elf_place_inplace(elf, pbuf, size);
 #endif
-                        return -ENOSYS;
-                    }
 
-                    ESP_LOGD(TAG, "Find function %s addr=%x", func_name, addr);
-                }
+    if (ret == -EAGAIN) {
+        ret = esp_elf_relocate(elf, pbuf);
+        esp_elf_free(pbuf);
+        return ret;
+    }
 
-                esp_elf_arch_relocate(elf, &rela_buf, sym, addr);
-            }
+#if !CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+
+    ESP_LOGI(TAG, "elf->entry=%p (in place)\n", elf->entry);
+
+    ret = esp_elf_tls_init(elf, pbuf);
+    if (!ret) {
+        if (!ehdr->shoff || !ehdr->shnum) {
+            ret = esp_elf_relocate_dynamic(elf, pbuf);
+        } else {
+            ret = esp_elf_relocate_sections(elf, pbuf);
         }
     }
 
+    if (ret) {
+        esp_elf_unload(elf);
+        return ret;
+    }
+
+    /* File bytes under .bss may still be read by the relocation pass, clear it last */
+
+    esp_elf_zero_inplace(elf, pbuf);
+
+#if SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE
+    cache_ll_writeback_all(CACHE_LL_LEVEL_INT_MEM, CACHE_TYPE_DATA, CACHE_LL_ID_ALL);
+#endif
+
 #ifdef CONFIG_ELF_LOADER_LOAD_PSRAM
     esp_elf_arch_flush();
+#endif
 #endif
 
-    return 0;
+    return ret;
 }
 
 /**
@@ -475,10 +1428,17 @@ int esp_elf_relocate(esp_elf_t *elf, const uint8_t *pbuf)
  */
 int esp_elf_request(esp_elf_t *elf, int opt, int argc, char *argv[])
 {
+    int ret;
+
     if (!elf || !(elf->entry)) {
         return -EINVAL;
     }
 
+    ret = esp_elf_tls_prepare(elf);
+    if (ret) {
+        return ret;
+    }
+
     elf->entry(argc, argv);
 
     return 0;
@@ -493,22 +1453,8 @@ int esp_elf_request(esp_elf_t *elf, int opt, int argc, char *argv[])
  */
 void esp_elf_deinit(esp_elf_t *elf)
 {
-#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
-    if (elf->pdata) {
-        esp_elf_free(elf->pdata);
-        elf->pdata = NULL;
-    }
-
-    if (elf->ptext) {
-        esp_elf_free(elf->ptext);
-        elf->ptext = NULL;
-    }
-#else
-    if (elf->psegment) {
-        esp_elf_free(elf->ptext);
-        elf->ptext = NULL;
-    }
-#endif
+    esp_elf_tls_deinit(elf);
+    esp_elf_unload(elf);
 
 #ifdef CONFIG_ELF_LOADER_SET_MMU
     esp_elf_arch_deinit_mmu(elf);
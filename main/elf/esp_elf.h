@@ -34,6 +34,11 @@ int esp_elf_init(esp_elf_t *elf);
 /**
  * @brief Decode and relocate ELF data.
  *
+ * Thread-local variables are reached through __tls_get_addr() only: the
+ * ELF must be built with -ftls-model=global-dynamic (or local-dynamic)
+ * and linked with -shared, so no TPREL relocations remain. Images using
+ * the static TLS models are rejected with -ENOTSUP.
+ *
  * @param elf - ELF object pointer
  * @param pbuf - ELF data buffer
  *
@@ -41,9 +46,28 @@ int esp_elf_init(esp_elf_t *elf);
  */
 int esp_elf_relocate(esp_elf_t *elf, const uint8_t *pbuf);
 
+/**
+ * @brief Decode and relocate ELF data, taking ownership of the buffer.
+ *
+ * The segments are relocated inside @pbuf when its layout allows it, so
+ * no image-sized copy is made; otherwise the image is copied as by
+ * esp_elf_relocate(). @pbuf belongs to the ELF object afterwards, even
+ * on failure.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer from esp_elf_malloc() or heap_caps_malloc()
+ * @param size - Buffer size in bytes, room past the file end is used for .bss
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_relocate_inplace(esp_elf_t *elf, uint8_t *pbuf, size_t size);
+
 /**
  * @brief Request running relocated ELF function.
  *
+ * The calling task's TLS block is allocated first; without memory for
+ * it the entry is not called and -ENOMEM is returned.
+ *
  * @param elf  - ELF object pointer
  * @param opt  - Request options
  * @param argc - Arguments number
@@ -0,0 +1,454 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/errno.h>
+#include <sys/lock.h>
+#include <sys/param.h>
+
+#include "sdkconfig.h"
+
+#if CONFIG_LAUNCHPAD_SHARED_TEXT
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_mmu_map.h"
+#include "hal/cache_hal.h"
+#include "hal/cache_ll.h"
+
+#include "elf_platform.h"
+
+#define PAGE_SIZE                   CONFIG_MMU_PAGE_SIZE
+#define PAGE_ROUND(_n)              (((_n) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1))
+
+/*
+ * Read-only segments of PIC images are reached PC-relatively, so an
+ * instance only works if its data sits at the link-time distance from
+ * its text. Every instance therefore gets its own virtual window in the
+ * PSRAM address space: the text pages of the window map the shared
+ * physical copy, the data pages map private memory. Both halves are
+ * esp_mmu mappings; the private pages stay allocated from the heap and
+ * are only ever accessed through the window while it exists.
+ */
+
+/** @brief Physical copy of one image's read-only pages */
+
+typedef struct elf_share {
+    struct elf_share    *next;          /*!< next cached image */
+    uint64_t            hash;           /*!< FNV-1a of the ELF file */
+    uint32_t            text_len;       /*!< page-rounded size of the read-only part */
+    uint8_t             *text;          /*!< heap address of the shared pages */
+    esp_paddr_t         paddr;          /*!< physical address of the shared pages */
+    int                 refs;           /*!< instances mapping the pages */
+    enum {
+        SHARE_PENDING,                  /*!< first instance is still relocating */
+        SHARE_OK,                       /*!< relocation left the pages untouched */
+        SHARE_PRIVATE,                  /*!< relocation wrote them, never share */
+    } state;
+} elf_share_t;
+
+/** @brief Segment layout of a shareable image */
+
+typedef struct elf_share_layout {
+    Elf32_Addr          vaddr_s;        /*!< first read-only byte */
+    Elf32_Addr          vaddr_rw;       /*!< first writable byte, page aligned from vaddr_s */
+    Elf32_Addr          vaddr_e;        /*!< end of the image */
+} elf_share_layout_t;
+
+static const char *TAG = "ELF";
+
+static _lock_t s_share_lock;
+static elf_share_t *s_shares;
+
+/**
+ * @brief Split an image into a read-only head and a writable tail.
+ *
+ * @param pbuf   - ELF data buffer
+ * @param layout - Filled with the image layout
+ *
+ * @return true if the image can share its read-only head.
+ */
+static bool esp_elf_share_layout(const uint8_t *pbuf, elf_share_layout_t *layout)
+{
+    bool first_segment = false;
+    bool writable = false;
+
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    memset(layout, 0, sizeof(*layout));
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type != PT_LOAD) {
+            continue;
+        }
+
+        if (!first_segment) {
+            if (phdr[i].flags & PF_W) {
+                return false;
+            }
+            layout->vaddr_s = phdr[i].vaddr;
+            first_segment = true;
+        } else if (phdr[i].vaddr < layout->vaddr_e) {
+            return false;
+        }
+
+        if (phdr[i].flags & PF_W) {
+            if (!writable) {
+                layout->vaddr_rw = phdr[i].vaddr;
+                writable = true;
+            }
+        } else if (writable) {
+            return false;
+        }
+
+        layout->vaddr_e = phdr[i].vaddr + phdr[i].memsz;
+    }
+
+    return writable && !((layout->vaddr_rw - layout->vaddr_s) & (PAGE_SIZE - 1));
+}
+
+/**
+ * @brief Hash every byte of the ELF file the loader looks at.
+ */
+static uint64_t esp_elf_share_hash(const uint8_t *pbuf)
+{
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+    const elf32_shdr_t *shdr = (const elf32_shdr_t *)(pbuf + ehdr->shoff);
+    uint32_t end = ehdr->phoff + ehdr->phnum * sizeof(elf32_phdr_t);
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        end = MAX(end, phdr[i].offset + phdr[i].filesz);
+    }
+
+    if (ehdr->shoff && ehdr->shnum) {
+        end = MAX(end, ehdr->shoff + ehdr->shnum * sizeof(elf32_shdr_t));
+        for (int i = 0; i < ehdr->shnum; i++) {
+            if (shdr[i].type != SHT_NOBITS) {
+                end = MAX(end, shdr[i].offset + shdr[i].size);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < end; i++) {
+        hash = (hash ^ pbuf[i]) * 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Copy the PT_LOAD parts of [start, end) to @dst, zeroing the rest.
+ */
+static void esp_elf_share_copy(uint8_t *dst, const uint8_t *pbuf, Elf32_Addr start, Elf32_Addr end)
+{
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    memset(dst, 0, PAGE_ROUND(end - start));
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type == PT_LOAD && phdr[i].vaddr >= start && phdr[i].vaddr < end) {
+            memcpy(dst + phdr[i].vaddr - start, pbuf + phdr[i].offset, phdr[i].filesz);
+        }
+    }
+}
+
+static uint8_t *esp_elf_share_alloc_pages(uint32_t len, esp_paddr_t *paddr)
+{
+    mmu_target_t target;
+    uint8_t *p = heap_caps_aligned_alloc(PAGE_SIZE, len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+
+    if (p && esp_mmu_vaddr_to_paddr(p, paddr, &target) != ESP_OK) {
+        heap_caps_free(p);
+        p = NULL;
+    }
+
+    return p;
+}
+
+/**
+ * @brief Map @len bytes at @paddr into the PSRAM address space.
+ *
+ * The pages may already be mapped elsewhere (the heap, other instances),
+ * so the mapping is made with ESP_MMU_MMAP_FLAG_PADDR_SHARED.
+ *
+ * @param writable - Whether the window may be written through
+ */
+static uint8_t *esp_elf_share_map(esp_paddr_t paddr, uint32_t len, bool writable)
+{
+    void *vaddr = NULL;
+    mmu_mem_caps_t caps = MMU_MEM_CAP_EXEC | MMU_MEM_CAP_READ |
+                          MMU_MEM_CAP_8BIT | MMU_MEM_CAP_32BIT;
+
+    if (writable) {
+        caps |= MMU_MEM_CAP_WRITE;
+    }
+
+    if (esp_mmu_map(paddr, len, MMU_TARGET_PSRAM0, caps,
+                    ESP_MMU_MMAP_FLAG_PADDR_SHARED, &vaddr) != ESP_OK) {
+        return NULL;
+    }
+
+    return vaddr;
+}
+
+static void esp_elf_share_put(elf_share_t *share)
+{
+    if (--share->refs) {
+        return;
+    }
+
+    for (elf_share_t **pp = &s_shares; *pp; pp = &(*pp)->next) {
+        if (*pp == share) {
+            *pp = share->next;
+            break;
+        }
+    }
+
+    heap_caps_free(share->text);
+    free(share);
+}
+
+/**
+ * @brief Load ELF segments with the read-only part shared between instances.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if loaded, -EAGAIN if the caller should fall back to a
+ *         private copy or other if failed.
+ */
+int esp_elf_share_load(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    elf_share_layout_t layout;
+    elf_share_t *share;
+    esp_paddr_t data_paddr;
+    uint8_t *vaddr;
+    uint8_t *data_vaddr;
+
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+
+    if (!esp_elf_share_layout(pbuf, &layout)) {
+        return -EAGAIN;
+    }
+
+    uint64_t hash = esp_elf_share_hash(pbuf);
+    uint32_t text_len = layout.vaddr_rw - layout.vaddr_s;
+    uint32_t data_len = PAGE_ROUND(layout.vaddr_e - layout.vaddr_rw);
+
+    _lock_acquire(&s_share_lock);
+
+    for (share = s_shares; share; share = share->next) {
+        if (share->hash == hash && share->text_len == text_len) {
+            break;
+        }
+    }
+
+    if (share && share->state != SHARE_OK) {
+        _lock_release(&s_share_lock);
+        return -EAGAIN;
+    }
+
+    if (!share) {
+        share = calloc(1, sizeof(elf_share_t));
+        if (!share) {
+            goto nomem;
+        }
+
+        share->text = esp_elf_share_alloc_pages(text_len, &share->paddr);
+        if (!share->text) {
+            free(share);
+            goto nomem;
+        }
+
+        share->hash     = hash;
+        share->text_len = text_len;
+        share->state    = SHARE_PENDING;
+        share->next     = s_shares;
+        s_shares        = share;
+
+        esp_elf_share_copy(share->text, pbuf, layout.vaddr_s, layout.vaddr_rw);
+        cache_ll_writeback_all(CACHE_LL_LEVEL_EXT_MEM, CACHE_TYPE_DATA, CACHE_LL_ID_ALL);
+    }
+
+    share->refs++;
+
+    elf->pdata = esp_elf_share_alloc_pages(data_len, &data_paddr);
+    if (!elf->pdata) {
+        goto fail;
+    }
+
+    esp_elf_share_copy(elf->pdata, pbuf, layout.vaddr_rw, layout.vaddr_e);
+    cache_ll_writeback_all(CACHE_LL_LEVEL_EXT_MEM, CACHE_TYPE_DATA, CACHE_LL_ID_ALL);
+
+    /*
+     * Two driver mappings, text then data, that have to end up back to
+     * back. The driver places blocks first-fit, so they do unless the
+     * text lands in a gap too small for the data as well; such an image
+     * falls back to a private copy.
+     *
+     * Only the first instance relocates in place and gets a writable
+     * text window; once the pages are known clean, instances map them
+     * read and execute only.
+     */
+
+    vaddr = esp_elf_share_map(share->paddr, text_len, share->state == SHARE_PENDING);
+    if (!vaddr) {
+        ESP_LOGW(TAG, "No virtual window for shared image");
+        goto fail;
+    }
+
+    data_vaddr = esp_elf_share_map(data_paddr, data_len, true);
+    if (data_vaddr != vaddr + text_len) {
+        ESP_LOGW(TAG, "No contiguous virtual window for shared image");
+        if (data_vaddr) {
+            esp_mmu_unmap(data_vaddr);
+        }
+        esp_mmu_unmap(vaddr);
+        goto fail;
+    }
+
+    _lock_release(&s_share_lock);
+
+    elf->svaddr   = layout.vaddr_s;
+    elf->ssize    = text_len + data_len;
+    elf->psegment = vaddr;
+    elf->share    = share;
+    elf->entry    = (void *)((uint8_t *)vaddr + ehdr->entry - layout.vaddr_s);
+    elf->flags   |= ESP_ELF_F_SHARED;
+
+    ESP_LOGI(TAG, "%s read-only pages, %d bytes, %d instance(s)",
+             share->state == SHARE_PENDING ? "new" : "shared",
+             (int)text_len, share->refs);
+
+    return 0;
+
+fail:
+    heap_caps_free(elf->pdata);
+    elf->pdata = NULL;
+    esp_elf_share_put(share);
+    _lock_release(&s_share_lock);
+    return -EAGAIN;
+
+nomem:
+    _lock_release(&s_share_lock);
+    return -EAGAIN;
+}
+
+/**
+ * @brief Decide whether freshly relocated read-only pages may be shared.
+ *
+ * The first instance relocates into the shared pages themselves. If that
+ * left them byte-identical to the file, no relocation targets read-only
+ * memory and later instances can map them as they are.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return None
+ */
+void esp_elf_share_commit(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    elf_share_t *share = elf->share;
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    if (!share || share->state != SHARE_PENDING) {
+        return;
+    }
+
+    bool clean = true;
+
+    for (int i = 0; i < ehdr->phnum && clean; i++) {
+        if (phdr[i].type == PT_LOAD && !(phdr[i].flags & PF_W)) {
+            clean = !memcmp(elf->psegment + phdr[i].vaddr - elf->svaddr,
+                            pbuf + phdr[i].offset, phdr[i].filesz);
+        }
+    }
+
+    _lock_acquire(&s_share_lock);
+    share->state = clean ? SHARE_OK : SHARE_PRIVATE;
+    _lock_release(&s_share_lock);
+
+    if (!clean) {
+        ESP_LOGW(TAG, "Image relocates its read-only segment, not shared");
+    }
+}
+
+/**
+ * @brief First address relocation may write to.
+ *
+ * Instances after the first map the shared pages read-only. Relocation
+ * of the first one left them untouched, so entries that target them
+ * would only store what is already there and are skipped.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return End of the shared pages if they are read-only, else elf->svaddr.
+ */
+Elf32_Addr esp_elf_share_reloc_start(const esp_elf_t *elf)
+{
+    const elf_share_t *share = elf->share;
+
+    if (!share || share->state != SHARE_OK) {
+        return elf->svaddr;
+    }
+
+    return elf->svaddr + share->text_len;
+}
+
+/**
+ * @brief Unmap an instance and drop its reference to the shared pages.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return None
+ */
+void esp_elf_share_release(esp_elf_t *elf)
+{
+    elf_share_t *share = elf->share;
+    uint32_t data_len = elf->ssize - share->text_len;
+    uint8_t *data_vaddr = elf->psegment + share->text_len;
+
+    /*
+     * The data pages are also mapped at elf->pdata by the heap. Drop the
+     * window's lines, dirty ones included, so nothing is written back
+     * through it once the heap hands the pages out again, and drop the
+     * heap's stale view of them too.
+     */
+
+    cache_hal_invalidate_addr((uint32_t)elf->psegment, elf->ssize);
+    esp_mmu_unmap(data_vaddr);
+    esp_mmu_unmap(elf->psegment);
+    cache_hal_invalidate_addr((uint32_t)elf->pdata, data_len);
+    heap_caps_free(elf->pdata);
+
+    _lock_acquire(&s_share_lock);
+    esp_elf_share_put(share);
+    _lock_release(&s_share_lock);
+
+    elf->pdata  = NULL;
+    elf->share  = NULL;
+    elf->flags &= ~ESP_ELF_F_SHARED;
+}
+
+/**
+ * @brief Tell whether an image would be loaded with shared read-only pages.
+ *
+ * @param pbuf - ELF data buffer
+ *
+ * @return true if esp_elf_share_load() may take it.
+ */
+bool esp_elf_share_candidate(const uint8_t *pbuf)
+{
+    elf_share_layout_t layout;
+
+    return esp_elf_share_layout(pbuf, &layout);
+}
+
+#endif /* CONFIG_LAUNCHPAD_SHARED_TEXT */
@@ -17,6 +17,7 @@
 #include <arpa/inet.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <sys/lock.h>
 
 #include "rom/ets_sys.h"
 #include "rom/cache.h"
@@ -42,34 +43,142 @@
 
 #include "elf_symbol.h"
 
-extern int __ltdf2(double a, double b);
-extern unsigned int __fixunsdfsi(double a);
-extern int __gtdf2(double a, double b);
-extern double __floatunsidf(unsigned int i);
-extern double __divdf3(double a, double b);
-unsigned long long __udivdi3(unsigned long long a, unsigned long long b) {
-    return b ? a / b : 0ULL;
-}
-
-unsigned long long __umoddi3(unsigned long long a, unsigned long long b) {
-    return b ? a % b : 0ULL;
-}
+/*
+ * libgcc helpers have no public prototypes; only their addresses are
+ * needed here, so declare them as opaque functions.
+ */
+#define LIBGCC_HELPER(_sym)         extern void _sym(void)
+#define LIBGCC_HELPER_WEAK(_sym)    extern void _sym(void) __attribute__((weak))
+
+/* Dynamic TLS resolver of loaded ELFs, see esp_elf_tls.c */
+extern void *__tls_get_addr(void *ti);
+
+/* 64-bit integer arithmetic */
+LIBGCC_HELPER(__divdi3);
+LIBGCC_HELPER(__moddi3);
+LIBGCC_HELPER(__udivdi3);
+LIBGCC_HELPER(__umoddi3);
+LIBGCC_HELPER(__udivmoddi4);
+LIBGCC_HELPER(__ashldi3);
+LIBGCC_HELPER(__ashrdi3);
+LIBGCC_HELPER(__lshrdi3);
+LIBGCC_HELPER(__negdi2);
+LIBGCC_HELPER(__cmpdi2);
+LIBGCC_HELPER(__ucmpdi2);
+LIBGCC_HELPER_WEAK(__muldi3);       /* not built for RV32 (mul is inlined) */
+
+/* Bit operations */
+LIBGCC_HELPER(__clzsi2);
+LIBGCC_HELPER(__clzdi2);
+LIBGCC_HELPER(__ctzsi2);
+LIBGCC_HELPER(__ctzdi2);
+LIBGCC_HELPER(__clrsbsi2);
+LIBGCC_HELPER(__clrsbdi2);
+LIBGCC_HELPER(__ffssi2);
+LIBGCC_HELPER(__ffsdi2);
+LIBGCC_HELPER(__popcountsi2);
+LIBGCC_HELPER(__popcountdi2);
+LIBGCC_HELPER(__paritysi2);
+LIBGCC_HELPER(__paritydi2);
+LIBGCC_HELPER(__bswapsi2);
+LIBGCC_HELPER(__bswapdi2);
+
+/* Double precision (soft-float on every supported core) */
+LIBGCC_HELPER(__adddf3);
+LIBGCC_HELPER(__subdf3);
+LIBGCC_HELPER(__muldf3);
+LIBGCC_HELPER(__divdf3);
+LIBGCC_HELPER(__negdf2);
+LIBGCC_HELPER(__eqdf2);
+LIBGCC_HELPER(__nedf2);
+LIBGCC_HELPER(__gedf2);
+LIBGCC_HELPER(__gtdf2);
+LIBGCC_HELPER(__ledf2);
+LIBGCC_HELPER(__ltdf2);
+LIBGCC_HELPER(__unorddf2);
+LIBGCC_HELPER(__fixdfsi);
+LIBGCC_HELPER(__fixunsdfsi);
+LIBGCC_HELPER(__fixdfdi);
+LIBGCC_HELPER(__fixunsdfdi);
+LIBGCC_HELPER(__floatsidf);
+LIBGCC_HELPER(__floatunsidf);
+LIBGCC_HELPER(__floatdidf);
+LIBGCC_HELPER(__floatundidf);
+LIBGCC_HELPER(__extendsfdf2);
+LIBGCC_HELPER(__truncdfsf2);
+LIBGCC_HELPER(__powidf2);
+
+/* Single precision <-> 64-bit integer (emitted even with a hardware FPU) */
+LIBGCC_HELPER(__fixsfdi);
+LIBGCC_HELPER(__fixunssfdi);
+LIBGCC_HELPER(__floatdisf);
+LIBGCC_HELPER(__floatundisf);
+LIBGCC_HELPER(__powisf2);
+
+/* Complex multiply/divide (known to GCC as builtins, so keep their real types) */
+extern _Complex float  __mulsc3(float, float, float, float);
+extern _Complex float  __divsc3(float, float, float, float);
+extern _Complex double __muldc3(double, double, double, double);
+extern _Complex double __divdc3(double, double, double, double);
+
+#if !defined(__riscv) || !defined(__riscv_flen)
+/* Single precision arithmetic (cores without the RISC-V F extension) */
+LIBGCC_HELPER(__addsf3);
+LIBGCC_HELPER(__subsf3);
+LIBGCC_HELPER(__mulsf3);
+LIBGCC_HELPER(__divsf3);
+LIBGCC_HELPER(__negsf2);
+LIBGCC_HELPER(__eqsf2);
+LIBGCC_HELPER(__nesf2);
+LIBGCC_HELPER(__gesf2);
+LIBGCC_HELPER(__gtsf2);
+LIBGCC_HELPER(__lesf2);
+LIBGCC_HELPER(__ltsf2);
+LIBGCC_HELPER(__unordsf2);
+LIBGCC_HELPER(__fixsfsi);
+LIBGCC_HELPER(__fixunssfsi);
+LIBGCC_HELPER(__floatsisf);
+LIBGCC_HELPER(__floatunsisf);
+#endif
 
+#if defined(__riscv)
+/* 128-bit long double (RISC-V ABI) */
+LIBGCC_HELPER(__addtf3);
+LIBGCC_HELPER(__subtf3);
+LIBGCC_HELPER(__multf3);
+LIBGCC_HELPER(__divtf3);
+LIBGCC_HELPER(__negtf2);
+LIBGCC_HELPER(__eqtf2);
+LIBGCC_HELPER(__netf2);
+LIBGCC_HELPER(__getf2);
+LIBGCC_HELPER(__gttf2);
+LIBGCC_HELPER(__letf2);
+LIBGCC_HELPER(__lttf2);
+LIBGCC_HELPER(__unordtf2);
+LIBGCC_HELPER(__fixtfsi);
+LIBGCC_HELPER(__fixunstfsi);
+LIBGCC_HELPER(__fixtfdi);
+LIBGCC_HELPER(__fixunstfdi);
+LIBGCC_HELPER(__floatsitf);
+LIBGCC_HELPER(__floatunsitf);
+LIBGCC_HELPER(__floatditf);
+LIBGCC_HELPER(__floatunditf);
+LIBGCC_HELPER(__extendsftf2);
+LIBGCC_HELPER(__extenddftf2);
+LIBGCC_HELPER(__trunctfsf2);
+LIBGCC_HELPER(__trunctfdf2);
+#endif
 
 /** @brief Libc public functions symbols look-up table */
 
 static const struct esp_elfsym g_esp_libc_elfsyms[] = {
 
-    /* string.h */
+    /* string.h (memcpy/memset/memcmp/strlen/strcmp: see launchpad_mem_init()) */
 
     ESP_ELFSYM_EXPORT(strerror),
-    ESP_ELFSYM_EXPORT(memset),
-    ESP_ELFSYM_EXPORT(memcpy),
-    ESP_ELFSYM_EXPORT(strlen),
     ESP_ELFSYM_EXPORT(strtod),
     ESP_ELFSYM_EXPORT(strrchr),
     ESP_ELFSYM_EXPORT(strchr),
-    ESP_ELFSYM_EXPORT(strcmp),
     ESP_ELFSYM_EXPORT(strtol),
     ESP_ELFSYM_EXPORT(strcspn),
     ESP_ELFSYM_EXPORT(strncat),
@@ -86,26 +195,19 @@ static const struct esp_elfsym g_esp_libc_elfsyms[] = {
     ESP_ELFSYM_EXPORT(exit),
     ESP_ELFSYM_EXPORT(close),
 
-    /* stdlib.h */
-
-    ESP_ELFSYM_EXPORT(malloc),
-    ESP_ELFSYM_EXPORT(calloc),
-    ESP_ELFSYM_EXPORT(realloc),
-    ESP_ELFSYM_EXPORT(free),
+    /* stdlib.h: malloc/calloc/realloc/free are registered by launchpad_arena_init() */
 
     /* time.h */
 
     ESP_ELFSYM_EXPORT(clock_gettime),
     ESP_ELFSYM_EXPORT(strftime),
 
-    /* pthread.h */
+    /* pthread.h: pthread_create/pthread_exit are registered by launchpad_arena_init() */
 
-    ESP_ELFSYM_EXPORT(pthread_create),
     ESP_ELFSYM_EXPORT(pthread_attr_init),
     ESP_ELFSYM_EXPORT(pthread_attr_setstacksize),
     ESP_ELFSYM_EXPORT(pthread_detach),
     ESP_ELFSYM_EXPORT(pthread_join),
-    ESP_ELFSYM_EXPORT(pthread_exit),
 
     /* newlib */
 
@@ -117,15 +219,8 @@ static const struct esp_elfsym g_esp_libc_elfsyms[] = {
     ESP_ELFSYM_EXPORT(_ctype_),
 #endif
 
-    /* math */
+    /* assert / error helpers */
 
-    ESP_ELFSYM_EXPORT(__ltdf2),
-    ESP_ELFSYM_EXPORT(__fixunsdfsi),
-    ESP_ELFSYM_EXPORT(__gtdf2),
-    ESP_ELFSYM_EXPORT(__floatunsidf),
-    ESP_ELFSYM_EXPORT(__divdf3),
-    ESP_ELFSYM_EXPORT(__umoddi3),
-    ESP_ELFSYM_EXPORT(__udivdi3),
     ESP_ELFSYM_EXPORT(__assert_func),
     ESP_ELFSYM_EXPORT(esp_err_to_name),
     ESP_ELFSYM_EXPORT(esp_log_buffer_hexdump_internal),
@@ -146,6 +241,258 @@ static const struct esp_elfsym g_esp_libc_elfsyms[] = {
     ESP_ELFSYM_END
 };
 
+/** @brief libgcc compiler helpers look-up table */
+
+static const struct esp_elfsym g_esp_libgcc_elfsyms[] = {
+
+    /* 64-bit integer arithmetic */
+
+    ESP_ELFSYM_EXPORT(__divdi3),
+    ESP_ELFSYM_EXPORT(__moddi3),
+    ESP_ELFSYM_EXPORT(__udivdi3),
+    ESP_ELFSYM_EXPORT(__umoddi3),
+    ESP_ELFSYM_EXPORT(__udivmoddi4),
+    ESP_ELFSYM_EXPORT(__ashldi3),
+    ESP_ELFSYM_EXPORT(__ashrdi3),
+    ESP_ELFSYM_EXPORT(__lshrdi3),
+    ESP_ELFSYM_EXPORT(__negdi2),
+    ESP_ELFSYM_EXPORT(__cmpdi2),
+    ESP_ELFSYM_EXPORT(__ucmpdi2),
+    ESP_ELFSYM_EXPORT(__muldi3),
+
+    /* bit operations */
+
+    ESP_ELFSYM_EXPORT(__clzsi2),
+    ESP_ELFSYM_EXPORT(__clzdi2),
+    ESP_ELFSYM_EXPORT(__ctzsi2),
+    ESP_ELFSYM_EXPORT(__ctzdi2),
+    ESP_ELFSYM_EXPORT(__clrsbsi2),
+    ESP_ELFSYM_EXPORT(__clrsbdi2),
+    ESP_ELFSYM_EXPORT(__ffssi2),
+    ESP_ELFSYM_EXPORT(__ffsdi2),
+    ESP_ELFSYM_EXPORT(__popcountsi2),
+    ESP_ELFSYM_EXPORT(__popcountdi2),
+    ESP_ELFSYM_EXPORT(__paritysi2),
+    ESP_ELFSYM_EXPORT(__paritydi2),
+    ESP_ELFSYM_EXPORT(__bswapsi2),
+    ESP_ELFSYM_EXPORT(__bswapdi2),
+
+    /* double precision */
+
+    ESP_ELFSYM_EXPORT(__adddf3),
+    ESP_ELFSYM_EXPORT(__subdf3),
+    ESP_ELFSYM_EXPORT(__muldf3),
+    ESP_ELFSYM_EXPORT(__divdf3),
+    ESP_ELFSYM_EXPORT(__negdf2),
+    ESP_ELFSYM_EXPORT(__eqdf2),
+    ESP_ELFSYM_EXPORT(__nedf2),
+    ESP_ELFSYM_EXPORT(__gedf2),
+    ESP_ELFSYM_EXPORT(__gtdf2),
+    ESP_ELFSYM_EXPORT(__ledf2),
+    ESP_ELFSYM_EXPORT(__ltdf2),
+    ESP_ELFSYM_EXPORT(__unorddf2),
+    ESP_ELFSYM_EXPORT(__fixdfsi),
+    ESP_ELFSYM_EXPORT(__fixunsdfsi),
+    ESP_ELFSYM_EXPORT(__fixdfdi),
+    ESP_ELFSYM_EXPORT(__fixunsdfdi),
+    ESP_ELFSYM_EXPORT(__floatsidf),
+    ESP_ELFSYM_EXPORT(__floatunsidf),
+    ESP_ELFSYM_EXPORT(__floatdidf),
+    ESP_ELFSYM_EXPORT(__floatundidf),
+    ESP_ELFSYM_EXPORT(__extendsfdf2),
+    ESP_ELFSYM_EXPORT(__truncdfsf2),
+    ESP_ELFSYM_EXPORT(__powidf2),
+
+    /* single precision <-> 64-bit */
+
+    ESP_ELFSYM_EXPORT(__fixsfdi),
+    ESP_ELFSYM_EXPORT(__fixunssfdi),
+    ESP_ELFSYM_EXPORT(__floatdisf),
+    ESP_ELFSYM_EXPORT(__floatundisf),
+    ESP_ELFSYM_EXPORT(__powisf2),
+
+    /* complex */
+
+    ESP_ELFSYM_EXPORT(__mulsc3),
+    ESP_ELFSYM_EXPORT(__divsc3),
+    ESP_ELFSYM_EXPORT(__muldc3),
+    ESP_ELFSYM_EXPORT(__divdc3),
+
+#if !defined(__riscv) || !defined(__riscv_flen)
+    /* single precision arithmetic */
+
+    ESP_ELFSYM_EXPORT(__addsf3),
+    ESP_ELFSYM_EXPORT(__subsf3),
+    ESP_ELFSYM_EXPORT(__mulsf3),
+    ESP_ELFSYM_EXPORT(__divsf3),
+    ESP_ELFSYM_EXPORT(__negsf2),
+    ESP_ELFSYM_EXPORT(__eqsf2),
+    ESP_ELFSYM_EXPORT(__nesf2),
+    ESP_ELFSYM_EXPORT(__gesf2),
+    ESP_ELFSYM_EXPORT(__gtsf2),
+    ESP_ELFSYM_EXPORT(__lesf2),
+    ESP_ELFSYM_EXPORT(__ltsf2),
+    ESP_ELFSYM_EXPORT(__unordsf2),
+    ESP_ELFSYM_EXPORT(__fixsfsi),
+    ESP_ELFSYM_EXPORT(__fixunssfsi),
+    ESP_ELFSYM_EXPORT(__floatsisf),
+    ESP_ELFSYM_EXPORT(__floatunsisf),
+#endif
+
+#if defined(__riscv)
+    /* 128-bit long double */
+
+    ESP_ELFSYM_EXPORT(__addtf3),
+    ESP_ELFSYM_EXPORT(__subtf3),
+    ESP_ELFSYM_EXPORT(__multf3),
+    ESP_ELFSYM_EXPORT(__divtf3),
+    ESP_ELFSYM_EXPORT(__negtf2),
+    ESP_ELFSYM_EXPORT(__eqtf2),
+    ESP_ELFSYM_EXPORT(__netf2),
+    ESP_ELFSYM_EXPORT(__getf2),
+    ESP_ELFSYM_EXPORT(__gttf2),
+    ESP_ELFSYM_EXPORT(__letf2),
+    ESP_ELFSYM_EXPORT(__lttf2),
+    ESP_ELFSYM_EXPORT(__unordtf2),
+    ESP_ELFSYM_EXPORT(__fixtfsi),
+    ESP_ELFSYM_EXPORT(__fixunstfsi),
+    ESP_ELFSYM_EXPORT(__fixtfdi),
+    ESP_ELFSYM_EXPORT(__fixunstfdi),
+    ESP_ELFSYM_EXPORT(__floatsitf),
+    ESP_ELFSYM_EXPORT(__floatunsitf),
+    ESP_ELFSYM_EXPORT(__floatditf),
+    ESP_ELFSYM_EXPORT(__floatunditf),
+    ESP_ELFSYM_EXPORT(__extendsftf2),
+    ESP_ELFSYM_EXPORT(__extenddftf2),
+    ESP_ELFSYM_EXPORT(__trunctfsf2),
+    ESP_ELFSYM_EXPORT(__trunctfdf2),
+#endif
+
+    ESP_ELFSYM_END
+};
+
+/** @brief libm public functions symbols look-up table */
+
+static const struct esp_elfsym g_esp_libm_elfsyms[] = {
+
+    /* double: trigonometric / hyperbolic */
+
+    ESP_ELFSYM_EXPORT(sin),
+    ESP_ELFSYM_EXPORT(cos),
+    ESP_ELFSYM_EXPORT(tan),
+    ESP_ELFSYM_EXPORT(asin),
+    ESP_ELFSYM_EXPORT(acos),
+    ESP_ELFSYM_EXPORT(atan),
+    ESP_ELFSYM_EXPORT(atan2),
+    ESP_ELFSYM_EXPORT(sinh),
+    ESP_ELFSYM_EXPORT(cosh),
+    ESP_ELFSYM_EXPORT(tanh),
+    ESP_ELFSYM_EXPORT(asinh),
+    ESP_ELFSYM_EXPORT(acosh),
+    ESP_ELFSYM_EXPORT(atanh),
+
+    /* double: exponential / logarithmic / power */
+
+    ESP_ELFSYM_EXPORT(exp),
+    ESP_ELFSYM_EXPORT(exp2),
+    ESP_ELFSYM_EXPORT(expm1),
+    ESP_ELFSYM_EXPORT(log),
+    ESP_ELFSYM_EXPORT(log2),
+    ESP_ELFSYM_EXPORT(log10),
+    ESP_ELFSYM_EXPORT(log1p),
+    ESP_ELFSYM_EXPORT(logb),
+    ESP_ELFSYM_EXPORT(ilogb),
+    ESP_ELFSYM_EXPORT(pow),
+    ESP_ELFSYM_EXPORT(sqrt),
+    ESP_ELFSYM_EXPORT(cbrt),
+    ESP_ELFSYM_EXPORT(hypot),
+    ESP_ELFSYM_EXPORT(erf),
+    ESP_ELFSYM_EXPORT(erfc),
+    ESP_ELFSYM_EXPORT(tgamma),
+    ESP_ELFSYM_EXPORT(lgamma),
+
+    /* double: rounding / remainder / manipulation */
+
+    ESP_ELFSYM_EXPORT(ceil),
+    ESP_ELFSYM_EXPORT(floor),
+    ESP_ELFSYM_EXPORT(trunc),
+    ESP_ELFSYM_EXPORT(round),
+    ESP_ELFSYM_EXPORT(lround),
+    ESP_ELFSYM_EXPORT(llround),
+    ESP_ELFSYM_EXPORT(rint),
+    ESP_ELFSYM_EXPORT(lrint),
+    ESP_ELFSYM_EXPORT(llrint),
+    ESP_ELFSYM_EXPORT(nearbyint),
+    ESP_ELFSYM_EXPORT(fmod),
+    ESP_ELFSYM_EXPORT(remainder),
+    ESP_ELFSYM_EXPORT(remquo),
+    ESP_ELFSYM_EXPORT(fabs),
+    ESP_ELFSYM_EXPORT(copysign),
+    ESP_ELFSYM_EXPORT(fdim),
+    ESP_ELFSYM_EXPORT(fmax),
+    ESP_ELFSYM_EXPORT(fmin),
+    ESP_ELFSYM_EXPORT(fma),
+    ESP_ELFSYM_EXPORT(frexp),
+    ESP_ELFSYM_EXPORT(ldexp),
+    ESP_ELFSYM_EXPORT(modf),
+    ESP_ELFSYM_EXPORT(scalbn),
+    ESP_ELFSYM_EXPORT(scalbln),
+    ESP_ELFSYM_EXPORT(nextafter),
+    ESP_ELFSYM_EXPORT(nan),
+
+    /* float (sinf/cosf/expf/exp2f/logf/log2f/log10f/atanf/atan2f: see launchpad_fmath_init()) */
+
+    ESP_ELFSYM_EXPORT(tanf),
+    ESP_ELFSYM_EXPORT(asinf),
+    ESP_ELFSYM_EXPORT(acosf),
+    ESP_ELFSYM_EXPORT(sinhf),
+    ESP_ELFSYM_EXPORT(coshf),
+    ESP_ELFSYM_EXPORT(tanhf),
+    ESP_ELFSYM_EXPORT(asinhf),
+    ESP_ELFSYM_EXPORT(acoshf),
+    ESP_ELFSYM_EXPORT(atanhf),
+    ESP_ELFSYM_EXPORT(expm1f),
+    ESP_ELFSYM_EXPORT(log1pf),
+    ESP_ELFSYM_EXPORT(logbf),
+    ESP_ELFSYM_EXPORT(ilogbf),
+    ESP_ELFSYM_EXPORT(powf),
+    ESP_ELFSYM_EXPORT(sqrtf),
+    ESP_ELFSYM_EXPORT(cbrtf),
+    ESP_ELFSYM_EXPORT(hypotf),
+    ESP_ELFSYM_EXPORT(erff),
+    ESP_ELFSYM_EXPORT(erfcf),
+    ESP_ELFSYM_EXPORT(tgammaf),
+    ESP_ELFSYM_EXPORT(lgammaf),
+    ESP_ELFSYM_EXPORT(ceilf),
+    ESP_ELFSYM_EXPORT(floorf),
+    ESP_ELFSYM_EXPORT(truncf),
+    ESP_ELFSYM_EXPORT(roundf),
+    ESP_ELFSYM_EXPORT(lroundf),
+    ESP_ELFSYM_EXPORT(llroundf),
+    ESP_ELFSYM_EXPORT(rintf),
+    ESP_ELFSYM_EXPORT(lrintf),
+    ESP_ELFSYM_EXPORT(llrintf),
+    ESP_ELFSYM_EXPORT(nearbyintf),
+    ESP_ELFSYM_EXPORT(fmodf),
+    ESP_ELFSYM_EXPORT(remainderf),
+    ESP_ELFSYM_EXPORT(remquof),
+    ESP_ELFSYM_EXPORT(fabsf),
+    ESP_ELFSYM_EXPORT(copysignf),
+    ESP_ELFSYM_EXPORT(fdimf),
+    ESP_ELFSYM_EXPORT(fmaxf),
+    ESP_ELFSYM_EXPORT(fminf),
+    ESP_ELFSYM_EXPORT(fmaf),
+    ESP_ELFSYM_EXPORT(frexpf),
+    ESP_ELFSYM_EXPORT(ldexpf),
+    ESP_ELFSYM_EXPORT(modff),
+    ESP_ELFSYM_EXPORT(scalbnf),
+    ESP_ELFSYM_EXPORT(scalblnf),
+    ESP_ELFSYM_EXPORT(nextafterf),
+    ESP_ELFSYM_EXPORT(nanf),
+
+    ESP_ELFSYM_END
+};
+
 /** @brief ESP-IDF public functions symbols look-up table */
 
 static const struct esp_elfsym g_esp_espidf_elfsyms[] = {
@@ -173,13 +520,11 @@ static const struct esp_elfsym g_esp_espidf_elfsyms[] = {
     /* ROM functions */
 
     ESP_ELFSYM_EXPORT(ets_printf),
-    ESP_ELFSYM_EXPORT(xTaskCreate),
-    ESP_ELFSYM_EXPORT(xTaskCreatePinnedToCore),
+    /* xTaskCreate/xTaskCreatePinnedToCore/vTaskDelete are registered by launchpad_arena_init() */
     ESP_ELFSYM_EXPORT(xQueueSemaphoreTake),
     ESP_ELFSYM_EXPORT(xQueueGenericSend),
     ESP_ELFSYM_EXPORT(xQueueCreateMutex),
     
-    ESP_ELFSYM_EXPORT(vTaskDelete),
     ESP_ELFSYM_EXPORT(vTaskDelay),
     ESP_ELFSYM_EXPORT(xTaskDelayUntil),
     ESP_ELFSYM_EXPORT(xTaskGetCurrentTaskHandle),
@@ -199,6 +544,7 @@ static const struct esp_elfsym g_esp_espidf_elfsyms[] = {
     ESP_ELFSYM_EXPORT(esp_elf_init),
     ESP_ELFSYM_EXPORT(esp_elf_deinit),
     ESP_ELFSYM_EXPORT(esp_elf_relocate),
+    ESP_ELFSYM_EXPORT(__tls_get_addr),
 
     /* esp_system.h */
     ESP_ELFSYM_EXPORT(esp_restart),
@@ -225,56 +571,199 @@ static const struct esp_elfsym g_esp_espidf_elfsyms[] = {
     ESP_ELFSYM_EXPORT(isalnum),
     ESP_ELFSYM_EXPORT(isxdigit),
 
-    /* math.h (часто нужны) */
-    ESP_ELFSYM_EXPORT(sin),
-    ESP_ELFSYM_EXPORT(cos),
-    ESP_ELFSYM_EXPORT(tan),
-    ESP_ELFSYM_EXPORT(sqrt),
-    ESP_ELFSYM_EXPORT(fabs),
-
     ESP_ELFSYM_END
 };
 
-/* Структура узла динамической таблицы */
+/*
+ * Dynamic symbol registry.
+ *
+ * Lookups run concurrently from every task that relocates an ELF, so the
+ * registry is an open-addressing hash table that readers probe without
+ * taking any lock:
+ *
+ *  - writers are serialized by s_dyn_lock and fill an empty slot in place,
+ *    storing its hash last, or swap the address of an existing one;
+ *  - only when the table is half full is a larger copy built and published
+ *    with a single atomic store, so registering n symbols costs O(n);
+ *  - readers announce themselves in the counter of the current epoch.
+ *    After publishing, a writer moves to the next epoch and waits only for
+ *    readers of the previous one before freeing the old table, so a steady
+ *    stream of new lookups cannot hold it off.
+ *
+ * Name strings are owned by the registry and never freed, so every
+ * table can share them.
+ */
+
 struct dyn_esp_elfsym {
-    const char *name;          /* строка‑имя символа                */
-    void        *sym;           /* адрес функции/данных              */
-    struct dyn_esp_elfsym *next;
+    uint32_t    hash;           /* 0 marks an empty slot */
+    const char *name;
+    void       *sym;
 };
 
-/* Глобальный список новых символов (простой односвязный список) */
-static struct dyn_esp_elfsym *g_dyn_syms = NULL;
+struct dyn_esp_elfsnap {
+    uint32_t    mask;           /* capacity - 1, capacity is a power of two */
+    uint32_t    count;
+    struct dyn_esp_elfsym slots[];
+};
+
+static struct dyn_esp_elfsnap *s_dyn_snap;
+static uint32_t s_dyn_epoch;
+static uint32_t s_dyn_readers[2];   /* by epoch parity */
+static _lock_t s_dyn_lock;
+
+/* FNV-1a; never returns 0 so the value doubles as the slot tag */
+static inline uint32_t dyn_sym_hash(const char *name)
+{
+    uint32_t h = 2166136261u;
+
+    while (*name) {
+        h = (h ^ (uint8_t)*name++) * 16777619u;
+    }
+    return h ? h : 1;
+}
+
+static struct dyn_esp_elfsym *dyn_sym_probe(const struct dyn_esp_elfsnap *snap,
+                                            const char *name, uint32_t hash)
+{
+    for (uint32_t i = hash & snap->mask; ; i = (i + 1) & snap->mask) {
+        const struct dyn_esp_elfsym *slot = &snap->slots[i];
+
+        if (!slot->hash) {
+            return (struct dyn_esp_elfsym *)slot;
+        }
+        if (slot->hash == hash && !strcmp(slot->name, name)) {
+            return (struct dyn_esp_elfsym *)slot;
+        }
+    }
+}
+
+static uintptr_t dyn_sym_find(const char *name)
+{
+    uint32_t hash = dyn_sym_hash(name);
+    uintptr_t addr = 0;
+    uint32_t *readers = &s_dyn_readers[__atomic_load_n(&s_dyn_epoch, __ATOMIC_SEQ_CST) & 1];
+
+    __atomic_add_fetch(readers, 1, __ATOMIC_SEQ_CST);
+
+    const struct dyn_esp_elfsnap *snap = __atomic_load_n(&s_dyn_snap, __ATOMIC_SEQ_CST);
+    for (uint32_t i = hash; snap; i++) {
+        const struct dyn_esp_elfsym *slot = &snap->slots[i & snap->mask];
+        uint32_t h = __atomic_load_n(&slot->hash, __ATOMIC_ACQUIRE);
 
-/* Внутренняя реализация – добавление узла в список   */
+        if (!h) {
+            break;
+        }
+        if (h == hash && !strcmp(slot->name, name)) {
+            addr = (uintptr_t)__atomic_load_n(&slot->sym, __ATOMIC_ACQUIRE);
+            break;
+        }
+    }
+
+    __atomic_sub_fetch(readers, 1, __ATOMIC_RELEASE);
+    return addr;
+}
+
+/* Copy @old into a table with room for at least @count entries */
+static struct dyn_esp_elfsnap *dyn_snap_grow(const struct dyn_esp_elfsnap *old, uint32_t count)
+{
+    uint32_t cap = 16;
+    while (cap < count * 2) {
+        cap <<= 1;
+    }
+
+    struct dyn_esp_elfsnap *snap = calloc(1, sizeof(*snap) + cap * sizeof(snap->slots[0]));
+    if (!snap) {
+        return NULL;
+    }
+    snap->mask = cap - 1;
+
+    if (old) {
+        for (uint32_t i = 0; i <= old->mask; i++) {
+            const struct dyn_esp_elfsym *slot = &old->slots[i];
+            if (slot->hash) {
+                *dyn_sym_probe(snap, slot->name, slot->hash) = *slot;
+            }
+        }
+        snap->count = old->count;
+    }
+    return snap;
+}
+
+/* Publish @snap and free @old once no reader can still see it */
+static void dyn_snap_publish(struct dyn_esp_elfsnap *snap, struct dyn_esp_elfsnap *old)
+{
+    __atomic_store_n(&s_dyn_snap, snap, __ATOMIC_SEQ_CST);
+
+    if (old) {
+        /* Readers arriving from now on count in the other epoch */
+        uint32_t epoch = __atomic_fetch_add(&s_dyn_epoch, 1, __ATOMIC_SEQ_CST);
+
+        while (__atomic_load_n(&s_dyn_readers[epoch & 1], __ATOMIC_SEQ_CST)) {
+            vTaskDelay(1);
+        }
+        free(old);
+    }
+}
+
+/**
+ * @brief Register (or replace) a dynamic symbol.
+ *
+ * Safe to call concurrently with elf_find_sym() and with other writers.
+ * A later registration of the same name replaces the earlier address.
+ *
+ * @return @p sym on success, 0 on invalid arguments or out of memory.
+ */
 uintptr_t _register_symbol(const char *name, void *sym)
 {
     if (!name || !sym) {
         return 0;
     }
 
-    /* Создаём новый узел */
-    struct dyn_esp_elfsym *node = malloc(sizeof(*node));
-    if (!node) {
-        return 0;           /* нехватка памяти – просто отказываем */
+    uint32_t hash = dyn_sym_hash(name);
+    uintptr_t ret = 0;
+
+    _lock_acquire(&s_dyn_lock);
+
+    struct dyn_esp_elfsnap *snap = s_dyn_snap;
+    struct dyn_esp_elfsym *slot = snap ? dyn_sym_probe(snap, name, hash) : NULL;
+
+    if (slot && slot->hash) {
+        __atomic_store_n(&slot->sym, sym, __ATOMIC_RELEASE);
+        ret = (uintptr_t)sym;
+        goto out;
     }
 
-    /* Дублируем строку‑имя, чтобы она оставалась живой после выхода из функции */
-    size_t len = strlen(name);
-    char *name_copy = malloc(len + 1);
+    /* Own the name so it stays valid after the caller returns */
+    const char *name_copy = strdup(name);
     if (!name_copy) {
-        free(node);
-        return 0;
+        goto out;
     }
-    memcpy(name_copy, name, len + 1);
-
-    node->name = name_copy;
-    node->sym  = sym;
 
-    /* Вставляем в начало списка (не важно порядок) */
-    node->next = g_dyn_syms;
-    g_dyn_syms = node;
+    /* Keep the table at most half full, so probes stay short */
+    if (!snap || (snap->count + 1) * 2 > snap->mask + 1) {
+        struct dyn_esp_elfsnap *grown = dyn_snap_grow(snap, (snap ? snap->count : 0) + 1);
+        if (!grown) {
+            free((void *)name_copy);
+            goto out;
+        }
+        slot = dyn_sym_probe(grown, name_copy, hash);
+        slot->hash = hash;
+        slot->name = name_copy;
+        slot->sym  = sym;
+        grown->count++;
+        dyn_snap_publish(grown, snap);
+    } else {
+        /* In place: readers see the slot once its hash is stored */
+        slot->name = name_copy;
+        slot->sym  = sym;
+        __atomic_store_n(&slot->hash, hash, __ATOMIC_RELEASE);
+        snap->count++;
+    }
+    ret = (uintptr_t)sym;
 
-    return (uintptr_t)sym;   /* возвращаем адрес, чтобы можно было сразу использовать */
+out:
+    _lock_release(&s_dyn_lock);
+    return ret;
 }
 
 /* --------------------------------------------------------------------
@@ -306,41 +795,24 @@ static inline uintptr_t elf_register_new_named_symbol(const char *name,
  */
 uintptr_t elf_find_sym(const char *sym_name)
 {
-    const struct esp_elfsym *syms;
-
-    syms = g_esp_libc_elfsyms;
-    while (syms->name) {
-        if (!strcmp(syms->name, sym_name)) {
-            return (uintptr_t)syms->sym;
-        }
-
-        syms++;
-    }
-
-    syms = g_esp_libc_elfsyms;
-    (void)syms;
-
-    syms = g_esp_espidf_elfsyms;
-    while (syms->name) {
-        if (!strcmp(syms->name, sym_name)) {
-            return (uintptr_t)syms->sym;
+    static const struct esp_elfsym *const tables[] = {
+        g_esp_libc_elfsyms,
+        g_esp_libgcc_elfsyms,
+        g_esp_libm_elfsyms,
+        g_esp_espidf_elfsyms,
+    };
+
+    for (size_t i = 0; i < sizeof(tables) / sizeof(tables[0]); i++) {
+        const struct esp_elfsym *syms = tables[i];
+
+        while (syms->name) {
+            if (!strcmp(syms->name, sym_name)) {
+                return (uintptr_t)syms->sym;
+            }
+
+            syms++;
         }
-
-        syms++;
     }
 
-    syms = g_esp_espidf_elfsyms;
-    (void)syms;
-
-    /* Ищем в динамической таблице */
-    struct dyn_esp_elfsym *node = g_dyn_syms;
-    while (node) {
-        if (!strcmp(node->name, sym_name)) {
-            return (uintptr_t)node->sym;
-        }
-        node = node->next;
-    }
-
-
-    return 0;
+    return dyn_sym_find(sym_name);
 }
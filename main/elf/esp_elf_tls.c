@@ -0,0 +1,224 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/errno.h>
+#include <sys/param.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "elf_platform.h"
+
+/* Slot 0 belongs to pthread */
+#define TLS_TASK_INDEX  1
+
+_Static_assert(TLS_TASK_INDEX < configNUM_THREAD_LOCAL_STORAGE_POINTERS,
+               "CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS must be at least 2");
+
+/** @brief Argument of __tls_get_addr(), filled by DTPMOD/DTPREL relocations */
+
+typedef struct elf_tls_index {
+    uintptr_t       module;             /*!< esp_elf_tls_t of the image */
+    uintptr_t       offset;             /*!< DTPREL offset of the variable */
+} elf_tls_index_t;
+
+/** @brief One task's TLS block of one image */
+
+typedef struct elf_tls_block {
+    struct elf_tls_block *next;         /*!< next image of the same task */
+    const esp_elf_tls_t  *module;       /*!< image template */
+    uint32_t              gen;          /*!< template generation the block was built from */
+    uint8_t              *data;         /*!< TLS block */
+} elf_tls_block_t;
+
+static const char *TAG = "ELF";
+
+static uint32_t s_tls_gen;
+
+/**
+ * @brief Record the PT_TLS template of a loaded ELF.
+ *
+ * @param elf  - ELF object pointer
+ * @param pbuf - ELF data buffer
+ *
+ * @return ESP_OK if success or other if failed.
+ */
+int esp_elf_tls_init(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    const elf32_hdr_t *ehdr = (const elf32_hdr_t *)pbuf;
+    const elf32_phdr_t *phdr = (const elf32_phdr_t *)(pbuf + ehdr->phoff);
+
+    memset(&elf->tls, 0, sizeof(elf->tls));
+
+    for (int i = 0; i < ehdr->phnum; i++) {
+        if (phdr[i].type != PT_TLS) {
+            continue;
+        }
+
+#if CONFIG_ELF_LOADER_BUS_ADDRESS_MIRROR
+        ESP_LOGE(TAG, "PT_TLS needs segment loading");
+        return -ENOTSUP;
+#else
+        if (phdr[i].memsz < phdr[i].filesz || phdr[i].vaddr < elf->svaddr) {
+            ESP_LOGE(TAG, "Invalid TLS segment[%d], vaddr: 0x%x, memsz: %d",
+                     i, phdr[i].vaddr, phdr[i].memsz);
+            return -EINVAL;
+        }
+
+        elf->tls.init   = elf->psegment + phdr[i].vaddr - elf->svaddr;
+        elf->tls.filesz = phdr[i].filesz;
+        elf->tls.memsz  = phdr[i].memsz;
+        elf->tls.align  = MAX(phdr[i].align, sizeof(void *));
+        elf->tls.gen    = __atomic_add_fetch(&s_tls_gen, 1, __ATOMIC_RELAXED);
+
+        ESP_LOGD(TAG, "TLS segment[%d], filesz: %d, memsz: %d, align: %d",
+                 i, phdr[i].filesz, phdr[i].memsz, (int)elf->tls.align);
+        return 0;
+#endif
+    }
+
+    return 0;
+}
+
+static void elf_tls_block_free(elf_tls_block_t *blk)
+{
+    heap_caps_free(blk->data);
+    free(blk);
+}
+
+static void elf_tls_task_delete(int index, void *arg)
+{
+    elf_tls_block_t *blk = arg;
+
+    while (blk) {
+        elf_tls_block_t *next = blk->next;
+
+        elf_tls_block_free(blk);
+        blk = next;
+    }
+}
+
+static int elf_tls_block_fill(elf_tls_block_t *blk, const esp_elf_tls_t *tls)
+{
+    heap_caps_free(blk->data);
+
+    blk->data = heap_caps_aligned_alloc(tls->align, MAX(tls->memsz, 1), MALLOC_CAP_8BIT);
+    if (!blk->data) {
+        return -ENOMEM;
+    }
+
+    memcpy(blk->data, tls->init, tls->filesz);
+    memset(blk->data + tls->filesz, 0, tls->memsz - tls->filesz);
+    blk->gen = tls->gen;
+
+    return 0;
+}
+
+static elf_tls_block_t *elf_tls_block_get(const esp_elf_tls_t *tls)
+{
+    elf_tls_block_t *head = pvTaskGetThreadLocalStoragePointer(NULL, TLS_TASK_INDEX);
+    elf_tls_block_t *blk;
+
+    for (blk = head; blk; blk = blk->next) {
+        if (blk->module == tls) {
+            break;
+        }
+    }
+
+    if (!blk) {
+        blk = calloc(1, sizeof(elf_tls_block_t));
+        if (!blk) {
+            return NULL;
+        }
+
+        blk->module = tls;
+        blk->next   = head;
+        vTaskSetThreadLocalStoragePointerAndDelCallback(NULL, TLS_TASK_INDEX, blk,
+                                                        elf_tls_task_delete);
+    }
+
+    /* An ELF object reused for a later image carries a new generation */
+
+    if (blk->gen != tls->gen && elf_tls_block_fill(blk, tls)) {
+        return NULL;
+    }
+
+    return blk;
+}
+
+/**
+ * @brief Give the calling task its TLS block of an ELF.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return ESP_OK if success or -ENOMEM if failed.
+ */
+int esp_elf_tls_prepare(esp_elf_t *elf)
+{
+    if (!elf->tls.gen) {
+        return 0;
+    }
+
+    if (!elf_tls_block_get(&elf->tls)) {
+        ESP_LOGE(TAG, "No memory for %d bytes of TLS", (int)elf->tls.memsz);
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Resolve a thread-local variable of a loaded ELF.
+ *
+ * Called by general- and local-dynamic TLS code. The task running the
+ * ELF got its block from esp_elf_tls_prepare(); other tasks get theirs
+ * on first access, initialised from the image's PT_TLS template.
+ *
+ * @param ti - Module and DTPREL offset of the variable
+ *
+ * @return Address of the calling task's copy of the variable, or NULL
+ *         if its block could not be allocated.
+ */
+void *__tls_get_addr(const elf_tls_index_t *ti)
+{
+    const esp_elf_tls_t *tls = (const esp_elf_tls_t *)ti->module;
+    elf_tls_block_t *blk = elf_tls_block_get(tls);
+
+    if (!blk) {
+        ESP_LOGE(TAG, "No memory for %d bytes of TLS", (int)tls->memsz);
+        return NULL;
+    }
+
+    return blk->data + ti->offset + ESP_ELF_TLS_DTV_OFFSET;
+}
+
+/**
+ * @brief Free the calling task's TLS block of an ELF.
+ *
+ * @param elf - ELF object pointer
+ *
+ * @return None
+ */
+void esp_elf_tls_deinit(esp_elf_t *elf)
+{
+    elf_tls_block_t *head = pvTaskGetThreadLocalStoragePointer(NULL, TLS_TASK_INDEX);
+
+    for (elf_tls_block_t **pp = &head; *pp; pp = &(*pp)->next) {
+        elf_tls_block_t *blk = *pp;
+
+        if (blk->module == &elf->tls) {
+            *pp = blk->next;
+            elf_tls_block_free(blk);
+            vTaskSetThreadLocalStoragePointerAndDelCallback(NULL, TLS_TASK_INDEX, head,
+                                                            head ? elf_tls_task_delete : NULL);
+            break;
+        }
+    }
+
+    memset(&elf->tls, 0, sizeof(elf->tls));
+}
@@ -3,20 +3,154 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <stdint.h>
 
 #include "elf/esp_elf.h"
+#include "include/arena.h"
+#include "include/log.h"
+#include "launchpad_vtty.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Выравнивание буфера файла – совпадает с линией кэша */
+#define EXEC_IMAGE_ALIGN 64
 
 static const char *TAG = "launchpad";
 
-/*  exec_from_bytes – основная работа с esp_elf                       */
-bool exec_from_bytes(const uint8_t *data, size_t size,
-                     int argc, char **argv)
+/* Состояние запущенного ELF для launchpad_exec() */
+static TaskHandle_t  s_exec_task;    /* задача, в которой он работает */
+static jmp_buf      *s_exec_jmp;     /* точка возврата в exec_run() */
+
+/* Следующий ELF цепочки; путь и argv лежат в одном блоке malloc */
+static char        **s_next_argv;
+static int           s_next_argc;
+
+static bool exec_file(const char *path, int argc, char **argv);
+
+/*  exec_run – запуск уже перемещённого ELF и очистка               */
+static bool exec_run(esp_elf_t *elf, int argc, char **argv)
+{
+    jmp_buf jb;
+    TaskHandle_t prev_task = s_exec_task;
+    jmp_buf *prev_jmp = s_exec_jmp;
+    volatile esp_err_t err = ESP_OK;
+
+    s_exec_task = xTaskGetCurrentTaskHandle();
+    s_exec_jmp  = &jb;
+
+    /* Своя куча приложения; если её не дали – работает с общей. */
+    launchpad_arena_attach(elf->psegment, elf->ssize);
+    launchpad_vtty_app_enter();
+    launchpad_log_app_enter(elf->psegment, elf->ssize);
+
+    /* launchpad_exec() возвращается сюда, бросая стек приложения. */
+    if (setjmp(jb) == 0) {
+        /* Запускаем ELF. Если нужно передать аргументы – передайте argc/argv. */
+        err = esp_elf_request(elf, 0, argc, argv);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG,
+                     "esp_elf_request failed: %s",
+                     esp_err_to_name(err));
+            /* Ошибка не критична – ELF уже размещён в памяти. */
+        }
+    }
+
+    s_exec_task = prev_task;
+    s_exec_jmp  = prev_jmp;
+
+    /* Потоки stdio, привязанные приложением к /dev/vtty/N, закрываем,
+     * пока их буферы ещё живут в куче приложения. */
+    launchpad_vtty_bind_stdio(-1);
+
+    /* Обработчик событий и приёмники vtty – код приложения, снимаем до выгрузки. */
+    launchpad_vtty_app_exit();
+
+    /* Отложенный лог ссылается на строки ELF – печатаем до выгрузки. */
+    launchpad_log_app_exit();
+
+    /* Очистка ресурсов: куча приложения уходит целиком, с утечками.
+     * Если задачи приложения ещё живы, оставляем и кучу, и образ:
+     * их код и данные должны пережить приложение. */
+    if (launchpad_arena_detach(elf->psegment) != ESP_OK) {
+        ESP_LOGE(TAG, "app tasks still running, image %p stays loaded", elf->psegment);
+        return false;
+    }
+    esp_elf_deinit(elf);
+    return err == ESP_OK;
+}
+
+/*  exec_chain – запускаем по очереди всё, что заказал launchpad_exec() */
+static bool exec_chain(bool ok)
+{
+    while (s_next_argv) {
+        char **argv = s_next_argv;
+        int argc = s_next_argc;
+
+        s_next_argv = NULL;
+
+        /* Путь хранится сразу за строками аргументов. */
+        const char *path = argc ? argv[argc - 1] + strlen(argv[argc - 1]) + 1
+                                : (const char *)&argv[1];
+
+        ESP_LOGI(TAG, "chain exec %s", path);
+        ok = exec_file(path, argc, argv);
+        free(argv);
+    }
+
+    return ok;
+}
+
+/*  launchpad_exec – заменить работающий ELF другим                  */
+int launchpad_exec(const char *path, char *const argv[])
+{
+    struct stat st;
+    size_t size;
+    int argc = 0;
+
+    if (!path || !s_exec_jmp || s_exec_task != xTaskGetCurrentTaskHandle()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (stat(path, &st) != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* Копируем argv и путь: память вызывающего будет освобождена. */
+    size = sizeof(char *) + strlen(path) + 1;
+    for (; argv && argv[argc]; argc++) {
+        size += sizeof(char *) + strlen(argv[argc]) + 1;
+    }
+
+    char **copy = malloc(size);
+    if (!copy) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    char *p = (char *)&copy[argc + 1];
+    for (int i = 0; i < argc; i++) {
+        copy[i] = strcpy(p, argv[i]);
+        p += strlen(p) + 1;
+    }
+    copy[argc] = NULL;
+    strcpy(p, path);
+
+    s_next_argv = copy;
+    s_next_argc = argc;
+
+    longjmp(*s_exec_jmp, 1);
+}
+
+/*  exec_bytes – основная работа с esp_elf                            */
+static bool exec_bytes(const uint8_t *data, size_t size,
+                       int argc, char **argv)
 {
     esp_elf_t elf;
     esp_err_t err;
@@ -34,23 +168,60 @@ bool exec_from_bytes(const uint8_t *data, size_t size,
         return false;
     }
 
-    /* Запускаем ELF. Если нужно передать аргументы – передайте argc/argv. */
-    err = esp_elf_request(&elf, 0, argc, argv);
+    return exec_run(&elf, argc, argv);
+}
+
+/*  exec_buffer – то же, но буфер становится образом                  */
+static bool exec_buffer(uint8_t *data, size_t size,
+                        int argc, char **argv)
+{
+    esp_elf_t elf;
+    esp_err_t err;
+
+    esp_elf_init(&elf);
+
+    /* Буфер переходит во владение elf – даже при ошибке. */
+    err = esp_elf_relocate_inplace(&elf, data, size);
     if (err != ESP_OK) {
         ESP_LOGE(TAG,
-                 "esp_elf_request failed: %s",
+                 "esp_elf_relocate_inplace failed: %s",
                  esp_err_to_name(err));
-        /* Ошибка не критична – ELF уже размещён в памяти. */
+        esp_elf_deinit(&elf);
+        return false;
     }
 
-    /* Очистка ресурсов. */
-    esp_elf_deinit(&elf);
-    return err == ESP_OK;
+    return exec_run(&elf, argc, argv);
 }
 
-/*  exec_from_file – читаем файл и делаем вызов выше              */
-bool exec_from_file(const char *path,
-                    int argc, char **argv)
+/*  exec_image_size – сколько байт нужно, чтобы образ поместился
+ *  в буфере файла вместе с .bss последнего сегмента                  */
+static size_t exec_image_size(int fd, size_t file_size)
+{
+    elf32_hdr_t ehdr;
+    elf32_phdr_t phdr;
+    size_t need = file_size;
+
+    if (pread(fd, &ehdr, sizeof(ehdr), 0) != sizeof(ehdr)) {
+        return file_size;
+    }
+
+    for (int i = 0; i < ehdr.phnum; i++) {
+        off_t off = ehdr.phoff + i * sizeof(phdr);
+
+        if (pread(fd, &phdr, sizeof(phdr), off) != sizeof(phdr)) {
+            return file_size;
+        }
+        if (phdr.type == PT_LOAD && phdr.offset + phdr.memsz > need) {
+            need = phdr.offset + phdr.memsz;
+        }
+    }
+
+    return need;
+}
+
+/*  exec_file – читаем файл и делаем вызов выше                   */
+static bool exec_file(const char *path,
+                      int argc, char **argv)
 {
     /* Открываем ELF‑файл. */
     int fd = open(path, O_RDONLY);
@@ -67,28 +238,44 @@ bool exec_from_file(const char *path,
         return false;
     }
 
-    /* Выделяем буфер и читаем файл полностью. */
-    uint8_t *buffer = malloc(st.st_size);
+    /* Выделяем буфер сразу под весь образ, чтобы загрузить его на месте. */
+    size_t size = exec_image_size(fd, st.st_size);
+    uint8_t *buffer = heap_caps_aligned_alloc(EXEC_IMAGE_ALIGN, size, MALLOC_CAP_8BIT);
     if (!buffer) {
         close(fd);
         ESP_LOGE(TAG, "Memory allocation failed");
         return false;
     }
 
-    ssize_t bytes_read = read(fd, buffer, st.st_size);
+    ssize_t bytes_read = pread(fd, buffer, st.st_size, 0);
     close(fd);
 
     if (bytes_read != st.st_size) {
-        free(buffer);
+        heap_caps_free(buffer);
         ESP_LOGE(TAG,
                  "Failed to read ELF file completely: %s",
                  path);
         return false;
     }
 
-    /* Делегируем запуск. */
-    bool ok = exec_from_bytes(buffer, st.st_size, argc, argv);
+    /* Делегируем запуск, буфер освободит загрузчик. */
+    return exec_buffer(buffer, size, argc, argv);
+}
 
-    free(buffer);
-    return ok;
+bool exec_from_bytes(const uint8_t *data, size_t size,
+                     int argc, char **argv)
+{
+    return exec_chain(exec_bytes(data, size, argc, argv));
+}
+
+bool exec_from_buffer(uint8_t *data, size_t size,
+                      int argc, char **argv)
+{
+    return exec_chain(exec_buffer(data, size, argc, argv));
+}
+
+bool exec_from_file(const char *path,
+                    int argc, char **argv)
+{
+    return exec_chain(exec_file(path, argc, argv));
 }
@@ -19,6 +19,24 @@
 bool exec_from_bytes(const uint8_t *data, size_t size,
                      int argc, char **argv);
 
+/**
+ * @brief Запускает ELF из памяти, забирая буфер себе.
+ *
+ * Если расположение сегментов, выравнивание и тип памяти позволяют,
+ * ELF перемещается прямо внутри `data` без копирования образа.
+ * Буфер освобождается загрузчиком в любом случае, после вызова
+ * обращаться к нему нельзя.
+ *
+ * @param data    буфер с ELF из malloc()/heap_caps_malloc()
+ * @param size    размер буфера; место за концом файла идёт под .bss
+ * @param argc    число аргументов (можно 0)
+ * @param argv    массив строк-аргументов (можно NULL)
+ * @return true   – ELF успешно запущен
+ *         false  – ошибка
+ */
+bool exec_from_buffer(uint8_t *data, size_t size,
+                      int argc, char **argv);
+
 /**
  * @brief Читает файл по `path` и запускает его как ELF.
  *
@@ -31,5 +49,24 @@ bool exec_from_bytes(const uint8_t *data, size_t size,
 bool exec_from_file(const char *path,
                     int argc, char **argv);
 
+/**
+ * @brief Заменяет работающий ELF другим, не возвращаясь в app_main.
+ *
+ * Вызывается из задачи, в которой загрузчик запустил текущий ELF.
+ * Стек приложения сбрасывается, его образ освобождается, затем новый
+ * ELF загружается на освободившееся место и получает управление.
+ * Монтирования, драйверы vtty и зарегистрированные символы остаются.
+ * Перед вызовом приложение должно остановить свои задачи и отпустить
+ * блокировки – их код и данные исчезнут вместе с образом.
+ *
+ * @param path    путь к новому ELF
+ * @param argv    аргументы, массив заканчивается NULL (можно NULL)
+ * @return        при успехе не возвращается;
+ *                ESP_ERR_INVALID_STATE – вызов не из задачи ELF,
+ *                ESP_ERR_NOT_FOUND     – файла нет,
+ *                ESP_ERR_NO_MEM        – не хватило памяти
+ */
+int launchpad_exec(const char *path, char *const argv[]);
+
 #endif /* EXEC_H */
 /* ──────────────────────────────────────────────── */
@@ -0,0 +1,83 @@
+/* -------------------------------------------------------------
+ * launchpad_alloc_api.h
+ *
+ * Tiered allocator exported to loaded ELF modules.
+ *
+ *   - up to LAUNCHPAD_ALLOC_SLAB_MAX bytes: size-class slabs in
+ *     internal SRAM, with a per-core cache of free objects in
+ *     front of each class, so the common alloc/free pair takes
+ *     no lock and has no per-block header;
+ *   - from CONFIG_LAUNCHPAD_ALLOC_PSRAM_MIN bytes: PSRAM, keeping
+ *     internal RAM free for DMA buffers and task stacks;
+ *   - in between: the regular heap.
+ *
+ * Every tier falls back to the next one when it is exhausted.
+ * The slab pool is only reserved on the first small request.
+ * Blocks from any of these functions are released with
+ * launchpad_free(), which also accepts pointers from the app's
+ * malloc(), arena blocks included; the app's free() accepts
+ * blocks from these functions in turn.
+ * launchpad_realloc() places the block by its new size, like
+ * launchpad_malloc(), so it drops DMA placement and alignment.
+ * ------------------------------------------------------------- */
+
+#ifndef LAUNCHPAD_ALLOC_API_H
+#define LAUNCHPAD_ALLOC_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest request served by the slabs */
+#define LAUNCHPAD_ALLOC_SLAB_MAX 512
+
+/* launchpad_malloc_caps() flags */
+typedef enum {
+    LAUNCHPAD_ALLOC_DEFAULT  = 0,
+    LAUNCHPAD_ALLOC_INTERNAL = (1 << 0),   /* internal SRAM only */
+    LAUNCHPAD_ALLOC_PSRAM    = (1 << 1),   /* external RAM only */
+    LAUNCHPAD_ALLOC_DMA      = (1 << 2),   /* DMA-capable internal RAM */
+    LAUNCHPAD_ALLOC_ALIGNED  = (1 << 3),   /* start and size on a cache line */
+    LAUNCHPAD_ALLOC_ZERO     = (1 << 4),   /* zero-filled */
+} launchpad_alloc_flags_t;
+
+/**
+ * @brief Set up the size classes and register the allocator for ELF lookup.
+ *
+ * Must be called before any ELF is relocated (done by launchpad_init()).
+ */
+void launchpad_alloc_init(void);
+
+/* --- malloc-compatible entry points, placement by size --- */
+void *launchpad_malloc(size_t size);
+void *launchpad_calloc(size_t nmemb, size_t size);
+void *launchpad_realloc(void *ptr, size_t size);
+void  launchpad_free(void *ptr);
+
+/**
+ * @brief Allocate with explicit placement.
+ *
+ * @param size   bytes
+ * @param flags  OR of launchpad_alloc_flags_t
+ * @return block or NULL; unlike the default path, an explicit
+ *         placement never falls back to another kind of memory
+ */
+void *launchpad_malloc_caps(size_t size, uint32_t flags);
+
+/* --- Cache-line aligned variants (no false sharing, safe for cache sync) --- */
+void *launchpad_malloc_aligned(size_t size);
+void *launchpad_calloc_aligned(size_t nmemb, size_t size);
+
+/**
+ * @brief Line size used by the aligned variants (the outermost cache).
+ */
+size_t launchpad_cache_line_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHPAD_ALLOC_API_H */
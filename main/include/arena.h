@@ -0,0 +1,109 @@
+/* -------------------------------------------------------------
+ * launchpad_arena_api.h
+ *
+ * Per-app heap arenas. Every loaded ELF gets a private TLSF heap
+ * carved from the arena pool (CONFIG_LAUNCHPAD_APP_ARENA_*); the
+ * malloc, calloc, realloc and free it imports are served from it.
+ * When the app exits the whole arena is released at once, so
+ * leaks never outlive the app and its small blocks never mix
+ * with firmware allocations.
+ *
+ * Allocations are matched to their app by the caller's address,
+ * or, for a caller outside every image (a tail call, malloc passed
+ * to firmware as a callback), by the task: the one the app was
+ * started in and those it created with xTaskCreate*() or
+ * pthread_create().
+ *
+ * Only the app's own malloc family is routed. Memory that firmware
+ * or libc allocates for the app (strdup(), fopen(), lwip, ...) comes
+ * from the global heap, is not released with the arena and leaks
+ * unless the app frees it. Pointers that did not come from an arena
+ * are passed on to launchpad_free()/launchpad_realloc(). Arena blocks
+ * must be freed by the app itself or with launchpad_free(), never
+ * by firmware code calling free().
+ *
+ * Tasks and pthreads the app creates must end before it returns.
+ * While one is alive the arena is not released (and the loader keeps
+ * the image), since it would run on freed memory. A pthread counts
+ * from pthread_create() until its start routine returns or it calls
+ * pthread_exit(). Static tasks (xTaskCreateStatic) are not tracked.
+ * ------------------------------------------------------------- */
+
+#ifndef LAUNCHPAD_ARENA_API_H
+#define LAUNCHPAD_ARENA_API_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Apps that may own an arena at the same time */
+#ifndef LAUNCHPAD_ARENA_MAX
+#define LAUNCHPAD_ARENA_MAX 4
+#endif
+
+typedef struct {
+    size_t   total_bytes;          /* arena size */
+    size_t   free_bytes;           /* currently free */
+    size_t   largest_free_block;   /* biggest single allocation possible now */
+    size_t   minimum_free_bytes;   /* low-water mark of free_bytes */
+    size_t   allocated_blocks;     /* live allocations */
+    size_t   free_blocks;          /* free fragments */
+    uint32_t fragmentation;        /* 0..100, 100 - largest_free_block / free_bytes */
+} launchpad_arena_stats_t;
+
+/**
+ * @brief Register malloc/calloc/realloc/free for ELF lookup.
+ *
+ * Must be called before any ELF is relocated (done by launchpad_init()).
+ */
+void launchpad_arena_init(void);
+
+/**
+ * @brief Give a relocated ELF its arena.
+ *
+ * @param image  first byte of the loaded image
+ * @param size   image size in bytes
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the app has to use the global heap
+ */
+esp_err_t launchpad_arena_attach(const void *image, size_t size);
+
+/**
+ * @brief Release the arena of an image, with everything still allocated in it.
+ *
+ * @param image  first byte of the loaded image, as passed to attach
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if tasks created by the app
+ *         are still alive: the arena is kept and the image must be too
+ */
+esp_err_t launchpad_arena_detach(const void *image);
+
+/**
+ * @brief Tell whether @p ptr lies in an app arena.
+ */
+bool launchpad_arena_owns(const void *ptr);
+
+/**
+ * @brief Resize / release an arena block; for launchpad_realloc()/free().
+ *
+ * @p ptr must satisfy launchpad_arena_owns().
+ */
+void *launchpad_arena_realloc(void *ptr, size_t size);
+void  launchpad_arena_free(void *ptr);
+
+/**
+ * @brief Usage of the calling app's arena.
+ *
+ * @param out  filled on success
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if the caller has no arena
+ */
+esp_err_t launchpad_arena_stats(launchpad_arena_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHPAD_ARENA_API_H */
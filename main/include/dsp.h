@@ -0,0 +1,111 @@
+/* -------------------------------------------------------------
+ * launchpad_dsp_api.h
+ *
+ * Signal-processing kernels exported to loaded ELF modules.
+ *
+ * Every kernel has a scalar reference implementation and an
+ * accelerated one (unrolled, multiple independent accumulators,
+ * fused multiply-add on cores with a hardware FPU).  The variant
+ * is chosen once by launchpad_dsp_init() from the platform
+ * descriptor and the selected function is registered directly
+ * under its launchpad_dsp_* name.
+ *
+ * Complex data is interleaved: { re0, im0, re1, im1, ... }.
+ * All functions return 0 on success and a negative value on
+ * invalid arguments, unless noted otherwise.
+ * ------------------------------------------------------------- */
+
+#ifndef LAUNCHPAD_DSP_API_H
+#define LAUNCHPAD_DSP_API_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest FFT size supported by launchpad_dsp_fft_init() */
+#ifndef LAUNCHPAD_DSP_FFT_MAX
+#define LAUNCHPAD_DSP_FFT_MAX 4096
+#endif
+
+/** FIR filter state (float). */
+typedef struct {
+    const float *coeffs;        /* ntaps coefficients                  */
+    float       *delay;         /* ntaps samples, owned by the caller  */
+    int          ntaps;
+    int          pos;           /* next write position in delay line   */
+} launchpad_dsp_fir_f32_t;
+
+/** FIR filter state (Q15). */
+typedef struct {
+    const int16_t *coeffs;      /* ntaps Q15 coefficients              */
+    int16_t       *delay;       /* ntaps samples, owned by the caller  */
+    int            ntaps;
+    int            pos;
+    int            shift;       /* output = acc >> shift, saturated    */
+} launchpad_dsp_fir_s16_t;
+
+/**
+ * @brief Select kernels and register them for ELF lookup.
+ */
+void launchpad_dsp_init(void);
+
+/**
+ * @brief Name of the selected implementation ("fpu" or "scalar").
+ */
+const char *launchpad_dsp_impl(void);
+
+/* --- Dot product --- */
+float   launchpad_dsp_dot_f32(const float *a, const float *b, int len);
+int32_t launchpad_dsp_dot_s16(const int16_t *a, const int16_t *b, int len, int shift);
+
+/* --- FIR --- */
+int launchpad_dsp_fir_init_f32(launchpad_dsp_fir_f32_t *fir, const float *coeffs,
+                               float *delay, int ntaps);
+int launchpad_dsp_fir_f32(launchpad_dsp_fir_f32_t *fir, const float *in, float *out, int len);
+int launchpad_dsp_fir_init_s16(launchpad_dsp_fir_s16_t *fir, const int16_t *coeffs,
+                               int16_t *delay, int ntaps, int shift);
+int launchpad_dsp_fir_s16(launchpad_dsp_fir_s16_t *fir, const int16_t *in, int16_t *out, int len);
+
+/**
+ * @brief Biquad section, direct form II transposed.
+ *
+ * @param coef { b0, b1, b2, a1, a2 } (a0 normalised to 1)
+ * @param w    two state values, zero-initialised by the caller
+ */
+int launchpad_dsp_biquad_f32(const float *in, float *out, int len,
+                             const float coef[5], float w[2]);
+
+/* --- FFT (in place, forward, complex float) --- */
+
+/**
+ * @brief Build the twiddle table for transforms up to @p max_n points.
+ *
+ * @param max_n power of two, <= LAUNCHPAD_DSP_FFT_MAX
+ */
+int launchpad_dsp_fft_init(int max_n);
+void launchpad_dsp_fft_deinit(void);
+
+/** Radix-2 FFT; @p n is a power of two. */
+int launchpad_dsp_fft2r_f32(float *data, int n);
+/** Radix-4 FFT; @p n is a power of four. */
+int launchpad_dsp_fft4r_f32(float *data, int n);
+
+/* --- Matrix multiply: C[m x k] = A[m x n] * B[n x k], row-major --- */
+int launchpad_dsp_mat_mul_f32(const float *A, const float *B, float *C,
+                              int m, int n, int k);
+
+/**
+ * @brief Run every kernel through both paths and log cycles/sample.
+ *
+ * Also reports the maximum deviation of the accelerated path
+ * from the scalar reference.
+ */
+void launchpad_dsp_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHPAD_DSP_API_H */
@@ -0,0 +1,54 @@
+/* -------------------------------------------------------------
+ * launchpad_fmath_api.h
+ *
+ * Single-precision libm entry points exported to loaded ELF
+ * modules under their standard names (sinf, cosf, expf, exp2f,
+ * logf, log2f, log10f, atanf, atan2f).
+ *
+ * On cores with a hardware single-precision FPU they are served
+ * by float-only kernels (Cody-Waite range reduction plus short
+ * minimax polynomials, max error ~3 ulp, errno is not set);
+ * elsewhere, and for arguments outside the fast range, the
+ * newlib implementations are used.
+ * ------------------------------------------------------------- */
+
+#ifndef LAUNCHPAD_FMATH_API_H
+#define LAUNCHPAD_FMATH_API_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* |x| above which sinf/cosf defer to newlib (argument reduction) */
+#ifndef LAUNCHPAD_FMATH_TRIG_MAX
+#define LAUNCHPAD_FMATH_TRIG_MAX 8192.0f
+#endif
+
+/**
+ * @brief Select float math routines and register them for ELF lookup.
+ *
+ * Must be called before any ELF is relocated (done by launchpad_init()).
+ */
+void launchpad_fmath_init(void);
+
+/* --- Float-only kernels (always available for direct use) --- */
+float launchpad_fast_sinf(float x);
+float launchpad_fast_cosf(float x);
+float launchpad_fast_expf(float x);
+float launchpad_fast_exp2f(float x);
+float launchpad_fast_logf(float x);
+float launchpad_fast_log2f(float x);
+float launchpad_fast_log10f(float x);
+float launchpad_fast_atanf(float x);
+float launchpad_fast_atan2f(float y, float x);
+
+/**
+ * @brief Name of the selected implementation ("fpu" or "newlib").
+ */
+const char *launchpad_fmath_impl(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHPAD_FMATH_API_H */
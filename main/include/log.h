@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,6 +28,44 @@ enum {
  */
 int launchpad_log(int level, const char *tag, const char *fmt, ...);
 
+/* Режимы launchpad_log() */
+enum {
+    LAUNCHPAD_LOG_MODE_SYNC     = 0,    /* форматирование сразу, в задаче вызывающего */
+    LAUNCHPAD_LOG_MODE_DEFERRED = 1,    /* бинарная запись в кольцо, печатает фоновая задача */
+};
+
+/* Счётчики отложенного режима */
+struct launchpad_log_stats {
+    uint32_t records;       /* напечатано из колец */
+    uint32_t dropped;       /* потеряно: кольцо было полно */
+    uint32_t sync;          /* напечатано сразу: формат не поддерживается */
+};
+
+/**
+ * @brief Выбор режима логирования.
+ *
+ * В отложенном режиме вызов пишет время, указатели на тег и формат и
+ * аргументы (%s копируется, до 32 байт) в кольцо своего ядра. Форматы
+ * с %n, long double, wide-строками или больше чем 8 аргументами
+ * печатаются сразу, как и вызовы, у которых тег или формат лежат не в
+ * образе ELF и не во flash (на стеке, в куче). При полном кольце
+ * сообщение теряется.
+ *
+ * @return 0 при успехе, 1 при ошибке
+ */
+int launchpad_log_set_mode(int mode);
+
+/** @brief Напечатать всё, что накопилось в кольцах. */
+void launchpad_log_flush(void);
+
+int launchpad_log_get_stats(struct launchpad_log_stats *st);
+
+/* Для exec.c: образ ELF, из которого можно брать строки без копирования */
+void launchpad_log_app_enter(const void *image, size_t size);
+
+/* Для exec.c: допечатать записи завершившегося ELF и забыть его форматы */
+void launchpad_log_app_exit(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,52 @@
+/* -------------------------------------------------------------
+ * launchpad_mem_api.h
+ *
+ * Accelerated memory/string primitives exported to loaded ELF
+ * modules under their standard libc names (memcpy, memset,
+ * memcmp, strlen, strcmp).
+ *
+ * The implementation is chosen once by launchpad_mem_init() from
+ * the platform descriptor: on cores with a 128-bit SIMD unit
+ * (LAUNCHPAD_HW_SIMD_SUPPORT, e.g. ESP32-P4 PIE) large aligned
+ * blocks go through vector loads/stores, everything else falls
+ * back to the plain newlib routines.
+ * ------------------------------------------------------------- */
+
+#ifndef LAUNCHPAD_MEM_API_H
+#define LAUNCHPAD_MEM_API_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Minimal block size (bytes) for which the SIMD path is used. */
+#ifndef LAUNCHPAD_MEM_SIMD_MIN
+#define LAUNCHPAD_MEM_SIMD_MIN 64
+#endif
+
+/**
+ * @brief Select memory primitives and register them for ELF lookup.
+ *
+ * Must be called before any ELF is relocated (done by launchpad_init()).
+ */
+void launchpad_mem_init(void);
+
+/* --- Currently selected implementations --- */
+void  *launchpad_memcpy(void *dst, const void *src, size_t n);
+void  *launchpad_memset(void *dst, int c, size_t n);
+int    launchpad_memcmp(const void *a, const void *b, size_t n);
+size_t launchpad_strlen(const char *s);
+int    launchpad_strcmp(const char *a, const char *b);
+
+/**
+ * @brief Name of the selected implementation ("pie" or "scalar").
+ */
+const char *launchpad_mem_impl(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHPAD_MEM_API_H */
@@ -3,16 +3,29 @@
 #include "elf/esp_elf.h"
 #include "platform.h"
 #include "launchpad_vtty.h"
+#include "launchpad_vtty_screen.h"
+#include "launchpad_vtty_fb.h"
+#include "exec.h"
 
 #include "include/log.h"
 #include "include/flash.h"
 #include "include/sd.h"
 #include "include/partition.h"
 #include "include/rootfs.h"
+#include "include/mem.h"
+#include "include/dsp.h"
+#include "include/fmath.h"
+#include "include/alloc.h"
+#include "include/arena.h"
 
 void launchpad_init(void)
 {
     launchpad_vtty_init();
+    launchpad_mem_init();
+    launchpad_dsp_init();
+    launchpad_fmath_init();
+    launchpad_alloc_init();
+    launchpad_arena_init();
 
     /* Register vTTY symbols for dynamic lookup */
     _register_symbol("launchpad_vtty_init", (void *)launchpad_vtty_init);
@@ -25,18 +38,47 @@ void launchpad_init(void)
     _register_symbol("launchpad_vtty_putc", (void *)launchpad_vtty_putc);
     _register_symbol("launchpad_vtty_putchar", (void *)launchpad_vtty_putchar);
     _register_symbol("launchpad_vtty_puts", (void *)launchpad_vtty_puts);
+    _register_symbol("launchpad_vtty_write", (void *)launchpad_vtty_write);
     _register_symbol("launchpad_vtty_printf", (void *)launchpad_vtty_printf);
+    _register_symbol("launchpad_vtty_vprintf", (void *)launchpad_vtty_vprintf);
     _register_symbol("launchpad_vtty_flush", (void *)launchpad_vtty_flush);
     _register_symbol("launchpad_vtty_getc", (void *)launchpad_vtty_getc);
+    _register_symbol("launchpad_vtty_getchar", (void *)launchpad_vtty_getchar);
+    _register_symbol("launchpad_vtty_getc_timeout", (void *)launchpad_vtty_getc_timeout);
+    _register_symbol("launchpad_vtty_read", (void *)launchpad_vtty_read);
     _register_symbol("launchpad_vtty_available", (void *)launchpad_vtty_available);
+    _register_symbol("launchpad_vtty_readline", (void *)launchpad_vtty_readline);
     _register_symbol("launchpad_vtty_clear_screen", (void *)launchpad_vtty_clear_screen);
     _register_symbol("launchpad_vtty_move_cursor", (void *)launchpad_vtty_move_cursor);
     _register_symbol("launchpad_vtty_set_baudrate", (void *)launchpad_vtty_set_baudrate);
     _register_symbol("launchpad_vtty_is_ready", (void *)launchpad_vtty_is_ready);
     _register_symbol("launchpad_vtty_set_callback", (void *)launchpad_vtty_set_callback);
     _register_symbol("launchpad_vtty_ioctl", (void *)launchpad_vtty_ioctl);
+    _register_symbol("launchpad_vtty_sink_add", (void *)launchpad_vtty_sink_add);
+    _register_symbol("launchpad_vtty_sink_add_driver", (void *)launchpad_vtty_sink_add_driver);
+    _register_symbol("launchpad_vtty_sink_add_file", (void *)launchpad_vtty_sink_add_file);
+    _register_symbol("launchpad_vtty_sink_add_tcp", (void *)launchpad_vtty_sink_add_tcp);
+    _register_symbol("launchpad_vtty_sink_remove", (void *)launchpad_vtty_sink_remove);
+    _register_symbol("launchpad_vtty_bind_stdio", (void *)launchpad_vtty_bind_stdio);
+
+    _register_symbol("launchpad_vtty_screen_create", (void *)launchpad_vtty_screen_create);
+    _register_symbol("launchpad_vtty_screen_destroy", (void *)launchpad_vtty_screen_destroy);
+    _register_symbol("launchpad_vtty_screen_clear", (void *)launchpad_vtty_screen_clear);
+    _register_symbol("launchpad_vtty_screen_set_style", (void *)launchpad_vtty_screen_set_style);
+    _register_symbol("launchpad_vtty_screen_putc", (void *)launchpad_vtty_screen_putc);
+    _register_symbol("launchpad_vtty_screen_puts", (void *)launchpad_vtty_screen_puts);
+    _register_symbol("launchpad_vtty_screen_fill", (void *)launchpad_vtty_screen_fill);
+    _register_symbol("launchpad_vtty_screen_set_cursor", (void *)launchpad_vtty_screen_set_cursor);
+    _register_symbol("launchpad_vtty_screen_invalidate", (void *)launchpad_vtty_screen_invalidate);
+    _register_symbol("launchpad_vtty_screen_present", (void *)launchpad_vtty_screen_present);
+    _register_symbol("launchpad_vtty_screen_present_to", (void *)launchpad_vtty_screen_present_to);
+
+    _register_symbol("launchpad_vtty_fb_get_stats", (void *)launchpad_vtty_fb_get_stats);
 
     _register_symbol("launchpad_log", (void *)launchpad_log);
+    _register_symbol("launchpad_log_set_mode", (void *)launchpad_log_set_mode);
+    _register_symbol("launchpad_log_flush", (void *)launchpad_log_flush);
+    _register_symbol("launchpad_log_get_stats", (void *)launchpad_log_get_stats);
 
     _register_symbol("launchpad_flash_size",            (void*)launchpad_flash_size);
     _register_symbol("launchpad_flash_erase",           (void*)launchpad_flash_erase);
@@ -69,8 +111,31 @@ void launchpad_init(void)
     /* Standard stdio names mapped to vTTY for loaded ELF modules */
     _register_symbol("puts", (void *)launchpad_vtty_puts);
     _register_symbol("printf", (void *)launchpad_vtty_printf);
+    _register_symbol("vprintf", (void *)launchpad_vtty_vprintf);
     _register_symbol("putchar", (void *)launchpad_vtty_putchar);
-    _register_symbol("getchar", (void *)launchpad_vtty_getc);
+    _register_symbol("getchar", (void *)launchpad_vtty_getchar);
+
+    _register_symbol("launchpad_memcpy",   (void *)launchpad_memcpy);
+    _register_symbol("launchpad_memset",   (void *)launchpad_memset);
+    _register_symbol("launchpad_memcmp",   (void *)launchpad_memcmp);
+    _register_symbol("launchpad_strlen",   (void *)launchpad_strlen);
+    _register_symbol("launchpad_strcmp",   (void *)launchpad_strcmp);
+    _register_symbol("launchpad_mem_impl", (void *)launchpad_mem_impl);
+
+    /* DSP kernels themselves are registered by launchpad_dsp_init() */
+    _register_symbol("launchpad_dsp_impl",         (void *)launchpad_dsp_impl);
+    _register_symbol("launchpad_dsp_fir_init_f32", (void *)launchpad_dsp_fir_init_f32);
+    _register_symbol("launchpad_dsp_fir_init_s16", (void *)launchpad_dsp_fir_init_s16);
+    _register_symbol("launchpad_dsp_fft_init",     (void *)launchpad_dsp_fft_init);
+    _register_symbol("launchpad_dsp_fft_deinit",   (void *)launchpad_dsp_fft_deinit);
+    _register_symbol("launchpad_dsp_benchmark",    (void *)launchpad_dsp_benchmark);
+
+    _register_symbol("launchpad_fmath_impl", (void *)launchpad_fmath_impl);
+
+    /* malloc/calloc/realloc/free are registered by launchpad_arena_init() */
+    _register_symbol("launchpad_arena_stats", (void *)launchpad_arena_stats);
 
     _register_symbol("launchpad_platform", (void *)launchpad_platform);
+
+    _register_symbol("launchpad_exec", (void *)launchpad_exec);
 }
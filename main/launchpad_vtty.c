@@ -1,18 +1,45 @@
 #include "launchpad_vtty.h"
+#include "launchpad_vtty_queue.h"
+#include "launchpad_vtty_vfs.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <unistd.h>
+#include <sys/select.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 #ifndef LAUNCHPAD_VTTY_MAX_DRIVERS
 #define LAUNCHPAD_VTTY_MAX_DRIVERS 8
 #endif
 
+/* Line discipline: longest editable line and lines kept for recall */
+#ifndef LAUNCHPAD_VTTY_LINE_MAX
+#define LAUNCHPAD_VTTY_LINE_MAX 128
+#endif
+
+#ifndef LAUNCHPAD_VTTY_HISTORY
+#define LAUNCHPAD_VTTY_HISTORY 8
+#endif
+
 static const struct vtty_driver *g_drivers[LAUNCHPAD_VTTY_MAX_DRIVERS];
 static struct launchpad_vtty_info g_infos[LAUNCHPAD_VTTY_MAX_DRIVERS];
 static int g_driver_count = 0;
 static int g_current_index = -1;
 static launchpad_vtty_event_cb_t g_event_cb = NULL;
+/* Held around calls into g_event_cb, so clearing it waits them out */
+static SemaphoreHandle_t g_event_lock;
+static StaticSemaphore_t g_event_lock_buf;
+
+static void ldisc_deinit(void);
 
 /* -------------------------------------------------------------------------- */
 /* Default stdio driver                                                       */
@@ -32,6 +59,11 @@ static int stdio_puts(const char *s)
     return (int)strlen(s);
 }
 
+static int stdio_write(const char *buf, size_t len)
+{
+    return (int)fwrite(buf, 1, len, stdout);
+}
+
 static void stdio_flush(void)
 {
     fflush(stdout);
@@ -43,9 +75,31 @@ static int stdio_getc(void)
     return (c == EOF) ? -1 : c;
 }
 
+/* Wait up to @timeout_ms (< 0: forever) for stdin to become readable */
+static int stdio_poll(int timeout_ms)
+{
+    fd_set rfds;
+    struct timeval tv = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+
+    FD_ZERO(&rfds);
+    FD_SET(STDIN_FILENO, &rfds);
+    return select(STDIN_FILENO + 1, &rfds, NULL, NULL, timeout_ms < 0 ? NULL : &tv) > 0;
+}
+
+static int stdio_read(char *buf, size_t len, int timeout_ms)
+{
+    if (!stdio_poll(timeout_ms))
+        return 0;
+    ssize_t n = read(STDIN_FILENO, buf, len);
+    return (n < 0) ? -1 : (int)n;
+}
+
 static int stdio_available(void)
 {
-    return 1; /* stdin is always available in this stub */
+    return stdio_poll(0);
 }
 
 static void stdio_clear_screen(void)
@@ -70,8 +124,10 @@ static const struct vtty_driver stdio_driver = {
     .deinit = NULL,
     .putc = stdio_putc,
     .puts = stdio_puts,
+    .write = stdio_write,
     .flush = stdio_flush,
     .getc = stdio_getc,
+    .read = stdio_read,
     .available = stdio_available,
     .clear_screen = stdio_clear_screen,
     .move_cursor = stdio_move_cursor,
@@ -81,10 +137,81 @@ static const struct vtty_driver stdio_driver = {
     .ioctl = NULL,
 };
 
+/* -------------------------------------------------------------------------- */
+/* Output delivery (called by the queue flush task)                           */
+/* -------------------------------------------------------------------------- */
+
+void vtty_deliver(int idx, const char *buf, size_t len)
+{
+    if (idx < 0 || idx >= g_driver_count)
+        return;
+
+    const struct vtty_driver *drv = g_drivers[idx];
+    size_t off = 0;
+
+    while (off < len) {
+        int n;
+
+        if (drv->write) {
+            n = drv->write(buf + off, len - off);
+        } else if (drv->putc) {
+            n = drv->putc(buf[off]) < 0 ? -1 : 1;
+        } else {
+            n = -1;
+        }
+        if (n <= 0)
+            break;  /* driver gone or broken: drop the rest */
+        off += n;
+    }
+}
+
+static int driver_sink_write(void *ctx, const char *buf, size_t len)
+{
+    vtty_deliver((int)(intptr_t)ctx, buf, len);
+    return 0;
+}
+
+/* Mirror all output to another registered driver, e.g. a second UART */
+int launchpad_vtty_sink_add_driver(int id)
+{
+    for (int i = 0; i < g_driver_count; ++i) {
+        if (g_infos[i].id == id)
+            return vtty_sink_track(vtty_queue_add_sink(g_infos[i].type, driver_sink_write, NULL,
+                                                       (void *)(intptr_t)i));
+    }
+    return -1;
+}
+
 /* -------------------------------------------------------------------------- */
 /* Core management                                                            */
 /* -------------------------------------------------------------------------- */
 
+/* Driver events carry no driver, so each slot gets its own entry point */
+static void vtty_event(int idx, int event)
+{
+    if (event == LAUNCHPAD_VTTY_EVENT_DATA)
+        vtty_vfs_notify(idx);
+    if (idx != g_current_index || !g_event_cb)
+        return;
+
+    /* Recursive: the callback may replace itself */
+    xSemaphoreTakeRecursive(g_event_lock, portMAX_DELAY);
+    if (g_event_cb)
+        g_event_cb(event);
+    xSemaphoreGiveRecursive(g_event_lock);
+}
+
+#define VTTY_EVENT_ENTRY(n) static void vtty_event_##n(int event) { vtty_event(n, event); }
+VTTY_EVENT_ENTRY(0) VTTY_EVENT_ENTRY(1) VTTY_EVENT_ENTRY(2) VTTY_EVENT_ENTRY(3)
+VTTY_EVENT_ENTRY(4) VTTY_EVENT_ENTRY(5) VTTY_EVENT_ENTRY(6) VTTY_EVENT_ENTRY(7)
+
+_Static_assert(LAUNCHPAD_VTTY_MAX_DRIVERS <= 8, "add event entries for more driver slots");
+
+static const launchpad_vtty_event_cb_t g_event_entries[] = {
+    vtty_event_0, vtty_event_1, vtty_event_2, vtty_event_3,
+    vtty_event_4, vtty_event_5, vtty_event_6, vtty_event_7,
+};
+
 int launchpad_vtty_register_driver(const struct vtty_driver *drv)
 {
     if (!drv || g_driver_count >= LAUNCHPAD_VTTY_MAX_DRIVERS)
@@ -96,6 +223,8 @@ int launchpad_vtty_register_driver(const struct vtty_driver *drv)
 
     if (drv->init)
         drv->init();
+    if (drv->set_callback)
+        drv->set_callback(g_event_entries[g_driver_count]);
 
     g_driver_count++;
     return 0;
@@ -105,6 +234,7 @@ int launchpad_vtty_set_default(int id)
 {
     for (int i = 0; i < g_driver_count; ++i) {
         if (g_infos[i].id == id) {
+            vtty_queue_sync();
             g_current_index = i;
             return 0;
         }
@@ -129,21 +259,31 @@ const struct launchpad_vtty_info *launchpad_vtty_list(int *cnt)
 
 int launchpad_vtty_init(void)
 {
+    /* Without the queue, output goes to the drivers directly */
+    vtty_queue_init();
+
+    if (!g_event_lock)
+        g_event_lock = xSemaphoreCreateRecursiveMutexStatic(&g_event_lock_buf);
+
     g_driver_count = 0;
     g_current_index = -1;
     g_event_cb = NULL;
     launchpad_vtty_register_driver(&stdio_driver);
     launchpad_vtty_register_uart(1, 38, 48, 115200);
     launchpad_vtty_set_default(1);
+    vtty_vfs_register();
     return 0;
 }
 
 int launchpad_vtty_deinit(void)
 {
+    vtty_queue_deinit();
+
     for (int i = 0; i < g_driver_count; ++i) {
         if (g_drivers[i] && g_drivers[i]->deinit)
             g_drivers[i]->deinit();
     }
+    ldisc_deinit();
     g_driver_count = 0;
     g_current_index = -1;
     g_event_cb = NULL;
@@ -163,10 +303,11 @@ static const struct vtty_driver *current_driver(void)
 
 int launchpad_vtty_putc(char c)
 {
-    const struct vtty_driver *drv = current_driver();
-    if (!drv || !drv->putc)
+    int idx = g_current_index;
+    if (idx < 0 || idx >= g_driver_count)
         return -1;
-    return drv->putc(c);
+
+    return vtty_queue_write(idx, &c, 1) < 0 ? -1 : 0;
 }
 
 int launchpad_vtty_putchar(char c)
@@ -174,42 +315,51 @@ int launchpad_vtty_putchar(char c)
     return launchpad_vtty_putc(c);
 }
 
+int launchpad_vtty_write(const char *buf, size_t len)
+{
+    int idx = g_current_index;
+    if (!buf || idx < 0 || idx >= g_driver_count)
+        return -1;
+
+    return vtty_queue_write(idx, buf, len);
+}
+
 int launchpad_vtty_puts(const char *s)
 {
-    const struct vtty_driver *drv = current_driver();
-    if (!drv)
+    if (!s)
         return -1;
-    if (drv->puts)
-        return drv->puts(s);
-    /* Fallback using putc */
-    int count = 0;
-    while (s && *s) {
-        if (drv->putc)
-            drv->putc(*s++);
-        else
-            return -1;
-        count++;
-    }
-    return count;
+    return launchpad_vtty_write(s, strlen(s));
+}
+
+int launchpad_vtty_vprintf(const char *fmt, va_list ap)
+{
+    int idx = g_current_index;
+    if (!fmt || idx < 0 || idx >= g_driver_count)
+        return -1;
+
+    /* Formatted straight into one queue record, never interleaved */
+    return vtty_queue_vprintf(idx, fmt, ap);
 }
 
 int launchpad_vtty_printf(const char *fmt, ...)
 {
-    char buffer[256];
     va_list ap;
     va_start(ap, fmt);
-    int len = vsnprintf(buffer, sizeof(buffer), fmt, ap);
+    int len = launchpad_vtty_vprintf(fmt, ap);
     va_end(ap);
-    if (len < 0)
-        return -1;
-    return launchpad_vtty_puts(buffer);
+    return len;
+}
+
+void vtty_slot_flush(int idx)
+{
+    vtty_queue_sync();
+    if (idx >= 0 && idx < g_driver_count && g_drivers[idx]->flush)
+        g_drivers[idx]->flush();
 }
 
 void launchpad_vtty_flush(void)
 {
-    const struct vtty_driver *drv = current_driver();
-    if (drv && drv->flush)
-        drv->flush();
+    vtty_slot_flush(g_current_index);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -221,15 +371,335 @@ int launchpad_vtty_getc(void)
     const struct vtty_driver *drv = current_driver();
     if (!drv || !drv->getc)
         return -1;
+    vtty_queue_sync();   /* show the prompt before waiting */
     return drv->getc();
 }
 
-int launchpad_vtty_available(void)
+int launchpad_vtty_getc_timeout(int timeout_ms)
 {
-    const struct vtty_driver *drv = current_driver();
-    if (!drv || !drv->available)
+    char c;
+    int n = launchpad_vtty_read(&c, 1, timeout_ms);
+    return (n == 1) ? (unsigned char)c : -1;
+}
+
+int launchpad_vtty_getchar(void)
+{
+    return launchpad_vtty_getc_timeout(-1);
+}
+
+int vtty_slot_read(int idx, char *buf, size_t len, int timeout_ms)
+{
+    if (idx < 0 || idx >= g_driver_count || !buf)
+        return -1;
+
+    const struct vtty_driver *drv = g_drivers[idx];
+    if (!len)
         return 0;
-    return drv->available();
+    vtty_queue_sync();
+
+    if (drv->read)
+        return drv->read(buf, len, timeout_ms);
+    if (!drv->getc)
+        return -1;
+
+    /* Driver without blocking input: poll once per tick */
+    TickType_t start = xTaskGetTickCount();
+    int c;
+    while ((c = drv->getc()) < 0) {
+        if (timeout_ms >= 0 && xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms))
+            return 0;
+        vTaskDelay(1);
+    }
+
+    size_t n = 0;
+    do {
+        buf[n++] = (char)c;
+    } while (n < len && (c = drv->getc()) >= 0);
+    return (int)n;
+}
+
+int launchpad_vtty_read(char *buf, size_t len, int timeout_ms)
+{
+    return vtty_slot_read(g_current_index, buf, len, timeout_ms);
+}
+
+int vtty_slot_available(int idx)
+{
+    if (idx < 0 || idx >= g_driver_count || !g_drivers[idx]->available)
+        return 0;
+    return g_drivers[idx]->available();
+}
+
+int vtty_slot_count(void)
+{
+    return g_driver_count;
+}
+
+int launchpad_vtty_available(void)
+{
+    return vtty_slot_available(g_current_index);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Line discipline                                                            */
+/* -------------------------------------------------------------------------- */
+
+#define LDISC_DEFAULT_FLAGS (LAUNCHPAD_VTTY_LDISC_ECHO | LAUNCHPAD_VTTY_LDISC_HISTORY)
+
+/* One per driver slot, allocated on its first use; everything from
+ * flags on is cleared when an app exits */
+struct vtty_ldisc {
+    int idx;                    /* driver slot it reads and echoes on */
+    SemaphoreHandle_t lock;     /* held by the readline() in progress */
+    StaticSemaphore_t lock_buf;
+    int flags;
+    char line[LAUNCHPAD_VTTY_LINE_MAX];
+    size_t len;
+    bool last_cr;               /* swallow the LF of a CR LF pair */
+    int esc;                    /* 0, 1 after ESC, 2 after ESC [ */
+    char in[32];                /* read ahead, e.g. the rest of a paste */
+    size_t in_pos;
+    size_t in_len;
+    char hist[LAUNCHPAD_VTTY_HISTORY][LAUNCHPAD_VTTY_LINE_MAX];
+    int hist_count;
+    int hist_next;              /* slot the next line goes to */
+    int hist_pos;               /* lines back while browsing, 0: editing */
+};
+
+static struct vtty_ldisc *g_ldisc[LAUNCHPAD_VTTY_MAX_DRIVERS];
+
+static void ldisc_reset(struct vtty_ldisc *ld)
+{
+    memset(&ld->flags, 0, sizeof(*ld) - offsetof(struct vtty_ldisc, flags));
+    ld->flags = LDISC_DEFAULT_FLAGS;
+}
+
+/* State of slot @idx, created on first use */
+static struct vtty_ldisc *ldisc_get(int idx)
+{
+    if (idx < 0 || idx >= g_driver_count)
+        return NULL;
+
+    struct vtty_ldisc *ld = __atomic_load_n(&g_ldisc[idx], __ATOMIC_ACQUIRE);
+    if (ld)
+        return ld;
+
+    ld = calloc(1, sizeof(*ld));
+    if (!ld)
+        return NULL;
+    ld->idx = idx;
+    ld->lock = xSemaphoreCreateMutexStatic(&ld->lock_buf);
+    ldisc_reset(ld);
+
+    /* Two first callers race: the loser uses the winner's state */
+    struct vtty_ldisc *prev = NULL;
+    if (!__atomic_compare_exchange_n(&g_ldisc[idx], &prev, ld, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        vSemaphoreDelete(ld->lock);
+        free(ld);
+        ld = prev;
+    }
+    return ld;
+}
+
+static void ldisc_echo(struct vtty_ldisc *ld, const char *s, size_t n)
+{
+    if (__atomic_load_n(&ld->flags, __ATOMIC_RELAXED) & LAUNCHPAD_VTTY_LDISC_ECHO)
+        vtty_queue_write(ld->idx, s, n);
+}
+
+static void ldisc_erase(struct vtty_ldisc *ld, size_t n)
+{
+    while (n--)
+        ldisc_echo(ld, "\b \b", 3);
+}
+
+/* Replace the edited line with @s, on screen too */
+static void ldisc_set_line(struct vtty_ldisc *ld, const char *s)
+{
+    ldisc_erase(ld, ld->len);
+    ld->len = strnlen(s, LAUNCHPAD_VTTY_LINE_MAX - 1);
+    memcpy(ld->line, s, ld->len);
+    ldisc_echo(ld, ld->line, ld->len);
+}
+
+static void ldisc_history_add(struct vtty_ldisc *ld)
+{
+    if (!ld->len || !(__atomic_load_n(&ld->flags, __ATOMIC_RELAXED) & LAUNCHPAD_VTTY_LDISC_HISTORY))
+        return;
+
+    /* Repeating the previous line does not add an entry */
+    int last = (ld->hist_next + LAUNCHPAD_VTTY_HISTORY - 1) % LAUNCHPAD_VTTY_HISTORY;
+    if (ld->hist_count && !strncmp(ld->hist[last], ld->line, ld->len) && !ld->hist[last][ld->len])
+        return;
+
+    memcpy(ld->hist[ld->hist_next], ld->line, ld->len);
+    ld->hist[ld->hist_next][ld->len] = '\0';
+    ld->hist_next = (ld->hist_next + 1) % LAUNCHPAD_VTTY_HISTORY;
+    if (ld->hist_count < LAUNCHPAD_VTTY_HISTORY)
+        ld->hist_count++;
+}
+
+/* Up (-1 older) or down (+1 newer) through the history */
+static void ldisc_history_move(struct vtty_ldisc *ld, int dir)
+{
+    int pos = ld->hist_pos - dir;
+
+    if (pos < 0 || pos > ld->hist_count)
+        return;
+    ld->hist_pos = pos;
+    if (!pos) {
+        ldisc_set_line(ld, "");
+        return;
+    }
+    int slot = (ld->hist_next + LAUNCHPAD_VTTY_HISTORY - pos) % LAUNCHPAD_VTTY_HISTORY;
+    ldisc_set_line(ld, ld->hist[slot]);
+}
+
+/* Feed one input byte; true when it completed the line */
+static bool ldisc_input(struct vtty_ldisc *ld, char c)
+{
+    bool was_cr = ld->last_cr;
+
+    ld->last_cr = false;
+
+    if (ld->esc == 1) {
+        ld->esc = (c == '[') ? 2 : 0;
+        return false;
+    }
+    if (ld->esc == 2) {
+        if (c >= 0x40 && c <= 0x7E) {   /* final byte of the sequence */
+            ld->esc = 0;
+            if (c == 'A')
+                ldisc_history_move(ld, -1);
+            else if (c == 'B')
+                ldisc_history_move(ld, 1);
+        }
+        return false;
+    }
+
+    switch (c) {
+    case '\n':
+        if (was_cr)
+            return false;
+        /* fall through */
+    case '\r':
+        ld->last_cr = (c == '\r');
+        ldisc_echo(ld, "\r\n", 2);
+        return true;
+    case '\b':
+    case 0x7F:
+        if (ld->len) {
+            ld->len--;
+            ldisc_erase(ld, 1);
+        }
+        return false;
+    case 0x15:                      /* Ctrl-U: whole line */
+        ldisc_erase(ld, ld->len);
+        ld->len = 0;
+        return false;
+    case 0x17: {                    /* Ctrl-W: previous word */
+        size_t n = ld->len;
+        while (n && ld->line[n - 1] == ' ')
+            n--;
+        while (n && ld->line[n - 1] != ' ')
+            n--;
+        ldisc_erase(ld, ld->len - n);
+        ld->len = n;
+        return false;
+    }
+    case 0x1B:
+        ld->esc = 1;
+        return false;
+    default:
+        break;
+    }
+
+    if ((unsigned char)c < 0x20)
+        return false;               /* other control characters are ignored */
+    if (ld->len >= LAUNCHPAD_VTTY_LINE_MAX - 1) {
+        ldisc_echo(ld, "\a", 1);
+        return false;
+    }
+    ld->line[ld->len++] = c;
+    ldisc_echo(ld, &c, 1);
+    return false;
+}
+
+/* Time left of @timeout_ms since @start, < 0 stays forever */
+static int ldisc_wait_left(TickType_t start, int timeout_ms)
+{
+    if (timeout_ms < 0)
+        return timeout_ms;
+    int spent = (int)pdTICKS_TO_MS(xTaskGetTickCount() - start);
+    return spent < timeout_ms ? timeout_ms - spent : 0;
+}
+
+int launchpad_vtty_readline(char *buf, size_t len, int timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    struct vtty_ldisc *ld = ldisc_get(g_current_index);
+    int ret = -1;
+
+    if (!buf || !len || !ld)
+        return -1;
+
+    /* Readers of one slot take turns, each within its own timeout */
+    if (xSemaphoreTake(ld->lock, timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms)) != pdTRUE)
+        return -1;
+
+    /* A line cut short by a timeout is continued by the next call */
+    for (;;) {
+        while (ld->in_pos < ld->in_len) {
+            if (!ldisc_input(ld, ld->in[ld->in_pos++]))
+                continue;
+
+            size_t n = ld->len < len - 1 ? ld->len : len - 1;
+            memcpy(buf, ld->line, n);
+            buf[n] = '\0';
+            ldisc_history_add(ld);
+            ld->len = 0;
+            ld->hist_pos = 0;
+            ret = (int)n;
+            goto out;
+        }
+
+        /* Everything typed or pasted so far comes in one call */
+        int n = vtty_slot_read(ld->idx, ld->in, sizeof(ld->in), ldisc_wait_left(start, timeout_ms));
+        if (n <= 0)
+            goto out;
+        ld->in_pos = 0;
+        ld->in_len = n;
+    }
+
+out:
+    xSemaphoreGive(ld->lock);
+    return ret;
+}
+
+static void ldisc_deinit(void)
+{
+    for (int i = 0; i < LAUNCHPAD_VTTY_MAX_DRIVERS; ++i) {
+        if (g_ldisc[i]) {
+            vSemaphoreDelete(g_ldisc[i]->lock);
+            free(g_ldisc[i]);
+            g_ldisc[i] = NULL;
+        }
+    }
+}
+
+/* An app's half-typed line, history and flags do not outlive it */
+static void ldisc_app_exit(void)
+{
+    for (int i = 0; i < LAUNCHPAD_VTTY_MAX_DRIVERS; ++i) {
+        struct vtty_ldisc *ld = __atomic_load_n(&g_ldisc[i], __ATOMIC_ACQUIRE);
+
+        /* Busy: an app task is still in readline(), and the image stays */
+        if (!ld || xSemaphoreTake(ld->lock, 0) != pdTRUE)
+            continue;
+        ldisc_reset(ld);
+        xSemaphoreGive(ld->lock);
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -239,26 +709,32 @@ int launchpad_vtty_available(void)
 void launchpad_vtty_clear_screen(void)
 {
     const struct vtty_driver *drv = current_driver();
-    if (drv && drv->clear_screen)
+    if (drv && drv->clear_screen) {
+        vtty_queue_sync();
         drv->clear_screen();
-    else
+    } else {
         launchpad_vtty_puts("\x1B[2J");
+    }
 }
 
 void launchpad_vtty_move_cursor(int row, int col)
 {
     const struct vtty_driver *drv = current_driver();
-    if (drv && drv->move_cursor)
+    if (drv && drv->move_cursor) {
+        vtty_queue_sync();
         drv->move_cursor(row, col);
-    else
+    } else {
         launchpad_vtty_printf("\x1B[%d;%dH", row, col);
+    }
 }
 
 void launchpad_vtty_set_baudrate(int baud)
 {
     const struct vtty_driver *drv = current_driver();
-    if (drv && drv->set_baudrate)
+    if (drv && drv->set_baudrate) {
+        launchpad_vtty_flush();     /* bytes already queued keep the old rate */
         drv->set_baudrate(baud);
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -275,16 +751,56 @@ int launchpad_vtty_is_ready(void)
 
 void launchpad_vtty_set_callback(launchpad_vtty_event_cb_t cb)
 {
+    /* Drivers report to vtty_event(), which forwards */
+    xSemaphoreTakeRecursive(g_event_lock, portMAX_DELAY);
     g_event_cb = cb;
-    const struct vtty_driver *drv = current_driver();
-    if (drv && drv->set_callback)
-        drv->set_callback(cb);
+    xSemaphoreGiveRecursive(g_event_lock);
+}
+
+void launchpad_vtty_app_enter(void)
+{
+    vtty_sink_app_enter();
+}
+
+void launchpad_vtty_app_exit(void)
+{
+    /* The callback is app code: returns once no call into it is running */
+    launchpad_vtty_set_callback(NULL);
+    vtty_sink_app_exit();
+    ldisc_app_exit();
 }
 
 int launchpad_vtty_ioctl(int cmd, void *arg)
 {
+    switch (cmd) {
+    case LAUNCHPAD_VTTY_IOCTL_GET_STATS:
+        if (!arg)
+            return -1;
+        vtty_queue_get_stats(arg);
+        return 0;
+    case LAUNCHPAD_VTTY_IOCTL_SET_POLICY:
+        return arg ? vtty_queue_set_policy(*(int *)arg) : -1;
+    case LAUNCHPAD_VTTY_IOCTL_SINK_STATS:
+        return arg ? vtty_queue_sink_stats(arg) : -1;
+    case LAUNCHPAD_VTTY_IOCTL_GET_LDISC:
+    case LAUNCHPAD_VTTY_IOCTL_SET_LDISC: {
+        /* Flags of the current slot; a readline() in progress sees the change */
+        struct vtty_ldisc *ld = ldisc_get(g_current_index);
+        if (!arg || !ld)
+            return -1;
+        if (cmd == LAUNCHPAD_VTTY_IOCTL_GET_LDISC)
+            *(int *)arg = __atomic_load_n(&ld->flags, __ATOMIC_RELAXED);
+        else
+            __atomic_store_n(&ld->flags, *(int *)arg, __ATOMIC_RELAXED);
+        return 0;
+    }
+    default:
+        break;
+    }
+
     const struct vtty_driver *drv = current_driver();
     if (!drv || !drv->ioctl)
         return -1;
+    vtty_queue_sync();
     return drv->ioctl(cmd, arg);
 }
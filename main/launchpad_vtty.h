@@ -2,14 +2,27 @@
 #define LAUNCHPAD_VTTY_H
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/** Callback type for VTTY events. */
+/** Events passed to launchpad_vtty_event_cb_t. */
+enum {
+    LAUNCHPAD_VTTY_EVENT_DATA     = 1,  /* Input is available */
+    LAUNCHPAD_VTTY_EVENT_BREAK    = 2,  /* Break condition on the line */
+    LAUNCHPAD_VTTY_EVENT_OVERFLOW = 3,  /* Input was lost, RX buffer flushed */
+    LAUNCHPAD_VTTY_EVENT_ERROR    = 4,  /* Framing or parity error */
+};
+
+/** Callback type for VTTY events; runs in the driver's event task. */
 typedef void (*launchpad_vtty_event_cb_t)(int event);
 
+/** Output callback of launchpad_vtty_vformat(); return < 0 to stop. */
+typedef int (*launchpad_vtty_emit_t)(void *ctx, const char *buf, size_t len);
+
 /** Driver interface. */
 struct vtty_driver {
     int id;                     /* Driver identifier */
@@ -18,8 +31,10 @@ struct vtty_driver {
     int (*deinit)(void);
     int (*putc)(char c);
     int (*puts)(const char *s);
+    int (*write)(const char *buf, size_t len);  /* Bulk output, returns bytes taken */
     void (*flush)(void);
     int (*getc)(void);
+    int (*read)(char *buf, size_t len, int timeout_ms);   /* Blocks for the first byte, < 0 waits forever */
     int (*available)(void);
     void (*clear_screen)(void);
     void (*move_cursor)(int row, int col);
@@ -29,6 +44,51 @@ struct vtty_driver {
     int (*ioctl)(int cmd, void *arg);
 };
 
+/** What output does when the console queue is full. Console output of
+ * either policy may only be called from tasks, not from ISRs. */
+enum {
+    LAUNCHPAD_VTTY_POLICY_DROP  = 0,    /* Discard the write and count it */
+    LAUNCHPAD_VTTY_POLICY_BLOCK = 1,    /* Wait for the flush task */
+};
+
+/** ioctl commands handled by the core for every driver. */
+enum {
+    LAUNCHPAD_VTTY_IOCTL_GET_STATS  = 0x5600,   /* arg: struct launchpad_vtty_stats * */
+    LAUNCHPAD_VTTY_IOCTL_SET_POLICY = 0x5601,   /* arg: int * */
+    LAUNCHPAD_VTTY_IOCTL_SINK_STATS = 0x5602,   /* arg: struct launchpad_vtty_sink_stats * */
+    LAUNCHPAD_VTTY_IOCTL_GET_LDISC  = 0x5603,   /* arg: int *, LAUNCHPAD_VTTY_LDISC_* */
+    LAUNCHPAD_VTTY_IOCTL_SET_LDISC  = 0x5604,   /* arg: int * */
+};
+
+/** Line discipline flags of launchpad_vtty_readline(). */
+enum {
+    LAUNCHPAD_VTTY_LDISC_ECHO    = 1 << 0,  /* Echo input and edits */
+    LAUNCHPAD_VTTY_LDISC_HISTORY = 1 << 1,  /* Keep lines for Up/Down recall */
+};
+
+/** Console queue counters, since boot. */
+struct launchpad_vtty_stats {
+    uint32_t bytes;             /* Delivered to drivers */
+    uint32_t records;           /* Writes and printfs queued */
+    uint32_t dropped;           /* Writes discarded on a full queue */
+    uint32_t dropped_bytes;
+    uint32_t blocked;           /* Writes that had to wait for space */
+    uint32_t high_water;        /* Most bytes ever queued */
+    uint32_t queued;            /* Bytes queued right now */
+    int policy;
+};
+
+/** Counters of one output sink; fill in id before the ioctl. */
+struct launchpad_vtty_sink_stats {
+    int id;
+    const char *name;
+    uint32_t bytes;             /* Written to the sink */
+    uint32_t dropped_bytes;     /* Skipped after falling too far behind */
+    uint32_t lag;               /* Queued but not yet written */
+    uint32_t max_lag;
+    uint32_t throughput;        /* Bytes per second since the sink was added */
+};
+
 /** Information about a registered VTTY. */
 struct launchpad_vtty_info {
     int id;                     /* Driver identifier */
@@ -47,12 +107,25 @@ const struct launchpad_vtty_info *launchpad_vtty_list(int *cnt);
 int launchpad_vtty_putc(char c);
 int launchpad_vtty_putchar(char c);
 int launchpad_vtty_puts(const char *s);
+int launchpad_vtty_write(const char *buf, size_t len);
 int launchpad_vtty_printf(const char *fmt, ...);
+int launchpad_vtty_vprintf(const char *fmt, va_list ap);
 void launchpad_vtty_flush(void);
 
 int launchpad_vtty_getc(void);
+int launchpad_vtty_getchar(void);
+int launchpad_vtty_getc_timeout(int timeout_ms);
+int launchpad_vtty_read(char *buf, size_t len, int timeout_ms);
 int launchpad_vtty_available(void);
 
+/* Cooked input: echo, backspace, Ctrl-U/Ctrl-W, Up/Down history; CR, LF
+ * and CR LF all end a line. Blocks until a whole line was entered and
+ * returns its length without the terminator, or -1 on timeout (the
+ * partial line is kept for the next call). Each driver slot has its own
+ * line, history and LDISC flags, reset when an app exits; tasks reading
+ * lines from one slot take turns. */
+int launchpad_vtty_readline(char *buf, size_t len, int timeout_ms);
+
 void launchpad_vtty_clear_screen(void);
 void launchpad_vtty_move_cursor(int row, int col);
 void launchpad_vtty_set_baudrate(int baud);
@@ -61,6 +134,33 @@ int launchpad_vtty_is_ready(void);
 void launchpad_vtty_set_callback(launchpad_vtty_event_cb_t cb);
 int launchpad_vtty_ioctl(int cmd, void *arg);
 
+/* Output sinks: copies of all console output, each drained at its own
+ * pace. A sink that falls behind loses output, the console does not wait
+ * for it. Each returns a sink id or -1. Sinks added while an app runs are
+ * removed when it returns. */
+int launchpad_vtty_sink_add(const char *name, launchpad_vtty_emit_t write, void *ctx);
+int launchpad_vtty_sink_add_driver(int id);
+int launchpad_vtty_sink_add_file(const char *path);
+int launchpad_vtty_sink_add_tcp(int port);
+int launchpad_vtty_sink_remove(int sink);
+
+/* Rebind the calling task's stdin/stdout/stderr to /dev/vtty/<n> (stderr
+ * unbuffered, the rest buffered by newlib); n < 0 restores the defaults.
+ * The streams are closed again when the app returns. */
+int launchpad_vtty_bind_stdio(int n);
+
+/* For exec.c, not exported: bracket an app run. On exit, drop what the
+ * app left behind in the console (its event callback and sinks) before
+ * its image is freed */
+void launchpad_vtty_app_enter(void);
+void launchpad_vtty_app_exit(void);
+
+/* printf-style formatting in chunks handed to @emit, with no length
+ * limit and no allocation. A floating-point conversion wider than 64
+ * characters prints the value rounded to 54 significant digits, then
+ * 0s. Returns the number of bytes produced or -1. */
+int launchpad_vtty_vformat(launchpad_vtty_emit_t emit, void *ctx, const char *fmt, va_list ap);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,779 @@
+#include "launchpad_vtty_fb.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+/* Color pairs with their own glyph cache; the least recently used goes */
+#ifndef LAUNCHPAD_VTTY_FB_GLYPH_SETS
+#define LAUNCHPAD_VTTY_FB_GLYPH_SETS 4
+#endif
+
+#define FB_SCALE_MAX    4
+#define FB_CSI_PARAMS   4
+#define FONT_FIRST      0x20
+#define FONT_GLYPHS     96      /* 0x20-0x7E and a box for anything else */
+#define GLYPH_BOX       (FONT_GLYPHS - 1)
+
+#define RGB565(r, g, b) (uint16_t)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3))
+
+enum {
+    FB_BOLD      = 1 << 0,
+    FB_UNDERLINE = 1 << 1,
+    FB_REVERSE   = 1 << 2,
+};
+
+enum { ST_TEXT, ST_ESC, ST_CSI };
+
+/* 8x8 glyphs, one byte per line, bit 0 is the leftmost pixel */
+static const uint8_t g_font[FONT_GLYPHS][8] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },    /* ' ' */
+    { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 },    /* '!' */
+    { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },    /* '"' */
+    { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 },    /* '#' */
+    { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 },    /* '$' */
+    { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 },    /* '%' */
+    { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 },    /* '&' */
+    { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 },    /* ''' */
+    { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 },    /* '(' */
+    { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 },    /* ')' */
+    { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 },    /* '*' */
+    { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 },    /* '+' */
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 },    /* ',' */
+    { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 },    /* '-' */
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 },    /* '.' */
+    { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 },    /* '/' */
+    { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 },    /* '0' */
+    { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 },    /* '1' */
+    { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 },    /* '2' */
+    { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 },    /* '3' */
+    { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 },    /* '4' */
+    { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 },    /* '5' */
+    { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 },    /* '6' */
+    { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 },    /* '7' */
+    { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 },    /* '8' */
+    { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 },    /* '9' */
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 },    /* ':' */
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 },    /* ';' */
+    { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 },    /* '<' */
+    { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 },    /* '=' */
+    { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 },    /* '>' */
+    { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 },    /* '?' */
+    { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 },    /* '@' */
+    { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 },    /* 'A' */
+    { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 },    /* 'B' */
+    { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 },    /* 'C' */
+    { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 },    /* 'D' */
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 },    /* 'E' */
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 },    /* 'F' */
+    { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 },    /* 'G' */
+    { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 },    /* 'H' */
+    { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },    /* 'I' */
+    { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 },    /* 'J' */
+    { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 },    /* 'K' */
+    { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 },    /* 'L' */
+    { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 },    /* 'M' */
+    { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 },    /* 'N' */
+    { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 },    /* 'O' */
+    { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 },    /* 'P' */
+    { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 },    /* 'Q' */
+    { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 },    /* 'R' */
+    { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 },    /* 'S' */
+    { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },    /* 'T' */
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 },    /* 'U' */
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },    /* 'V' */
+    { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 },    /* 'W' */
+    { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 },    /* 'X' */
+    { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 },    /* 'Y' */
+    { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 },    /* 'Z' */
+    { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 },    /* '[' */
+    { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 },    /* '\' */
+    { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 },    /* ']' */
+    { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 },    /* '^' */
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF },    /* '_' */
+    { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 },    /* '`' */
+    { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 },    /* 'a' */
+    { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 },    /* 'b' */
+    { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 },    /* 'c' */
+    { 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 },    /* 'd' */
+    { 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 },    /* 'e' */
+    { 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 },    /* 'f' */
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F },    /* 'g' */
+    { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 },    /* 'h' */
+    { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },    /* 'i' */
+    { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E },    /* 'j' */
+    { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 },    /* 'k' */
+    { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },    /* 'l' */
+    { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 },    /* 'm' */
+    { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 },    /* 'n' */
+    { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 },    /* 'o' */
+    { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F },    /* 'p' */
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 },    /* 'q' */
+    { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 },    /* 'r' */
+    { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 },    /* 's' */
+    { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 },    /* 't' */
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 },    /* 'u' */
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },    /* 'v' */
+    { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 },    /* 'w' */
+    { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 },    /* 'x' */
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F },    /* 'y' */
+    { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 },    /* 'z' */
+    { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 },    /* '{' */
+    { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 },    /* '|' */
+    { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 },    /* '}' */
+    { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },    /* '~' */
+    { 0x00, 0x3F, 0x21, 0x21, 0x21, 0x21, 0x3F, 0x00 },    /* box */
+};
+
+/* ANSI colors 0-7 and their bright variants */
+static const uint16_t g_palette[16] = {
+    RGB565(0x00, 0x00, 0x00), RGB565(0xAA, 0x00, 0x00),
+    RGB565(0x00, 0xAA, 0x00), RGB565(0xAA, 0x55, 0x00),
+    RGB565(0x00, 0x00, 0xAA), RGB565(0xAA, 0x00, 0xAA),
+    RGB565(0x00, 0xAA, 0xAA), RGB565(0xAA, 0xAA, 0xAA),
+    RGB565(0x55, 0x55, 0x55), RGB565(0xFF, 0x55, 0x55),
+    RGB565(0x55, 0xFF, 0x55), RGB565(0xFF, 0xFF, 0x55),
+    RGB565(0x55, 0x55, 0xFF), RGB565(0xFF, 0x55, 0xFF),
+    RGB565(0x55, 0xFF, 0xFF), RGB565(0xFF, 0xFF, 0xFF),
+};
+
+/* All glyphs of one color pair, rasterised on first use */
+struct fb_glyphs {
+    uint16_t fg;
+    uint16_t bg;
+    bool underline;
+    bool valid;
+    uint32_t used;              /* LRU stamp */
+    uint32_t ready[(FONT_GLYPHS + 31) / 32];
+    uint16_t *pix;              /* FONT_GLYPHS cells of cell_w * cell_h */
+};
+
+/* Changed columns [c0, c1) of one text row */
+struct fb_span {
+    int16_t c0;
+    int16_t c1;
+};
+
+struct vtty_fb {
+    struct launchpad_vtty_fb_config cfg;
+    uint16_t *fb;
+    bool own_fb;
+    int cell_w, cell_h;
+    int cols, rows;
+    int top;                    /* Framebuffer text row shown first */
+    bool scrolled;              /* top moved since the last present */
+
+    int row, col;
+    bool wrap_pending;          /* Last column written, wrap on the next glyph */
+    int fg, bg;                 /* Palette index, -1 for the configured color */
+    int attr;
+    int saved_row, saved_col;
+
+    int state;
+    int params[FB_CSI_PARAMS];
+    int nparams;
+    bool priv;                  /* "ESC [ ?": private modes, ignored */
+
+    struct fb_glyphs sets[LAUNCHPAD_VTTY_FB_GLYPH_SETS];
+    struct fb_glyphs *glyphs;   /* Set for the current rendition */
+    uint32_t stamp;
+
+    struct fb_span *dirty;      /* Per framebuffer text row */
+    bool all_dirty;
+
+    struct launchpad_vtty_fb_stats stats;
+    SemaphoreHandle_t lock;
+    StaticSemaphore_t lock_buf;
+};
+
+static struct vtty_fb g_fb;
+
+/* -------------------------------------------------------------------------- */
+/* Glyph cache                                                                */
+/* -------------------------------------------------------------------------- */
+
+static size_t cell_px(void)
+{
+    return (size_t)g_fb.cell_w * g_fb.cell_h;
+}
+
+static uint16_t color_of(int idx, uint16_t dflt)
+{
+    return idx < 0 ? dflt : g_palette[idx];
+}
+
+/* Pick the glyph set for the current rendition, evicting the oldest */
+static void fb_select_glyphs(void)
+{
+    int fgi = g_fb.fg;
+    if ((g_fb.attr & FB_BOLD) && fgi >= 0 && fgi < 8)
+        fgi += 8;
+
+    uint16_t fg = color_of(fgi, g_fb.cfg.fg);
+    uint16_t bg = color_of(g_fb.bg, g_fb.cfg.bg);
+    bool ul = g_fb.attr & FB_UNDERLINE;
+    if (g_fb.attr & FB_REVERSE) {
+        uint16_t t = fg;
+        fg = bg;
+        bg = t;
+    }
+
+    struct fb_glyphs *victim = &g_fb.sets[0];
+    for (int i = 0; i < LAUNCHPAD_VTTY_FB_GLYPH_SETS; ++i) {
+        struct fb_glyphs *s = &g_fb.sets[i];
+        if (s->valid && s->fg == fg && s->bg == bg && s->underline == ul) {
+            victim = s;
+            goto found;
+        }
+        if (!s->valid || (victim->valid && s->used < victim->used))
+            victim = s;
+    }
+
+    victim->fg = fg;
+    victim->bg = bg;
+    victim->underline = ul;
+    victim->valid = true;
+    memset(victim->ready, 0, sizeof(victim->ready));
+
+found:
+    victim->used = ++g_fb.stamp;
+    g_fb.glyphs = victim;
+}
+
+static const uint16_t *fb_glyph(int g)
+{
+    struct fb_glyphs *s = g_fb.glyphs;
+    uint16_t *pix = s->pix + (size_t)g * cell_px();
+
+    if (s->ready[g / 32] & (1u << (g % 32)))
+        return pix;
+
+    int scale = g_fb.cfg.scale;
+    uint16_t *p = pix;
+    for (int y = 0; y < g_fb.cell_h; ++y) {
+        unsigned bits = g_font[g][y / scale];
+        if (s->underline && y / scale == 7)
+            bits = 0xFF;
+        for (int x = 0; x < g_fb.cell_w; ++x)
+            *p++ = ((bits >> (x / scale)) & 1) ? s->fg : s->bg;
+    }
+    s->ready[g / 32] |= 1u << (g % 32);
+    g_fb.stats.glyph_misses++;
+    return pix;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Drawing                                                                    */
+/* -------------------------------------------------------------------------- */
+
+/* First pixel of screen cell (@row, @col) */
+static uint16_t *fb_cell(int row, int col)
+{
+    int frow = (g_fb.top + row) % g_fb.rows;
+    return g_fb.fb + ((size_t)frow * g_fb.cell_h * g_fb.cfg.width) + (size_t)col * g_fb.cell_w;
+}
+
+static void fb_mark(int row, int c0, int c1)
+{
+    struct fb_span *d = &g_fb.dirty[(g_fb.top + row) % g_fb.rows];
+
+    if (d->c0 >= d->c1) {
+        d->c0 = c0;
+        d->c1 = c1;
+        return;
+    }
+    if (c0 < d->c0)
+        d->c0 = c0;
+    if (c1 > d->c1)
+        d->c1 = c1;
+}
+
+static void fb_draw(int row, int col, int g)
+{
+    const uint16_t *src = fb_glyph(g);
+    uint16_t *dst = fb_cell(row, col);
+    size_t line = g_fb.cell_w * sizeof(uint16_t);
+
+    for (int y = 0; y < g_fb.cell_h; ++y) {
+        memcpy(dst, src, line);
+        dst += g_fb.cfg.width;
+        src += g_fb.cell_w;
+    }
+    fb_mark(row, col, col + 1);
+    g_fb.stats.chars++;
+}
+
+/* Blank columns [@c0, @c1) of @row in the current background */
+static void fb_erase(int row, int c0, int c1)
+{
+    if (c0 >= c1)
+        return;
+
+    uint16_t bg = g_fb.glyphs->bg;
+    uint16_t *dst = fb_cell(row, c0);
+    int w = (c1 - c0) * g_fb.cell_w;
+
+    for (int x = 0; x < w; ++x)
+        dst[x] = bg;
+    for (int y = 1; y < g_fb.cell_h; ++y)
+        memcpy(dst + (size_t)y * g_fb.cfg.width, dst, w * sizeof(uint16_t));
+    fb_mark(row, c0, c1);
+}
+
+/* Scroll up one row by moving the top, then blank the row that came in */
+static void fb_scroll(void)
+{
+    g_fb.top = (g_fb.top + 1) % g_fb.rows;
+    g_fb.scrolled = true;
+    g_fb.stats.scrolls++;
+    if (!g_fb.cfg.scroll)
+        g_fb.all_dirty = true;     /* every row moved on the panel */
+    fb_erase(g_fb.rows - 1, 0, g_fb.cols);
+}
+
+static void fb_newline(void)
+{
+    g_fb.wrap_pending = false;
+    if (g_fb.row == g_fb.rows - 1)
+        fb_scroll();
+    else
+        g_fb.row++;
+}
+
+static void fb_goto(int row, int col)
+{
+    g_fb.row = row < 0 ? 0 : row >= g_fb.rows ? g_fb.rows - 1 : row;
+    g_fb.col = col < 0 ? 0 : col >= g_fb.cols ? g_fb.cols - 1 : col;
+    g_fb.wrap_pending = false;
+}
+
+static void fb_glyph_out(int g)
+{
+    if (g_fb.wrap_pending) {
+        g_fb.col = 0;
+        fb_newline();
+    }
+    fb_draw(g_fb.row, g_fb.col, g);
+    if (g_fb.col == g_fb.cols - 1)
+        g_fb.wrap_pending = true;
+    else
+        g_fb.col++;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Control characters and escape sequences                                    */
+/* -------------------------------------------------------------------------- */
+
+static int csi_param(int i, int dflt)
+{
+    return (i < g_fb.nparams && g_fb.params[i] > 0) ? g_fb.params[i] : dflt;
+}
+
+static void fb_sgr(void)
+{
+    if (!g_fb.nparams)
+        g_fb.nparams = 1;   /* "ESC [ m" is a reset */
+
+    for (int i = 0; i < g_fb.nparams; ++i) {
+        int p = g_fb.params[i];
+
+        if (p == 0) {
+            g_fb.attr = 0;
+            g_fb.fg = g_fb.bg = -1;
+        } else if (p == 1) {
+            g_fb.attr |= FB_BOLD;
+        } else if (p == 4) {
+            g_fb.attr |= FB_UNDERLINE;
+        } else if (p == 7) {
+            g_fb.attr |= FB_REVERSE;
+        } else if (p == 22) {
+            g_fb.attr &= ~FB_BOLD;
+        } else if (p == 24) {
+            g_fb.attr &= ~FB_UNDERLINE;
+        } else if (p == 27) {
+            g_fb.attr &= ~FB_REVERSE;
+        } else if (p >= 30 && p <= 37) {
+            g_fb.fg = p - 30;
+        } else if (p == 39) {
+            g_fb.fg = -1;
+        } else if (p >= 40 && p <= 47) {
+            g_fb.bg = p - 40;
+        } else if (p == 49) {
+            g_fb.bg = -1;
+        } else if (p >= 90 && p <= 97) {
+            g_fb.fg = p - 90 + 8;
+        } else if (p >= 100 && p <= 107) {
+            g_fb.bg = p - 100 + 8;
+        }
+    }
+    fb_select_glyphs();
+}
+
+static void fb_csi(char f)
+{
+    int n = csi_param(0, 1);
+
+    if (g_fb.priv)
+        return;
+
+    switch (f) {
+    case 'A':
+        fb_goto(g_fb.row - n, g_fb.col);
+        break;
+    case 'B':
+        fb_goto(g_fb.row + n, g_fb.col);
+        break;
+    case 'C':
+        fb_goto(g_fb.row, g_fb.col + n);
+        break;
+    case 'D':
+        fb_goto(g_fb.row, g_fb.col - n);
+        break;
+    case 'G':
+        fb_goto(g_fb.row, n - 1);
+        break;
+    case 'd':
+        fb_goto(n - 1, g_fb.col);
+        break;
+    case 'H':
+    case 'f':
+        fb_goto(n - 1, csi_param(1, 1) - 1);
+        break;
+    case 'J': {
+        int mode = csi_param(0, 0);
+        int from = mode == 0 ? g_fb.row + 1 : 0;
+        int to = mode == 1 ? g_fb.row : g_fb.rows;
+
+        if (mode == 0)
+            fb_erase(g_fb.row, g_fb.col, g_fb.cols);
+        else if (mode == 1)
+            fb_erase(g_fb.row, 0, g_fb.col + 1);
+        for (int r = from; r < to; ++r)
+            fb_erase(r, 0, g_fb.cols);
+        break;
+    }
+    case 'K': {
+        int mode = csi_param(0, 0);
+
+        if (mode == 0)
+            fb_erase(g_fb.row, g_fb.col, g_fb.cols);
+        else if (mode == 1)
+            fb_erase(g_fb.row, 0, g_fb.col + 1);
+        else
+            fb_erase(g_fb.row, 0, g_fb.cols);
+        break;
+    }
+    case 'm':
+        fb_sgr();
+        break;
+    case 's':
+        g_fb.saved_row = g_fb.row;
+        g_fb.saved_col = g_fb.col;
+        break;
+    case 'u':
+        fb_goto(g_fb.saved_row, g_fb.saved_col);
+        break;
+    default:
+        break;
+    }
+}
+
+static void fb_input(unsigned char c)
+{
+    switch (g_fb.state) {
+    case ST_ESC:
+        if (c == '[') {
+            g_fb.state = ST_CSI;
+            g_fb.nparams = 0;
+            g_fb.priv = false;
+            memset(g_fb.params, 0, sizeof(g_fb.params));
+        } else {
+            g_fb.state = ST_TEXT;
+        }
+        return;
+
+    case ST_CSI:
+        if (c >= '0' && c <= '9') {
+            if (!g_fb.nparams)
+                g_fb.nparams = 1;
+            if (g_fb.nparams <= FB_CSI_PARAMS) {
+                int *p = &g_fb.params[g_fb.nparams - 1];
+                if (*p < 10000)
+                    *p = *p * 10 + (c - '0');
+            }
+        } else if (c == ';') {
+            g_fb.nparams = (g_fb.nparams ? g_fb.nparams : 1) + 1;
+        } else if (c == '?') {
+            g_fb.priv = true;
+        } else if (c >= 0x40 && c <= 0x7E) {
+            if (g_fb.nparams > FB_CSI_PARAMS)
+                g_fb.nparams = FB_CSI_PARAMS;
+            g_fb.state = ST_TEXT;
+            fb_csi(c);
+        }
+        return;
+
+    default:
+        break;
+    }
+
+    switch (c) {
+    case 0x1B:
+        g_fb.state = ST_ESC;
+        break;
+    case '\n':
+        /* No tty layer adds the CR here, so LF starts a new line */
+        g_fb.col = 0;
+        fb_newline();
+        break;
+    case '\r':
+        g_fb.col = 0;
+        g_fb.wrap_pending = false;
+        break;
+    case '\b':
+        if (g_fb.col > 0 && !g_fb.wrap_pending)
+            g_fb.col--;
+        g_fb.wrap_pending = false;
+        break;
+    case '\t': {
+        int next = (g_fb.col + 8) & ~7;
+        fb_goto(g_fb.row, next < g_fb.cols ? next : g_fb.cols - 1);
+        break;
+    }
+    default:
+        if (c >= FONT_FIRST && c < FONT_FIRST + GLYPH_BOX)
+            fb_glyph_out(c - FONT_FIRST);
+        else if (c >= 0xC0)
+            fb_glyph_out(GLYPH_BOX);    /* a UTF-8 sequence gets one box */
+        break;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Panel updates                                                              */
+/* -------------------------------------------------------------------------- */
+
+static uint32_t fb_push(int first, int last, int c0, int c1)
+{
+    int frow = g_fb.cfg.scroll ? first : (g_fb.top + first) % g_fb.rows;
+    int x = c0 * g_fb.cell_w;
+    int w = (c1 - c0) * g_fb.cell_w;
+    int h = (last - first) * g_fb.cell_h;
+    const uint16_t *px = g_fb.fb + (size_t)frow * g_fb.cell_h * g_fb.cfg.width + x;
+
+    g_fb.cfg.flush(g_fb.cfg.ctx, x, first * g_fb.cell_h, w, h, px, g_fb.cfg.width);
+    g_fb.stats.rects++;
+    return (uint32_t)w * h * sizeof(uint16_t);
+}
+
+/*
+ * Hand the changed rows to the panel, merging neighbours whose spans
+ * overlap. With hardware scroll the rows go in framebuffer order,
+ * otherwise in display order, split where the framebuffer wraps.
+ */
+static void fb_present(void)
+{
+    bool hw = g_fb.cfg.scroll != NULL;
+    uint32_t bytes = 0;
+    int first = -1, c0 = 0, c1 = 0;
+
+    if (g_fb.all_dirty) {
+        for (int r = 0; r < g_fb.rows; ++r)
+            g_fb.dirty[r] = (struct fb_span){ 0, (int16_t)g_fb.cols };
+        g_fb.all_dirty = false;
+    }
+
+    if (!g_fb.cfg.flush) {
+        memset(g_fb.dirty, 0, g_fb.rows * sizeof(*g_fb.dirty));
+        return;
+    }
+
+    for (int r = 0; r <= g_fb.rows; ++r) {
+        int frow = hw ? r : (g_fb.top + r) % g_fb.rows;
+        struct fb_span d = { 0, 0 };
+
+        if (r < g_fb.rows) {
+            d = g_fb.dirty[frow];
+            g_fb.dirty[frow] = (struct fb_span){ 0, 0 };
+        }
+
+        bool dirty = d.c0 < d.c1;
+        bool joins = dirty && first >= 0 && d.c0 <= c1 && c0 <= d.c1 && (hw || frow != 0);
+        if (first >= 0 && !joins) {
+            bytes += fb_push(first, r, c0, c1);
+            first = -1;
+        }
+        if (!dirty)
+            continue;
+        if (first < 0) {
+            first = r;
+            c0 = d.c0;
+            c1 = d.c1;
+        } else {
+            c0 = d.c0 < c0 ? d.c0 : c0;
+            c1 = d.c1 > c1 ? d.c1 : c1;
+        }
+    }
+
+    if (hw && g_fb.scrolled)
+        g_fb.cfg.scroll(g_fb.cfg.ctx, g_fb.top * g_fb.cell_h);
+    g_fb.scrolled = false;
+
+    if (bytes) {
+        g_fb.stats.frames++;
+        g_fb.stats.bytes_flushed += bytes;
+        g_fb.stats.last_frame_bytes = bytes;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Driver                                                                     */
+/* -------------------------------------------------------------------------- */
+
+static int fb_init(void)
+{
+    g_fb.lock = xSemaphoreCreateMutexStatic(&g_fb.lock_buf);
+    return 0;
+}
+
+static int fb_deinit(void)
+{
+    for (int i = 0; i < LAUNCHPAD_VTTY_FB_GLYPH_SETS; ++i)
+        heap_caps_free(g_fb.sets[i].pix);
+    heap_caps_free(g_fb.dirty);
+    if (g_fb.own_fb)
+        heap_caps_free(g_fb.fb);
+    memset(&g_fb, 0, sizeof(g_fb));
+    return 0;
+}
+
+static int fb_write(const char *buf, size_t len)
+{
+    xSemaphoreTake(g_fb.lock, portMAX_DELAY);
+    for (size_t i = 0; i < len; ++i)
+        fb_input((unsigned char)buf[i]);
+    fb_present();
+    xSemaphoreGive(g_fb.lock);
+    return (int)len;
+}
+
+static int fb_putc(char c)
+{
+    return fb_write(&c, 1);
+}
+
+static int fb_puts(const char *s)
+{
+    if (!s)
+        return -1;
+    return fb_write(s, strlen(s));
+}
+
+static void fb_clear_screen(void)
+{
+    fb_write("\x1B[2J\x1B[H", 7);
+}
+
+static void fb_move_cursor(int row, int col)
+{
+    xSemaphoreTake(g_fb.lock, portMAX_DELAY);
+    fb_goto(row - 1, col - 1);
+    xSemaphoreGive(g_fb.lock);
+}
+
+static int fb_is_ready(void)
+{
+    return g_fb.fb != NULL;
+}
+
+static int fb_ioctl(int cmd, void *arg)
+{
+    if (cmd == LAUNCHPAD_VTTY_IOCTL_FB_STATS)
+        return launchpad_vtty_fb_get_stats(arg);
+    return -1;
+}
+
+static const struct vtty_driver fb_driver = {
+    .id = 2,
+    .type = "fb",
+    .init = fb_init,
+    .deinit = fb_deinit,
+    .putc = fb_putc,
+    .puts = fb_puts,
+    .write = fb_write,
+    .flush = NULL,      /* every write is pushed to the panel */
+    .getc = NULL,
+    .read = NULL,
+    .available = NULL,
+    .clear_screen = fb_clear_screen,
+    .move_cursor = fb_move_cursor,
+    .set_baudrate = NULL,
+    .is_ready = fb_is_ready,
+    .set_callback = NULL,
+    .ioctl = fb_ioctl,
+};
+
+int launchpad_vtty_fb_get_stats(struct launchpad_vtty_fb_stats *st)
+{
+    if (!st || !g_fb.fb)
+        return -1;
+    xSemaphoreTake(g_fb.lock, portMAX_DELAY);
+    *st = g_fb.stats;
+    xSemaphoreGive(g_fb.lock);
+    return 0;
+}
+
+int launchpad_vtty_register_fb(const struct launchpad_vtty_fb_config *cfg)
+{
+    if (!cfg || g_fb.fb || cfg->scale < 1 || cfg->scale > FB_SCALE_MAX)
+        return -1;
+
+    g_fb.cfg = *cfg;
+    g_fb.cell_w = 8 * cfg->scale;
+    g_fb.cell_h = 8 * cfg->scale;
+    g_fb.cols = cfg->width / g_fb.cell_w;
+    g_fb.rows = cfg->height / g_fb.cell_h;
+    if (g_fb.cols < 1 || g_fb.rows < 1)
+        goto fail;
+
+    /* Large buffers go to PSRAM when there is some */
+    uint32_t caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    size_t fb_size = (size_t)cfg->width * cfg->height * sizeof(uint16_t);
+    size_t set_size = FONT_GLYPHS * cell_px() * sizeof(uint16_t);
+
+    g_fb.fb = cfg->fb;
+    if (!g_fb.fb) {
+        g_fb.fb = heap_caps_malloc(fb_size, caps);
+        if (!g_fb.fb)
+            g_fb.fb = heap_caps_malloc(fb_size, MALLOC_CAP_8BIT);
+        g_fb.own_fb = true;
+    }
+    g_fb.dirty = heap_caps_calloc(g_fb.rows, sizeof(*g_fb.dirty), MALLOC_CAP_8BIT);
+    if (!g_fb.fb || !g_fb.dirty)
+        goto fail;
+    for (int i = 0; i < LAUNCHPAD_VTTY_FB_GLYPH_SETS; ++i) {
+        g_fb.sets[i].pix = heap_caps_malloc(set_size, caps);
+        if (!g_fb.sets[i].pix)
+            g_fb.sets[i].pix = heap_caps_malloc(set_size, MALLOC_CAP_8BIT);
+        if (!g_fb.sets[i].pix)
+            goto fail;
+    }
+
+    g_fb.fg = g_fb.bg = -1;
+    fb_select_glyphs();
+    for (size_t i = 0; i < fb_size / sizeof(uint16_t); ++i)
+        g_fb.fb[i] = cfg->bg;
+    g_fb.all_dirty = true;
+
+    if (launchpad_vtty_register_driver(&fb_driver) == 0)
+        return 0;
+
+fail:
+    fb_deinit();
+    return -1;
+}
@@ -0,0 +1,68 @@
+#ifndef LAUNCHPAD_VTTY_FB_H
+#define LAUNCHPAD_VTTY_FB_H
+
+#include <stdint.h>
+#include "launchpad_vtty.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Text console drawn into an RGB565 framebuffer in memory.
+ *
+ * Output is rendered with an 8x8 font (scaled by an integer factor)
+ * from pre-rasterised glyphs, with the usual control characters and
+ * the ANSI sequences of launchpad_vtty_screen. Only the changed parts
+ * of the framebuffer are handed to the panel backend after each write.
+ *
+ * Scrolling moves the row shown at the top instead of the pixels. With
+ * a @scroll callback the panel follows that in hardware and flush
+ * coordinates are framebuffer lines; without one a scroll pushes the
+ * whole screen in display order.
+ */
+
+/** Push @w x @h pixels at (@x, @y); @stride is in pixels. */
+typedef void (*launchpad_vtty_fb_flush_t)(void *ctx, int x, int y, int w, int h,
+                                          const uint16_t *pixels, int stride);
+
+/** Show framebuffer line @line at the top of the scroll area. */
+typedef void (*launchpad_vtty_fb_scroll_t)(void *ctx, int line);
+
+struct launchpad_vtty_fb_config {
+    uint16_t *fb;               /* width * height pixels, NULL to allocate */
+    int width;
+    int height;
+    int scale;                  /* Glyph magnification, 1 gives 8x8 cells */
+    uint16_t fg;                /* Default colors, native-endian RGB565 */
+    uint16_t bg;
+    launchpad_vtty_fb_flush_t flush;    /* Optional: the framebuffer may be scanned out as is */
+    launchpad_vtty_fb_scroll_t scroll;  /* Optional: hardware vertical scroll */
+    void *ctx;
+};
+
+/** ioctl commands of the framebuffer driver. */
+enum {
+    LAUNCHPAD_VTTY_IOCTL_FB_STATS = 0x5680,     /* arg: struct launchpad_vtty_fb_stats * */
+};
+
+/** Framebuffer console counters, since registration. */
+struct launchpad_vtty_fb_stats {
+    uint32_t chars;             /* Glyphs drawn */
+    uint32_t frames;            /* Writes that pushed pixels to the panel */
+    uint32_t rects;
+    uint32_t bytes_flushed;
+    uint32_t last_frame_bytes;
+    uint32_t scrolls;
+    uint32_t glyph_misses;      /* Glyphs rasterised into the cache */
+};
+
+/* Register the framebuffer console as a vtty driver; returns 0 or -1 */
+int launchpad_vtty_register_fb(const struct launchpad_vtty_fb_config *cfg);
+int launchpad_vtty_fb_get_stats(struct launchpad_vtty_fb_stats *st);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHPAD_VTTY_FB_H */
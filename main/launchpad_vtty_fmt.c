@@ -0,0 +1,536 @@
+#include "launchpad_vtty.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <float.h>
+
+/* Stack buffer for one floating-point conversion. Wider results
+ * (e.g. "%f" of 1e200, "%.80e") are streamed from the value rounded
+ * to FLOAT_DIGITS significant digits, the digits past them print as 0. */
+#ifndef LAUNCHPAD_VTTY_FMT_FLOAT_BUF
+#define LAUNCHPAD_VTTY_FMT_FLOAT_BUF 64
+#endif
+
+/* Significant digits of "%.*Le" that fit the buffer: "-d." and "e-4966" */
+#define FLOAT_DIGITS (LAUNCHPAD_VTTY_FMT_FLOAT_BUF - 10)
+
+#define F_LEFT  (1 << 0)    /* '-' */
+#define F_PLUS  (1 << 1)    /* '+' */
+#define F_SPACE (1 << 2)    /* ' ' */
+#define F_ALT   (1 << 3)    /* '#' */
+#define F_ZERO  (1 << 4)    /* '0' */
+
+enum fmt_len { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_Z, LEN_J, LEN_T, LEN_LD };
+
+struct fmt_out {
+    launchpad_vtty_emit_t emit;
+    void *ctx;
+    int count;
+    bool err;
+};
+
+struct fmt_spec {
+    int flags;
+    int width;
+    int prec;               /* -1 when not given */
+    enum fmt_len len;
+};
+
+struct fmt_num {
+    bool is_ld;             /* 'L': ld, else d */
+    long double ld;
+    double d;
+};
+
+/* Decimal digits of a streamed conversion: s[0] weighs 10^e, digits
+ * past the ns known ones are 0 */
+struct fmt_digits {
+    char s[LAUNCHPAD_VTTY_FMT_FLOAT_BUF];
+    int ns;
+    int e;
+    bool neg;
+};
+
+/* -------------------------------------------------------------------------- */
+/* Output                                                                     */
+/* -------------------------------------------------------------------------- */
+
+static void out(struct fmt_out *o, const char *s, size_t n)
+{
+    if (!n || o->err)
+        return;
+    if (o->emit(o->ctx, s, n) < 0)
+        o->err = true;
+    else
+        o->count += (int)n;
+}
+
+static void out_fill(struct fmt_out *o, char c, int n)
+{
+    char fill[16];
+
+    if (n <= 0)
+        return;
+    memset(fill, c, sizeof(fill));
+    while (n > 0) {
+        int k = n < (int)sizeof(fill) ? n : (int)sizeof(fill);
+        out(o, fill, k);
+        n -= k;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Conversions                                                                */
+/* -------------------------------------------------------------------------- */
+
+static void fmt_int(struct fmt_out *o, const struct fmt_spec *sp, char conv,
+                    uintmax_t v, bool neg)
+{
+    char digits[24];        /* 64-bit octal needs 22 */
+    char prefix[2];
+    int nprefix = 0;
+    int n;
+    unsigned base = (conv == 'o') ? 8 : (conv == 'x' || conv == 'X' || conv == 'p') ? 16 : 10;
+    const char *hex = (conv == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+
+    if (neg)
+        prefix[nprefix++] = '-';
+    else if (sp->flags & F_PLUS)
+        prefix[nprefix++] = '+';
+    else if (sp->flags & F_SPACE)
+        prefix[nprefix++] = ' ';
+
+    if (base == 16 && (v || conv == 'p') && (sp->flags & F_ALT)) {
+        prefix[nprefix++] = '0';
+        prefix[nprefix++] = (conv == 'X') ? 'X' : 'x';
+    }
+
+    /* Digits are built from the end so they go out in one call */
+    char *d = digits + sizeof(digits);
+    while (v) {
+        *--d = hex[v % base];
+        v /= base;
+    }
+    n = (int)(digits + sizeof(digits) - d);
+
+    /* "%.0d" of 0 prints nothing */
+    int prec = sp->prec < 0 ? 1 : sp->prec;
+    int zeros = prec > n ? prec - n : 0;
+
+    /* '#' with 'o' forces a leading 0 */
+    if (base == 8 && (sp->flags & F_ALT) && !zeros && (n == 0 || *d != '0'))
+        zeros = 1;
+
+    int len = nprefix + zeros + n;
+    int pad = sp->width > len ? sp->width - len : 0;
+
+    if ((sp->flags & F_ZERO) && !(sp->flags & F_LEFT) && sp->prec < 0) {
+        zeros += pad;
+        pad = 0;
+    }
+
+    if (!(sp->flags & F_LEFT))
+        out_fill(o, ' ', pad);
+    out(o, prefix, nprefix);
+    out_fill(o, '0', zeros);
+    out(o, d, n);
+    if (sp->flags & F_LEFT)
+        out_fill(o, ' ', pad);
+}
+
+static void fmt_str(struct fmt_out *o, const struct fmt_spec *sp, const char *s, size_t n)
+{
+    int pad = sp->width > (int)n ? sp->width - (int)n : 0;
+
+    if (!(sp->flags & F_LEFT))
+        out_fill(o, ' ', pad);
+    out(o, s, n);
+    if (sp->flags & F_LEFT)
+        out_fill(o, ' ', pad);
+}
+
+/* Field padding before a conversion of len bytes; returns the zeros
+ * that go between its sign or prefix and its digits */
+static int pad_before(struct fmt_out *o, const struct fmt_spec *sp, int len, bool zero_ok)
+{
+    int pad = sp->width > len ? sp->width - len : 0;
+
+    if (sp->flags & F_LEFT)
+        return 0;
+    if ((sp->flags & F_ZERO) && zero_ok)
+        return pad;
+    out_fill(o, ' ', pad);
+    return 0;
+}
+
+static void pad_after(struct fmt_out *o, const struct fmt_spec *sp, int len)
+{
+    if (sp->flags & F_LEFT)
+        out_fill(o, ' ', sp->width - len);
+}
+
+static int float_snprintf(char *buf, size_t size, const char *spec, int prec, const struct fmt_num *v)
+{
+    return v->is_ld ? snprintf(buf, size, spec, prec, v->ld) : snprintf(buf, size, spec, prec, v->d);
+}
+
+/* The value rounded to prec + 1 significant digits, as "%.*e" would */
+static void float_digits(const struct fmt_num *v, int prec, struct fmt_digits *dg)
+{
+    char buf[LAUNCHPAD_VTTY_FMT_FLOAT_BUF];
+    const char *p = buf;
+
+    float_snprintf(buf, sizeof(buf), v->is_ld ? "%.*Le" : "%.*e", prec, v);
+    dg->neg = *p == '-';
+    if (dg->neg)
+        p++;
+    for (dg->ns = 0; *p != 'e'; p++) {
+        if (*p != '.')
+            dg->s[dg->ns++] = *p;
+    }
+    dg->e = (int)strtol(p + 1, NULL, 10);
+}
+
+/* Digits [from, from + n) of dg */
+static void out_digits(struct fmt_out *o, const struct fmt_digits *dg, int from, int n)
+{
+    int lead = from < 0 ? (-from < n ? -from : n) : 0;
+
+    out_fill(o, '0', lead);
+    from += lead;
+    n -= lead;
+
+    int known = from < dg->ns ? (n < dg->ns - from ? n : dg->ns - from) : 0;
+    out(o, dg->s + from, known);
+    out_fill(o, '0', n - known);
+}
+
+/* "%a" is exact once the precision covers the mantissa: pad it with 0 */
+static void fmt_hex_wide(struct fmt_out *o, const struct fmt_spec *sp, char conv, const struct fmt_num *v)
+{
+    char spec[8];
+    char buf[LAUNCHPAD_VTTY_FMT_FLOAT_BUF];
+    int mant = ((v->is_ld ? LDBL_MANT_DIG : DBL_MANT_DIG) + 3) / 4;
+    int n;
+
+    snprintf(spec, sizeof(spec), "%%%s.*%s%c", (sp->flags & F_PLUS) ? "+" : (sp->flags & F_SPACE) ? " " : "",
+             v->is_ld ? "L" : "", conv);
+    n = float_snprintf(buf, sizeof(buf), spec, mant, v);
+    if (n < 0 || n >= (int)sizeof(buf)) {
+        o->err = true;
+        return;
+    }
+
+    int pfx = (buf[0] == '-' || buf[0] == '+' || buf[0] == ' ') + 2;
+    int exp = (int)(strchr(buf, conv == 'A' ? 'P' : 'p') - buf);
+    int len = n + sp->prec - mant;
+    int zeros = pad_before(o, sp, len, true);
+
+    out(o, buf, pfx);
+    out_fill(o, '0', zeros);
+    out(o, buf + pfx, exp - pfx);
+    out_fill(o, '0', sp->prec - mant);
+    out(o, buf + exp, n - exp);
+    pad_after(o, sp, len);
+}
+
+static void fmt_float_wide(struct fmt_out *o, const struct fmt_spec *sp, char conv, const struct fmt_num *v)
+{
+    struct fmt_digits dg;
+    char lc = conv | 0x20;
+    bool alt = sp->flags & F_ALT;
+    bool fixed = lc == 'f';
+    int prec = sp->prec < 0 ? 6 : sp->prec;
+
+    if (lc == 'a') {
+        fmt_hex_wide(o, sp, conv, v);
+        return;
+    }
+
+    if (lc == 'f') {
+        float_digits(v, FLOAT_DIGITS - 1, &dg);
+
+        /* Round at the last digit asked for if it is among the known ones */
+        int sig = prec + dg.e + 1;
+        if (sig > 0 && sig < FLOAT_DIGITS) {
+            float_digits(v, sig - 1, &dg);
+        } else if (sig == 0 && dg.s[0] >= '5') {
+            dg.s[0] = '1';
+            dg.ns = 1;
+            dg.e++;
+        } else if (sig <= 0) {
+            dg.ns = 0;
+        }
+    } else if (lc == 'e') {
+        float_digits(v, prec < FLOAT_DIGITS ? prec : FLOAT_DIGITS - 1, &dg);
+    } else {
+        /* 'g': 'e' or 'f' style by the exponent after rounding */
+        int p = prec ? prec : 1;
+        float_digits(v, (p < FLOAT_DIGITS ? p : FLOAT_DIGITS) - 1, &dg);
+        fixed = dg.e >= -4 && dg.e < p;
+        prec = fixed ? p - 1 - dg.e : p - 1;
+
+        if (!alt) {
+            int last = dg.ns - 1;
+            while (last >= 0 && dg.s[last] == '0')
+                last--;
+            int keep = fixed ? last - dg.e : last;
+            if (prec > keep)
+                prec = keep > 0 ? keep : 0;
+        }
+    }
+
+    char sign = dg.neg ? '-' : (sp->flags & F_PLUS) ? '+' : (sp->flags & F_SPACE) ? ' ' : 0;
+    char exp[8];
+    int nexp = 0;
+    int nint = 1;
+
+    if (fixed)
+        nint = dg.e >= 0 ? dg.e + 1 : 1;
+    else
+        nexp = snprintf(exp, sizeof(exp), "%c%c%02d", (conv & 0x20) ? 'e' : 'E',
+                        dg.e < 0 ? '-' : '+', dg.e < 0 ? -dg.e : dg.e);
+
+    int len = !!sign + nint + (prec || alt ? 1 + prec : 0) + nexp;
+    int zeros = pad_before(o, sp, len, true);
+
+    if (sign)
+        out(o, &sign, 1);
+    out_fill(o, '0', zeros);
+    out_digits(o, &dg, fixed ? dg.e + 1 - nint : 0, nint);
+    if (prec || alt) {
+        out(o, ".", 1);
+        out_digits(o, &dg, fixed ? dg.e + 1 : 1, prec);
+    }
+    out(o, exp, nexp);
+    pad_after(o, sp, len);
+}
+
+/* Floating point is left to newlib, one conversion at a time; the field
+ * width is applied here so only long numbers take the streamed path */
+static void fmt_float(struct fmt_out *o, const struct fmt_spec *sp, char conv, va_list *ap)
+{
+    char spec[24];
+    char buf[LAUNCHPAD_VTTY_FMT_FLOAT_BUF];
+    char *p = spec;
+    struct fmt_num v = { .is_ld = sp->len == LEN_LD };
+    int n;
+
+    if (v.is_ld)
+        v.ld = va_arg(*ap, long double);
+    else
+        v.d = va_arg(*ap, double);
+
+    *p++ = '%';
+    if (sp->flags & F_PLUS)  *p++ = '+';
+    if (sp->flags & F_SPACE) *p++ = ' ';
+    if (sp->flags & F_ALT)   *p++ = '#';
+    strcpy(p, ".*");
+    p += 2;
+    if (v.is_ld)
+        *p++ = 'L';
+    *p++ = conv;
+    *p = '\0';
+
+    n = float_snprintf(buf, sizeof(buf), spec, sp->prec, &v);
+    if (n < 0) {
+        o->err = true;
+        return;
+    }
+    if (n >= (int)sizeof(buf)) {
+        fmt_float_wide(o, sp, conv, &v);
+        return;
+    }
+
+    /* Zeros go after the sign and "0x", never into "inf" or "nan" */
+    int pfx = buf[0] == '-' || buf[0] == '+' || buf[0] == ' ';
+    if ((conv | 0x20) == 'a')
+        pfx += 2;
+    int zeros = pad_before(o, sp, n, strpbrk(buf, "0123456789") != NULL);
+
+    out(o, buf, zeros ? pfx : 0);
+    out_fill(o, '0', zeros);
+    out(o, buf + (zeros ? pfx : 0), n - (zeros ? pfx : 0));
+    pad_after(o, sp, n);
+}
+
+static uintmax_t arg_unsigned(enum fmt_len len, va_list *ap)
+{
+    switch (len) {
+    case LEN_HH: return (unsigned char)va_arg(*ap, unsigned int);
+    case LEN_H:  return (unsigned short)va_arg(*ap, unsigned int);
+    case LEN_L:  return va_arg(*ap, unsigned long);
+    case LEN_LL: return va_arg(*ap, unsigned long long);
+    case LEN_Z:  return va_arg(*ap, size_t);
+    case LEN_J:  return va_arg(*ap, uintmax_t);
+    case LEN_T:  return (uintmax_t)va_arg(*ap, ptrdiff_t);
+    default:     return va_arg(*ap, unsigned int);
+    }
+}
+
+static intmax_t arg_signed(enum fmt_len len, va_list *ap)
+{
+    switch (len) {
+    case LEN_HH: return (signed char)va_arg(*ap, int);
+    case LEN_H:  return (short)va_arg(*ap, int);
+    case LEN_L:  return va_arg(*ap, long);
+    case LEN_LL: return va_arg(*ap, long long);
+    case LEN_Z:  return (intmax_t)va_arg(*ap, size_t);
+    case LEN_J:  return va_arg(*ap, intmax_t);
+    case LEN_T:  return va_arg(*ap, ptrdiff_t);
+    default:     return va_arg(*ap, int);
+    }
+}
+
+static void store_count(enum fmt_len len, va_list *ap, int count)
+{
+    switch (len) {
+    case LEN_HH: *va_arg(*ap, signed char *) = count; break;
+    case LEN_H:  *va_arg(*ap, short *) = count; break;
+    case LEN_L:  *va_arg(*ap, long *) = count; break;
+    case LEN_LL: *va_arg(*ap, long long *) = count; break;
+    case LEN_Z:  *va_arg(*ap, size_t *) = count; break;
+    case LEN_J:  *va_arg(*ap, intmax_t *) = count; break;
+    case LEN_T:  *va_arg(*ap, ptrdiff_t *) = count; break;
+    default:     *va_arg(*ap, int *) = count; break;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Driver loop                                                                */
+/* -------------------------------------------------------------------------- */
+
+int launchpad_vtty_vformat(launchpad_vtty_emit_t emit, void *ctx, const char *fmt, va_list ap_in)
+{
+    struct fmt_out o = { .emit = emit, .ctx = ctx };
+    va_list ap;
+
+    if (!emit || !fmt)
+        return -1;
+
+    va_copy(ap, ap_in);
+
+    while (*fmt && !o.err) {
+        /* Literal run up to the next conversion */
+        const char *pct = strchr(fmt, '%');
+        if (!pct) {
+            out(&o, fmt, strlen(fmt));
+            break;
+        }
+        out(&o, fmt, pct - fmt);
+        fmt = pct + 1;
+
+        struct fmt_spec sp = { .prec = -1 };
+
+        for (;; fmt++) {
+            if (*fmt == '-')      sp.flags |= F_LEFT;
+            else if (*fmt == '+') sp.flags |= F_PLUS;
+            else if (*fmt == ' ') sp.flags |= F_SPACE;
+            else if (*fmt == '#') sp.flags |= F_ALT;
+            else if (*fmt == '0') sp.flags |= F_ZERO;
+            else break;
+        }
+
+        if (*fmt == '*') {
+            sp.width = va_arg(ap, int);
+            if (sp.width < 0) {
+                sp.flags |= F_LEFT;
+                sp.width = -sp.width;
+            }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9')
+                sp.width = sp.width * 10 + (*fmt++ - '0');
+        }
+
+        if (*fmt == '.') {
+            fmt++;
+            sp.prec = 0;
+            if (*fmt == '*') {
+                sp.prec = va_arg(ap, int);
+                if (sp.prec < 0)
+                    sp.prec = -1;
+                fmt++;
+            } else {
+                while (*fmt >= '0' && *fmt <= '9')
+                    sp.prec = sp.prec * 10 + (*fmt++ - '0');
+            }
+        }
+
+        switch (*fmt) {
+        case 'h':
+            sp.len = (fmt[1] == 'h') ? LEN_HH : LEN_H;
+            fmt += (sp.len == LEN_HH) ? 2 : 1;
+            break;
+        case 'l':
+            sp.len = (fmt[1] == 'l') ? LEN_LL : LEN_L;
+            fmt += (sp.len == LEN_LL) ? 2 : 1;
+            break;
+        case 'z': sp.len = LEN_Z;  fmt++; break;
+        case 'j': sp.len = LEN_J;  fmt++; break;
+        case 't': sp.len = LEN_T;  fmt++; break;
+        case 'L': sp.len = LEN_LD; fmt++; break;
+        default: break;
+        }
+
+        char conv = *fmt;
+        if (!conv)
+            break;
+        fmt++;
+
+        switch (conv) {
+        case 'd':
+        case 'i': {
+            intmax_t v = arg_signed(sp.len, &ap);
+            fmt_int(&o, &sp, conv, v < 0 ? -(uintmax_t)v : (uintmax_t)v, v < 0);
+            break;
+        }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            sp.flags &= ~(F_PLUS | F_SPACE);
+            fmt_int(&o, &sp, conv, arg_unsigned(sp.len, &ap), false);
+            break;
+        case 'p':
+            sp.flags = (sp.flags & F_LEFT) | F_ALT;
+            fmt_int(&o, &sp, conv, (uintptr_t)va_arg(ap, void *), false);
+            break;
+        case 'c': {
+            char c = (char)va_arg(ap, int);
+            fmt_str(&o, &sp, &c, 1);
+            break;
+        }
+        case 's': {
+            const char *s = va_arg(ap, const char *);
+            if (!s)
+                s = "(null)";
+            fmt_str(&o, &sp, s, sp.prec >= 0 ? strnlen(s, sp.prec) : strlen(s));
+            break;
+        }
+        case 'f': case 'F':
+        case 'e': case 'E':
+        case 'g': case 'G':
+        case 'a': case 'A':
+            fmt_float(&o, &sp, conv, &ap);
+            break;
+        case 'n':
+            store_count(sp.len, &ap, o.count);
+            break;
+        case '%':
+            out(&o, "%", 1);
+            break;
+        default:
+            /* Unknown conversion: print it as written */
+            out(&o, pct, fmt - pct);
+            break;
+        }
+    }
+
+    va_end(ap);
+    return o.err ? -1 : o.count;
+}
@@ -0,0 +1,640 @@
+#include "launchpad_vtty_queue.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_heap_caps.h"
+
+/* Ring size in bytes; a power of two up to 64 KiB */
+#ifndef LAUNCHPAD_VTTY_QUEUE_SIZE
+#define LAUNCHPAD_VTTY_QUEUE_SIZE 4096
+#endif
+
+/* What a producer does when the ring is full */
+#ifndef LAUNCHPAD_VTTY_QUEUE_POLICY
+#define LAUNCHPAD_VTTY_QUEUE_POLICY LAUNCHPAD_VTTY_POLICY_BLOCK
+#endif
+
+/* Stack buffer of one printf; output up to this size is a single record */
+#ifndef LAUNCHPAD_VTTY_PRINTF_BUF
+#define LAUNCHPAD_VTTY_PRINTF_BUF (LAUNCHPAD_VTTY_QUEUE_SIZE < 1024 ? LAUNCHPAD_VTTY_QUEUE_SIZE / 4 : 256)
+#endif
+
+#ifndef LAUNCHPAD_VTTY_FLUSH_STACK
+#define LAUNCHPAD_VTTY_FLUSH_STACK 3072
+#endif
+
+#ifndef LAUNCHPAD_VTTY_FLUSH_PRIO
+#define LAUNCHPAD_VTTY_FLUSH_PRIO (tskIDLE_PRIORITY + 1)
+#endif
+
+/* A sink further behind than this loses output instead of holding
+ * ring space the producers need */
+#ifndef LAUNCHPAD_VTTY_SINK_LAG_MAX
+#define LAUNCHPAD_VTTY_SINK_LAG_MAX (LAUNCHPAD_VTTY_QUEUE_SIZE / 2)
+#endif
+
+#ifndef LAUNCHPAD_VTTY_SINK_STACK
+#define LAUNCHPAD_VTTY_SINK_STACK 4096
+#endif
+
+#ifndef LAUNCHPAD_VTTY_SINK_PRIO
+#define LAUNCHPAD_VTTY_SINK_PRIO (tskIDLE_PRIORITY + 1)
+#endif
+
+_Static_assert((LAUNCHPAD_VTTY_QUEUE_SIZE & (LAUNCHPAD_VTTY_QUEUE_SIZE - 1)) == 0 &&
+               LAUNCHPAD_VTTY_QUEUE_SIZE <= 65536,
+               "LAUNCHPAD_VTTY_QUEUE_SIZE must be a power of two up to 64 KiB");
+
+#define QUEUE_MASK      (LAUNCHPAD_VTTY_QUEUE_SIZE - 1)
+
+/*
+ * Record header, one word at a 4-byte aligned ring offset:
+ *   bit 31     committed (0 while the producer is still writing)
+ *   bit 30     padding up to the end of the ring, skipped
+ *   bits 16-23 driver slot
+ *   bits 0-15  payload length (padding: length of the whole gap)
+ */
+#define REC_COMMITTED   0x80000000u
+#define REC_PAD         0x40000000u
+#define REC_IDX_SHIFT   16
+#define REC_LEN_MASK    0xFFFFu
+#define REC_HDR         4
+#define REC_MAX         (LAUNCHPAD_VTTY_QUEUE_SIZE / 4)    /* larger writes are split */
+
+#define REC_SIZE(len)   ((REC_HDR + (len) + 3) & ~3u)
+
+_Static_assert(LAUNCHPAD_VTTY_PRINTF_BUF <= REC_MAX,
+               "LAUNCHPAD_VTTY_PRINTF_BUF must fit in one record");
+
+/* Bytes the flusher collects before calling a driver */
+#define STAGE_SIZE      256
+
+#define PROGRESS_BIT    (1 << 0)
+
+/* Bits of vtty_queue.sleepers: the flusher, then one per sink slot */
+#define SLEEP_FLUSHER   (1u << 0)
+#define SLEEP_SINK(i)   (1u << ((i) + 1))
+
+enum { SINK_FREE, SINK_ACTIVE, SINK_STOPPING };
+
+struct vtty_sink {
+    int state;
+    char name[16];
+    launchpad_vtty_emit_t write;
+    void (*close)(void *ctx);
+    void *ctx;
+    uint32_t cursor;            /* read up to; owned by the sink task */
+    char *stage;
+    TickType_t since;
+    SemaphoreHandle_t wake;
+    StaticSemaphore_t wake_buf;
+    uint32_t bytes;
+    uint32_t dropped_bytes;
+    uint32_t max_lag;
+};
+
+struct vtty_queue {
+    uint8_t *ring;
+    uint32_t head;              /* reserved up to (producers) */
+    uint32_t tail;              /* freed up to (flusher) */
+    uint32_t reclaim;           /* being freed up to; >= tail */
+    uint32_t done;              /* delivered to drivers up to */
+    int policy;
+    uint32_t sleepers;          /* consumers waiting for a commit */
+    TaskHandle_t task;
+    EventGroupHandle_t progress;
+    struct launchpad_vtty_stats stats;
+    struct vtty_sink sinks[LAUNCHPAD_VTTY_MAX_SINKS];
+};
+
+static struct vtty_queue g_q = {
+    .policy = LAUNCHPAD_VTTY_QUEUE_POLICY,
+};
+
+#define STAT_ADD(field, n) __atomic_add_fetch(&g_q.stats.field, (n), __ATOMIC_RELAXED)
+
+/* -------------------------------------------------------------------------- */
+/* Producers                                                                  */
+/* -------------------------------------------------------------------------- */
+
+/* Claim room for a @len byte record; NULL when the ring is full */
+static uint8_t *q_reserve(uint32_t len)
+{
+    const uint32_t total = REC_SIZE(len);
+    uint32_t head = __atomic_load_n(&g_q.head, __ATOMIC_RELAXED);
+
+    for (;;) {
+        uint32_t tail = __atomic_load_n(&g_q.tail, __ATOMIC_ACQUIRE);
+        uint32_t off = head & QUEUE_MASK;
+        uint32_t pad = (off + total > LAUNCHPAD_VTTY_QUEUE_SIZE) ? LAUNCHPAD_VTTY_QUEUE_SIZE - off : 0;
+        uint32_t used = head + pad + total - tail;
+
+        if (used > LAUNCHPAD_VTTY_QUEUE_SIZE)
+            return NULL;
+
+        if (__atomic_compare_exchange_n(&g_q.head, &head, head + pad + total, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            /* Statistics only: a lost update between producers is harmless */
+            if (used > __atomic_load_n(&g_q.stats.high_water, __ATOMIC_RELAXED))
+                __atomic_store_n(&g_q.stats.high_water, used, __ATOMIC_RELAXED);
+            if (pad)
+                __atomic_store_n((uint32_t *)(g_q.ring + off), REC_COMMITTED | REC_PAD | pad,
+                                 __ATOMIC_SEQ_CST);
+            return g_q.ring + ((head + pad) & QUEUE_MASK);
+        }
+    }
+}
+
+static bool q_can_block(void)
+{
+    return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING &&
+           xTaskGetCurrentTaskHandle() != g_q.task;
+}
+
+/* Wait for the flusher to make progress; may return early */
+static void q_wait_progress(void)
+{
+    xTaskNotifyGive(g_q.task);
+    xEventGroupWaitBits(g_q.progress, PROGRESS_BIT, pdTRUE, pdTRUE, 1);
+}
+
+static uint8_t *q_reserve_wait(uint32_t len)
+{
+    uint8_t *rec = q_reserve(len);
+    if (rec)
+        return rec;
+
+    if (g_q.policy == LAUNCHPAD_VTTY_POLICY_BLOCK && q_can_block()) {
+        STAT_ADD(blocked, 1);
+        do {
+            q_wait_progress();
+        } while (!(rec = q_reserve(len)));
+        return rec;
+    }
+
+    STAT_ADD(dropped, 1);
+    STAT_ADD(dropped_bytes, len);
+    return NULL;
+}
+
+static void q_commit(uint8_t *rec, int idx, uint32_t len)
+{
+    __atomic_store_n((uint32_t *)rec, REC_COMMITTED | ((uint32_t)idx << REC_IDX_SHIFT) | len,
+                     __ATOMIC_SEQ_CST);
+    STAT_ADD(records, 1);
+
+    uint32_t sleepers = __atomic_load_n(&g_q.sleepers, __ATOMIC_SEQ_CST);
+    if (sleepers & SLEEP_FLUSHER)
+        xTaskNotifyGive(g_q.task);
+    for (int i = 0; sleepers >>= 1; ++i) {
+        if (sleepers & 1)
+            xSemaphoreGive(g_q.sinks[i].wake);
+    }
+}
+
+int vtty_queue_write(int idx, const char *buf, size_t len)
+{
+    size_t done = 0;
+
+    if (!g_q.ring) {
+        vtty_deliver(idx, buf, len);
+        return (int)len;
+    }
+
+    while (done < len) {
+        uint32_t n = (len - done > REC_MAX) ? REC_MAX : (uint32_t)(len - done);
+        uint8_t *rec = q_reserve_wait(n);
+        if (!rec)
+            return done ? (int)done : -1;
+
+        memcpy(rec + REC_HDR, buf + done, n);
+        q_commit(rec, idx, n);
+        done += n;
+    }
+    return (int)len;
+}
+
+/* Formatted output is collected on the caller's stack and queued one
+ * buffer at a time: a printf that fits is one record, a longer one
+ * becomes several and may interleave with other writers */
+struct q_stream {
+    int idx;
+    size_t len;
+    char buf[LAUNCHPAD_VTTY_PRINTF_BUF];
+};
+
+static int q_stream_emit(void *ctx, const char *buf, size_t len)
+{
+    struct q_stream *st = ctx;
+
+    while (len) {
+        size_t n = sizeof(st->buf) - st->len;
+        if (n > len)
+            n = len;
+        memcpy(st->buf + st->len, buf, n);
+        st->len += n;
+        buf += n;
+        len -= n;
+        if (st->len == sizeof(st->buf)) {
+            vtty_queue_write(st->idx, st->buf, st->len);
+            st->len = 0;
+        }
+    }
+    return 0;
+}
+
+int vtty_queue_vprintf(int idx, const char *fmt, va_list ap)
+{
+    struct q_stream st = { .idx = idx };
+    int n;
+
+    /* One pass: "%n" stores once and wide floats are formatted once */
+    n = launchpad_vtty_vformat(q_stream_emit, &st, fmt, ap);
+    if (st.len)
+        vtty_queue_write(idx, st.buf, st.len);
+    return n;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Flusher                                                                    */
+/* -------------------------------------------------------------------------- */
+
+static bool q_committed_at(uint32_t pos)
+{
+    uint32_t hdr = __atomic_load_n((uint32_t *)(g_q.ring + (pos & QUEUE_MASK)), __ATOMIC_SEQ_CST);
+    return hdr & REC_COMMITTED;
+}
+
+/* Free ring space nobody needs any more: below the driver position and
+ * every sink cursor, except for sinks lagging past the limit */
+static bool q_release(void)
+{
+    uint32_t tail = g_q.tail;
+    uint32_t target = g_q.done;
+
+    for (int i = 0; i < LAUNCHPAD_VTTY_MAX_SINKS; ++i) {
+        struct vtty_sink *sk = &g_q.sinks[i];
+        if (__atomic_load_n(&sk->state, __ATOMIC_ACQUIRE) == SINK_FREE)
+            continue;
+
+        uint32_t c = __atomic_load_n(&sk->cursor, __ATOMIC_ACQUIRE);
+        if ((int32_t)(g_q.done - c) > LAUNCHPAD_VTTY_SINK_LAG_MAX)
+            c = g_q.done - LAUNCHPAD_VTTY_SINK_LAG_MAX;
+        if ((int32_t)(c - tail) < 0)
+            c = tail;
+        if ((int32_t)(c - target) < 0)
+            target = c;
+    }
+    if (target == tail)
+        return false;
+
+    /* Sinks check reclaim after copying, so announce it before zeroing */
+    __atomic_store_n(&g_q.reclaim, target, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    /* Zero what is freed: an uncommitted header must read as 0 */
+    uint32_t off = tail & QUEUE_MASK;
+    uint32_t n = target - tail;
+    if (off + n > LAUNCHPAD_VTTY_QUEUE_SIZE) {
+        memset(g_q.ring + off, 0, LAUNCHPAD_VTTY_QUEUE_SIZE - off);
+        memset(g_q.ring, 0, off + n - LAUNCHPAD_VTTY_QUEUE_SIZE);
+    } else {
+        memset(g_q.ring + off, 0, n);
+    }
+
+    __atomic_store_n(&g_q.tail, target, __ATOMIC_RELEASE);
+    xEventGroupSetBits(g_q.progress, PROGRESS_BIT);
+    return true;
+}
+
+static void q_delivered(uint32_t pos)
+{
+    __atomic_store_n(&g_q.done, pos, __ATOMIC_RELEASE);
+    q_release();
+}
+
+/* Hand every committed record to its driver; false if there was none */
+static bool q_drain(void)
+{
+    const uint32_t start = g_q.done;
+    uint32_t pos = start;
+    char stage[STAGE_SIZE];
+    size_t slen = 0;
+    int sidx = -1;
+
+    for (;;) {
+        uint8_t *rec = g_q.ring + (pos & QUEUE_MASK);
+        uint32_t hdr = __atomic_load_n((uint32_t *)rec, __ATOMIC_SEQ_CST);
+        uint32_t len = hdr & REC_LEN_MASK;
+
+        if (!(hdr & REC_COMMITTED))
+            break;
+
+        if (hdr & REC_PAD) {
+            pos += len;
+            continue;
+        }
+
+        int idx = (hdr >> REC_IDX_SHIFT) & 0xFF;
+        if (slen && (idx != sidx || slen + len > sizeof(stage))) {
+            vtty_deliver(sidx, stage, slen);
+            slen = 0;
+            q_delivered(pos);
+        }
+        STAT_ADD(bytes, len);
+        pos += REC_SIZE(len);
+
+        if (len > sizeof(stage)) {
+            vtty_deliver(idx, (const char *)rec + REC_HDR, len);
+            q_delivered(pos);
+        } else {
+            memcpy(stage + slen, rec + REC_HDR, len);
+            slen += len;
+            sidx = idx;
+        }
+    }
+
+    if (slen)
+        vtty_deliver(sidx, stage, slen);
+    if (pos == start)
+        return false;
+    q_delivered(pos);
+    return true;
+}
+
+static void vtty_flush_task(void *arg)
+{
+    for (;;) {
+        /* Also woken by sinks that moved on, to free their space */
+        if (q_drain() | q_release())
+            continue;
+
+        /* Producers notify only while the bit is set; re-check after setting it */
+        __atomic_or_fetch(&g_q.sleepers, SLEEP_FLUSHER, __ATOMIC_SEQ_CST);
+        if (!q_committed_at(g_q.done))
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        __atomic_and_fetch(&g_q.sleepers, ~SLEEP_FLUSHER, __ATOMIC_SEQ_CST);
+    }
+}
+
+void vtty_queue_sync(void)
+{
+    if (!g_q.ring)
+        return;
+
+    uint32_t target = __atomic_load_n(&g_q.head, __ATOMIC_ACQUIRE);
+
+    if (!q_can_block()) {
+        q_drain();
+        return;
+    }
+
+    while ((int32_t)(__atomic_load_n(&g_q.done, __ATOMIC_ACQUIRE) - target) < 0)
+        q_wait_progress();
+}
+
+/* -------------------------------------------------------------------------- */
+/* Sinks                                                                      */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Copy committed records from the sink cursor into its stage buffer.
+ * Nothing stops the flusher from reclaiming the span meanwhile, so the
+ * copy is only trusted if reclaim has not passed the cursor afterwards.
+ */
+static size_t sink_collect(struct vtty_sink *sk, uint32_t *next)
+{
+    /* Below head the previous lap is already zeroed; beyond it a stale
+     * committed header may still be there */
+    const uint32_t head = __atomic_load_n(&g_q.head, __ATOMIC_ACQUIRE);
+    uint32_t pos = sk->cursor;
+    size_t n = 0;
+
+    while ((int32_t)(head - pos) > 0) {
+        uint32_t off = pos & QUEUE_MASK;
+        uint32_t hdr = __atomic_load_n((uint32_t *)(g_q.ring + off), __ATOMIC_ACQUIRE);
+        uint32_t len = hdr & REC_LEN_MASK;
+
+        if (!(hdr & REC_COMMITTED))
+            break;
+        if (hdr & REC_PAD) {
+            if (!len)
+                break;
+            pos += len;
+            continue;
+        }
+        /* A header torn by reclaim can hold anything; stay in bounds */
+        if (n + len > REC_MAX || off + REC_SIZE(len) > LAUNCHPAD_VTTY_QUEUE_SIZE)
+            break;
+        memcpy(sk->stage + n, g_q.ring + off + REC_HDR, len);
+        n += len;
+        pos += REC_SIZE(len);
+    }
+
+    *next = pos;
+    return n;
+}
+
+static void vtty_sink_task(void *arg)
+{
+    struct vtty_sink *sk = arg;
+    const int i = sk - g_q.sinks;
+
+    while (__atomic_load_n(&sk->state, __ATOMIC_ACQUIRE) == SINK_ACTIVE) {
+        uint32_t next;
+        size_t n = sink_collect(sk, &next);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t reclaim = __atomic_load_n(&g_q.reclaim, __ATOMIC_RELAXED);
+        uint32_t prev = sk->cursor;
+
+        if ((int32_t)(reclaim - prev) > 0) {
+            /* Fell too far behind and the copy may be torn. Reclaim can
+             * stop mid-record; the driver position is always a boundary
+             * and is never reclaimed past. */
+            uint32_t done = __atomic_load_n(&g_q.done, __ATOMIC_ACQUIRE);
+            __atomic_add_fetch(&sk->dropped_bytes, done - prev, __ATOMIC_RELAXED);
+            __atomic_store_n(&sk->cursor, done, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        if (next == prev) {
+            __atomic_or_fetch(&g_q.sleepers, SLEEP_SINK(i), __ATOMIC_SEQ_CST);
+            if ((int32_t)(__atomic_load_n(&g_q.head, __ATOMIC_SEQ_CST) - prev) <= 0 || !q_committed_at(prev))
+                xSemaphoreTake(sk->wake, portMAX_DELAY);
+            __atomic_and_fetch(&g_q.sleepers, ~SLEEP_SINK(i), __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        uint32_t lag = __atomic_load_n(&g_q.head, __ATOMIC_RELAXED) - prev;
+        if (lag > sk->max_lag)
+            __atomic_store_n(&sk->max_lag, lag, __ATOMIC_RELAXED);
+
+        if (n && sk->write(sk->ctx, sk->stage, n) >= 0)
+            __atomic_add_fetch(&sk->bytes, n, __ATOMIC_RELAXED);
+        __atomic_store_n(&sk->cursor, next, __ATOMIC_RELEASE);
+
+        /* This sink may have been what held the ring tail back */
+        if ((int32_t)(prev - __atomic_load_n(&g_q.tail, __ATOMIC_ACQUIRE)) <= 0)
+            xTaskNotifyGive(g_q.task);
+    }
+
+    __atomic_store_n(&sk->state, SINK_FREE, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+int vtty_queue_add_sink(const char *name, launchpad_vtty_emit_t write, void (*close)(void *ctx), void *ctx)
+{
+    if (!g_q.ring || !write)
+        return -1;
+
+    for (int i = 0; i < LAUNCHPAD_VTTY_MAX_SINKS; ++i) {
+        struct vtty_sink *sk = &g_q.sinks[i];
+        int expected = SINK_FREE;
+
+        if (!__atomic_compare_exchange_n(&sk->state, &expected, SINK_STOPPING, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            continue;
+
+        sk->stage = heap_caps_malloc(REC_MAX, MALLOC_CAP_8BIT);
+        if (!sk->wake)
+            sk->wake = xSemaphoreCreateBinaryStatic(&sk->wake_buf);
+        if (!sk->stage) {
+            __atomic_store_n(&sk->state, SINK_FREE, __ATOMIC_RELEASE);
+            return -1;
+        }
+
+        snprintf(sk->name, sizeof(sk->name), "%s", name ? name : "sink");
+        sk->write = write;
+        sk->close = close;
+        sk->ctx = ctx;
+        sk->bytes = sk->dropped_bytes = sk->max_lag = 0;
+        sk->since = xTaskGetTickCount();
+        /* Only output from now on; the flusher tolerates a stale cursor */
+        sk->cursor = __atomic_load_n(&g_q.head, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&sk->state, SINK_ACTIVE, __ATOMIC_RELEASE);
+
+        if (xTaskCreate(vtty_sink_task, "vtty_sink", LAUNCHPAD_VTTY_SINK_STACK, sk,
+                        LAUNCHPAD_VTTY_SINK_PRIO, NULL) != pdPASS) {
+            heap_caps_free(sk->stage);
+            sk->stage = NULL;
+            __atomic_store_n(&sk->state, SINK_FREE, __ATOMIC_RELEASE);
+            return -1;
+        }
+        return i;
+    }
+    return -1;
+}
+
+int vtty_queue_remove_sink(int id)
+{
+    if (id < 0 || id >= LAUNCHPAD_VTTY_MAX_SINKS)
+        return -1;
+
+    struct vtty_sink *sk = &g_q.sinks[id];
+    int expected = SINK_ACTIVE;
+    if (!__atomic_compare_exchange_n(&sk->state, &expected, SINK_STOPPING, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        return -1;
+
+    xSemaphoreGive(sk->wake);
+    while (__atomic_load_n(&sk->state, __ATOMIC_ACQUIRE) != SINK_FREE)
+        vTaskDelay(1);
+
+    if (sk->close)
+        sk->close(sk->ctx);
+    heap_caps_free(sk->stage);
+    sk->stage = NULL;
+    xTaskNotifyGive(g_q.task);      /* its cursor no longer holds the tail */
+    return 0;
+}
+
+int vtty_queue_sink_stats(struct launchpad_vtty_sink_stats *st)
+{
+    if (st->id < 0 || st->id >= LAUNCHPAD_VTTY_MAX_SINKS)
+        return -1;
+
+    struct vtty_sink *sk = &g_q.sinks[st->id];
+    if (__atomic_load_n(&sk->state, __ATOMIC_ACQUIRE) != SINK_ACTIVE)
+        return -1;
+
+    uint32_t ms = pdTICKS_TO_MS(xTaskGetTickCount() - sk->since);
+
+    st->name = sk->name;
+    /* Counters are updated by the sink task while we read them */
+    st->bytes = __atomic_load_n(&sk->bytes, __ATOMIC_RELAXED);
+    st->dropped_bytes = __atomic_load_n(&sk->dropped_bytes, __ATOMIC_RELAXED);
+    st->lag = __atomic_load_n(&g_q.head, __ATOMIC_RELAXED) - __atomic_load_n(&sk->cursor, __ATOMIC_RELAXED);
+    st->max_lag = __atomic_load_n(&sk->max_lag, __ATOMIC_RELAXED);
+    st->throughput = ms ? (uint32_t)((uint64_t)st->bytes * 1000 / ms) : 0;
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Setup and control                                                          */
+/* -------------------------------------------------------------------------- */
+
+int vtty_queue_init(void)
+{
+    if (g_q.ring)
+        return 0;
+
+    g_q.progress = xEventGroupCreate();
+    g_q.ring = heap_caps_calloc(1, LAUNCHPAD_VTTY_QUEUE_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!g_q.progress || !g_q.ring)
+        goto fail;
+
+    g_q.head = g_q.tail = g_q.reclaim = g_q.done = 0;
+    if (xTaskCreate(vtty_flush_task, "vtty_flush", LAUNCHPAD_VTTY_FLUSH_STACK, NULL,
+                    LAUNCHPAD_VTTY_FLUSH_PRIO, &g_q.task) != pdPASS)
+        goto fail;
+    return 0;
+
+fail:
+    /* Output then goes to the drivers directly */
+    if (g_q.progress)
+        vEventGroupDelete(g_q.progress);
+    heap_caps_free(g_q.ring);
+    g_q.progress = NULL;
+    g_q.ring = NULL;
+    return -1;
+}
+
+void vtty_queue_deinit(void)
+{
+    if (!g_q.ring)
+        return;
+
+    for (int i = 0; i < LAUNCHPAD_VTTY_MAX_SINKS; ++i)
+        vtty_queue_remove_sink(i);
+    vtty_queue_sync();
+    vTaskDelete(g_q.task);
+    vEventGroupDelete(g_q.progress);
+    heap_caps_free(g_q.ring);
+    g_q.task = NULL;
+    g_q.progress = NULL;
+    g_q.ring = NULL;
+}
+
+void vtty_queue_get_stats(struct launchpad_vtty_stats *st)
+{
+    *st = g_q.stats;
+    st->queued = g_q.ring ? __atomic_load_n(&g_q.head, __ATOMIC_RELAXED) -
+                            __atomic_load_n(&g_q.tail, __ATOMIC_RELAXED) : 0;
+    st->policy = g_q.policy;
+}
+
+int vtty_queue_set_policy(int policy)
+{
+    if (policy != LAUNCHPAD_VTTY_POLICY_DROP && policy != LAUNCHPAD_VTTY_POLICY_BLOCK)
+        return -1;
+    g_q.policy = policy;
+    return 0;
+}
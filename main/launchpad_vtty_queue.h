@@ -0,0 +1,55 @@
+#ifndef LAUNCHPAD_VTTY_QUEUE_H
+#define LAUNCHPAD_VTTY_QUEUE_H
+
+/*
+ * Console output queue of the vtty core (not exported to apps).
+ *
+ * Producers reserve a record in a shared ring with one atomic and
+ * commit it when filled; a low-priority flusher task hands committed
+ * records to the drivers in order. A record is one write of up to a
+ * quarter of the ring, or one printf of up to LAUNCHPAD_VTTY_PRINTF_BUF
+ * bytes, and is never interleaved with other output; longer output is
+ * split into several records that other writers may come between.
+ *
+ * Committing wakes the flusher and sinks through task notifications and
+ * semaphores, so output is for task context only, never from an ISR.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include "launchpad_vtty.h"
+
+/* Extra outputs, each drained by its own task */
+#ifndef LAUNCHPAD_VTTY_MAX_SINKS
+#define LAUNCHPAD_VTTY_MAX_SINKS 4
+#endif
+
+int vtty_queue_init(void);
+void vtty_queue_deinit(void);
+
+/* Queue output for driver slot @idx; returns bytes queued or -1 */
+int vtty_queue_write(int idx, const char *buf, size_t len);
+int vtty_queue_vprintf(int idx, const char *fmt, va_list ap);
+
+/* Wait until everything queued so far has reached its driver */
+void vtty_queue_sync(void);
+
+void vtty_queue_get_stats(struct launchpad_vtty_stats *st);
+int vtty_queue_set_policy(int policy);
+
+/* Sinks see all output from the moment they are added, each through its
+ * own task and read cursor; @close (optional) runs on removal */
+int vtty_queue_add_sink(const char *name, launchpad_vtty_emit_t write, void (*close)(void *ctx), void *ctx);
+int vtty_queue_remove_sink(int id);
+int vtty_queue_sink_stats(struct launchpad_vtty_sink_stats *st);
+
+/* Ownership of sinks added through the public API: a sink added while an
+ * app runs belongs to it and is removed when it returns */
+int vtty_sink_track(int id);
+void vtty_sink_app_enter(void);
+void vtty_sink_app_exit(void);
+
+/* Provided by the core: pass bytes to the driver in slot @idx */
+void vtty_deliver(int idx, const char *buf, size_t len);
+
+#endif /* LAUNCHPAD_VTTY_QUEUE_H */
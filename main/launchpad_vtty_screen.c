@@ -0,0 +1,487 @@
+#include "launchpad_vtty_screen.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+/* Rewriting up to this many cells can be cheaper than a cursor escape */
+#define SCREEN_REWRITE_MAX 4
+
+#define COLOR_DEFAULT LAUNCHPAD_VTTY_COLOR_DEFAULT
+#define ATTR_VISIBLE_BLANK (LAUNCHPAD_VTTY_ATTR_UNDERLINE | LAUNCHPAD_VTTY_ATTR_REVERSE)
+
+struct vtty_cell {
+    char ch;
+    uint8_t attr;
+    uint8_t fg;
+    uint8_t bg;
+};
+
+struct launchpad_vtty_screen {
+    int rows;
+    int cols;
+    struct vtty_cell *front;    /* what the terminal shows */
+    struct vtty_cell *back;     /* frame being drawn */
+    struct vtty_cell pen;       /* style of new cells */
+    int cursor_row;             /* cursor after present, -1 leaves it */
+    int cursor_col;
+    bool full;                  /* terminal state unknown, redraw all */
+};
+
+/* Terminal state as far as present() knows it */
+struct term {
+    launchpad_vtty_emit_t emit;
+    void *ctx;
+    const struct launchpad_vtty_screen *scr;
+    int row;                    /* -1: unknown (also after a write to the last column) */
+    int col;
+    struct vtty_cell sgr;       /* current rendition, ch unused */
+    bool sgr_known;
+    int bytes;
+    bool err;
+    size_t len;
+    char buf[128];
+};
+
+/* -------------------------------------------------------------------------- */
+/* Cells                                                                      */
+/* -------------------------------------------------------------------------- */
+
+static inline bool cell_eq(struct vtty_cell a, struct vtty_cell b)
+{
+    return a.ch == b.ch && a.attr == b.attr && a.fg == b.fg && a.bg == b.bg;
+}
+
+static inline bool cell_is_blank(struct vtty_cell c)
+{
+    return c.ch == ' ' && c.attr == 0 && c.fg == COLOR_DEFAULT;
+}
+
+static inline struct vtty_cell cell_blank(uint8_t bg)
+{
+    return (struct vtty_cell){ .ch = ' ', .attr = 0, .fg = COLOR_DEFAULT, .bg = bg };
+}
+
+/* A space shows only its background unless underlined or reversed */
+static inline struct vtty_cell cell_make(const struct launchpad_vtty_screen *scr, char c)
+{
+    struct vtty_cell cell = scr->pen;
+
+    cell.ch = ((unsigned char)c < 0x20 || c == 0x7f) ? '?' : c;
+    if (cell.ch == ' ' && !(cell.attr & ATTR_VISIBLE_BLANK)) {
+        cell.attr = 0;
+        cell.fg = COLOR_DEFAULT;
+    }
+    return cell;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Output                                                                     */
+/* -------------------------------------------------------------------------- */
+
+static void term_flush(struct term *t)
+{
+    if (t->len && !t->err && t->emit(t->ctx, t->buf, t->len) < 0)
+        t->err = true;
+    t->len = 0;
+}
+
+static void term_out(struct term *t, const char *s, size_t n)
+{
+    t->bytes += (int)n;
+    while (n) {
+        if (t->len == sizeof(t->buf))
+            term_flush(t);
+        size_t k = sizeof(t->buf) - t->len;
+        if (k > n)
+            k = n;
+        memcpy(t->buf + t->len, s, k);
+        t->len += k;
+        s += k;
+        n -= k;
+    }
+}
+
+/* Room for the longest csi() or cup() sequence: ESC [ int ; int H */
+#define SEQ_MAX 32
+
+/* "ESC [ n f", with n omitted when it is 1 */
+static int csi(char *out, int n, char f)
+{
+    return (n == 1) ? sprintf(out, "\x1B[%c", f) : sprintf(out, "\x1B[%d%c", n, f);
+}
+
+static int cup(char *out, int row, int col)
+{
+    if (col == 0)
+        return row == 0 ? sprintf(out, "\x1B[H") : sprintf(out, "\x1B[%dH", row + 1);
+    return sprintf(out, "\x1B[%d;%dH", row + 1, col + 1);
+}
+
+static void color_param(char *p, int *n, int base, uint8_t color)
+{
+    if (color == COLOR_DEFAULT)
+        *n += sprintf(p + *n, "%s%d", *n ? ";" : "", base + 9);
+    else if (color < 8)
+        *n += sprintf(p + *n, "%s%d", *n ? ";" : "", base + color);
+    else
+        *n += sprintf(p + *n, "%s%d", *n ? ";" : "", base + 60 + (color - 8));
+}
+
+/* Switch the rendition to @target with the fewest parameters */
+static void term_sgr(struct term *t, struct vtty_cell target)
+{
+    static const struct { uint8_t attr; char code; } codes[] = {
+        { LAUNCHPAD_VTTY_ATTR_BOLD, '1' },
+        { LAUNCHPAD_VTTY_ATTR_UNDERLINE, '4' },
+        { LAUNCHPAD_VTTY_ATTR_REVERSE, '7' },
+    };
+    struct vtty_cell base = t->sgr;
+    char p[40];
+    int n = 0;
+
+    if (!t->sgr_known || (base.attr & ~target.attr)) {
+        p[n++] = '0';
+        base = cell_blank(COLOR_DEFAULT);
+    }
+    for (size_t i = 0; i < sizeof(codes) / sizeof(codes[0]); i++) {
+        if ((target.attr & codes[i].attr) && !(base.attr & codes[i].attr)) {
+            if (n)
+                p[n++] = ';';
+            p[n++] = codes[i].code;
+        }
+    }
+    if (target.fg != base.fg)
+        color_param(p, &n, 30, target.fg);
+    if (target.bg != base.bg)
+        color_param(p, &n, 40, target.bg);
+
+    t->sgr = target;
+    t->sgr_known = true;
+    if (!n)
+        return;
+
+    term_out(t, "\x1B[", 2);
+    if (!(n == 1 && p[0] == '0'))
+        term_out(t, p, n);
+    term_out(t, "m", 1);
+}
+
+/* Does the current rendition draw @cell as it should? */
+static bool term_fits(const struct term *t, struct vtty_cell cell)
+{
+    if (!t->sgr_known)
+        return false;
+    if (cell_is_blank(cell))
+        return t->sgr.bg == cell.bg && !(t->sgr.attr & ATTR_VISIBLE_BLANK);
+    return t->sgr.attr == cell.attr && t->sgr.fg == cell.fg && t->sgr.bg == cell.bg;
+}
+
+static void term_style(struct term *t, struct vtty_cell cell)
+{
+    if (term_fits(t, cell))
+        return;
+
+    if (cell_is_blank(cell) && t->sgr_known) {
+        /* Keep what does not show on a blank cell */
+        struct vtty_cell target = t->sgr;
+        target.attr &= ~ATTR_VISIBLE_BLANK;
+        target.bg = cell.bg;
+        term_sgr(t, target);
+    } else {
+        term_sgr(t, cell);
+    }
+}
+
+/* Move to (@row, @col) by the shortest of the sequences that get there */
+static void term_move(struct term *t, int row, int col)
+{
+    const struct launchpad_vtty_screen *scr = t->scr;
+    char best[SEQ_MAX];
+    char cand[SEQ_MAX];
+    int blen;
+    int n;
+
+    if (t->row == row && t->col == col)
+        return;
+
+    blen = cup(best, row, col);
+
+#define TAKE(len) do { if ((len) < blen) { memcpy(best, cand, (len)); blen = (len); } } while (0)
+
+    if (t->row == row && col > t->col) {
+        const struct vtty_cell *b = scr->back + row * scr->cols;
+        int gap = col - t->col;
+
+        n = csi(cand, gap, 'C');
+        TAKE(n);
+
+        /* Reprint the cells in between if they need no style change */
+        if (gap <= SCREEN_REWRITE_MAX && gap < blen) {
+            bool ok = true;
+            for (int c = t->col; c < col && ok; c++)
+                ok = term_fits(t, b[c]);
+            if (ok) {
+                for (int c = t->col; c < col; c++)
+                    cand[c - t->col] = b[c].ch;
+                TAKE(gap);
+            }
+        }
+    } else if (t->row == row) {
+        int back = t->col - col;
+
+        n = csi(cand, back, 'D');
+        TAKE(n);
+        if (back <= SCREEN_REWRITE_MAX) {
+            memset(cand, '\b', back);
+            TAKE(back);
+        }
+        cand[0] = '\r';
+        n = col ? 1 + csi(cand + 1, col, 'C') : 1;
+        TAKE(n);
+    } else if (t->row >= 0) {
+        int down = row - t->row;
+
+        if (col == t->col) {
+            n = csi(cand, down > 0 ? down : -down, down > 0 ? 'B' : 'A');
+            TAKE(n);
+        }
+        /* LF never scrolls here: the target row is on screen */
+        if (col == 0 && down > 0 && down <= SCREEN_REWRITE_MAX) {
+            n = 0;
+            if (t->col != 0)
+                cand[n++] = '\r';
+            memset(cand + n, '\n', down);
+            n += down;
+            TAKE(n);
+        }
+    }
+
+#undef TAKE
+
+    term_out(t, best, blen);
+    t->row = row;
+    t->col = col;
+}
+
+static void term_cell(struct term *t, int row, int col, struct vtty_cell cell)
+{
+    term_move(t, row, col);
+    term_style(t, cell);
+    term_out(t, &cell.ch, 1);
+
+    /* The cursor waits at the last column until the next character wraps */
+    if (++t->col >= t->scr->cols)
+        t->row = t->col = -1;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Diff                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void present_row(struct term *t, struct launchpad_vtty_screen *scr, int row)
+{
+    struct vtty_cell *f = scr->front + row * scr->cols;
+    const struct vtty_cell *b = scr->back + row * scr->cols;
+    const int cols = scr->cols;
+    char seq[SEQ_MAX];
+
+    /* Blank tail of the new row that "erase to end of line" can produce */
+    int tail = cols;
+    if (cell_is_blank(b[cols - 1])) {
+        tail = cols - 1;
+        while (tail > 0 && cell_eq(b[tail - 1], b[cols - 1]))
+            tail--;
+    }
+
+    for (int c = 0; c < cols; c++) {
+        if (cell_eq(f[c], b[c]))
+            continue;
+
+        if (c >= tail) {
+            int changed = 0;
+            for (int k = c; k < cols; k++)
+                changed += !cell_eq(f[k], b[k]);
+            if (changed > 3) {
+                term_move(t, row, c);
+                term_style(t, b[c]);
+                term_out(t, "\x1B[K", 3);
+                memcpy(&f[c], &b[c], (cols - c) * sizeof(*f));
+                return;
+            }
+        }
+
+        if (cell_is_blank(b[c])) {
+            /* Run of equal blanks, cut after its last changed cell */
+            int end = c, changed = 0;
+            for (int k = c; k < cols && cell_eq(b[k], b[c]); k++) {
+                if (!cell_eq(f[k], b[k])) {
+                    end = k;
+                    changed++;
+                }
+            }
+            int n = csi(seq, end - c + 1, 'X');
+            if (changed > n) {
+                term_move(t, row, c);
+                term_style(t, b[c]);
+                term_out(t, seq, n);
+                memcpy(&f[c], &b[c], (end - c + 1) * sizeof(*f));
+                c = end;
+                continue;
+            }
+        }
+
+        term_cell(t, row, c, b[c]);
+        f[c] = b[c];
+    }
+}
+
+int launchpad_vtty_screen_present_to(launchpad_vtty_screen_t *scr, launchpad_vtty_emit_t emit, void *ctx)
+{
+    struct term t = {
+        .emit = emit,
+        .ctx = ctx,
+        .scr = scr,
+        .row = -1,
+        .col = -1,
+    };
+
+    if (!scr || !emit)
+        return -1;
+
+    if (scr->full) {
+        term_out(&t, "\x1B[m\x1B[2J", 7);
+        t.sgr = cell_blank(COLOR_DEFAULT);
+        t.sgr_known = true;
+        for (int i = 0; i < scr->rows * scr->cols; i++)
+            scr->front[i] = t.sgr;
+        scr->full = false;
+    }
+
+    for (int row = 0; row < scr->rows; row++)
+        present_row(&t, scr, row);
+
+    if (scr->cursor_row >= 0)
+        term_move(&t, scr->cursor_row, scr->cursor_col);
+
+    term_flush(&t);
+    if (t.err) {
+        scr->full = true;
+        return -1;
+    }
+    return t.bytes;
+}
+
+static int screen_emit(void *ctx, const char *buf, size_t len)
+{
+    return launchpad_vtty_write(buf, len) < 0 ? -1 : 0;
+}
+
+int launchpad_vtty_screen_present(launchpad_vtty_screen_t *scr)
+{
+    int n = launchpad_vtty_screen_present_to(scr, screen_emit, NULL);
+    launchpad_vtty_flush();
+    return n;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Drawing                                                                    */
+/* -------------------------------------------------------------------------- */
+
+launchpad_vtty_screen_t *launchpad_vtty_screen_create(int rows, int cols)
+{
+    if (rows <= 0 || cols <= 0)
+        return NULL;
+
+    launchpad_vtty_screen_t *scr = calloc(1, sizeof(*scr));
+    if (!scr)
+        return NULL;
+
+    scr->rows = rows;
+    scr->cols = cols;
+    scr->front = malloc(rows * cols * sizeof(struct vtty_cell));
+    scr->back = malloc(rows * cols * sizeof(struct vtty_cell));
+    if (!scr->front || !scr->back) {
+        launchpad_vtty_screen_destroy(scr);
+        return NULL;
+    }
+
+    scr->pen = cell_blank(COLOR_DEFAULT);
+    scr->cursor_row = -1;
+    scr->cursor_col = -1;
+    scr->full = true;
+    launchpad_vtty_screen_clear(scr);
+    return scr;
+}
+
+void launchpad_vtty_screen_destroy(launchpad_vtty_screen_t *scr)
+{
+    if (!scr)
+        return;
+    free(scr->front);
+    free(scr->back);
+    free(scr);
+}
+
+void launchpad_vtty_screen_clear(launchpad_vtty_screen_t *scr)
+{
+    struct vtty_cell blank = cell_blank(scr->pen.bg);
+
+    for (int i = 0; i < scr->rows * scr->cols; i++)
+        scr->back[i] = blank;
+}
+
+void launchpad_vtty_screen_set_style(launchpad_vtty_screen_t *scr, uint8_t attr, uint8_t fg, uint8_t bg)
+{
+    scr->pen.attr = attr;
+    scr->pen.fg = fg > COLOR_DEFAULT ? COLOR_DEFAULT : fg;
+    scr->pen.bg = bg > COLOR_DEFAULT ? COLOR_DEFAULT : bg;
+}
+
+void launchpad_vtty_screen_putc(launchpad_vtty_screen_t *scr, int row, int col, char c)
+{
+    if (row < 0 || row >= scr->rows || col < 0 || col >= scr->cols)
+        return;
+    scr->back[row * scr->cols + col] = cell_make(scr, c);
+}
+
+int launchpad_vtty_screen_puts(launchpad_vtty_screen_t *scr, int row, int col, const char *s)
+{
+    int n = 0;
+
+    if (!s || row < 0 || row >= scr->rows)
+        return 0;
+    for (; *s && col < scr->cols; s++, col++) {
+        if (col >= 0) {
+            scr->back[row * scr->cols + col] = cell_make(scr, *s);
+            n++;
+        }
+    }
+    return n;
+}
+
+void launchpad_vtty_screen_fill(launchpad_vtty_screen_t *scr, int row, int col, int rows, int cols, char c)
+{
+    struct vtty_cell cell = cell_make(scr, c);
+
+    for (int r = row < 0 ? 0 : row; r < row + rows && r < scr->rows; r++) {
+        for (int k = col < 0 ? 0 : col; k < col + cols && k < scr->cols; k++)
+            scr->back[r * scr->cols + k] = cell;
+    }
+}
+
+void launchpad_vtty_screen_set_cursor(launchpad_vtty_screen_t *scr, int row, int col)
+{
+    if (row < 0 || row >= scr->rows || col < 0 || col >= scr->cols) {
+        scr->cursor_row = scr->cursor_col = -1;
+        return;
+    }
+    scr->cursor_row = row;
+    scr->cursor_col = col;
+}
+
+void launchpad_vtty_screen_invalidate(launchpad_vtty_screen_t *scr)
+{
+    scr->full = true;
+}
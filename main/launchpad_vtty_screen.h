@@ -0,0 +1,54 @@
+#ifndef LAUNCHPAD_VTTY_SCREEN_H
+#define LAUNCHPAD_VTTY_SCREEN_H
+
+#include <stdint.h>
+#include "launchpad_vtty.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Double-buffered character screen for TUIs on a vtty.
+ *
+ * Apps draw into a back buffer of cells; present() compares it with
+ * what the terminal already shows and sends only the difference as
+ * ANSI escapes (shortest cursor motion, attribute deltas, erase for
+ * blank runs). Coordinates are 0-based.
+ */
+typedef struct launchpad_vtty_screen launchpad_vtty_screen_t;
+
+/** Cell attributes. */
+enum {
+    LAUNCHPAD_VTTY_ATTR_BOLD      = 1 << 0,
+    LAUNCHPAD_VTTY_ATTR_UNDERLINE = 1 << 1,
+    LAUNCHPAD_VTTY_ATTR_REVERSE   = 1 << 2,
+};
+
+/** Colors 0-7 are the ANSI colors, 8-15 their bright variants. */
+#define LAUNCHPAD_VTTY_COLOR_DEFAULT 16
+
+launchpad_vtty_screen_t *launchpad_vtty_screen_create(int rows, int cols);
+void launchpad_vtty_screen_destroy(launchpad_vtty_screen_t *scr);
+
+/* Drawing into the back buffer */
+void launchpad_vtty_screen_clear(launchpad_vtty_screen_t *scr);
+void launchpad_vtty_screen_set_style(launchpad_vtty_screen_t *scr, uint8_t attr, uint8_t fg, uint8_t bg);
+void launchpad_vtty_screen_putc(launchpad_vtty_screen_t *scr, int row, int col, char c);
+int launchpad_vtty_screen_puts(launchpad_vtty_screen_t *scr, int row, int col, const char *s);
+void launchpad_vtty_screen_fill(launchpad_vtty_screen_t *scr, int row, int col, int rows, int cols, char c);
+void launchpad_vtty_screen_set_cursor(launchpad_vtty_screen_t *scr, int row, int col);
+
+/* Redraw everything on the next present (e.g. after the terminal was reset) */
+void launchpad_vtty_screen_invalidate(launchpad_vtty_screen_t *scr);
+
+/* Send the difference to the current vtty; returns bytes sent or -1 */
+int launchpad_vtty_screen_present(launchpad_vtty_screen_t *scr);
+/* Same, to any output */
+int launchpad_vtty_screen_present_to(launchpad_vtty_screen_t *scr, launchpad_vtty_emit_t emit, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHPAD_VTTY_SCREEN_H */
@@ -0,0 +1,188 @@
+#include "launchpad_vtty.h"
+#include "launchpad_vtty_queue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "lwip/sockets.h"
+
+/* A TCP client that cannot take output for this long is dropped */
+#ifndef LAUNCHPAD_VTTY_TCP_SEND_TIMEOUT_MS
+#define LAUNCHPAD_VTTY_TCP_SEND_TIMEOUT_MS 1000
+#endif
+
+/* Apps running, nested; a sink records the level it was added at, 0 for firmware */
+static int g_app_depth;
+static uint8_t g_sink_owner[LAUNCHPAD_VTTY_MAX_SINKS];
+
+int vtty_sink_track(int id)
+{
+    if (id >= 0)
+        g_sink_owner[id] = g_app_depth;
+    return id;
+}
+
+void vtty_sink_app_enter(void)
+{
+    g_app_depth++;
+}
+
+void vtty_sink_app_exit(void)
+{
+    if (!g_app_depth)
+        return;
+
+    /* Their write and ctx may live in the image that is about to go */
+    for (int i = 0; i < LAUNCHPAD_VTTY_MAX_SINKS; ++i) {
+        if (g_sink_owner[i] >= g_app_depth) {
+            vtty_queue_remove_sink(i);
+            g_sink_owner[i] = 0;
+        }
+    }
+    g_app_depth--;
+}
+
+int launchpad_vtty_sink_add(const char *name, launchpad_vtty_emit_t write, void *ctx)
+{
+    return vtty_sink_track(vtty_queue_add_sink(name, write, NULL, ctx));
+}
+
+int launchpad_vtty_sink_remove(int sink)
+{
+    int ret = vtty_queue_remove_sink(sink);
+    if (!ret)
+        g_sink_owner[sink] = 0;
+    return ret;
+}
+
+/* -------------------------------------------------------------------------- */
+/* File sink                                                                  */
+/* -------------------------------------------------------------------------- */
+
+static int file_sink_write(void *ctx, const char *buf, size_t len)
+{
+    FILE *f = ctx;
+
+    /* The sink task hands over whole batches, so flush each one */
+    if (fwrite(buf, 1, len, f) != len)
+        return -1;
+    return fflush(f) ? -1 : 0;
+}
+
+static void file_sink_close(void *ctx)
+{
+    fclose(ctx);
+}
+
+int launchpad_vtty_sink_add_file(const char *path)
+{
+    if (!path)
+        return -1;
+
+    FILE *f = fopen(path, "a");
+    if (!f)
+        return -1;
+
+    const char *name = strrchr(path, '/');
+    int id = vtty_queue_add_sink(name ? name + 1 : path, file_sink_write, file_sink_close, f);
+    if (id < 0)
+        fclose(f);
+    return vtty_sink_track(id);
+}
+
+/* -------------------------------------------------------------------------- */
+/* TCP sink                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/* One client at a time; output while nobody is connected is discarded */
+struct tcp_sink {
+    int listen_fd;
+    int client_fd;
+};
+
+static void tcp_sink_accept(struct tcp_sink *ts)
+{
+    int fd = accept(ts->listen_fd, NULL, NULL);
+    if (fd < 0)
+        return;
+
+    struct timeval tv = {
+        .tv_sec = LAUNCHPAD_VTTY_TCP_SEND_TIMEOUT_MS / 1000,
+        .tv_usec = (LAUNCHPAD_VTTY_TCP_SEND_TIMEOUT_MS % 1000) * 1000,
+    };
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    ts->client_fd = fd;
+}
+
+static int tcp_sink_write(void *ctx, const char *buf, size_t len)
+{
+    struct tcp_sink *ts = ctx;
+
+    if (ts->client_fd < 0)
+        tcp_sink_accept(ts);
+    if (ts->client_fd < 0)
+        return 0;
+
+    while (len) {
+        ssize_t n = send(ts->client_fd, buf, len, 0);
+        if (n <= 0) {
+            close(ts->client_fd);
+            ts->client_fd = -1;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void tcp_sink_close(void *ctx)
+{
+    struct tcp_sink *ts = ctx;
+
+    if (ts->client_fd >= 0)
+        close(ts->client_fd);
+    close(ts->listen_fd);
+    free(ts);
+}
+
+int launchpad_vtty_sink_add_tcp(int port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    struct tcp_sink *ts = malloc(sizeof(*ts));
+    if (!ts)
+        return -1;
+
+    ts->client_fd = -1;
+    ts->listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (ts->listen_fd < 0)
+        goto fail;
+
+    /* accept() is polled from the sink task and must not block it */
+    int one = 1;
+    setsockopt(ts->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    fcntl(ts->listen_fd, F_SETFL, fcntl(ts->listen_fd, F_GETFL, 0) | O_NONBLOCK);
+    if (bind(ts->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(ts->listen_fd, 1) < 0)
+        goto fail;
+
+    int id = vtty_queue_add_sink("tcp", tcp_sink_write, tcp_sink_close, ts);
+    if (id >= 0)
+        return vtty_sink_track(id);
+
+fail:
+    if (ts->listen_fd >= 0)
+        close(ts->listen_fd);
+    free(ts);
+    return -1;
+}
@@ -1,12 +1,31 @@
 #include "launchpad_vtty.h"
 #include "driver/uart.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 #include <string.h>
 
 #ifndef LAUNCHPAD_VTTY_UART_RX_BUF
 #define LAUNCHPAD_VTTY_UART_RX_BUF 1024
 #endif
 
+/* Lets uart_write_bytes() return once data is queued, not sent */
+#ifndef LAUNCHPAD_VTTY_UART_TX_BUF
+#define LAUNCHPAD_VTTY_UART_TX_BUF 1024
+#endif
+
+#ifndef LAUNCHPAD_VTTY_UART_EVENT_QUEUE
+#define LAUNCHPAD_VTTY_UART_EVENT_QUEUE 16
+#endif
+
+#ifndef LAUNCHPAD_VTTY_UART_EVENT_STACK
+#define LAUNCHPAD_VTTY_UART_EVENT_STACK 2048
+#endif
+
+#ifndef LAUNCHPAD_VTTY_UART_EVENT_PRIO
+#define LAUNCHPAD_VTTY_UART_EVENT_PRIO 10
+#endif
+
 struct uart_params {
     int port;
     int tx_pin;
@@ -21,6 +40,50 @@ static struct uart_params g_uart = {
     .baud = 115200,
 };
 
+static QueueHandle_t g_uart_events;
+static TaskHandle_t g_uart_event_task;
+static volatile launchpad_vtty_event_cb_t g_uart_cb;
+
+static void uart_notify(int event)
+{
+    launchpad_vtty_event_cb_t cb = g_uart_cb;
+    if (cb)
+        cb(event);
+}
+
+/* Turns UART driver events into vtty events; readers block in the driver */
+static void uart_event_task(void *arg)
+{
+    uart_event_t ev;
+
+    for (;;) {
+        if (xQueueReceive(g_uart_events, &ev, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        switch (ev.type) {
+        case UART_DATA:
+            uart_notify(LAUNCHPAD_VTTY_EVENT_DATA);
+            break;
+        case UART_BREAK:
+            uart_notify(LAUNCHPAD_VTTY_EVENT_BREAK);
+            break;
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            /* Data already lost; start over rather than hand out a torn stream */
+            uart_flush_input(g_uart.port);
+            xQueueReset(g_uart_events);
+            uart_notify(LAUNCHPAD_VTTY_EVENT_OVERFLOW);
+            break;
+        case UART_FRAME_ERR:
+        case UART_PARITY_ERR:
+            uart_notify(LAUNCHPAD_VTTY_EVENT_ERROR);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static int uart_init(void)
 {
     uart_config_t cfg = {
@@ -31,16 +94,28 @@ static int uart_init(void)
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
     };
 
-    uart_driver_install(g_uart.port, LAUNCHPAD_VTTY_UART_RX_BUF, 0, 0, NULL, 0);
+    if (uart_driver_install(g_uart.port, LAUNCHPAD_VTTY_UART_RX_BUF,
+                            LAUNCHPAD_VTTY_UART_TX_BUF, LAUNCHPAD_VTTY_UART_EVENT_QUEUE,
+                            &g_uart_events, 0) != ESP_OK)
+        return -1;
     uart_param_config(g_uart.port, &cfg);
     uart_set_pin(g_uart.port, g_uart.tx_pin, g_uart.rx_pin,
                  UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+
+    xTaskCreate(uart_event_task, "vtty_uart", LAUNCHPAD_VTTY_UART_EVENT_STACK,
+                NULL, LAUNCHPAD_VTTY_UART_EVENT_PRIO, &g_uart_event_task);
     return 0;
 }
 
 static int uart_deinit(void)
 {
+    /* The task waits on the driver's queue: stop it before the queue goes */
+    if (g_uart_event_task) {
+        vTaskDelete(g_uart_event_task);
+        g_uart_event_task = NULL;
+    }
     uart_driver_delete(g_uart.port);
+    g_uart_events = NULL;
     return 0;
 }
 
@@ -54,8 +129,14 @@ static int uart_puts(const char *s)
 {
     if (!s)
         return -1;
-    uart_write_bytes(g_uart.port, s, strlen(s));
-    return (int)strlen(s);
+    size_t len = strlen(s);
+    uart_write_bytes(g_uart.port, s, len);
+    return (int)len;
+}
+
+static int uart_write(const char *buf, size_t len)
+{
+    return uart_write_bytes(g_uart.port, buf, len);
 }
 
 static void vtty_uart_flush(void)
@@ -70,6 +151,32 @@ static int uart_getc(void)
     return (len > 0) ? c : -1;
 }
 
+static int uart_read(char *buf, size_t len, int timeout_ms)
+{
+    TickType_t ticks = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+    /* Sleep in the driver until the first byte, then take what is buffered */
+    int n = uart_read_bytes(g_uart.port, buf, 1, ticks);
+    if (n <= 0)
+        return n;
+
+    size_t more = 0;
+    uart_get_buffered_data_len(g_uart.port, &more);
+    if (more > len - 1)
+        more = len - 1;
+    if (more) {
+        int m = uart_read_bytes(g_uart.port, buf + 1, more, 0);
+        if (m > 0)
+            n += m;
+    }
+    return n;
+}
+
+static void uart_set_callback(launchpad_vtty_event_cb_t cb)
+{
+    g_uart_cb = cb;
+}
+
 static int uart_available(void)
 {
     size_t len = 0;
@@ -95,14 +202,16 @@ static const struct vtty_driver uart_driver = {
     .deinit = uart_deinit,
     .putc = uart_putc,
     .puts = uart_puts,
+    .write = uart_write,
     .flush = vtty_uart_flush,
     .getc = uart_getc,
+    .read = uart_read,
     .available = uart_available,
     .clear_screen = NULL,
     .move_cursor = NULL,
     .set_baudrate = uart_set_baud,
     .is_ready = uart_is_ready,
-    .set_callback = NULL,
+    .set_callback = uart_set_callback,
     .ioctl = NULL,
 };
 
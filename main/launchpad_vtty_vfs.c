@@ -0,0 +1,353 @@
+#include "launchpad_vtty.h"
+#include "launchpad_vtty_queue.h"
+#include "launchpad_vtty_vfs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/select.h>
+#include <sys/reent.h>
+
+#include "esp_vfs.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#define VFS_BASE "/dev/vtty"
+
+#ifndef LAUNCHPAD_VTTY_VFS_MAX_FDS
+#define LAUNCHPAD_VTTY_VFS_MAX_FDS 16
+#endif
+
+static const char *TAG = "LaunchpadVttyVfs";
+
+struct vfs_file {
+    int idx;                    /* driver slot, -1 when closed */
+    int flags;
+};
+
+/* A select() call waiting on some of our descriptors */
+struct vfs_select {
+    struct vfs_select *next;
+    esp_vfs_select_sem_t sem;
+    fd_set want_rd;
+    fd_set want_wr;
+    fd_set *readfds;            /* the caller's sets, filled in as fds get ready */
+    fd_set *writefds;
+};
+
+static struct vfs_file g_files[LAUNCHPAD_VTTY_VFS_MAX_FDS];
+static struct vfs_select *g_selects;
+static SemaphoreHandle_t g_select_lock;     /* g_selects, and claiming g_files[] slots */
+static StaticSemaphore_t g_select_lock_buf;
+static bool g_registered;
+
+static void select_lock(void)
+{
+    xSemaphoreTake(g_select_lock, portMAX_DELAY);
+}
+
+static void select_unlock(void)
+{
+    xSemaphoreGive(g_select_lock);
+}
+
+/* -------------------------------------------------------------------------- */
+/* File operations                                                            */
+/* -------------------------------------------------------------------------- */
+
+static int file_slot(int fd)
+{
+    if (fd < 0 || fd >= LAUNCHPAD_VTTY_VFS_MAX_FDS || g_files[fd].idx < 0) {
+        errno = EBADF;
+        return -1;
+    }
+    return g_files[fd].idx;
+}
+
+static int vfs_open(const char *path, int flags, int mode)
+{
+    /* The VFS hands over the path past VFS_BASE, i.e. "/<N>" */
+    if (path[0] != '/' || path[1] < '0' || path[1] > '9') {
+        errno = ENOENT;
+        return -1;
+    }
+
+    char *end;
+    long idx = strtol(path + 1, &end, 10);
+
+    if (*end || idx >= vtty_slot_count()) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    /* Two tasks opening at once must not get the same fd */
+    select_lock();
+    for (int fd = 0; fd < LAUNCHPAD_VTTY_VFS_MAX_FDS; ++fd) {
+        if (g_files[fd].idx < 0) {
+            g_files[fd].flags = flags;
+            g_files[fd].idx = (int)idx;
+            select_unlock();
+            return fd;
+        }
+    }
+    select_unlock();
+    errno = ENFILE;
+    return -1;
+}
+
+static int vfs_close(int fd)
+{
+    select_lock();
+    int idx = file_slot(fd);
+    if (idx >= 0)
+        g_files[fd].idx = -1;
+    select_unlock();
+    return idx < 0 ? -1 : 0;
+}
+
+static ssize_t vfs_write(int fd, const void *data, size_t size)
+{
+    int idx = file_slot(fd);
+    if (idx < 0)
+        return -1;
+
+    int n = vtty_queue_write(idx, data, size);
+    if (n < 0) {
+        errno = EAGAIN;     /* console queue full, drop policy */
+        return -1;
+    }
+    return n;
+}
+
+static ssize_t vfs_read(int fd, void *dst, size_t size)
+{
+    int idx = file_slot(fd);
+    if (idx < 0)
+        return -1;
+
+    bool nonblock = g_files[fd].flags & O_NONBLOCK;
+    int n = vtty_slot_read(idx, dst, size, nonblock ? 0 : -1);
+    if (n < 0) {
+        errno = EIO;
+        return -1;
+    }
+    if (!n && nonblock) {
+        errno = EAGAIN;
+        return -1;
+    }
+    return n;
+}
+
+static int vfs_fsync(int fd)
+{
+    int idx = file_slot(fd);
+    if (idx < 0)
+        return -1;
+    vtty_slot_flush(idx);
+    return 0;
+}
+
+static int vfs_fstat(int fd, struct stat *st)
+{
+    if (file_slot(fd) < 0)
+        return -1;
+    memset(st, 0, sizeof(*st));
+    st->st_mode = S_IFCHR;      /* newlib line-buffers streams on character devices */
+    return 0;
+}
+
+static int vfs_fcntl(int fd, int cmd, int arg)
+{
+    if (file_slot(fd) < 0)
+        return -1;
+
+    switch (cmd) {
+    case F_GETFL:
+        return g_files[fd].flags;
+    case F_SETFL:
+        g_files[fd].flags = arg;
+        return 0;
+    default:
+        errno = ENOSYS;
+        return -1;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* select()                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Output is always accepted (it is queued), so only reads can wait.
+ * Readiness comes from the driver's DATA event; a driver without events
+ * is only seen as readable if it already was when select() started.
+ */
+
+static esp_err_t vfs_start_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds,
+                                  esp_vfs_select_sem_t sem, void **end_select_args)
+{
+    struct vfs_select *sel = calloc(1, sizeof(*sel));
+    bool ready = false;
+
+    if (!sel)
+        return ESP_ERR_NO_MEM;
+
+    sel->sem = sem;
+    sel->want_rd = *readfds;
+    sel->want_wr = *writefds;
+    sel->readfds = readfds;
+    sel->writefds = writefds;
+    FD_ZERO(readfds);
+    FD_ZERO(writefds);
+    FD_ZERO(exceptfds);
+
+    if (nfds > LAUNCHPAD_VTTY_VFS_MAX_FDS)
+        nfds = LAUNCHPAD_VTTY_VFS_MAX_FDS;
+
+    select_lock();
+    for (int fd = 0; fd < nfds; ++fd) {
+        int idx = g_files[fd].idx;
+        if (idx < 0)
+            continue;
+        if (FD_ISSET(fd, &sel->want_wr)) {
+            FD_SET(fd, writefds);
+            ready = true;
+        }
+        if (FD_ISSET(fd, &sel->want_rd) && vtty_slot_available(idx) > 0) {
+            FD_SET(fd, readfds);
+            ready = true;
+        }
+    }
+    sel->next = g_selects;
+    g_selects = sel;
+    select_unlock();
+
+    if (ready)
+        esp_vfs_select_triggered(sem);
+    *end_select_args = sel;
+    return ESP_OK;
+}
+
+static esp_err_t vfs_end_select(void *end_select_args)
+{
+    struct vfs_select *sel = end_select_args;
+
+    select_lock();
+    for (struct vfs_select **p = &g_selects; *p; p = &(*p)->next) {
+        if (*p == sel) {
+            *p = sel->next;
+            break;
+        }
+    }
+    select_unlock();
+
+    free(sel);
+    return ESP_OK;
+}
+
+void vtty_vfs_notify(int idx)
+{
+    if (!g_registered)
+        return;
+
+    select_lock();
+    for (struct vfs_select *sel = g_selects; sel; sel = sel->next) {
+        bool hit = false;
+        for (int fd = 0; fd < LAUNCHPAD_VTTY_VFS_MAX_FDS; ++fd) {
+            if (g_files[fd].idx == idx && FD_ISSET(fd, &sel->want_rd)) {
+                FD_SET(fd, sel->readfds);
+                hit = true;
+            }
+        }
+        if (hit)
+            esp_vfs_select_triggered(sel->sem);
+    }
+    select_unlock();
+}
+
+/* -------------------------------------------------------------------------- */
+/* Registration and stdio binding                                             */
+/* -------------------------------------------------------------------------- */
+
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+static const esp_vfs_select_ops_t s_vtty_select = {
+    .start_select = vfs_start_select,
+    .end_select = vfs_end_select,
+};
+#endif
+
+static const esp_vfs_fs_ops_t s_vtty_vfs = {
+    .write = vfs_write,
+    .read = vfs_read,
+    .open = vfs_open,
+    .close = vfs_close,
+    .fstat = vfs_fstat,
+    .fcntl = vfs_fcntl,
+    .fsync = vfs_fsync,
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+    .select = &s_vtty_select,
+#endif
+};
+
+int vtty_vfs_register(void)
+{
+    if (g_registered)
+        return 0;
+
+    for (int fd = 0; fd < LAUNCHPAD_VTTY_VFS_MAX_FDS; ++fd)
+        g_files[fd].idx = -1;
+    g_select_lock = xSemaphoreCreateMutexStatic(&g_select_lock_buf);
+
+    esp_err_t err = esp_vfs_register_fs(VFS_BASE, &s_vtty_vfs, ESP_VFS_FLAG_STATIC, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register %s: %s", VFS_BASE, esp_err_to_name(err));
+        return -1;
+    }
+    g_registered = true;
+    return 0;
+}
+
+/* Put a stream back to the one every task starts with */
+static void stdio_restore(FILE **cur, FILE *orig)
+{
+    if (*cur != orig) {
+        fclose(*cur);
+        *cur = orig;
+    }
+}
+
+int launchpad_vtty_bind_stdio(int n)
+{
+    /* The streams are per task: this only affects the caller */
+    stdio_restore(&stdin, _GLOBAL_REENT->_stdin);
+    stdio_restore(&stdout, _GLOBAL_REENT->_stdout);
+    stdio_restore(&stderr, _GLOBAL_REENT->_stderr);
+    if (n < 0)
+        return 0;
+
+    char path[24];
+    snprintf(path, sizeof(path), VFS_BASE "/%d", n);
+
+    FILE *in = fopen(path, "r");
+    FILE *out = fopen(path, "w");
+    FILE *err = fopen(path, "w");
+    if (!in || !out || !err) {
+        if (in)
+            fclose(in);
+        if (out)
+            fclose(out);
+        if (err)
+            fclose(err);
+        return -1;
+    }
+
+    setvbuf(err, NULL, _IONBF, 0);
+    stdin = in;
+    stdout = out;
+    stderr = err;
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef LAUNCHPAD_VTTY_VFS_H
+#define LAUNCHPAD_VTTY_VFS_H
+
+/*
+ * Character devices /dev/vtty/<N> over the vtty driver slots (not
+ * exported to apps). Like /dev/uart/<N>, the whole set is one VFS
+ * registered at /dev/vtty: the IDF only routes a path to a prefix that
+ * is followed by '/' or the end of the string. Writes go through the console queue like every
+ * other vtty output; reads and select() go to the slot's driver.
+ */
+
+#include <stddef.h>
+
+int vtty_vfs_register(void);
+
+/* Input arrived on slot @idx: wake select() callers */
+void vtty_vfs_notify(int idx);
+
+/* Provided by the core */
+int vtty_slot_count(void);
+int vtty_slot_read(int idx, char *buf, size_t len, int timeout_ms);
+int vtty_slot_available(int idx);
+void vtty_slot_flush(int idx);
+
+#endif /* LAUNCHPAD_VTTY_VFS_H */
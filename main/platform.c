@@ -1,4 +1,5 @@
 #include "platform.h"
+#include "sdkconfig.h"
 
 static const launchpad_platform_info_t g_launchpad_info = {
     .magic          = LAUNCHPAD_MAGIC,
@@ -12,13 +13,73 @@ static const launchpad_platform_info_t g_launchpad_info = {
     /* Строки: обязательно завершаем NUL, остальные байты могут быть пустыми */
     .loader_name     = "LaunchPad",
     .build_name      = "Developer Build Preview",
+#if CONFIG_IDF_TARGET_ESP32P4
+    .platform_name   = "ESP32-P4",
+#else
     .platform_name   = "ESP32",
+#endif
 
     .bitness         = 32,
     .endian          = LAUNCHPAD_ENDIAN_LITTLE,
 
     .reserved0       = 0,                /* выравнивание */
 
+#if CONFIG_IDF_TARGET_ESP32P4
+    .features        =         LAUNCHPAD_FEATURE_UART |
+        LAUNCHPAD_FEATURE_SPI |
+        LAUNCHPAD_FEATURE_I2C |
+        LAUNCHPAD_FEATURE_SDIO |
+        LAUNCHPAD_FEATURE_USB_HOST |
+        LAUNCHPAD_FEATURE_USB_DEV |
+        LAUNCHPAD_FEATURE_CAN |        /* TWAI */
+        LAUNCHPAD_FEATURE_ETH |        /* EMAC */
+        LAUNCHPAD_FEATURE_PWM |
+        LAUNCHPAD_FEATURE_LCD |        /* MIPI-DSI / RGB / I80 */
+        LAUNCHPAD_FEATURE_FB_RGB565 |
+        LAUNCHPAD_FEATURE_FB_RGB888 |
+        LAUNCHPAD_FEATURE_I2S |
+        LAUNCHPAD_FEATURE_TOUCH |
+        LAUNCHPAD_FEATURE_CAMERA_MIPI |
+        LAUNCHPAD_FEATURE_SD_CARD |
+        LAUNCHPAD_FEATURE_FLASH |
+        LAUNCHPAD_FEATURE_SLEEP_MODE |
+        LAUNCHPAD_FEATURE_WAKEUP_GPIO |
+        LAUNCHPAD_FEATURE_RTC_ALARM |
+        LAUNCHPAD_FEATURE_HARDWARE_RNG |
+        LAUNCHPAD_FEATURE_AES |
+        LAUNCHPAD_FEATURE_RSA |
+        LAUNCHPAD_FEATURE_HMAC |
+        LAUNCHPAD_FEATURE_SECURE_BOOT |
+        LAUNCHPAD_FEATURE_JTAG |
+        LAUNCHPAD_FEATURE_UART_DEBUG |
+        LAUNCHPAD_FEATURE_WATCHDOG |
+        LAUNCHPAD_FEATURE_SYSTEM_TICK,
+    .hardware        =         LAUNCHPAD_HW_MULTICORE |
+        LAUNCHPAD_HW_ARCH_RISCV |
+        LAUNCHPAD_HW_RISCV_RV32I |
+
+        /* Инструкционные расширения: RV32IMAFC + PIE (128-bit SIMD) */
+        LAUNCHPAD_HW_RISCV_C |
+        LAUNCHPAD_HW_RISCV_F |
+        LAUNCHPAD_HW_RISCV_A |
+        LAUNCHPAD_HW_SIMD_SUPPORT |
+
+        /* Микроархитектура */
+        LAUNCHPAD_HW_CORE_INORDER |
+        LAUNCHPAD_HW_CACHE_L1_I |
+        LAUNCHPAD_HW_CACHE_L1_D |
+        LAUNCHPAD_HW_CACHE_L2 |
+
+        /* Безопасность */
+        LAUNCHPAD_HW_RNG |
+        LAUNCHPAD_HW_CRYPTO_ACCEL |
+
+        /* Прочее */
+        LAUNCHPAD_HW_MULTIPLICATION_FPU |
+        LAUNCHPAD_HW_DIVISION_FPU |
+        LAUNCHPAD_HW_HARDWARE_DIVIDE |
+        LAUNCHPAD_HW_HARDWARE_MULTIPLY,
+#else
     .features        =         LAUNCHPAD_FEATURE_UART |
         LAUNCHPAD_FEATURE_SPI |
         LAUNCHPAD_FEATURE_I2C |
@@ -62,6 +123,7 @@ static const launchpad_platform_info_t g_launchpad_info = {
         /* Прочее */
         LAUNCHPAD_HW_HARDWARE_DIVIDE |
         LAUNCHPAD_HW_HARDWARE_MULTIPLY,
+#endif
     /* Дополнительная информация – может быть пустой строкой */
     .custom_info     = ""
 };
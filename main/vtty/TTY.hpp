@@ -1,15 +1,20 @@
 #pragma once
 #include "TTYDriver.hpp"
+#include <string.h>
 
+// With a concrete (final) Driver the calls below are bound at compile
+// time; TTY<> keeps the runtime-polymorphic behaviour.
+template <typename Driver = TTYDriver>
 class TTY {
 private:
-    TTYDriver* driver;
+    Driver* driver;
 public:
-    explicit TTY(TTYDriver* drv) : driver(drv) {
+    explicit TTY(Driver* drv) : driver(drv) {
         driver->init();
     }
 
-    void write(const char* str) { driver->write(str); }
-    void write_char(char c)     { driver->write_char(c); }
-    char read()                 { return driver->read(); }
+    void write(const char* str)             { driver->write(str, strlen(str)); }
+    void write(const char* buf, size_t len) { driver->write(buf, len); }
+    void write_char(char c)                 { driver->write_char(c); }
+    char read()                             { return driver->read(); }
 };
@@ -1,4 +1,5 @@
 #pragma once
+#include <stddef.h>
 
 class TTYDriver {
 public:
@@ -7,4 +8,10 @@ public:
     virtual void write_char(char c) = 0;
     virtual char read() = 0;
     virtual ~TTYDriver() = default;
+
+    // Bulk output; drivers that can send a whole span at once should override
+    virtual void write(const char* buf, size_t len) {
+        for (size_t i = 0; i < len; ++i)
+            write_char(buf[i]);
+    }
 };
@@ -1,8 +1,9 @@
+#pragma once
 #include "TTYDriver.hpp"
 #include "driver/uart.h"
 #include <string.h>
 
-class UARTTTYDriver : public TTYDriver {
+class UARTTTYDriver final : public TTYDriver {
 private:
     int uart_num;
     int tx_pin;
@@ -28,7 +29,11 @@ public:
     }
 
     void write(const char* str) override {
-        uart_write_bytes((uart_port_t)uart_num, str, strlen(str));
+        write(str, strlen(str));
+    }
+
+    void write(const char* buf, size_t len) override {
+        uart_write_bytes((uart_port_t)uart_num, buf, len);
     }
 
     void write_char(char c) override {
@@ -1,3 +1,3 @@
 #include "global_tty.hpp"
 
-TTY* global_tty = nullptr;
+GlobalTTY* global_tty = nullptr;
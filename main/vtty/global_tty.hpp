@@ -1,4 +1,13 @@
 #pragma once
 #include "TTY.hpp"
+#include "UARTDriver.hpp"
 
-extern TTY* global_tty;
+// Driver type of the console TTY; TTYDriver allows any driver at the
+// cost of a virtual call per operation
+#ifndef LAUNCHPAD_GLOBAL_TTY_DRIVER
+#define LAUNCHPAD_GLOBAL_TTY_DRIVER UARTTTYDriver
+#endif
+
+using GlobalTTY = TTY<LAUNCHPAD_GLOBAL_TTY_DRIVER>;
+
+extern GlobalTTY* global_tty;
@@ -1,4 +1,5 @@
 #include "global_tty.hpp"
+#include "launchpad_vtty.h"
 #include <cstdio>
 #include <cstdarg>
 
@@ -7,7 +8,7 @@ extern "C" {
 int tty_puts(const char* str) {
     if (global_tty) {
         global_tty->write(str);
-        global_tty->write("\r\n");
+        global_tty->write("\r\n", 2);
     }
     return 0;
 }
@@ -30,13 +31,16 @@ int tty_fputs(const char* str, FILE* /*stream*/) {
     return 0;
 }
 
+static int tty_emit(void* /*ctx*/, const char* buf, size_t len) {
+    global_tty->write(buf, len);
+    return 0;
+}
+
 static int tty_vprintf_internal(const char* fmt, va_list ap) {
-    char buffer[256];
-    int len = vsnprintf(buffer, sizeof(buffer), fmt, ap);
-    if (len > 0 && global_tty) {
-        global_tty->write(buffer);
+    if (!global_tty) {
+        return vsnprintf(nullptr, 0, fmt, ap);
     }
-    return len;
+    return launchpad_vtty_vformat(tty_emit, nullptr, fmt, ap);
 }
 
 int tty_printf(const char* fmt, ...) {
@@ -63,10 +67,8 @@ int tty_fprintf(FILE* stream, const char* fmt, ...) {
 size_t tty_fwrite(const void* ptr, size_t size, size_t nmemb, FILE* /*stream*/) {
     size_t total = size * nmemb;
     const char* data = static_cast<const char*>(ptr);
-    if (global_tty) {
-        for (size_t i = 0; i < total; ++i) {
-            global_tty->write_char(data[i]);
-        }
+    if (global_tty && total) {
+        global_tty->write(data, total);
     }
     return nmemb;
 }
@@ -0,0 +1,45 @@
+/* -------------------------------------------------------------
+ * bench_fmath.c
+ *
+ * Nanoseconds per call of the float kernels next to the host
+ * libm. The host libm is a double-capable, vectorised reference,
+ * so the ratio here is not the one against newlib on a core with
+ * a single-precision FPU.
+ * ------------------------------------------------------------- */
+
+#include <math.h>
+
+#include "host_test.h"
+#include "include/fmath.h"
+
+#define CALLS 4000000
+
+static double bench(float (*fn)(float), float lo, float hi)
+{
+    float step = (hi - lo) / CALLS;
+    float x = lo;
+    uint64_t t0 = host_now_ns();
+
+    for (int i = 0; i < CALLS; i++) {
+        HOST_KEEP(fn(x));
+        x += step;
+    }
+    return (double)(host_now_ns() - t0) / CALLS;
+}
+
+#define ROW(name, lo, hi) \
+    printf("%-7s %10.2f %10.2f\n", #name, bench(name, lo, hi), bench(launchpad_fast_##name, lo, hi))
+
+int main(void)
+{
+    printf("%-7s %10s %10s\n", "func", "libm ns", "fast ns");
+    ROW(sinf, -100, 100);
+    ROW(cosf, -100, 100);
+    ROW(expf, -80, 80);
+    ROW(exp2f, -120, 120);
+    ROW(logf, 1e-6f, 1e6f);
+    ROW(log2f, 1e-6f, 1e6f);
+    ROW(log10f, 1e-6f, 1e6f);
+    ROW(atanf, -100, 100);
+    return 0;
+}
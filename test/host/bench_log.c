@@ -0,0 +1,70 @@
+/* -------------------------------------------------------------
+ * bench_log.c
+ *
+ * Cost of one launchpad_log() call: formatted at once, deferred
+ * including the drain, and the deferred producer alone (rings
+ * filled without draining, then emptied outside the timing),
+ * and the clock read every deferred record starts with.
+ * Output is formatted and dropped, so no I/O is measured.
+ * ------------------------------------------------------------- */
+
+#include "esp_timer.h"
+#include "host_stubs.h"
+#include "host_test.h"
+#include "include/log.h"
+
+#define CALLS  2000000
+#define BATCH  48           /* under half a ring: the drain task is not woken */
+
+static double run(bool drain)
+{
+    uint64_t t0 = host_now_ns();
+
+    for (int i = 0; i < CALLS; i++) {
+        launchpad_log(LAUNCHPAD_LOG_INFO, "b", "sample %d value %u ok\n", i, (unsigned)i * 3);
+        if (drain && i % BATCH == BATCH - 1) {
+            launchpad_log_flush();
+        }
+    }
+    return (double)(host_now_ns() - t0) / CALLS;
+}
+
+int main(void)
+{
+    struct launchpad_log_stats st;
+    uint64_t producer = 0;
+
+    g_host_log.discard = true;
+
+    launchpad_log_set_mode(LAUNCHPAD_LOG_MODE_SYNC);
+    double sync = run(false);
+
+    launchpad_log_set_mode(LAUNCHPAD_LOG_MODE_DEFERRED);
+    double deferred = run(true);
+
+    for (int r = 0; r < CALLS / BATCH; r++) {
+        uint64_t t0 = host_now_ns();
+
+        for (int i = 0; i < BATCH; i++) {
+            launchpad_log(LAUNCHPAD_LOG_INFO, "b", "sample %d value %u ok\n", i, (unsigned)i * 3);
+        }
+        producer += host_now_ns() - t0;
+        launchpad_log_flush();
+    }
+
+    uint64_t t0 = host_now_ns();
+    int64_t sum = 0;
+    for (int i = 0; i < CALLS; i++) {
+        sum += esp_timer_get_time();
+    }
+    HOST_KEEP(sum);
+    double clock_read = (double)(host_now_ns() - t0) / CALLS;
+
+    launchpad_log_get_stats(&st);
+    printf("sync                      %6.1f ns/call\n", sync);
+    printf("deferred, with drain      %6.1f ns/call\n", deferred);
+    printf("deferred, producer only   %6.1f ns/call\n", (double)producer / CALLS);
+    printf("of which the clock read   %6.1f ns\n", clock_read);
+    printf("(%u records, %u dropped)\n", st.records, st.dropped);
+    return 0;
+}
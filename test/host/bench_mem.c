@@ -0,0 +1,76 @@
+/* -------------------------------------------------------------
+ * bench_mem.c
+ *
+ * Throughput of the exported string primitives against the C
+ * library, in bytes per nanosecond. The host libc uses SIMD, so
+ * here it is the upper bound rather than the newlib baseline the
+ * word routines replace on the target; only the target build
+ * includes the PIE block paths.
+ * ------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "host_stubs.h"
+#include "include/mem.h"
+
+#define ROUNDS_BYTES (64u << 20)
+
+typedef size_t (*strlen_fn)(const char *);
+typedef int (*strcmp_fn)(const char *, const char *);
+
+static double bench_strlen(strlen_fn fn, const char *s, size_t n)
+{
+    size_t rounds = ROUNDS_BYTES / (n + 1);
+    uint64_t t0 = host_now_ns();
+
+    for (size_t r = 0; r < rounds; r++) {
+        HOST_KEEP(s);
+        HOST_KEEP(fn(s));
+    }
+    return (double)rounds * n / (host_now_ns() - t0);
+}
+
+static double bench_strcmp(strcmp_fn fn, const char *a, const char *b, size_t n)
+{
+    size_t rounds = ROUNDS_BYTES / (n + 1);
+    uint64_t t0 = host_now_ns();
+
+    for (size_t r = 0; r < rounds; r++) {
+        HOST_KEEP(a);
+        HOST_KEEP(fn(a, b));
+    }
+    return (double)rounds * n / (host_now_ns() - t0);
+}
+
+int main(void)
+{
+    static const size_t sizes[] = { 8, 32, 128, 1024, 16384 };
+    char *a = aligned_alloc(64, 16384 + 64);
+    char *b = aligned_alloc(64, 16384 + 64);
+
+    g_host_platform.hardware = LAUNCHPAD_HW_CACHE_L1_D;
+    launchpad_mem_init();
+
+    strlen_fn word_strlen = (strlen_fn)host_symbol("strlen");
+    strcmp_fn word_strcmp = (strcmp_fn)host_symbol("strcmp");
+
+    printf("%-8s %8s %12s %12s\n", "routine", "bytes", "libc B/ns", "launchpad B/ns");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t n = sizes[i];
+
+        memset(a, 'q', n);
+        memset(b, 'q', n);
+        a[n] = b[n] = '\0';
+
+        printf("%-8s %8zu %12.2f %12.2f\n", "strlen", n,
+               bench_strlen(strlen, a, n), bench_strlen(word_strlen, a, n));
+        printf("%-8s %8zu %12.2f %12.2f\n", "strcmp", n,
+               bench_strcmp(strcmp, a, b, n), bench_strcmp(word_strcmp, a, b, n));
+    }
+
+    free(a);
+    free(b);
+    return 0;
+}
@@ -0,0 +1,66 @@
+/* -------------------------------------------------------------
+ * bench_tty.cpp
+ *
+ * Cost per byte of TTY output into a mock driver: one virtual
+ * write_char per byte, one virtual bulk write per span, and the
+ * bulk write bound at compile time through TTY<Driver>.
+ * ------------------------------------------------------------- */
+
+#include <cstdio>
+#include <cstring>
+
+#include "host_test.h"
+#include "vtty/TTY.hpp"
+
+namespace {
+
+size_t g_bytes, g_calls;
+
+struct Mock final : TTYDriver {
+    void init() override {}
+    void write(const char *s) override { write(s, strlen(s)); }
+    void write(const char *b, size_t n) override { g_calls++; g_bytes += n; HOST_KEEP(b); }
+    void write_char(char c) override { g_calls++; g_bytes++; HOST_KEEP(c); }
+    char read() override { return 0; }
+};
+
+constexpr int ITERS = 200000;
+constexpr size_t LEN = 80;
+char g_buf[LEN];
+
+template <typename Fn>
+void run(const char *name, Fn fn)
+{
+    g_calls = g_bytes = 0;
+
+    uint64_t t0 = host_now_ns();
+    for (int i = 0; i < ITERS; ++i) {
+        fn();
+    }
+    double ns = double(host_now_ns() - t0) / (double(ITERS) * LEN);
+
+    printf("%-18s %6.2f ns/byte  %5.1f calls per %zu-byte write\n", name, ns,
+           double(g_calls) / ITERS, LEN);
+}
+
+} // namespace
+
+int main()
+{
+    Mock m;
+    TTY<> dyn(&m);
+    TTY<Mock> fixed(&m);
+
+    // Through pointers, so the calls are not resolved from the local object
+    TTY<> *pd = &dyn;
+    TTY<Mock> *pf = &fixed;
+
+    memset(g_buf, 'a', sizeof(g_buf));
+    HOST_KEEP(pd);
+    HOST_KEEP(pf);
+
+    run("per-byte virtual", [&] { for (size_t k = 0; k < LEN; ++k) pd->write_char(g_buf[k]); });
+    run("bulk virtual", [&] { pd->write(g_buf, LEN); });
+    run("bulk static", [&] { pf->write(g_buf, LEN); });
+    return 0;
+}
@@ -0,0 +1,74 @@
+/* -------------------------------------------------------------
+ * bench_vtty_fb.c
+ *
+ * Drawing rate and panel traffic of the framebuffer console on
+ * an 800x480 screen at scale 2 with a no-op panel, printing log
+ * lines that scroll, with and without hardware scroll.
+ * ------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "host_test.h"
+#include "launchpad_vtty_fb.h"
+
+#define LINES 200000
+
+static const struct vtty_driver *s_drv;
+static uint64_t s_bytes;       /* the 32-bit stats counter wraps here */
+
+int launchpad_vtty_register_driver(const struct vtty_driver *drv)
+{
+    s_drv = drv;
+    if (drv->init) {
+        drv->init();
+    }
+    return 0;
+}
+
+static void panel_flush(void *ctx, int x, int y, int w, int h, const uint16_t *px, int stride)
+{
+    HOST_KEEP(px);
+    s_bytes += (uint64_t)w * h * sizeof(uint16_t);
+}
+
+static void panel_scroll(void *ctx, int line)
+{
+    HOST_KEEP(line);
+}
+
+int main(void)
+{
+    for (int hw = 0; hw < 2; hw++) {
+        struct launchpad_vtty_fb_config cfg = {
+            .width = 800,
+            .height = 480,
+            .scale = 2,
+            .fg = 0xFFFF,
+            .bg = 0x0000,
+            .flush = panel_flush,
+            .scroll = hw ? panel_scroll : NULL,
+        };
+        struct launchpad_vtty_fb_stats st;
+        char line[64];
+
+        if (s_drv) {
+            s_drv->deinit();
+        }
+        launchpad_vtty_register_fb(&cfg);
+        s_bytes = 0;
+
+        uint64_t t0 = host_now_ns();
+        for (int i = 0; i < LINES; i++) {
+            int n = snprintf(line, sizeof(line), "[%6d] the quick brown fox jumps over\n", i);
+
+            s_drv->write(line, n);
+        }
+        double s = (host_now_ns() - t0) / 1e9;
+
+        launchpad_vtty_fb_get_stats(&st);
+        /* Every line scrolls once the screen is full */
+        printf("%s scroll: %5.1f Mchars/s, %6.1f kB flushed per line, %u scrolls\n", hw ? "hw" : "sw",
+               st.chars / s / 1e6, s_bytes / 1e3 / LINES, st.scrolls);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+/* -------------------------------------------------------------
+ * host_test.h
+ *
+ * Checks and timing shared by the host tests and benchmarks.
+ * ------------------------------------------------------------- */
+
+#ifndef LAUNCHPAD_HOST_TEST_H
+#define LAUNCHPAD_HOST_TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" int host_failures;
+#else
+extern int host_failures;
+#endif
+
+/* Report a failed condition and keep going; main() returns host_result() */
+#define CHECK(cond, ...)                                                \
+    do {                                                                \
+        if (!(cond)) {                                                  \
+            host_failures++;                                            \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__,      \
+                    __LINE__, #cond);                                   \
+            fprintf(stderr, __VA_ARGS__);                               \
+            fputc('\n', stderr);                                        \
+        }                                                               \
+    } while (0)
+
+static inline int host_result(void)
+{
+    if (host_failures) {
+        fprintf(stderr, "%d check(s) failed\n", host_failures);
+    }
+    return host_failures ? 1 : 0;
+}
+
+static inline uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* Keep a benchmark result alive without a volatile store in the loop */
+#define HOST_KEEP(x) __asm__ __volatile__("" : : "g"(x) : "memory")
+
+#endif /* LAUNCHPAD_HOST_TEST_H */
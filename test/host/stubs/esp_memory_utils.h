@@ -0,0 +1,19 @@
+/* Host build: every address is executable memory, and the program's
+ * own text and read-only data stand in for flash rodata */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+static inline bool esp_ptr_executable(const void *p)
+{
+    (void)p;
+    return true;
+}
+
+static inline bool esp_ptr_in_drom(const void *p)
+{
+    extern char __executable_start[], edata[];
+
+    return (uintptr_t)p >= (uintptr_t)__executable_start && (uintptr_t)p < (uintptr_t)edata;
+}
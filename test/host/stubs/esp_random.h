@@ -0,0 +1,6 @@
+/* Host build: hardware RNG */
+#pragma once
+
+#include <stdint.h>
+
+uint32_t esp_random(void);
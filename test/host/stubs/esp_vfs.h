@@ -0,0 +1,7 @@
+/* Host build: the host's own file and directory calls */
+#pragma once
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
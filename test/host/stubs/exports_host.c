@@ -0,0 +1,117 @@
+/* -------------------------------------------------------------
+ * exports_host.c
+ *
+ * Stand-ins for names in the export tables of esp_elf_symbol.c
+ * that the host does not provide: 32-bit libgcc helpers, newlib
+ * internals and ESP-IDF services. Tests only take their
+ * addresses; calling one aborts. No headers are included, so the
+ * placeholder type never meets the real prototype.
+ * ------------------------------------------------------------- */
+
+void abort(void);
+
+#define HOST_STANDIN(_sym)  \
+    void _sym(void);        \
+    void _sym(void)         \
+    {                       \
+        abort();            \
+    }
+
+/* libgcc helpers of 32-bit targets; x86-64 has hardware or 128-bit ones */
+HOST_STANDIN(__divdi3)
+HOST_STANDIN(__moddi3)
+HOST_STANDIN(__udivdi3)
+HOST_STANDIN(__umoddi3)
+HOST_STANDIN(__udivmoddi4)
+HOST_STANDIN(__ashldi3)
+HOST_STANDIN(__ashrdi3)
+HOST_STANDIN(__lshrdi3)
+HOST_STANDIN(__negdi2)
+HOST_STANDIN(__cmpdi2)
+HOST_STANDIN(__ucmpdi2)
+HOST_STANDIN(__muldi3)
+HOST_STANDIN(__clzsi2)
+HOST_STANDIN(__ctzsi2)
+HOST_STANDIN(__clrsbsi2)
+HOST_STANDIN(__ffssi2)
+HOST_STANDIN(__popcountsi2)
+HOST_STANDIN(__paritysi2)
+HOST_STANDIN(__adddf3)
+HOST_STANDIN(__subdf3)
+HOST_STANDIN(__muldf3)
+HOST_STANDIN(__divdf3)
+HOST_STANDIN(__negdf2)
+HOST_STANDIN(__eqdf2)
+HOST_STANDIN(__nedf2)
+HOST_STANDIN(__gedf2)
+HOST_STANDIN(__gtdf2)
+HOST_STANDIN(__ledf2)
+HOST_STANDIN(__ltdf2)
+HOST_STANDIN(__unorddf2)
+HOST_STANDIN(__fixdfsi)
+HOST_STANDIN(__fixunsdfsi)
+HOST_STANDIN(__fixdfdi)
+HOST_STANDIN(__floatsidf)
+HOST_STANDIN(__floatunsidf)
+HOST_STANDIN(__floatdidf)
+HOST_STANDIN(__floatundidf)
+HOST_STANDIN(__fixsfdi)
+HOST_STANDIN(__floatdisf)
+HOST_STANDIN(__floatundisf)
+HOST_STANDIN(__addsf3)
+HOST_STANDIN(__subsf3)
+HOST_STANDIN(__mulsf3)
+HOST_STANDIN(__divsf3)
+HOST_STANDIN(__negsf2)
+HOST_STANDIN(__eqsf2)
+HOST_STANDIN(__nesf2)
+HOST_STANDIN(__gesf2)
+HOST_STANDIN(__gtsf2)
+HOST_STANDIN(__lesf2)
+HOST_STANDIN(__ltsf2)
+HOST_STANDIN(__unordsf2)
+HOST_STANDIN(__fixsfsi)
+HOST_STANDIN(__fixunssfsi)
+HOST_STANDIN(__floatsisf)
+HOST_STANDIN(__floatunsisf)
+
+/* newlib */
+HOST_STANDIN(__errno)
+HOST_STANDIN(__getreent)
+HOST_STANDIN(__assert_func)
+const char _ctype_[257];
+
+/* ESP-IDF, FreeRTOS and lwIP */
+HOST_STANDIN(esp_err_to_name)
+HOST_STANDIN(esp_random)
+HOST_STANDIN(esp_restart)
+HOST_STANDIN(esp_get_free_heap_size)
+HOST_STANDIN(ets_printf)
+HOST_STANDIN(esp_log)
+HOST_STANDIN(esp_log_level_set)
+HOST_STANDIN(esp_log_buffer_hex_internal)
+HOST_STANDIN(esp_log_buffer_char_internal)
+HOST_STANDIN(esp_log_buffer_hexdump_internal)
+HOST_STANDIN(esp_elf_init)
+HOST_STANDIN(esp_elf_deinit)
+HOST_STANDIN(esp_elf_relocate)
+HOST_STANDIN(esp_elf_request)
+HOST_STANDIN(xQueueCreateMutex)
+HOST_STANDIN(xQueueSemaphoreTake)
+HOST_STANDIN(xQueueGenericSend)
+HOST_STANDIN(xTaskDelayUntil)
+HOST_STANDIN(vTaskPrioritySet)
+HOST_STANDIN(lwip_socket)
+HOST_STANDIN(lwip_bind)
+HOST_STANDIN(lwip_listen)
+HOST_STANDIN(lwip_accept)
+HOST_STANDIN(lwip_connect)
+HOST_STANDIN(lwip_setsockopt)
+HOST_STANDIN(lwip_recv)
+HOST_STANDIN(lwip_recvfrom)
+HOST_STANDIN(lwip_send)
+HOST_STANDIN(lwip_sendto)
+HOST_STANDIN(lwip_htons)
+HOST_STANDIN(lwip_htonl)
+HOST_STANDIN(ipaddr_addr)
+HOST_STANDIN(ip4addr_ntoa)
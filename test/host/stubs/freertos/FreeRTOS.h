@@ -0,0 +1,58 @@
+/* Host build: FreeRTOS types and port layer over pthreads (freertos_host.c) */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdFAIL  0
+
+/* One tick per millisecond */
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  1
+#define portMAX_DELAY       ((TickType_t)0xffffffffu)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define pdTICKS_TO_MS(t)    ((t))
+
+#define configMAX_PRIORITIES 25
+#define portNUM_PROCESSORS   CONFIG_FREERTOS_NUMBER_OF_CORES
+#define tskNO_AFFINITY       0x7fffffff
+
+/* Critical sections share one recursive lock; the owner field is unused */
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+#define portMUX_INITIALIZE(m)        ((void)(m))
+#define spinlock_initialize(m)       ((void)(m))
+
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(m)     vPortEnterCritical(m)
+#define portEXIT_CRITICAL(m)      vPortExitCritical(m)
+#define portENTER_CRITICAL_ISR(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL_ISR(m)  vPortExitCritical(m)
+
+BaseType_t xPortInIsrContext(void);
+BaseType_t xPortGetCoreID(void);
+#define portGET_CORE_ID() xPortGetCoreID()
+#define portYIELD_FROM_ISR(...) ((void)0)
+
+/* Queue layer under the semaphore macros; declared by FreeRTOS.h's
+ * includes on the target */
+typedef void *QueueHandle_t;
+QueueHandle_t xQueueCreateMutex(uint8_t type);
+BaseType_t xQueueSemaphoreTake(QueueHandle_t queue, TickType_t ticks);
+BaseType_t xQueueGenericSend(QueueHandle_t queue, const void *item, TickType_t ticks, BaseType_t pos);
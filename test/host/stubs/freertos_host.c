@@ -0,0 +1,437 @@
+/* -------------------------------------------------------------
+ * freertos_host.c
+ *
+ * Just enough of the FreeRTOS API over pthreads to run the
+ * launchpad modules that spawn tasks or wait on semaphores.
+ * Priorities and core affinity are ignored; every task really
+ * runs concurrently, which is what the parallel paths need.
+ * ------------------------------------------------------------- */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct host_task {
+    pthread_t       thread;
+    TaskFunction_t  fn;
+    void            *arg;
+    UBaseType_t     prio;
+    BaseType_t      core;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    uint32_t        notify;
+};
+
+struct host_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    UBaseType_t     count;
+    UBaseType_t     max;
+    bool            is_static;
+    bool            is_mutex;
+    TaskHandle_t    holder;
+    UBaseType_t     depth;
+};
+
+struct host_event_group {
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    EventBits_t     bits;
+};
+
+_Static_assert(sizeof(struct host_sem) <= sizeof(StaticSemaphore_t), "StaticSemaphore_t too small");
+
+static pthread_mutex_t s_critical = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread struct host_task *t_self;
+
+/* Absolute deadline @ticks from now, for the timed waits */
+static struct timespec host_deadline(TickType_t ticks)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return ts;
+}
+
+/* Wait on @cond; false once @ticks have passed */
+static bool host_wait(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks,
+                      const struct timespec *until)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, until) != ETIMEDOUT;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Port                                                                       */
+/* -------------------------------------------------------------------------- */
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+    (void)mux;
+    pthread_mutex_lock(&s_critical);
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+    (void)mux;
+    pthread_mutex_unlock(&s_critical);
+}
+
+BaseType_t xPortInIsrContext(void)
+{
+    return pdFALSE;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    struct host_task *t = xTaskGetCurrentTaskHandle();
+
+    return t->core == tskNO_AFFINITY ? 0 : t->core;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Tasks                                                                      */
+/* -------------------------------------------------------------------------- */
+
+static struct host_task *host_task_new(void)
+{
+    struct host_task *t = calloc(1, sizeof(*t));
+
+    if (t) {
+        pthread_mutex_init(&t->lock, NULL);
+        pthread_cond_init(&t->cond, NULL);
+        t->prio = 1;
+    }
+    return t;
+}
+
+static void *host_task_entry(void *arg)
+{
+    struct host_task *t = arg;
+
+    t_self = t;
+    t->fn(t->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *handle, BaseType_t core)
+{
+    struct host_task *t = host_task_new();
+
+    (void)name;
+    (void)stack;
+    if (!t) {
+        return pdFAIL;
+    }
+    t->fn   = fn;
+    t->arg  = arg;
+    t->prio = prio;
+    t->core = core;
+    if (handle) {
+        *handle = t;
+    }
+    if (pthread_create(&t->thread, NULL, host_task_entry, t)) {
+        free(t);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    /* Handles stay allocated: others may still hold them */
+    if (task && task != t_self) {
+        /* Stops at its next wait, as a blocked FreeRTOS task would, and
+         * is gone before this returns */
+        pthread_cancel(task->thread);
+        pthread_join(task->thread, NULL);
+        return;
+    }
+    pthread_detach(pthread_self());
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = { ticks / 1000, (long)(ticks % 1000) * 1000000 };
+
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    /* Threads not created through xTaskCreate (main) get a handle on first use */
+    if (!t_self) {
+        t_self = host_task_new();
+        t_self->thread = pthread_self();
+    }
+    return t_self;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return (task ? task : xTaskGetCurrentTaskHandle())->prio;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    struct host_task *t = xTaskGetCurrentTaskHandle();
+    struct timespec until = host_deadline(ticks);
+    uint32_t v;
+
+    pthread_mutex_lock(&t->lock);
+    while (!t->notify && host_wait(&t->cond, &t->lock, ticks, &until)) {
+    }
+    v = t->notify;
+    if (v) {
+        t->notify = clear ? 0 : v - 1;
+    }
+    pthread_mutex_unlock(&t->lock);
+    return v;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+    if (woken) {
+        *woken = pdTRUE;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Semaphores                                                                 */
+/* -------------------------------------------------------------------------- */
+
+static SemaphoreHandle_t host_sem_init(struct host_sem *s, bool is_static, UBaseType_t max,
+                                       UBaseType_t initial, bool is_mutex)
+{
+    if (!s) {
+        return NULL;
+    }
+    memset(s, 0, sizeof(*s));
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->count     = initial;
+    s->max       = max;
+    s->is_static = is_static;
+    s->is_mutex  = is_mutex;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return host_sem_init(malloc(sizeof(struct host_sem)), false, 1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    return host_sem_init(malloc(sizeof(struct host_sem)), false, max, initial, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return host_sem_init(malloc(sizeof(struct host_sem)), false, 1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buf)
+{
+    return host_sem_init((struct host_sem *)buf, true, 1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buf)
+{
+    return host_sem_init((struct host_sem *)buf, true, 1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t *buf)
+{
+    return host_sem_init((struct host_sem *)buf, true, 1, 1, true);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks)
+{
+    struct timespec until = host_deadline(ticks);
+    BaseType_t ok;
+
+    pthread_mutex_lock(&s->lock);
+    while (!s->count && host_wait(&s->cond, &s->lock, ticks, &until)) {
+    }
+    ok = s->count != 0;
+    if (ok) {
+        s->count--;
+        s->holder = xTaskGetCurrentTaskHandle();
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    BaseType_t ok;
+
+    pthread_mutex_lock(&s->lock);
+    ok = s->count < s->max;
+    if (ok) {
+        s->count++;
+        s->holder = NULL;
+        pthread_cond_signal(&s->cond);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t *woken)
+{
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xSemaphoreGive(s);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t s, TickType_t ticks)
+{
+    if (s->holder == xTaskGetCurrentTaskHandle()) {
+        s->depth++;
+        return pdTRUE;
+    }
+    return xSemaphoreTake(s, ticks);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t s)
+{
+    if (s->depth) {
+        s->depth--;
+        return pdTRUE;
+    }
+    return xSemaphoreGive(s);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    if (!s->is_static) {
+        free(s);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* Event groups                                                               */
+/* -------------------------------------------------------------------------- */
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct host_event_group *g = calloc(1, sizeof(*g));
+
+    if (g) {
+        pthread_mutex_init(&g->lock, NULL);
+        pthread_cond_init(&g->cond, NULL);
+    }
+    return g;
+}
+
+void vEventGroupDelete(EventGroupHandle_t g)
+{
+    pthread_cond_destroy(&g->cond);
+    pthread_mutex_destroy(&g->lock);
+    free(g);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    EventBits_t v;
+
+    pthread_mutex_lock(&g->lock);
+    v = g->bits |= bits;
+    pthread_cond_broadcast(&g->cond);
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits)
+{
+    EventBits_t v;
+
+    pthread_mutex_lock(&g->lock);
+    v = g->bits;
+    g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t g)
+{
+    EventBits_t v;
+
+    pthread_mutex_lock(&g->lock);
+    v = g->bits;
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear,
+                                BaseType_t all, TickType_t ticks)
+{
+    struct timespec until = host_deadline(ticks);
+    EventBits_t v;
+
+    pthread_mutex_lock(&g->lock);
+    for (;;) {
+        v = g->bits;
+        if (all ? (v & bits) == bits : (v & bits) != 0) {
+            if (clear) {
+                g->bits &= ~bits;
+            }
+            break;
+        }
+        if (!host_wait(&g->cond, &g->lock, ticks, &until)) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
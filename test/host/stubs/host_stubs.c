@@ -0,0 +1,116 @@
+/* -------------------------------------------------------------
+ * host_stubs.c
+ *
+ * Host stand-ins for the ESP-IDF services the modules under test
+ * call: logging, the platform descriptor and the symbol registry.
+ * ------------------------------------------------------------- */
+
+#include "host_stubs.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_log.h"
+#include "host_test.h"
+#include "elf/esp_elf.h"
+
+int host_failures;
+
+launchpad_platform_info_t g_host_platform = {
+    .bitness = 32,
+};
+
+launchpad_platform_info_t launchpad_platform(void)
+{
+    return g_host_platform;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Logging                                                                    */
+/* -------------------------------------------------------------------------- */
+
+struct host_log g_host_log;
+static pthread_mutex_t s_log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void esp_log_writev(esp_log_level_t level, const char *tag, const char *format, va_list args)
+{
+    if (g_host_log.capture) {
+        pthread_mutex_lock(&s_log_lock);
+        size_t room = sizeof(g_host_log.out) - g_host_log.len;
+        int n = vsnprintf(g_host_log.out + g_host_log.len, room, format, args);
+        if (n > 0) {
+            g_host_log.len += (size_t)n < room ? (size_t)n : room - 1;
+        }
+        pthread_mutex_unlock(&s_log_lock);
+        return;
+    }
+    if (g_host_log.discard) {
+        char line[256];
+
+        vsnprintf(line, sizeof(line), format, args);
+        HOST_KEEP(line);
+        return;
+    }
+    if (level > ESP_LOG_WARN) {
+        return;
+    }
+    fprintf(stderr, "%c (%s) ", level == ESP_LOG_ERROR ? 'E' : 'W', tag);
+    vfprintf(stderr, format, args);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    esp_log_writev(level, tag, format, ap);
+    va_end(ap);
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Symbol registry                                                            */
+/* -------------------------------------------------------------------------- */
+
+static struct {
+    const char *name;
+    void *sym;
+} s_symbols[HOST_SYMBOLS_MAX];
+static int s_nr_symbols;
+
+/* Weak: a test that builds the real registry in replaces this one */
+__attribute__((weak)) uintptr_t _register_symbol(const char *name, void *sym)
+{
+    for (int i = 0; i < s_nr_symbols; i++) {
+        if (!strcmp(s_symbols[i].name, name)) {
+            s_symbols[i].sym = sym;
+            return (uintptr_t)sym;
+        }
+    }
+    if (s_nr_symbols == HOST_SYMBOLS_MAX) {
+        return 0;
+    }
+    s_symbols[s_nr_symbols].name = name;
+    s_symbols[s_nr_symbols].sym  = sym;
+    s_nr_symbols++;
+    return (uintptr_t)sym;
+}
+
+void *host_symbol(const char *name)
+{
+    for (int i = 0; i < s_nr_symbols; i++) {
+        if (!strcmp(s_symbols[i].name, name)) {
+            return s_symbols[i].sym;
+        }
+    }
+    return NULL;
+}
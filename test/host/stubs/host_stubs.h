@@ -0,0 +1,51 @@
+/* -------------------------------------------------------------
+ * host_stubs.h
+ *
+ * Hooks of the host stubs for tests to steer and inspect.
+ * ------------------------------------------------------------- */
+
+#ifndef LAUNCHPAD_HOST_STUBS_H
+#define LAUNCHPAD_HOST_STUBS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HOST_SYMBOLS_MAX 256
+
+/* Returned by launchpad_platform(); set hardware before a module's init */
+extern launchpad_platform_info_t g_host_platform;
+
+/* Address last given to _register_symbol() for @name, NULL if none */
+void *host_symbol(const char *name);
+
+/* What driver/uart.h calls wrote, from uart_host.c; tests reset it */
+struct host_uart {
+    char out[65536];
+    size_t len;
+    long calls;
+    int baud;
+};
+extern struct host_uart g_host_uart;
+
+/* esp_log output; by default warnings and errors go to stderr. With
+ * @capture every level is appended to @out without a prefix, with
+ * @discard every level is formatted and dropped */
+struct host_log {
+    bool capture;
+    bool discard;
+    char out[1 << 22];
+    size_t len;
+};
+extern struct host_log g_host_log;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LAUNCHPAD_HOST_STUBS_H */
@@ -0,0 +1,8 @@
+/* Host build: lwIP's BSD socket names are the host's */
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
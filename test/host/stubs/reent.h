@@ -0,0 +1,9 @@
+/* Host build: newlib names that glibc's headers do not declare */
+#pragma once
+
+struct _reent;
+
+struct _reent *__getreent(void);
+int *__errno(void);
+void __assert_func(const char *file, int line, const char *func, const char *expr);
+extern const char _ctype_[];
@@ -0,0 +1,2 @@
+/* Host build: no cache control; included for completeness only */
+#pragma once
@@ -0,0 +1,4 @@
+/* Host build: ROM console */
+#pragma once
+
+int ets_printf(const char *fmt, ...);
@@ -0,0 +1,5 @@
+/* Host build configuration: only what the modules under test read */
+#pragma once
+
+#define CONFIG_IDF_TARGET_ESP32P4 1
+#define CONFIG_FREERTOS_NUMBER_OF_CORES 2
@@ -0,0 +1,5 @@
+/* Host build: no target-specific units */
+#pragma once
+
+#define SOC_CPU_HAS_PIE                     0
+#define SOC_CACHE_INTERNAL_MEM_VIA_L1CACHE  0
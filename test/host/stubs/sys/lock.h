@@ -0,0 +1,18 @@
+/* Host build: newlib retargetable locks as a spinning flag */
+#pragma once
+
+#include <sched.h>
+
+typedef int _lock_t;
+
+static inline void _lock_acquire(_lock_t *lock)
+{
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+}
+
+static inline void _lock_release(_lock_t *lock)
+{
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,25 @@
+/* Host build: the host's sockets plus the lwIP entry points that
+ * ESP-IDF's socket headers map them to */
+#pragma once
+
+#include_next <sys/socket.h>
+
+#include <stdint.h>
+
+struct ip4_addr;
+
+int lwip_socket(int domain, int type, int protocol);
+int lwip_bind(int s, const struct sockaddr *name, socklen_t namelen);
+int lwip_listen(int s, int backlog);
+int lwip_accept(int s, struct sockaddr *addr, socklen_t *addrlen);
+int lwip_connect(int s, const struct sockaddr *name, socklen_t namelen);
+int lwip_setsockopt(int s, int level, int optname, const void *optval, socklen_t optlen);
+ssize_t lwip_recv(int s, void *mem, size_t len, int flags);
+ssize_t lwip_recvfrom(int s, void *mem, size_t len, int flags, struct sockaddr *from, socklen_t *fromlen);
+ssize_t lwip_send(int s, const void *data, size_t size, int flags);
+ssize_t lwip_sendto(int s, const void *data, size_t size, int flags, const struct sockaddr *to,
+                    socklen_t tolen);
+uint16_t lwip_htons(uint16_t x);
+uint32_t lwip_htonl(uint32_t x);
+uint32_t ipaddr_addr(const char *cp);
+char *ip4addr_ntoa(const struct ip4_addr *addr);
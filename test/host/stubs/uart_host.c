@@ -0,0 +1,61 @@
+/* -------------------------------------------------------------
+ * uart_host.c
+ *
+ * A UART that keeps what is written to it and counts the calls.
+ * ------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "driver/uart.h"
+#include "host_stubs.h"
+
+struct host_uart g_host_uart;
+
+esp_err_t uart_driver_install(uart_port_t port, int rx_size, int tx_size, int queue_size,
+                              void *queue, int flags)
+{
+    (void)port;
+    (void)rx_size;
+    (void)tx_size;
+    (void)queue_size;
+    (void)queue;
+    (void)flags;
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t port, const uart_config_t *config)
+{
+    (void)port;
+    g_host_uart.baud = config->baud_rate;
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t port, int tx, int rx, int rts, int cts)
+{
+    (void)port;
+    (void)tx;
+    (void)rx;
+    (void)rts;
+    (void)cts;
+    return ESP_OK;
+}
+
+int uart_write_bytes(uart_port_t port, const void *buf, size_t len)
+{
+    size_t room = sizeof(g_host_uart.out) - g_host_uart.len;
+
+    (void)port;
+    memcpy(g_host_uart.out + g_host_uart.len, buf, len < room ? len : room);
+    g_host_uart.len += len < room ? len : room;
+    g_host_uart.calls++;
+    return (int)len;
+}
+
+int uart_read_bytes(uart_port_t port, void *buf, uint32_t len, TickType_t ticks)
+{
+    (void)port;
+    (void)buf;
+    (void)len;
+    (void)ticks;
+    return 0;
+}
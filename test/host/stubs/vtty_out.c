@@ -0,0 +1,20 @@
+/* -------------------------------------------------------------
+ * vtty_out.c
+ *
+ * Console output for modules tested without the vtty core:
+ * launchpad_vtty_write() goes to stdout.
+ * ------------------------------------------------------------- */
+
+#include <stdio.h>
+
+#include "launchpad_vtty.h"
+
+int launchpad_vtty_write(const char *buf, size_t len)
+{
+    return (int)fwrite(buf, 1, len, stdout);
+}
+
+void launchpad_vtty_flush(void)
+{
+    fflush(stdout);
+}
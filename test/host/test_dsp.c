@@ -0,0 +1,163 @@
+/* -------------------------------------------------------------
+ * test_dsp.c
+ *
+ * The FPU kernels against the scalar reference kernels. The
+ * module is built into the test so both dispatch tables are in
+ * reach. Integer kernels must agree exactly, on full-scale,
+ * alternating and random Q15 data; float kernels must agree to
+ * within rounding.
+ * ------------------------------------------------------------- */
+
+#include "abi/launchpad/dsp.c"
+
+#include "host_test.h"
+
+#define MAX_LEN   67            /* odd, past several unrolled blocks */
+#define MAX_TAPS  33
+#define FFT_N     1024
+#define MAT       13
+
+enum { PAT_MIN, PAT_MAX, PAT_ALT, PAT_RANDOM, PAT_COUNT };
+
+static const char *const s_pat_name[PAT_COUNT] = { "INT16_MIN", "INT16_MAX", "alternating", "random" };
+
+static void fill_s16(int16_t *x, int n, int pat)
+{
+    for (int i = 0; i < n; i++) {
+        switch (pat) {
+        case PAT_MIN:    x[i] = INT16_MIN; break;
+        case PAT_MAX:    x[i] = INT16_MAX; break;
+        case PAT_ALT:    x[i] = (i & 1) ? INT16_MAX : INT16_MIN; break;
+        default:         x[i] = (int16_t)(rand() & 0xFFFF); break;
+        }
+    }
+}
+
+static void fill_f32(float *x, int n)
+{
+    for (int i = 0; i < n; i++) {
+        x[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+    }
+}
+
+/* Largest difference relative to the largest reference magnitude */
+static float rel_err(const float *ref, const float *got, int n)
+{
+    float scale = 1.0f;
+
+    for (int i = 0; i < n; i++) {
+        scale = fmaxf(scale, fabsf(ref[i]));
+    }
+    return max_err(ref, got, n) / scale;
+}
+
+static void check_dot_s16(void)
+{
+    static const int shifts[] = { 0, 1, 15, 31 };
+    int16_t a[MAX_LEN], b[MAX_LEN];
+
+    for (int pat = 0; pat < PAT_COUNT; pat++) {
+        for (int len = 0; len <= MAX_LEN; len++) {
+            fill_s16(a, len, pat);
+            fill_s16(b, len, pat == PAT_ALT ? PAT_MIN : pat);
+            for (size_t s = 0; s < sizeof(shifts) / sizeof(shifts[0]); s++) {
+                int32_t want = s_ref_ops.dot_s16(a, b, len, shifts[s]);
+                int32_t got = s_fast_ops.dot_s16(a, b, len, shifts[s]);
+
+                CHECK(got == want, "dot_s16 %s len %d shift %d: %ld, reference %ld", s_pat_name[pat], len,
+                      shifts[s], (long)got, (long)want);
+            }
+        }
+    }
+}
+
+static void check_fir_s16(void)
+{
+    int16_t coeffs[MAX_TAPS], in[MAX_LEN];
+    int16_t d_ref[MAX_TAPS], d_fast[MAX_TAPS];
+    int16_t o_ref[MAX_LEN], o_fast[MAX_LEN];
+
+    for (int pat = 0; pat < PAT_COUNT; pat++) {
+        for (int ntaps = 1; ntaps <= MAX_TAPS; ntaps++) {
+            launchpad_dsp_fir_s16_t ref, fast;
+
+            fill_s16(coeffs, ntaps, pat);
+            fill_s16(in, MAX_LEN, pat == PAT_ALT ? PAT_MIN : pat);
+            launchpad_dsp_fir_init_s16(&ref, coeffs, d_ref, ntaps, 15);
+            launchpad_dsp_fir_init_s16(&fast, coeffs, d_fast, ntaps, 15);
+
+            /* Two calls, so the delay line wraps with state carried over */
+            for (int half = 0; half < 2; half++) {
+                s_ref_ops.fir_s16(&ref, in, o_ref, MAX_LEN);
+                s_fast_ops.fir_s16(&fast, in, o_fast, MAX_LEN);
+                CHECK(!memcmp(o_ref, o_fast, sizeof(o_ref)), "fir_s16 %s ntaps %d differs",
+                      s_pat_name[pat], ntaps);
+            }
+        }
+    }
+}
+
+static void check_float(void)
+{
+    static float a[FFT_N * 2], b[FFT_N * 2], r[FFT_N * 2], f[FFT_N * 2];
+    float d_ref[MAX_TAPS], d_fast[MAX_TAPS];
+
+    fill_f32(a, FFT_N * 2);
+    fill_f32(b, FFT_N * 2);
+
+    for (int len = 0; len <= MAX_LEN; len++) {
+        float want = s_ref_ops.dot_f32(a, b, len);
+        float got = s_fast_ops.dot_f32(a, b, len);
+
+        CHECK(fabsf(got - want) <= 1e-5f * len, "dot_f32 len %d: %g, reference %g", len, got, want);
+    }
+
+    for (int ntaps = 1; ntaps <= MAX_TAPS; ntaps++) {
+        launchpad_dsp_fir_f32_t ref, fast;
+
+        launchpad_dsp_fir_init_f32(&ref, b, d_ref, ntaps);
+        launchpad_dsp_fir_init_f32(&fast, b, d_fast, ntaps);
+        s_ref_ops.fir_f32(&ref, a, r, MAX_LEN * 2);
+        s_fast_ops.fir_f32(&fast, a, f, MAX_LEN * 2);
+        CHECK(rel_err(r, f, MAX_LEN * 2) < 1e-5f, "fir_f32 ntaps %d differs by %g", ntaps,
+              rel_err(r, f, MAX_LEN * 2));
+    }
+
+    /* Low-pass biquad, stable poles */
+    const float coef[5] = { 0.0675f, 0.1349f, 0.0675f, -1.1430f, 0.4128f };
+    float w_ref[2] = { 0 }, w_fast[2] = { 0 };
+    s_ref_ops.biquad_f32(a, r, FFT_N, coef, w_ref);
+    s_fast_ops.biquad_f32(a, f, FFT_N, coef, w_fast);
+    CHECK(rel_err(r, f, FFT_N) < 1e-5f, "biquad_f32 differs by %g", rel_err(r, f, FFT_N));
+
+    CHECK(s_ref_ops.mat_mul_f32(a, b, r, MAT, MAT + 2, MAT - 3) == 0 &&
+          s_fast_ops.mat_mul_f32(a, b, f, MAT, MAT + 2, MAT - 3) == 0, "mat_mul_f32 failed");
+    CHECK(rel_err(r, f, MAT * (MAT - 3)) < 1e-5f, "mat_mul_f32 differs by %g",
+          rel_err(r, f, MAT * (MAT - 3)));
+
+    CHECK(launchpad_dsp_fft_init(FFT_N) == 0, "fft_init");
+    for (int n = 4; n <= FFT_N; n *= 2) {
+        memcpy(r, a, 2 * n * sizeof(float));
+        memcpy(f, a, 2 * n * sizeof(float));
+        CHECK(s_ref_ops.fft2r_f32(r, n) == 0 && s_fast_ops.fft2r_f32(f, n) == 0, "fft2r n %d", n);
+        CHECK(rel_err(r, f, 2 * n) < 1e-5f, "fft2r_f32 n %d differs by %g", n, rel_err(r, f, 2 * n));
+
+        if (ilog2(n) % 2 == 0) {
+            memcpy(r, a, 2 * n * sizeof(float));
+            memcpy(f, a, 2 * n * sizeof(float));
+            CHECK(s_ref_ops.fft4r_f32(r, n) == 0 && s_fast_ops.fft4r_f32(f, n) == 0, "fft4r n %d", n);
+            CHECK(rel_err(r, f, 2 * n) < 1e-5f, "fft4r_f32 n %d differs by %g", n,
+                  rel_err(r, f, 2 * n));
+        }
+    }
+    launchpad_dsp_fft_deinit();
+}
+
+int main(void)
+{
+    srand(27);
+    check_dot_s16();
+    check_fir_s16();
+    check_float();
+    return host_result();
+}
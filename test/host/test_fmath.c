@@ -0,0 +1,172 @@
+/* -------------------------------------------------------------
+ * test_fmath.c
+ *
+ * Accuracy of the float-only kernels against the host's double
+ * libm, in ulp of the correctly rounded float result, over the
+ * ranges they serve; plus the special values and the symbol
+ * selection done by launchpad_fmath_init().
+ * ------------------------------------------------------------- */
+
+#include <math.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "host_stubs.h"
+#include "include/fmath.h"
+
+/* Bound stated in include/fmath.h */
+#define MAX_ULP 3.0
+
+#define STEPS 2000000
+
+/* Error of @r in ulp of the float nearest @ref */
+static double ulp_err(float r, double ref)
+{
+    if (isnan(ref)) {
+        return isnan(r) ? 0 : INFINITY;
+    }
+    if (isinf(ref)) {
+        return r == ref ? 0 : INFINITY;
+    }
+
+    float fr = fabsf((float)ref);
+    double u = fr == 0 ? 1.4e-45 : nextafterf(fr, INFINITY) - fr;
+
+    return fabs(r - ref) / u;
+}
+
+static void check_range(const char *name, float (*fn)(float), double (*ref)(double),
+                        double lo, double hi)
+{
+    double worst = 0;
+    float at = 0;
+
+    for (int i = 0; i <= STEPS; i++) {
+        float x = (float)(lo + (hi - lo) * i / STEPS);
+        double e = ulp_err(fn(x), ref(x));
+
+        if (e > worst) {
+            worst = e;
+            at = x;
+        }
+    }
+    printf("%-7s [%g, %g]  max %.2f ulp at %g\n", name, lo, hi, worst, at);
+    CHECK(worst <= MAX_ULP, "%s: %.2f ulp at %.9g", name, worst, at);
+}
+
+/* Logarithms over every binade: step the exponent, sweep the mantissa */
+static void check_log(const char *name, float (*fn)(float), double (*ref)(double))
+{
+    double worst = 0;
+    float at = 0;
+
+    for (int e = -149; e < 128; e++) {
+        for (int i = 0; i < 4096; i++) {
+            float x = ldexpf(1.0f + i / 4096.0f, e);
+            double err = ulp_err(fn(x), ref(x));
+
+            if (err > worst) {
+                worst = err;
+                at = x;
+            }
+        }
+    }
+    printf("%-7s all binades  max %.2f ulp at %g\n", name, worst, at);
+    CHECK(worst <= MAX_ULP, "%s: %.2f ulp at %.9g", name, worst, at);
+}
+
+static void check_atan2(void)
+{
+    double worst = 0;
+    float wy = 0, wx = 0;
+
+    for (int i = 0; i <= 1000; i++) {
+        for (int j = 0; j <= 1000; j++) {
+            float y = -5 + i * 0.01f, x = -5 + j * 0.01f;
+            double e = ulp_err(launchpad_fast_atan2f(y, x), atan2(y, x));
+
+            if (e > worst) {
+                worst = e;
+                wy = y;
+                wx = x;
+            }
+        }
+    }
+    printf("%-7s [-5, 5]^2  max %.2f ulp at (%g, %g)\n", "atan2f", worst, wy, wx);
+    CHECK(worst <= MAX_ULP, "atan2f: %.2f ulp at (%g, %g)", worst, wy, wx);
+}
+
+static int same(float a, float b)
+{
+    return (isnan(a) && isnan(b)) || (a == b && signbit(a) == signbit(b));
+}
+
+#define SPECIAL(expr, want) CHECK(same((expr), (want)), "%s = %g, want %g", #expr, (double)(expr), (double)(want))
+
+static void check_special(void)
+{
+    SPECIAL(launchpad_fast_sinf(NAN), NAN);
+    SPECIAL(launchpad_fast_sinf(INFINITY), NAN);
+    SPECIAL(launchpad_fast_sinf(-0.0f), -0.0f);
+    SPECIAL(launchpad_fast_cosf(0.0f), 1.0f);
+    SPECIAL(launchpad_fast_cosf(-INFINITY), NAN);
+
+    SPECIAL(launchpad_fast_expf(NAN), NAN);
+    SPECIAL(launchpad_fast_expf(INFINITY), INFINITY);
+    SPECIAL(launchpad_fast_expf(-INFINITY), 0.0f);
+    SPECIAL(launchpad_fast_expf(100.0f), INFINITY);
+    SPECIAL(launchpad_fast_expf(-120.0f), 0.0f);
+    SPECIAL(launchpad_fast_exp2f(10.0f), 1024.0f);
+    SPECIAL(launchpad_fast_exp2f(-149.0f), 0x1p-149f);
+    SPECIAL(launchpad_fast_exp2f(128.0f), INFINITY);
+
+    SPECIAL(launchpad_fast_logf(0.0f), -INFINITY);
+    SPECIAL(launchpad_fast_logf(-0.0f), -INFINITY);
+    SPECIAL(launchpad_fast_logf(-1.0f), NAN);
+    SPECIAL(launchpad_fast_logf(INFINITY), INFINITY);
+    SPECIAL(launchpad_fast_logf(1.0f), 0.0f);
+    SPECIAL(launchpad_fast_log2f(8.0f), 3.0f);
+    SPECIAL(launchpad_fast_log10f(1000.0f), 3.0f);
+
+    SPECIAL(launchpad_fast_atanf(INFINITY), (float)M_PI_2);
+    SPECIAL(launchpad_fast_atanf(-0.0f), -0.0f);
+    SPECIAL(launchpad_fast_atan2f(0.0f, -0.0f), (float)M_PI);
+    SPECIAL(launchpad_fast_atan2f(-0.0f, -1.0f), (float)-M_PI);
+    SPECIAL(launchpad_fast_atan2f(-0.0f, 1.0f), -0.0f);
+    SPECIAL(launchpad_fast_atan2f(INFINITY, -INFINITY), (float)(3 * M_PI_4));
+    SPECIAL(launchpad_fast_atan2f(NAN, 1.0f), NAN);
+}
+
+static void check_selection(void)
+{
+    g_host_platform.hardware = 0;
+    launchpad_fmath_init();
+    CHECK(!strcmp(launchpad_fmath_impl(), "newlib"), "impl %s", launchpad_fmath_impl());
+    CHECK(host_symbol("sinf") == (void *)sinf, "sinf not newlib");
+
+    g_host_platform.hardware = LAUNCHPAD_HW_RISCV_F;
+    launchpad_fmath_init();
+    CHECK(!strcmp(launchpad_fmath_impl(), "fpu"), "impl %s", launchpad_fmath_impl());
+    CHECK(host_symbol("sinf") == (void *)launchpad_fast_sinf, "sinf not fast");
+    CHECK(host_symbol("atan2f") == (void *)launchpad_fast_atan2f, "atan2f not fast");
+}
+
+int main(void)
+{
+    check_selection();
+
+    check_range("sinf", launchpad_fast_sinf, sin, -4, 4);
+    check_range("sinf", launchpad_fast_sinf, sin, -LAUNCHPAD_FMATH_TRIG_MAX, LAUNCHPAD_FMATH_TRIG_MAX);
+    check_range("cosf", launchpad_fast_cosf, cos, -4, 4);
+    check_range("cosf", launchpad_fast_cosf, cos, -LAUNCHPAD_FMATH_TRIG_MAX, LAUNCHPAD_FMATH_TRIG_MAX);
+    check_range("expf", launchpad_fast_expf, exp, -104, 89);
+    check_range("exp2f", launchpad_fast_exp2f, exp2, -151, 128.5);
+    check_log("logf", launchpad_fast_logf, log);
+    check_log("log2f", launchpad_fast_log2f, log2);
+    check_log("log10f", launchpad_fast_log10f, log10);
+    check_range("atanf", launchpad_fast_atanf, atan, -100, 100);
+    check_atan2();
+    check_special();
+
+    return host_result();
+}
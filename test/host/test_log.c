@@ -0,0 +1,197 @@
+/* -------------------------------------------------------------
+ * test_log.c
+ *
+ * Deferred launchpad_log() against vsnprintf and under load.
+ *
+ * Each format goes through the ring and the drain task's decoder
+ * and must print what vsnprintf prints. Calls that cannot be
+ * deferred must print at once and be counted as sync. Four tasks
+ * on two cores then log concurrently: every task's lines must
+ * come out in order, and the lines lost must match the drop count.
+ * ------------------------------------------------------------- */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_stubs.h"
+#include "host_test.h"
+#include "include/log.h"
+
+#define WORKERS      4
+#define WORKER_LINES 5000
+
+static char s_expect[4096];
+
+static struct launchpad_log_stats stats(void)
+{
+    struct launchpad_log_stats st;
+
+    launchpad_log_get_stats(&st);
+    return st;
+}
+
+static void expect(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(s_expect, sizeof(s_expect), fmt, ap);
+    va_end(ap);
+}
+
+/* Log through the ring and compare the drained line with vsnprintf */
+#define CHECK_FORMAT(...)                                                       \
+    do {                                                                        \
+        uint32_t records = stats().records;                                     \
+        g_host_log.len = 0;                                                     \
+        launchpad_log(LAUNCHPAD_LOG_INFO, "t", __VA_ARGS__);                    \
+        launchpad_log_flush();                                                  \
+        expect(__VA_ARGS__);                                                    \
+        CHECK(stats().records == records + 1, "%s: not deferred", #__VA_ARGS__); \
+        CHECK(g_host_log.len == strlen(s_expect) &&                             \
+              !memcmp(g_host_log.out, s_expect, g_host_log.len),                \
+              "got '%.*s', expected '%s'", (int)g_host_log.len, g_host_log.out, \
+              s_expect);                                                        \
+    } while (0)
+
+/* Must bypass the ring and print before launchpad_log() returns */
+#define CHECK_SYNC(fmt, ...)                                                    \
+    do {                                                                        \
+        uint32_t sync = stats().sync;                                           \
+        launchpad_log_flush();                                                  \
+        g_host_log.len = 0;                                                     \
+        launchpad_log(LAUNCHPAD_LOG_INFO, "t", fmt, ##__VA_ARGS__);             \
+        CHECK(stats().sync == sync + 1, "%s: not printed at once", #fmt);       \
+        CHECK(g_host_log.len > 0, "%s: nothing printed", #fmt);                 \
+    } while (0)
+
+static void check_formats(void)
+{
+    char on_stack[] = "on the stack";
+    char *on_heap = strdup("heap %d\n");
+
+    CHECK_FORMAT("plain\n");
+    CHECK_FORMAT("%d %i %u %x %X %o %c|\n", -5, 42, 3000000000u, 0xbeef, 0xBEEF, 8, 'z');
+    CHECK_FORMAT("%5d|%-5d|%05d|%+d|% d|%#x\n", 1, 2, 3, 4, 5, 255);
+    CHECK_FORMAT("%lld %llu %llx\n", -1234567890123LL, 18446744073709551615ULL,
+                 0x1122334455667788ULL);
+    CHECK_FORMAT("%ld %lu %zu %td %jd\n", -7L, 8UL, (size_t)9, (ptrdiff_t)-10, (intmax_t)11);
+    CHECK_FORMAT("%f %.3f %e %g %10.2f|\n", 3.14159, 2.71828, 12345.678, 0.0001, -1.5);
+    CHECK_FORMAT("%s [%10s] [%-6s] [%.3s]\n", on_stack, "ab", "cd", "truncate");
+    CHECK_FORMAT("%*d|%-*d|%.*f|\n", 6, 42, 4, 7, 2, 3.14159);
+    CHECK_FORMAT("%*.*f|\n", 8, 3, 2.5);
+    CHECK_FORMAT("%p 100%% %hhd %hd\n", (void *)0x1234, (char)300, (short)70000);
+    CHECK_FORMAT("%d %d %d %d %d %d %d %d\n", 1, 2, 3, 4, 5, 6, 7, 8);
+
+    /* %s is copied up to 32 bytes; a NULL prints as glibc does */
+    uint32_t records = stats().records;
+    g_host_log.len = 0;
+    launchpad_log(LAUNCHPAD_LOG_INFO, "t", "%s|%s\n", "0123456789012345678901234567890123456789",
+                  (char *)NULL);
+    launchpad_log_flush();
+    expect("%.32s|%s\n", "0123456789012345678901234567890123456789", "(null)");
+    CHECK(stats().records == records + 1 && g_host_log.len == strlen(s_expect) &&
+          !memcmp(g_host_log.out, s_expect, g_host_log.len),
+          "long %%s: got '%.*s'", (int)g_host_log.len, g_host_log.out);
+
+    CHECK_SYNC("%d %d %d %d %d %d %d %d %d\n", 1, 2, 3, 4, 5, 6, 7, 8, 9);
+    /* Each '*' takes an argument slot too */
+    CHECK_SYNC("%*d|%-*d|%.*f|%*.*f\n", 6, 42, 4, 7, 2, 3.14159, 8, 3, 2.5);
+    CHECK_SYNC("%Lf\n", 1.5L);
+    CHECK_SYNC("%ls\n", L"wide");
+    CHECK_SYNC(on_heap, 1);
+
+    /* A heap format inside the app image is deferred until the app returns */
+    launchpad_log_app_enter(on_heap, strlen(on_heap) + 1);
+    CHECK_FORMAT(on_heap, 2);
+    launchpad_log_app_exit();
+    CHECK_SYNC(on_heap, 3);
+
+    /* Same address, different format: the cached description must not be reused */
+    strcpy(on_heap, "%s!\n");
+    launchpad_log_app_enter(on_heap, strlen(on_heap) + 1);
+    CHECK_FORMAT(on_heap, "str");
+    launchpad_log_app_exit();
+
+    free(on_heap);
+}
+
+static volatile int s_done;
+
+static void worker(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+
+    for (int i = 0; i < WORKER_LINES; i++) {
+        launchpad_log(LAUNCHPAD_LOG_INFO, "w", "w%d %d\n", id, i);
+        if (i % 50 == 49) {
+            vTaskDelay(1);
+        }
+    }
+    __atomic_add_fetch(&s_done, 1, __ATOMIC_SEQ_CST);
+    vTaskDelete(NULL);
+}
+
+static void check_stress(void)
+{
+    int next[WORKERS] = { 0 };
+    int disorder = 0, missing = 0;
+    uint32_t dropped = stats().dropped;
+
+    launchpad_log_flush();
+    g_host_log.len = 0;
+
+    for (int i = 0; i < WORKERS; i++) {
+        TaskHandle_t t;
+
+        xTaskCreatePinnedToCore(worker, "w", 4096, (void *)(intptr_t)i, 5, &t, i % 2);
+    }
+    while (__atomic_load_n(&s_done, __ATOMIC_SEQ_CST) < WORKERS) {
+        vTaskDelay(1);
+    }
+    launchpad_log_flush();
+
+    g_host_log.out[g_host_log.len] = '\0';
+    for (char *p = g_host_log.out; p && *p; p = strchr(p, '\n'), p = p ? p + 1 : NULL) {
+        int id, i;
+
+        /* Drop reports are lines of their own and do not parse */
+        if (sscanf(p, "w%d %d", &id, &i) != 2 || id < 0 || id >= WORKERS) {
+            continue;
+        }
+        disorder += i < next[id];
+        missing += i > next[id] ? i - next[id] : 0;
+        next[id] = i + 1;
+    }
+    for (int id = 0; id < WORKERS; id++) {
+        missing += WORKER_LINES - next[id];
+    }
+    dropped = stats().dropped - dropped;
+
+    printf("stress: %d lines, %d lost, %u dropped\n", WORKERS * WORKER_LINES, missing, dropped);
+    CHECK(disorder == 0, "%d lines out of order", disorder);
+    CHECK((uint32_t)missing == dropped, "%d lines lost, %u counted", missing, dropped);
+}
+
+int main(void)
+{
+    g_host_log.capture = true;
+    CHECK(launchpad_log_set_mode(LAUNCHPAD_LOG_MODE_DEFERRED) == 0, "set_mode");
+
+    check_formats();
+    check_stress();
+
+    /* Back to sync: formatted at once, nothing left in the rings */
+    CHECK(launchpad_log_set_mode(LAUNCHPAD_LOG_MODE_SYNC) == 0, "set_mode");
+    g_host_log.len = 0;
+    launchpad_log(LAUNCHPAD_LOG_WARN, NULL, "sync %d\n", 5);
+    CHECK(g_host_log.len == 7 && !memcmp(g_host_log.out, "sync 5\n", 7), "sync mode");
+
+    struct launchpad_log_stats st = stats();
+    printf("records %u, dropped %u, sync %u\n", st.records, st.dropped, st.sync);
+    return host_result();
+}
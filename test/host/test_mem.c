@@ -0,0 +1,186 @@
+/* -------------------------------------------------------------
+ * test_mem.c
+ *
+ * Correctness of the memory and string primitives exported by
+ * launchpad_mem_init(). The PIE vector paths only build for the
+ * target; here the scalar selection and the word-at-a-time
+ * strlen/strcmp are checked against byte-wise references, over
+ * every alignment and up to a page boundary.
+ * ------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "host_test.h"
+#include "host_stubs.h"
+#include "include/mem.h"
+
+#define BUF 1024
+
+static int sign(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+static size_t ref_strlen(const char *s)
+{
+    size_t n = 0;
+
+    while (s[n]) {
+        n++;
+    }
+    return n;
+}
+
+static int ref_strcmp(const char *a, const char *b)
+{
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return (unsigned char)*a - (unsigned char)*b;
+}
+
+static void test_scalar_exports(void)
+{
+    g_host_platform.hardware = 0;
+    launchpad_mem_init();
+
+    CHECK(!strcmp(launchpad_mem_impl(), "scalar"), "impl %s", launchpad_mem_impl());
+    CHECK(host_symbol("memcpy") == (void *)memcpy, "memcpy not newlib");
+    CHECK(host_symbol("strlen") == (void *)strlen, "strlen not newlib");
+}
+
+static void test_word_exports(void)
+{
+    g_host_platform.hardware = LAUNCHPAD_HW_CACHE_L1_D;
+    launchpad_mem_init();
+
+    CHECK(host_symbol("strlen") && host_symbol("strlen") != (void *)strlen,
+          "word strlen not selected");
+    CHECK(host_symbol("strcmp") && host_symbol("strcmp") != (void *)strcmp,
+          "word strcmp not selected");
+}
+
+static void test_block_ops(void)
+{
+    static unsigned char src[BUF + 64], dst[BUF + 64], ref[BUF + 64];
+
+    for (int i = 0; i < (int)sizeof(src); i++) {
+        src[i] = (unsigned char)(i * 7 + 3);
+    }
+
+    for (int sa = 0; sa < 16; sa++) {
+        for (int da = 0; da < 16; da++) {
+            for (int n = 0; n <= 300; n += (n < 80 ? 1 : 37)) {
+                memset(dst, 0xA5, sizeof(dst));
+                memset(ref, 0xA5, sizeof(ref));
+                for (int i = 0; i < n; i++) {
+                    ref[da + i] = src[sa + i];
+                }
+                CHECK(launchpad_memcpy(dst + da, src + sa, n) == dst + da, "memcpy return");
+                CHECK(!memcmp(dst, ref, sizeof(dst)), "memcpy sa=%d da=%d n=%d", sa, da, n);
+
+                CHECK(launchpad_memcmp(dst + da, src + sa, n) == 0, "memcmp equal n=%d", n);
+                if (n) {
+                    int k = (n * 5) / 7;
+                    dst[da + k] ^= 0x80;
+                    int want = sign((int)dst[da + k] - (int)src[sa + k]);
+                    CHECK(sign(launchpad_memcmp(dst + da, src + sa, n)) == want,
+                          "memcmp diff at %d of %d", k, n);
+                }
+            }
+        }
+    }
+
+    for (int da = 0; da < 16; da++) {
+        for (int n = 0; n <= BUF; n += (n < 80 ? 1 : 61)) {
+            memset(dst, 0x11, sizeof(dst));
+            memset(ref, 0x11, sizeof(ref));
+            memset(ref + da, 0xC3, n);
+            CHECK(launchpad_memset(dst + da, 0xC3, n) == dst + da, "memset return");
+            CHECK(!memcmp(dst, ref, sizeof(dst)), "memset da=%d n=%d", da, n);
+        }
+    }
+}
+
+static void test_strings(void)
+{
+    static char a[BUF + 16], b[BUF + 16];
+
+    for (int aa = 0; aa < 8; aa++) {
+        for (int n = 0; n < 200; n++) {
+            memset(a, 'x', sizeof(a));
+            a[aa + n] = '\0';
+            CHECK(launchpad_strlen(a + aa) == (size_t)n, "strlen align %d len %d", aa, n);
+
+            /* High bytes must not be mistaken for terminators */
+            if (n) {
+                a[aa + n - 1] = (char)0x80;
+                CHECK(launchpad_strlen(a + aa) == ref_strlen(a + aa), "strlen 0x80 len %d", n);
+            }
+        }
+    }
+
+    for (int aa = 0; aa < 8; aa++) {
+        for (int ba = 0; ba < 8; ba++) {
+            for (int n = 0; n < 70; n++) {
+                for (int i = 0; i < n; i++) {
+                    a[aa + i] = b[ba + i] = (char)('a' + (i * 3) % 26);
+                }
+                a[aa + n] = b[ba + n] = '\0';
+                CHECK(launchpad_strcmp(a + aa, b + ba) == 0, "strcmp equal %d/%d/%d", aa, ba, n);
+
+                for (int k = 0; k < n; k += 7) {
+                    char keep = b[ba + k];
+                    b[ba + k] = (char)(k & 1 ? 0xF0 : 0x01);
+                    CHECK(sign(launchpad_strcmp(a + aa, b + ba)) ==
+                          sign(ref_strcmp(a + aa, b + ba)), "strcmp diff %d/%d/%d@%d", aa, ba, n, k);
+                    b[ba + k] = keep;
+                }
+
+                /* One string a prefix of the other */
+                if (n) {
+                    b[ba + n - 1] = '\0';
+                    CHECK(launchpad_strcmp(a + aa, b + ba) > 0, "strcmp prefix %d", n);
+                }
+            }
+        }
+    }
+}
+
+/* Word reads past the terminator must stay inside the page */
+static void test_page_end(void)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    char *map = mmap(NULL, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    CHECK(map != MAP_FAILED, "mmap");
+    if (map == MAP_FAILED) {
+        return;
+    }
+    mprotect(map + page, page, PROT_NONE);
+
+    for (int n = 0; n < 16; n++) {
+        char *s = map + page - 1 - n;
+
+        memset(s, 'y', n);
+        s[n] = '\0';
+        CHECK(launchpad_strlen(s) == (size_t)n, "strlen at page end, len %d", n);
+        CHECK(launchpad_strcmp(s, s) == 0, "strcmp at page end, len %d", n);
+    }
+    munmap(map, 2 * page);
+}
+
+int main(void)
+{
+    test_scalar_exports();
+    test_block_ops();
+    test_word_exports();
+    test_block_ops();
+    test_strings();
+    test_page_end();
+    return host_result();
+}
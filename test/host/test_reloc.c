@@ -0,0 +1,203 @@
+/* -------------------------------------------------------------
+ * test_reloc.c
+ *
+ * The two-core RELA path of the ELF loader must leave the image
+ * byte-for-byte as the serial loop does. The loader is built
+ * here with CONFIG_LAUNCHPAD_PARALLEL_RELOC on and a threshold
+ * the test moves at run time; tasks are host threads, so both
+ * halves really run at the same time.
+ * ------------------------------------------------------------- */
+
+#include "sdkconfig.h"
+
+#undef CONFIG_LAUNCHPAD_PARALLEL_RELOC
+#undef CONFIG_LAUNCHPAD_PARALLEL_RELOC_MIN
+#define CONFIG_LAUNCHPAD_PARALLEL_RELOC     1
+#define CONFIG_LAUNCHPAD_PARALLEL_RELOC_MIN host_reloc_min
+
+#include <stdint.h>
+
+static uint32_t host_reloc_min;
+
+#include "elf/esp_elf.c"
+
+#include "host_test.h"
+
+#define IMAGE_SIZE  (1u << 20)
+#define NR_SYMS     300
+
+/* Relocation types as the RISC-V backend numbers them */
+#define R_32        1
+#define R_RELATIVE  3
+#define R_JUMP_SLOT 5
+
+static elf32_sym_t s_syms[NR_SYMS];
+static char s_strtab[NR_SYMS * 8];
+
+/* -------------------------------------------------------------------------- */
+/* Loader dependencies                                                        */
+/* -------------------------------------------------------------------------- */
+
+void *esp_elf_malloc(uint32_t n, bool exec)
+{
+    (void)exec;
+    return malloc(n);
+}
+
+void esp_elf_free(void *ptr)
+{
+    free(ptr);
+}
+
+/* Every name but "missing" resolves, to an address derived from it */
+uintptr_t elf_find_sym(const char *name)
+{
+    if (!strcmp(name, "missing")) {
+        return 0;
+    }
+    return 0x40000000u + strlen(name) * 16 + (unsigned char)name[1];
+}
+
+int esp_elf_tls_init(esp_elf_t *elf, const uint8_t *pbuf)
+{
+    (void)elf;
+    (void)pbuf;
+    return 0;
+}
+
+int esp_elf_tls_prepare(esp_elf_t *elf)
+{
+    (void)elf;
+    return 0;
+}
+
+void esp_elf_tls_deinit(esp_elf_t *elf)
+{
+    (void)elf;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Test                                                                       */
+/* -------------------------------------------------------------------------- */
+
+static void make_symbols(void)
+{
+    int off = 1;
+
+    for (int i = 1; i < NR_SYMS; i++) {
+        s_syms[i].name = off;
+        off += sprintf(s_strtab + off, i == NR_SYMS - 1 ? "missing" : "s%d", i) + 1;
+    }
+}
+
+/* @n entries over shuffled targets, or ascending ones as linkers sort
+ * them; every fourth word is hit twice so that the order of writes to
+ * one word matters */
+static elf32_rela_t *make_relas(uint32_t n, unsigned seed, bool sorted)
+{
+    elf32_rela_t *r = calloc(n, sizeof(*r));
+    uint32_t words = n - n / 4 + 1;
+    uint32_t *order = malloc(n * sizeof(*order));
+
+    srand(seed);
+    for (uint32_t i = 0; i < n; i++) {
+        order[i] = sorted ? (uint64_t)i * words / n : i % words;
+    }
+    for (uint32_t i = n - 1; i > 0 && !sorted; i--) {
+        uint32_t j = rand() % (i + 1), t = order[i];
+
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        static const int types[] = { R_32, R_RELATIVE, R_JUMP_SLOT };
+        int type = types[rand() % 3];
+        int sym = type == R_RELATIVE ? 0 : 1 + rand() % (NR_SYMS - 2);
+
+        r[i].offset = 0x1000 + order[i] * 4;
+        r[i].info   = ELF_R_INFO(sym, type);
+        r[i].addend = rand() % IMAGE_SIZE;
+    }
+    free(order);
+    return r;
+}
+
+/* Relocate into @image with the given threshold; returns the loader's result */
+static int run(uint8_t *image, const elf32_rela_t *r, uint32_t n, uint32_t min, uint64_t *ns)
+{
+    esp_elf_t elf = { .psegment = image, .svaddr = 0 };
+    uint64_t t0;
+    int ret;
+
+    memset(image, 0, IMAGE_SIZE);
+    host_reloc_min = min;
+    t0 = host_now_ns();
+    ret = esp_elf_relocate_rela(&elf, r, n, s_syms, NR_SYMS, s_strtab);
+    if (ns) {
+        *ns = host_now_ns() - t0;
+    }
+    return ret;
+}
+
+static void check_same(uint32_t n, unsigned seed, bool sorted)
+{
+    /* Relocated words hold absolute addresses, so both runs use one buffer */
+    uint8_t *image = malloc(IMAGE_SIZE);
+    uint8_t *serial = malloc(IMAGE_SIZE);
+    elf32_rela_t *r = make_relas(n, seed, sorted);
+    uint64_t t_serial, t_parallel;
+
+    int ret_serial = run(image, r, n, UINT32_MAX, &t_serial);
+    memcpy(serial, image, IMAGE_SIZE);
+    int ret_parallel = run(image, r, n, 0, &t_parallel);
+
+    CHECK(ret_serial == 0 && ret_parallel == 0, "n=%u: ret %d/%d", n, ret_serial, ret_parallel);
+    CHECK(!memcmp(serial, image, IMAGE_SIZE), "n=%u seed=%u%s: images differ",
+          n, seed, sorted ? " sorted" : "");
+    if (n >= 10000) {
+        printf("%6u %s entries: serial %.2f ms, parallel %.2f ms\n", n,
+               sorted ? "sorted  " : "shuffled", t_serial / 1e6, t_parallel / 1e6);
+    }
+
+    free(r);
+    free(serial);
+    free(image);
+}
+
+/* A bad entry in either half fails the whole call */
+static void check_errors(void)
+{
+    uint32_t n = 2000;
+    uint8_t *image = malloc(IMAGE_SIZE);
+    elf32_rela_t *r = make_relas(n, 3, false);
+
+    r[n - 1].info = ELF_R_INFO(1, 200);
+    CHECK(run(image, r, n, 0, NULL) == -EINVAL, "bad type in parallel run");
+    CHECK(run(image, r, n, UINT32_MAX, NULL) == -EINVAL, "bad type in serial run");
+
+    r[n - 1].info = ELF_R_INFO(NR_SYMS - 1, R_32);
+    CHECK(run(image, r, n, 0, NULL) == -ENOSYS, "missing symbol");
+
+    r[n - 1].info = ELF_R_INFO(NR_SYMS, R_32);
+    CHECK(run(image, r, n, 0, NULL) == -EINVAL, "symbol index out of range");
+
+    free(r);
+    free(image);
+}
+
+int main(void)
+{
+    static const uint32_t sizes[] = { 1, 2, 3, 17, 256, 4096, 50000 };
+
+    make_symbols();
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (unsigned seed = 1; seed <= 4; seed++) {
+            check_same(sizes[i], seed, false);
+            check_same(sizes[i], seed, true);
+        }
+    }
+    check_errors();
+
+    return host_result();
+}
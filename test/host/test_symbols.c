@@ -0,0 +1,81 @@
+/* -------------------------------------------------------------
+ * test_symbols.c
+ *
+ * Every libgcc helper and libm function the loader exports must
+ * resolve through elf_find_sym() to a non-NULL address, and so
+ * must the float kernels launchpad_fmath_init() registers and
+ * the helpers GCC emits for soft double and 64-bit code on RV32.
+ * The symbol module is built into the test to reach its tables.
+ * ------------------------------------------------------------- */
+
+/* The module's (...) parameter list needs C23; the helper is unused,
+ * so give it a prototype the host compiler accepts */
+#define elf_register_new_named_symbol(...) \
+    host_register_named_symbol(const char *name, void (*sym)(void))
+
+#include "elf/esp_elf_symbol.c"
+
+#include "host_stubs.h"
+#include "host_test.h"
+#include "include/fmath.h"
+
+/* What an RV32IMAFC app calls for double, 64-bit integer and complex
+ * arithmetic, taken from a build of such code, not from the tables */
+static const char *const s_emitted[] = {
+    "__adddf3", "__subdf3", "__muldf3", "__divdf3", "__negdf2",
+    "__eqdf2", "__nedf2", "__gedf2", "__gtdf2", "__ledf2", "__ltdf2", "__unorddf2",
+    "__fixdfsi", "__fixunsdfsi", "__fixdfdi", "__fixunsdfdi",
+    "__floatsidf", "__floatunsidf", "__floatdidf", "__floatundidf",
+    "__extendsfdf2", "__truncdfsf2",
+    "__fixsfdi", "__fixunssfdi", "__floatdisf", "__floatundisf",
+    "__divdi3", "__moddi3", "__udivdi3", "__umoddi3",
+    "__ashldi3", "__ashrdi3", "__lshrdi3",
+    "__clzsi2", "__ctzsi2", "__popcountsi2", "__bswapsi2", "__bswapdi2",
+    "__powidf2", "__powisf2",
+    "__mulsc3", "__divsc3", "__muldc3", "__divdc3",
+};
+
+/* Registered at run time by launchpad_fmath_init(), kernels or newlib */
+static const char *const s_fmath[] = {
+    "sinf", "cosf", "expf", "exp2f", "logf", "log2f", "log10f", "atanf", "atan2f",
+};
+
+static int check_table(const char *what, const struct esp_elfsym *syms)
+{
+    int n = 0;
+
+    for (; syms->name; syms++, n++) {
+        uintptr_t addr = elf_find_sym(syms->name);
+
+        CHECK(addr != 0, "%s: %s does not resolve", what, syms->name);
+        CHECK(addr == (uintptr_t)syms->sym, "%s: %s resolves to %#lx, the table has %p", what,
+              syms->name, (unsigned long)addr, syms->sym);
+    }
+    return n;
+}
+
+static void check_names(const char *what, const char *const *names, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        CHECK(elf_find_sym(names[i]) != 0, "%s: %s does not resolve", what, names[i]);
+    }
+}
+
+int main(void)
+{
+    int libgcc = check_table("libgcc", g_esp_libgcc_elfsyms);
+    int libm = check_table("libm", g_esp_libm_elfsyms);
+
+    check_names("emitted", s_emitted, sizeof(s_emitted) / sizeof(s_emitted[0]));
+
+    for (int fpu = 0; fpu < 2; fpu++) {
+        g_host_platform.hardware = fpu ? LAUNCHPAD_HW_RISCV_F : 0;
+        launchpad_fmath_init();
+        check_names(fpu ? "fmath kernels" : "fmath newlib", s_fmath, sizeof(s_fmath) / sizeof(s_fmath[0]));
+    }
+
+    CHECK(elf_find_sym("no_such_symbol") == 0, "an unknown name resolves");
+
+    printf("%d libgcc and %d libm exports resolve\n", libgcc, libm);
+    return host_result();
+}
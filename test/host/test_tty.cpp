@@ -0,0 +1,131 @@
+/* -------------------------------------------------------------
+ * test_tty.cpp
+ *
+ * The C++ TTY layer: TTY<> and TTY<Driver> forward whole spans,
+ * a driver without a bulk write falls back to write_char, and
+ * the stdio redirection hands the UART one call per span.
+ * ------------------------------------------------------------- */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "host_test.h"
+#include "host_stubs.h"
+#include "vtty/global_tty.hpp"
+
+extern "C" {
+int tty_puts(const char *str);
+int tty_putchar(int c);
+int tty_fputs(const char *str, FILE *stream);
+int tty_printf(const char *fmt, ...);
+size_t tty_fwrite(const void *ptr, size_t size, size_t nmemb, FILE *stream);
+}
+
+namespace {
+
+struct Recorder {
+    std::string out;
+    long calls = 0;
+    long char_calls = 0;
+};
+
+// Bulk-capable driver
+struct BulkMock final : TTYDriver {
+    Recorder rec;
+    int inits = 0;
+
+    void init() override { inits++; }
+    void write(const char *s) override { write(s, strlen(s)); }
+    void write(const char *b, size_t n) override { rec.calls++; rec.out.append(b, n); }
+    void write_char(char c) override { rec.calls++; rec.char_calls++; rec.out += c; }
+    char read() override { return 'r'; }
+};
+
+// Only the required overrides: bulk writes use the base loop
+struct CharMock : TTYDriver {
+    Recorder rec;
+
+    void init() override {}
+    void write(const char *s) override { while (*s) write_char(*s++); }
+    using TTYDriver::write;
+    void write_char(char c) override { rec.calls++; rec.char_calls++; rec.out += c; }
+    char read() override { return 0; }
+};
+
+void test_forwarding()
+{
+    BulkMock m;
+    TTY<> dyn(&m);
+    TTY<BulkMock> fixed(&m);
+
+    CHECK(m.inits == 2, "init called %d times", m.inits);
+
+    dyn.write("hello, ");
+    fixed.write("world", 5);
+    dyn.write_char('!');
+    CHECK(m.rec.out == "hello, world!", "got '%s'", m.rec.out.c_str());
+    CHECK(m.rec.calls == 3 && m.rec.char_calls == 1, "%ld calls", m.rec.calls);
+    CHECK(fixed.read() == 'r', "read");
+}
+
+void test_fallback()
+{
+    CharMock m;
+    TTY<> tty(&m);
+
+    tty.write("abc", 3);
+    tty.write("de");
+    CHECK(m.rec.out == "abcde", "got '%s'", m.rec.out.c_str());
+    CHECK(m.rec.calls == 5 && m.rec.char_calls == 5, "%ld calls", m.rec.calls);
+}
+
+std::string uart_take()
+{
+    std::string s(g_host_uart.out, g_host_uart.len);
+
+    g_host_uart.len = 0;
+    g_host_uart.calls = 0;
+    return s;
+}
+
+void test_stdio_redirect()
+{
+    UARTTTYDriver uart(1, 38, 48, 115200);
+    GlobalTTY tty(&uart);
+    char line[81];
+
+    CHECK(g_host_uart.baud == 115200, "baud %d", g_host_uart.baud);
+    global_tty = &tty;
+
+    memset(line, 'x', 80);
+    line[80] = '\0';
+    uart_take();
+    tty_fwrite(line, 1, 80, stdout);
+    CHECK(g_host_uart.calls == 1, "fwrite of 80 bytes: %ld calls", g_host_uart.calls);
+    CHECK(uart_take() == line, "fwrite content");
+
+    tty_puts("ready");
+    CHECK(g_host_uart.calls == 2, "puts: %ld calls", g_host_uart.calls);
+    CHECK(uart_take() == "ready\r\n", "puts content");
+
+    tty_printf("%s=%d, %5.2f|%-4x|", "n", -42, 3.14159, 0xab);
+    CHECK(uart_take() == "n=-42,  3.14|ab  |", "printf content");
+
+    tty_fputs("abc", stdout);
+    tty_putchar('d');
+    CHECK(uart_take() == "abcd", "fputs/putchar content");
+
+    global_tty = nullptr;
+    CHECK(tty_printf("%d", 12345) == 5, "printf without a tty still counts");
+}
+
+} // namespace
+
+int main()
+{
+    test_forwarding();
+    test_fallback();
+    test_stdio_redirect();
+    return host_result();
+}
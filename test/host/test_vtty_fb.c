@@ -0,0 +1,380 @@
+/* -------------------------------------------------------------
+ * test_vtty_fb.c
+ *
+ * The framebuffer console against a golden image and a model.
+ *
+ * The glyph sheet it renders must match golden/fb_font.txt; run
+ * with --write-golden to regenerate that file after a deliberate
+ * font change. The glyphs read from the file then drive a
+ * character-grid model of the console, and 5000 random writes of
+ * text and escapes must leave the panel pixel-for-pixel equal to
+ * the model, with and without hardware scroll, at scales 1 and 2.
+ * ------------------------------------------------------------- */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "launchpad_vtty_fb.h"
+
+#define GOLDEN_FONT HOST_GOLDEN_DIR "/fb_font.txt"
+
+#define GLYPHS      96          /* 0x20-0x7E, then the box */
+#define SHEET_COLS  16
+#define SHEET_ROWS  (GLYPHS / SHEET_COLS)
+
+#define FG 0xFFFF
+#define BG 0x0000
+
+#define PANEL_W 800
+#define PANEL_H 480
+
+static const struct vtty_driver *s_drv;
+static uint16_t s_panel[PANEL_H][PANEL_W];
+static int s_panel_w, s_panel_h, s_hw_top;
+static uint8_t s_font[GLYPHS][8];
+
+int launchpad_vtty_register_driver(const struct vtty_driver *drv)
+{
+    s_drv = drv;
+    if (drv->init) {
+        drv->init();
+    }
+    return 0;
+}
+
+static void panel_flush(void *ctx, int x, int y, int w, int h, const uint16_t *px, int stride)
+{
+    (void)ctx;
+    if (x < 0 || y < 0 || w < 0 || h < 0 || x + w > s_panel_w || y + h > s_panel_h) {
+        CHECK(0, "flush outside the panel: %d,%d %dx%d", x, y, w, h);
+        return;
+    }
+    for (int j = 0; j < h; j++) {
+        memcpy(&s_panel[y + j][x], px + (size_t)j * stride, w * sizeof(uint16_t));
+    }
+}
+
+static void panel_scroll(void *ctx, int line)
+{
+    (void)ctx;
+    s_hw_top = line;
+}
+
+static int fb_open(int width, int height, int scale, bool hw_scroll)
+{
+    struct launchpad_vtty_fb_config cfg = {
+        .width = width,
+        .height = height,
+        .scale = scale,
+        .fg = FG,
+        .bg = BG,
+        .flush = panel_flush,
+        .scroll = hw_scroll ? panel_scroll : NULL,
+    };
+
+    if (s_drv) {
+        s_drv->deinit();
+        s_drv = NULL;
+    }
+    s_panel_w = width;
+    s_panel_h = height;
+    s_hw_top = 0;
+    memset(s_panel, 0x55, sizeof(s_panel));
+    return launchpad_vtty_register_fb(&cfg);
+}
+
+static void fb_write(const char *s)
+{
+    s_drv->write(s, strlen(s));
+}
+
+/* -------------------------------------------------------------------------- */
+/* Golden glyph sheet                                                         */
+/* -------------------------------------------------------------------------- */
+
+static void render_sheet(void)
+{
+    char all[GLYPHS + 2];
+    int n = 0;
+
+    for (int c = 0x20; c < 0x7F; c++) {
+        all[n++] = (char)c;
+    }
+    /* Anything else draws the box; a UTF-8 sequence draws one */
+    all[n++] = (char)0xC3;
+    all[n++] = (char)0xA9;
+    all[n] = '\0';
+
+    CHECK(fb_open(SHEET_COLS * 8, SHEET_ROWS * 8, 1, false) == 0, "register");
+    fb_write(all);
+}
+
+static int write_golden(void)
+{
+    FILE *f = fopen(GOLDEN_FONT, "w");
+
+    if (!f) {
+        perror(GOLDEN_FONT);
+        return 1;
+    }
+    render_sheet();
+    for (int y = 0; y < SHEET_ROWS * 8; y++) {
+        for (int x = 0; x < SHEET_COLS * 8; x++) {
+            fputc(s_panel[y][x] == FG ? '#' : '.', f);
+        }
+        fputc('\n', f);
+    }
+    fclose(f);
+    printf("wrote %s\n", GOLDEN_FONT);
+    return 0;
+}
+
+/* Compare the rendered sheet with the file and load the glyphs from it */
+static bool check_golden(void)
+{
+    FILE *f = fopen(GOLDEN_FONT, "r");
+    char line[SHEET_COLS * 8 + 2];
+    int bad = 0;
+
+    CHECK(f != NULL, "cannot open %s", GOLDEN_FONT);
+    if (!f) {
+        return false;
+    }
+    render_sheet();
+    for (int y = 0; y < SHEET_ROWS * 8; y++) {
+        if (!fgets(line, sizeof(line), f) || strlen(line) < SHEET_COLS * 8) {
+            CHECK(0, "%s: line %d is short", GOLDEN_FONT, y + 1);
+            fclose(f);
+            return false;
+        }
+        for (int x = 0; x < SHEET_COLS * 8; x++) {
+            bool on = line[x] == '#';
+            int g = (y / 8) * SHEET_COLS + x / 8;
+
+            if (on) {
+                s_font[g][y % 8] |= 1u << (x % 8);
+            }
+            if (on != (s_panel[y][x] == FG)) {
+                if (!bad++) {
+                    CHECK(0, "glyph %d (0x%02x) differs from the golden image at %d,%d",
+                          g, 0x20 + g, x % 8, y % 8);
+                }
+            }
+        }
+    }
+    fclose(f);
+    return !bad;
+}
+
+/* -------------------------------------------------------------------------- */
+/* Character-grid model                                                       */
+/* -------------------------------------------------------------------------- */
+
+typedef struct {
+    uint8_t glyph;
+    bool reverse;
+    bool underline;
+} mcell_t;
+
+static struct {
+    mcell_t cell[64][128];
+    int rows, cols;
+    int row, col;
+    bool wrap;
+    bool reverse, underline;
+} s_model;
+
+static void model_erase(int row, int c0, int c1)
+{
+    for (int c = c0; c < c1; c++) {
+        /* Erase uses the background of the rendition, never underlined */
+        s_model.cell[row][c] = (mcell_t){ 0, s_model.reverse, false };
+    }
+}
+
+static void model_reset(int rows, int cols)
+{
+    memset(&s_model, 0, sizeof(s_model));
+    s_model.rows = rows;
+    s_model.cols = cols;
+}
+
+static void model_newline(void)
+{
+    s_model.wrap = false;
+    if (s_model.row < s_model.rows - 1) {
+        s_model.row++;
+        return;
+    }
+    memmove(s_model.cell[0], s_model.cell[1], sizeof(s_model.cell[0]) * (s_model.rows - 1));
+    model_erase(s_model.rows - 1, 0, s_model.cols);
+}
+
+static void model_put(int glyph)
+{
+    if (s_model.wrap) {
+        s_model.col = 0;
+        model_newline();
+    }
+    s_model.cell[s_model.row][s_model.col] = (mcell_t){ glyph, s_model.reverse, s_model.underline };
+    if (s_model.col == s_model.cols - 1) {
+        s_model.wrap = true;
+    } else {
+        s_model.col++;
+    }
+}
+
+static int clampi(int v, int lo, int hi)
+{
+    return v < lo ? lo : v > hi ? hi : v;
+}
+
+/* Only the sequences the random writer below produces */
+static const char *model_csi(const char *s)
+{
+    int p[2] = { 0, 0 }, n = 0;
+
+    for (; (*s >= '0' && *s <= '9') || *s == ';'; s++) {
+        if (*s == ';') {
+            n++;
+        } else if (n < 2) {
+            p[n] = p[n] * 10 + (*s - '0');
+        }
+    }
+
+    switch (*s) {
+    case 'H':
+        s_model.row = clampi((p[0] ? p[0] : 1) - 1, 0, s_model.rows - 1);
+        s_model.col = clampi((p[1] ? p[1] : 1) - 1, 0, s_model.cols - 1);
+        s_model.wrap = false;
+        break;
+    case 'J':
+        for (int r = 0; r < s_model.rows; r++) {
+            model_erase(r, 0, s_model.cols);
+        }
+        break;
+    case 'K':
+        model_erase(s_model.row, s_model.col, s_model.cols);
+        break;
+    case 'm':
+        if (p[0] == 0) {
+            s_model.reverse = s_model.underline = false;
+        } else if (p[0] == 4) {
+            s_model.underline = true;
+        } else if (p[0] == 7) {
+            s_model.reverse = true;
+        } else if (p[0] == 24) {
+            s_model.underline = false;
+        } else if (p[0] == 27) {
+            s_model.reverse = false;
+        }
+        break;
+    }
+    return s;
+}
+
+static void model_write(const char *s)
+{
+    for (; *s; s++) {
+        unsigned char c = *s;
+
+        if (c == 0x1B && s[1] == '[') {
+            s = model_csi(s + 2);
+        } else if (c == '\n') {
+            s_model.col = 0;
+            model_newline();
+        } else if (c == '\r') {
+            s_model.col = 0;
+            s_model.wrap = false;
+        } else if (c >= 0x20 && c < 0x7F) {
+            model_put(c - 0x20);
+        } else if (c >= 0xC0) {
+            model_put(GLYPHS - 1);
+        }
+    }
+}
+
+/* Pixels differing between the panel and the model */
+static int model_check(int scale, bool hw_scroll)
+{
+    int cw = 8 * scale, lines = s_model.rows * cw;
+    int bad = 0;
+
+    for (int r = 0; r < s_model.rows; r++) {
+        for (int c = 0; c < s_model.cols; c++) {
+            mcell_t m = s_model.cell[r][c];
+            uint16_t fg = m.reverse ? BG : FG, bg = m.reverse ? FG : BG;
+
+            for (int y = 0; y < cw; y++) {
+                unsigned bits = m.underline && y / scale == 7 ? 0xFF : s_font[m.glyph][y / scale];
+                int py = r * cw + y;
+
+                if (hw_scroll) {
+                    py = (py + s_hw_top) % lines;
+                }
+                for (int x = 0; x < cw; x++) {
+                    uint16_t want = (bits >> (x / scale)) & 1 ? fg : bg;
+
+                    bad += s_panel[py][c * cw + x] != want;
+                }
+            }
+        }
+    }
+    return bad;
+}
+
+static void check_random(int scale, bool hw_scroll)
+{
+    static const char *words[] = {
+        "hello", "World!", "\n", "\r", "  ", "0123456789", "~{}|",
+        "abcdefghijklmnopqrstuvwxyz", "\x1b[2J", "\x1b[H", "\x1b[3;5H", "\x1b[K",
+        "\n\n\n", "\x1b[7m", "\x1b[27m", "\x1b[4m", "\x1b[24m", "\x1b[0m", "caf\xc3\xa9",
+    };
+    const int nwords = sizeof(words) / sizeof(words[0]);
+    /* Odd sizes leave partial cells at the right and bottom edges */
+    int width = 80 * 4 + 5, height = 48 * 2 + 3;
+
+    CHECK(fb_open(width, height, scale, hw_scroll) == 0, "register");
+    model_reset(height / (8 * scale), width / (8 * scale));
+    srand(scale * 2 + hw_scroll);
+
+    for (int it = 0; it < 5000; it++) {
+        char buf[256] = "";
+        int k = 1 + rand() % 6;
+
+        for (int i = 0; i < k; i++) {
+            strcat(buf, words[rand() % nwords]);
+        }
+        fb_write(buf);
+        model_write(buf);
+
+        int bad = model_check(scale, hw_scroll);
+        if (bad) {
+            CHECK(0, "scale %d %s scroll: write %d ('%s') leaves %d pixels wrong", scale,
+                  hw_scroll ? "hw" : "sw", it, buf, bad);
+            return;
+        }
+    }
+
+    struct launchpad_vtty_fb_stats st;
+    launchpad_vtty_fb_get_stats(&st);
+    printf("scale %d %s scroll: %u chars, %u frames, %u rects, %u scrolls, %u glyph misses\n",
+           scale, hw_scroll ? "hw" : "sw", st.chars, st.frames, st.rects, st.scrolls, st.glyph_misses);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && !strcmp(argv[1], "--write-golden")) {
+        return write_golden();
+    }
+
+    if (check_golden()) {
+        for (int scale = 1; scale <= 2; scale++) {
+            check_random(scale, false);
+            check_random(scale, true);
+        }
+    }
+    return host_result();
+}
@@ -0,0 +1,149 @@
+/* -------------------------------------------------------------
+ * test_vtty_fmt.c
+ *
+ * Floating-point conversions of launchpad_vtty_vformat() against
+ * the host's vsnprintf. Short results must match exactly, at any
+ * field width. Wide ones are streamed without allocating: exact
+ * while the value has no more significant digits than the
+ * formatter keeps, else the same length and leading digits
+ * ("%g" may then drop fewer trailing zeros, so only "%#g").
+ * ------------------------------------------------------------- */
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Count what the formatter allocates */
+static int s_allocs;
+#define malloc(n)     (s_allocs++, malloc(n))
+#define realloc(p, n) (s_allocs++, realloc(p, n))
+#include "launchpad_vtty_fmt.c"
+#undef malloc
+#undef realloc
+
+#include "host_test.h"
+
+#define OUT_MAX 4096
+
+struct capture {
+    char buf[OUT_MAX];
+    size_t len;
+    int calls;
+};
+
+static int capture(void *ctx, const char *buf, size_t len)
+{
+    struct capture *c = ctx;
+
+    if (c->len + len >= sizeof(c->buf))
+        return -1;
+    memcpy(c->buf + c->len, buf, len);
+    c->len += len;
+    c->buf[c->len] = '\0';
+    c->calls++;
+    return 0;
+}
+
+/* Format with both; returns how many leading bytes agree, -1 if all do */
+static int __attribute__((format(printf, 2, 3))) compare(struct capture *c, const char *fmt, ...)
+{
+    static char want[OUT_MAX];
+    va_list ap;
+    int n, got;
+
+    memset(c, 0, sizeof(*c));
+    va_start(ap, fmt);
+    n = vsnprintf(want, sizeof(want), fmt, ap);
+    va_end(ap);
+    va_start(ap, fmt);
+    got = launchpad_vtty_vformat(capture, c, fmt, ap);
+    va_end(ap);
+
+    CHECK(got == (int)c->len, "%s: returned %d for %zu bytes", fmt, got, c->len);
+    CHECK(got == n, "%s: %d bytes, want %d\n  got  \"%s\"\n  want \"%s\"", fmt, got, n, c->buf, want);
+
+    for (int i = 0; i < n; i++) {
+        if (c->buf[i] != want[i])
+            return i;
+    }
+    return -1;
+}
+
+#define CHECK_EXACT(...)                                                \
+    do {                                                                \
+        struct capture c_;                                              \
+        int at_ = compare(&c_, __VA_ARGS__);                            \
+        CHECK(at_ < 0, "%s: differs at %d\n  got  \"%s\"",              \
+              #__VA_ARGS__, at_, c_.buf);                               \
+    } while (0)
+
+/* Wide result of a value with more digits than the formatter keeps:
+ * the bytes before its last, rounded, significant digit must agree */
+#define CHECK_LEADING(digits, ...)                                      \
+    do {                                                                \
+        struct capture c_;                                              \
+        int at_ = compare(&c_, __VA_ARGS__);                            \
+        CHECK(at_ < 0 || at_ >= (digits), "%s: differs at %d\n  got  \"%s\"", \
+              #__VA_ARGS__, at_, c_.buf);                               \
+    } while (0)
+
+static void check_short(void)
+{
+    static const double values[] = { 0.0, -0.0, 1.0, -2.5, 3.14159, 1e-5, 123456.789, 1e20, -1e-300 };
+    static const char *const fmts[] = {
+        "%f", "%.0f", "%#.0f", "%+.3f", "% e", "%.2E", "%g", "%#g", "%.3G", "%a", "%.2A",
+        "%12.4f", "%-12.4e|", "%012.3f", "%+012g", "%-+012.1f|", "% 015a",
+        "%80.3f", "%-80e|", "%080.2f", "%+0100a", "%0100.10g",
+    };
+
+    for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+        for (size_t f = 0; f < sizeof(fmts) / sizeof(fmts[0]); f++)
+            CHECK_EXACT(fmts[f], values[v]);
+    }
+
+    /* No zero padding inside "inf" and "nan" */
+    CHECK_EXACT("%010f|%-10F|%+010e", 1.0 / 0.0, -1.0 / 0.0, 0.0 / 0.0);
+    CHECK_EXACT("%070f|%-70F|", 1.0 / 0.0, -1.0 / 0.0);
+    CHECK_EXACT("%12.3Lf|%-12Le|%012La", 2.5L, -1e10L, 0.75L);
+}
+
+static void check_wide(void)
+{
+    /* Dyadic values with short exact expansions */
+    const double tiny = 1.0 / (1 << 30);
+
+    CHECK_EXACT("%.70f", 0.375);
+    CHECK_EXACT("%.80f|%.80e|%.80E", tiny, tiny, -tiny);
+    CHECK_EXACT("%.80g|%#.80g|%.80G", tiny, tiny, 1e20);
+    CHECK_EXACT("%.60f", 1e20);
+    CHECK_EXACT("%#.70e|%+.70e|% .70e", 0.0, -0.0, 1.0);
+    CHECK_EXACT("%100.70f|%-100.70e|%0100.70f|%+0100.70e", 0.5, 0.5, -0.5, 0.5);
+    CHECK_EXACT("%.100a|%-+120.100A|%0120.100a", 1.0 / 3, -1e300, 0.1);
+    CHECK_EXACT("%.100La|%.70Lf", 1.0L / 3, 1.5L);
+
+    /* Rounded at a digit the formatter knows */
+    CHECK_EXACT("%.70f|%.70f", 1.234567e-60, -9.99999999999e-61);
+    CHECK_EXACT("%.70f|%.70f", 6e-71, 4e-71);
+    CHECK_EXACT("%.120f", 1e-110);
+
+    /* Exact expansion longer than the digits kept */
+    CHECK_LEADING(FLOAT_DIGITS - 1, "%f", 1e200);
+    CHECK_LEADING(FLOAT_DIGITS, "%.2f", -1.7976931348623157e308);
+    CHECK_LEADING(FLOAT_DIGITS + 1, "%.100f", 0.1);
+    CHECK_LEADING(FLOAT_DIGITS + 1, "%+.100e", 1e-5);
+    CHECK_LEADING(FLOAT_DIGITS, "%#.100g", 1e-5);
+    CHECK_LEADING(FLOAT_DIGITS - 1, "%Lf", 1e300L);
+
+    /* Far past any buffer, in bounded pieces */
+    struct capture c;
+    CHECK(compare(&c, "%.3000f", 1.0) < 0, "%%.3000f differs");
+    CHECK(c.calls < 3000 / 8, "%%.3000f took %d emit calls", c.calls);
+}
+
+int main(void)
+{
+    check_short();
+    check_wide();
+    CHECK(s_allocs == 0, "%d allocations", s_allocs);
+    return host_result();
+}
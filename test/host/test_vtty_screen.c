@@ -0,0 +1,433 @@
+/* -------------------------------------------------------------
+ * test_vtty_screen.c
+ *
+ * Feeds what launchpad_vtty_screen_present() sends into a small
+ * VT100 model (deferred wrap, CUP/CUU/CUD/CUF/CUB, EL, ECH, ED 2,
+ * SGR) and compares the modelled terminal with the frame the test
+ * drew, cell by cell, after every present. Prints the bytes each
+ * workload costs per frame next to a naive full repaint.
+ * ------------------------------------------------------------- */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "launchpad_vtty_screen.h"
+
+#define ROWS 24
+#define COLS 80
+
+/* Full repaint: every cell plus a cursor move per row */
+#define NAIVE_BYTES (ROWS * COLS + ROWS * 8)
+
+#define DEF LAUNCHPAD_VTTY_COLOR_DEFAULT
+#define VISIBLE_ON_BLANK (LAUNCHPAD_VTTY_ATTR_UNDERLINE | LAUNCHPAD_VTTY_ATTR_REVERSE)
+
+typedef struct {
+    char ch;
+    uint8_t attr, fg, bg;
+} cell_t;
+
+/* -------------------------------------------------------------------------- */
+/* Terminal model                                                             */
+/* -------------------------------------------------------------------------- */
+
+static struct {
+    cell_t cell[ROWS][COLS];
+    cell_t pen;
+    int row, col;
+    bool wrap;                  /* at the last column, next character wraps */
+    int state;                  /* 0 text, 1 after ESC, 2 in CSI */
+    char arg[64];
+    int arg_len;
+    long bytes;
+    bool broken;
+} s_term = { .pen = { ' ', 0, DEF, DEF } };
+
+static void term_fail(const char *what, int c)
+{
+    if (!s_term.broken) {
+        CHECK(0, "terminal model: %s (%d)", what, c);
+    }
+    s_term.broken = true;
+}
+
+static void term_sgr(const int *p, int n)
+{
+    cell_t *pen = &s_term.pen;
+
+    if (!n) {
+        pen->attr = 0;
+        pen->fg = pen->bg = DEF;
+    }
+    for (int i = 0; i < n; i++) {
+        int v = p[i];
+
+        if (v == 0) {
+            pen->attr = 0;
+            pen->fg = pen->bg = DEF;
+        } else if (v == 1) {
+            pen->attr |= LAUNCHPAD_VTTY_ATTR_BOLD;
+        } else if (v == 4) {
+            pen->attr |= LAUNCHPAD_VTTY_ATTR_UNDERLINE;
+        } else if (v == 7) {
+            pen->attr |= LAUNCHPAD_VTTY_ATTR_REVERSE;
+        } else if (v >= 30 && v <= 37) {
+            pen->fg = v - 30;
+        } else if (v == 39) {
+            pen->fg = DEF;
+        } else if (v >= 40 && v <= 47) {
+            pen->bg = v - 40;
+        } else if (v == 49) {
+            pen->bg = DEF;
+        } else if (v >= 90 && v <= 97) {
+            pen->fg = v - 90 + 8;
+        } else if (v >= 100 && v <= 107) {
+            pen->bg = v - 100 + 8;
+        } else {
+            term_fail("unknown SGR", v);
+        }
+    }
+}
+
+static void term_erase(int row, int from, int to)
+{
+    for (int c = from; c < to && c < COLS; c++) {
+        s_term.cell[row][c] = (cell_t){ ' ', 0, DEF, s_term.pen.bg };
+    }
+}
+
+static void term_csi(char final)
+{
+    int p[16], n = 0;
+
+    if (s_term.arg_len) {
+        for (char *s = s_term.arg; n < 16; s++) {
+            p[n++] = atoi(s);
+            s = strchr(s, ';');
+            if (!s) {
+                break;
+            }
+        }
+    }
+
+    int a = n > 0 && p[0] ? p[0] : 1;
+
+    s_term.wrap = false;
+    switch (final) {
+    case 'H':
+        s_term.row = (n > 0 && p[0] ? p[0] : 1) - 1;
+        s_term.col = (n > 1 && p[1] ? p[1] : 1) - 1;
+        break;
+    case 'A':
+        s_term.row = s_term.row - a < 0 ? 0 : s_term.row - a;
+        break;
+    case 'B':
+        s_term.row = s_term.row + a > ROWS - 1 ? ROWS - 1 : s_term.row + a;
+        break;
+    case 'C':
+        s_term.col = s_term.col + a > COLS - 1 ? COLS - 1 : s_term.col + a;
+        break;
+    case 'D':
+        s_term.col = s_term.col - a < 0 ? 0 : s_term.col - a;
+        break;
+    case 'K':
+        term_erase(s_term.row, s_term.col, COLS);
+        break;
+    case 'X':
+        term_erase(s_term.row, s_term.col, s_term.col + a);
+        break;
+    case 'J':
+        if (n < 1 || p[0] != 2) {
+            term_fail("only ED 2 is modelled", n ? p[0] : 0);
+        }
+        for (int r = 0; r < ROWS; r++) {
+            term_erase(r, 0, COLS);
+        }
+        break;
+    case 'm':
+        term_sgr(p, n);
+        break;
+    default:
+        term_fail("unknown CSI final", final);
+    }
+}
+
+static void term_feed(char ch)
+{
+    switch (s_term.state) {
+    case 0:
+        if (ch == '\x1b') {
+            s_term.state = 1;
+        } else if (ch == '\r') {
+            s_term.col = 0;
+            s_term.wrap = false;
+        } else if (ch == '\n') {
+            if (s_term.row == ROWS - 1) {
+                term_fail("line feed would scroll", ch);
+            } else {
+                s_term.row++;
+            }
+            s_term.wrap = false;
+        } else if (ch == '\b') {
+            if (s_term.col > 0) {
+                s_term.col--;
+            }
+            s_term.wrap = false;
+        } else {
+            if (s_term.wrap) {
+                if (s_term.row == ROWS - 1) {
+                    term_fail("wrap would scroll", ch);
+                    return;
+                }
+                s_term.col = 0;
+                s_term.row++;
+                s_term.wrap = false;
+            }
+            s_term.cell[s_term.row][s_term.col] = s_term.pen;
+            s_term.cell[s_term.row][s_term.col].ch = ch;
+            if (s_term.col == COLS - 1) {
+                s_term.wrap = true;
+            } else {
+                s_term.col++;
+            }
+        }
+        break;
+    case 1:
+        if (ch != '[') {
+            term_fail("ESC not followed by [", ch);
+        }
+        s_term.state = 2;
+        s_term.arg_len = 0;
+        break;
+    default:
+        if ((ch >= '0' && ch <= '9') || ch == ';') {
+            if (s_term.arg_len < (int)sizeof(s_term.arg) - 1) {
+                s_term.arg[s_term.arg_len++] = ch;
+            }
+            break;
+        }
+        s_term.arg[s_term.arg_len] = '\0';
+        s_term.state = 0;
+        term_csi(ch);
+    }
+}
+
+static int term_emit(void *ctx, const char *buf, size_t len)
+{
+    (void)ctx;
+    s_term.bytes += len;
+    for (size_t i = 0; i < len; i++) {
+        term_feed(buf[i]);
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* What the test drew, mirrored next to the screen calls                      */
+/* -------------------------------------------------------------------------- */
+
+static launchpad_vtty_screen_t *s_scr;
+static cell_t s_want[ROWS][COLS];
+static cell_t s_style = { ' ', 0, DEF, DEF };
+static int s_cursor_row = -1, s_cursor_col;
+
+static void draw_style(uint8_t attr, uint8_t fg, uint8_t bg)
+{
+    launchpad_vtty_screen_set_style(s_scr, attr, fg, bg);
+    s_style = (cell_t){ ' ', attr, fg, bg };
+}
+
+static void draw_text(int row, int col, const char *t)
+{
+    launchpad_vtty_screen_puts(s_scr, row, col, t);
+    for (; *t && col < COLS; t++, col++) {
+        s_want[row][col] = s_style;
+        s_want[row][col].ch = *t;
+    }
+}
+
+static void draw_clear(void)
+{
+    launchpad_vtty_screen_clear(s_scr);
+    for (int r = 0; r < ROWS; r++) {
+        for (int c = 0; c < COLS; c++) {
+            s_want[r][c] = (cell_t){ ' ', 0, DEF, s_style.bg };
+        }
+    }
+}
+
+static void draw_cursor(int row, int col)
+{
+    launchpad_vtty_screen_set_cursor(s_scr, row, col);
+    s_cursor_row = row;
+    s_cursor_col = col;
+}
+
+/* A blank cell shows only its background, underline and reverse */
+static bool cells_match(cell_t got, cell_t want)
+{
+    if (got.ch != want.ch || got.bg != want.bg) {
+        return false;
+    }
+    if (want.ch == ' ' && !(want.attr & VISIBLE_ON_BLANK)) {
+        return !(got.attr & VISIBLE_ON_BLANK);
+    }
+    return got.attr == want.attr && got.fg == want.fg;
+}
+
+static long present(const char *workload)
+{
+    long before = s_term.bytes;
+
+    CHECK(launchpad_vtty_screen_present_to(s_scr, term_emit, NULL) >= 0, "present");
+    for (int r = 0; r < ROWS; r++) {
+        for (int c = 0; c < COLS; c++) {
+            cell_t g = s_term.cell[r][c], w = s_want[r][c];
+
+            if (!cells_match(g, w)) {
+                CHECK(0, "%s: cell %d,%d is '%c' %d/%d/%d, want '%c' %d/%d/%d", workload, r, c,
+                      g.ch, g.attr, g.fg, g.bg, w.ch, w.attr, w.fg, w.bg);
+                exit(host_result());
+            }
+        }
+    }
+    if (s_cursor_row >= 0) {
+        CHECK(s_term.row == s_cursor_row && s_term.col == s_cursor_col && !s_term.wrap,
+              "%s: cursor at %d,%d, want %d,%d", workload, s_term.row, s_term.col,
+              s_cursor_row, s_cursor_col);
+    }
+    return s_term.bytes - before;
+}
+
+static void report(const char *workload, long bytes, int frames)
+{
+    double per_frame = (double)bytes / frames;
+
+    printf("%-18s %7.1f bytes/frame (naive repaint %d)\n", workload, per_frame, NAIVE_BYTES);
+    CHECK(per_frame < NAIVE_BYTES, "%s costs more than a repaint", workload);
+}
+
+/* -------------------------------------------------------------------------- */
+/* Workloads                                                                  */
+/* -------------------------------------------------------------------------- */
+
+/* Static labels; a third of the values change per frame */
+static void workload_dashboard(void)
+{
+    long sum = 0;
+
+    draw_style(LAUNCHPAD_VTTY_ATTR_BOLD, 7, 4);
+    for (int c = 0; c < COLS; c++) {
+        draw_text(0, c, " ");
+    }
+    draw_text(0, 2, "LaunchPad monitor");
+    draw_style(0, DEF, DEF);
+    for (int r = 2; r < 20; r++) {
+        char label[32];
+
+        snprintf(label, sizeof(label), "sensor %02d: ", r);
+        draw_text(r, 2, label);
+    }
+    printf("%-18s %7ld bytes\n", "dashboard setup", present("dashboard"));
+
+    for (int i = 0; i < 100; i++) {
+        for (int r = 2; r < 20; r++) {
+            if (rand() % 3 == 0) {
+                char value[16];
+
+                snprintf(value, sizeof(value), "%6d", rand() % 100000);
+                draw_style(rand() % 2, rand() % 8, DEF);
+                draw_text(r, 14, value);
+                draw_style(0, DEF, DEF);
+            }
+        }
+        sum += present("dashboard");
+    }
+    report("dashboard update", sum, 100);
+}
+
+/* Every line rewritten, as a scrolled log */
+static void workload_log(void)
+{
+    long sum = 0;
+
+    for (int i = 0; i < 50; i++) {
+        draw_style(0, DEF, DEF);
+        draw_clear();
+        for (int r = 0; r < ROWS; r++) {
+            char line[96];
+
+            snprintf(line, sizeof(line), "[%05d] log line %d %s", i + r, r,
+                     (r + i) % 4 ? "ok" : "warning: something long happened here");
+            draw_text(r, 0, line);
+        }
+        sum += present("log");
+    }
+    report("log rewrite", sum, 50);
+}
+
+/* 40 random cells of random style per frame, cleared now and then */
+static void workload_random(void)
+{
+    long sum = 0;
+
+    for (int i = 0; i < 200; i++) {
+        for (int k = 0; k < 40; k++) {
+            char t[2] = { " abc#"[rand() % 5], '\0' };
+
+            draw_style(rand() % 8, rand() % 17, rand() % 17);
+            draw_text(rand() % ROWS, rand() % COLS, t);
+        }
+        if (i % 20 == 0) {
+            draw_style(0, DEF, rand() % 17);
+            draw_clear();
+        }
+        sum += present("random");
+    }
+    report("random cells", sum, 200);
+}
+
+/* A reverse-video box sliding right, redrawn from scratch each frame */
+static void workload_box(void)
+{
+    long sum = 0;
+
+    for (int i = 0; i < 60; i++) {
+        draw_style(0, DEF, DEF);
+        draw_clear();
+        draw_style(LAUNCHPAD_VTTY_ATTR_REVERSE, DEF, DEF);
+        for (int r = 5; r < 10; r++) {
+            for (int c = 0; c < 20; c++) {
+                draw_text(r, (i + c) % COLS, " ");
+            }
+        }
+        draw_cursor(ROWS - 1, 0);
+        sum += present("box");
+    }
+    report("moving box", sum, 60);
+}
+
+int main(void)
+{
+    srand(1);
+    s_scr = launchpad_vtty_screen_create(ROWS, COLS);
+    CHECK(s_scr != NULL, "create");
+
+    draw_style(0, DEF, DEF);
+    draw_clear();
+    printf("%-18s %7ld bytes\n", "first frame", present("first"));
+
+    workload_dashboard();
+    workload_log();
+    workload_random();
+    workload_box();
+
+    /* A full redraw must reproduce the same screen */
+    launchpad_vtty_screen_invalidate(s_scr);
+    present("invalidate");
+
+    launchpad_vtty_screen_destroy(s_scr);
+    return host_result();
+}
@@ -0,0 +1,259 @@
+/* -------------------------------------------------------------
+ * test_vtty_tx.c
+ *
+ * Console output through the vtty core and its queue, into mock
+ * drivers that record every call. Checks that the bytes arrive
+ * complete and in order, that concurrent printfs stay whole
+ * lines and that sinks see the same stream; reports how many
+ * driver calls character-at-a-time output costs.
+ * ------------------------------------------------------------- */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "launchpad_vtty.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define CAPTURE_MAX (1u << 20)
+
+struct capture {
+    char buf[CAPTURE_MAX];
+    size_t len;
+    long calls;
+};
+
+static struct capture s_write_cap, s_putc_cap, s_sink_cap;
+
+static void capture(struct capture *c, const char *buf, size_t len)
+{
+    if (c->len + len <= CAPTURE_MAX) {
+        memcpy(c->buf + c->len, buf, len);
+    }
+    c->len += len;
+    c->calls++;
+}
+
+static void capture_reset(struct capture *c)
+{
+    c->len = 0;
+    c->calls = 0;
+}
+
+static int mock_write(const char *buf, size_t len)
+{
+    capture(&s_write_cap, buf, len);
+    return (int)len;
+}
+
+static int mock_putc(char c)
+{
+    capture(&s_putc_cap, &c, 1);
+    return 0;
+}
+
+static const struct vtty_driver s_mock_write = {
+    .id = 7,
+    .type = "mock-write",
+    .write = mock_write,
+};
+
+static const struct vtty_driver s_mock_putc = {
+    .id = 8,
+    .type = "mock-putc",
+    .putc = mock_putc,
+};
+
+/* The console the firmware would bring up; none on the host */
+int launchpad_vtty_register_uart(int uart_num, int tx_pin, int rx_pin, int baud)
+{
+    (void)uart_num;
+    (void)tx_pin;
+    (void)rx_pin;
+    (void)baud;
+    return -1;
+}
+
+int vtty_vfs_register(void)
+{
+    return 0;
+}
+
+void vtty_vfs_notify(int idx)
+{
+    (void)idx;
+}
+
+/* -------------------------------------------------------------------------- */
+
+#define LINES 1000
+#define TEXT  "hello, world: line of text "
+
+static size_t expect_lines(char *out)
+{
+    size_t n = 0;
+
+    for (int l = 0; l < LINES; l++) {
+        n += sprintf(out + n, TEXT "%d\n", l);
+    }
+    return n;
+}
+
+static void write_lines_by_char(void)
+{
+    for (int l = 0; l < LINES; l++) {
+        for (const char *p = TEXT; *p; p++) {
+            launchpad_vtty_putc(*p);
+        }
+        launchpad_vtty_printf("%d\n", l);
+    }
+    launchpad_vtty_flush();
+}
+
+static void test_bulk_driver(const char *want, size_t want_len)
+{
+    capture_reset(&s_write_cap);
+    CHECK(launchpad_vtty_set_default(7) == 0, "set_default");
+    write_lines_by_char();
+
+    CHECK(s_write_cap.len == want_len, "write driver got %zu of %zu bytes", s_write_cap.len, want_len);
+    CHECK(!memcmp(s_write_cap.buf, want, want_len), "write driver output differs");
+    printf("write driver: %ld calls for %zu bytes, %.3f calls/byte\n",
+           s_write_cap.calls, s_write_cap.len, (double)s_write_cap.calls / s_write_cap.len);
+
+    /* One driver call per queued record would be the unbatched cost */
+    struct launchpad_vtty_stats st;
+    launchpad_vtty_ioctl(LAUNCHPAD_VTTY_IOCTL_GET_STATS, &st);
+    CHECK(s_write_cap.calls < (long)st.records, "%ld calls for %u records", s_write_cap.calls, st.records);
+}
+
+static void test_putc_driver(const char *want, size_t want_len)
+{
+    capture_reset(&s_putc_cap);
+    CHECK(launchpad_vtty_set_default(8) == 0, "set_default");
+    write_lines_by_char();
+
+    CHECK(s_putc_cap.len == want_len, "putc driver got %zu of %zu bytes", s_putc_cap.len, want_len);
+    CHECK(!memcmp(s_putc_cap.buf, want, want_len), "putc driver output differs");
+}
+
+/* -------------------------------------------------------------------------- */
+
+#define WRITERS      4
+#define WRITER_LINES 2000
+
+static volatile int s_writers_done;
+
+static void writer_task(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+
+    for (int l = 0; l < WRITER_LINES; l++) {
+        launchpad_vtty_printf("writer %d line %d of %d: %s\n", id, l, WRITER_LINES,
+                              "some padding so the records are not tiny");
+    }
+    __atomic_add_fetch(&s_writers_done, 1, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+/* Each printf is one record: lines from several tasks never mix */
+static void test_concurrent_lines(void)
+{
+    int next[WRITERS] = { 0 };
+
+    capture_reset(&s_write_cap);
+    launchpad_vtty_set_default(7);
+    for (int i = 0; i < WRITERS; i++) {
+        xTaskCreate(writer_task, "writer", 4096, (void *)(intptr_t)i, 1, NULL);
+    }
+    while (__atomic_load_n(&s_writers_done, __ATOMIC_ACQUIRE) < WRITERS) {
+        vTaskDelay(1);
+    }
+    launchpad_vtty_flush();
+
+    char *p = s_write_cap.buf, *end = p + s_write_cap.len;
+    int lines = 0;
+
+    while (p < end) {
+        char *nl = memchr(p, '\n', end - p);
+        int id, l, total, used = 0;
+
+        if (!nl || sscanf(p, "writer %d line %d of %d: %n", &id, &l, &total, &used) != 3 ||
+            id < 0 || id >= WRITERS || l != next[id] ||
+            strncmp(p + used, "some padding so the records are not tiny", nl - p - used)) {
+            CHECK(0, "broken line %d: %.60s", lines, p);
+            return;
+        }
+        next[id]++;
+        lines++;
+        p = nl + 1;
+    }
+    CHECK(lines == WRITERS * WRITER_LINES, "%d lines", lines);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static int sink_write(void *ctx, const char *buf, size_t len)
+{
+    capture(ctx, buf, len);
+    return 0;
+}
+
+static void sink_wait(int id)
+{
+    struct launchpad_vtty_sink_stats st = { .id = id };
+
+    do {
+        vTaskDelay(1);
+        launchpad_vtty_ioctl(LAUNCHPAD_VTTY_IOCTL_SINK_STATS, &st);
+    } while (st.lag);
+}
+
+static void test_sink(void)
+{
+    char want[256];
+    size_t want_len = 0;
+
+    capture_reset(&s_write_cap);
+    launchpad_vtty_set_default(7);
+
+    int id = launchpad_vtty_sink_add("capture", sink_write, &s_sink_cap);
+    CHECK(id >= 0, "sink_add");
+
+    for (int l = 0; l < 8; l++) {
+        char line[32];
+        int n = snprintf(line, sizeof(line), "sink line %d\n", l);
+
+        memcpy(want + want_len, line, n);
+        want_len += n;
+        launchpad_vtty_write(line, n);
+        sink_wait(id);
+    }
+    launchpad_vtty_flush();
+
+    /* Removal joins the sink task, so its writes are visible after */
+    CHECK(launchpad_vtty_sink_remove(id) == 0, "sink_remove");
+    CHECK(s_sink_cap.len == want_len && !memcmp(s_sink_cap.buf, want, want_len),
+          "sink got %zu of %zu bytes", s_sink_cap.len, want_len);
+    CHECK(s_write_cap.len == want_len && !memcmp(s_write_cap.buf, want, want_len),
+          "driver got %zu of %zu bytes", s_write_cap.len, want_len);
+}
+
+int main(void)
+{
+    static char want[LINES * 40];
+    size_t want_len = expect_lines(want);
+
+    launchpad_vtty_init();
+    launchpad_vtty_register_driver(&s_mock_write);
+    launchpad_vtty_register_driver(&s_mock_putc);
+
+    test_bulk_driver(want, want_len);
+    test_putc_driver(want, want_len);
+    test_concurrent_lines();
+    test_sink();
+
+    launchpad_vtty_deinit();
+    return host_result();
+}